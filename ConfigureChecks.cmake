@@ -97,6 +97,7 @@ if(UNIX)
 	cmake_push_check_state()
 	list(APPEND CMAKE_REQUIRED_DEFINITIONS -D_GNU_SOURCE)
 	check_symbol_exists("memmem"        "string.h"   HAVE_MEMMEM)
+	check_symbol_exists("posix_fallocate" "fcntl.h"  HAVE_POSIX_FALLOCATE)
 	check_symbol_exists("strcasestr"    "string.h"   HAVE_STRCASESTR)
 	check_symbol_exists("strerrorname_np" "string.h" HAVE_STRERRORNAME_NP)
 	check_symbol_exists("strptime"      "time.h"     HAVE_STRPTIME)
@@ -50,7 +50,9 @@
 #include <stdarg.h>
 #include <locale.h>
 #include <errno.h>
+#include <fcntl.h>
 
+#include <ws_attributes.h>
 #include <ws_exit_codes.h>
 #include <wsutil/ws_getopt.h>
 
@@ -59,6 +61,7 @@
 #include <wiretap/wtap.h>
 
 #include <wsutil/cmdarg_err.h>
+#include <wsutil/clopts_common.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/privileges.h>
 #include <cli_main.h>
@@ -91,6 +94,8 @@
 
 static gboolean stop_after_failure = FALSE;
 
+static guint32 num_jobs = 1;        /* Number of files read at the same time */
+
 /*
  * table report variables
  */
@@ -146,16 +151,13 @@ static gboolean cap_file_hashes    = TRUE;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static gchar file_sha256[HASH_STR_SIZE];
-static gchar file_sha1[HASH_STR_SIZE];
-
-static char  *hash_buf = NULL;
-static gcry_md_hd_t hd = NULL;
-
-static guint num_ipv4_addresses;
-static guint num_ipv6_addresses;
-static guint num_decryption_secrets;
+/*
+ * The callbacks for name resolution and decryption secrets blocks don't
+ * get any user data, and with -j the files are read in several threads.
+ */
+static WS_THREAD_LOCAL guint num_ipv4_addresses;
+static WS_THREAD_LOCAL guint num_ipv6_addresses;
+static WS_THREAD_LOCAL guint num_decryption_secrets;
 
 /*
  * If we have at least two packets with time stamps, and they're not in
@@ -209,6 +211,27 @@ typedef struct _capture_info {
     GArray               *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
     guint32               pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
     GArray               *idb_info_strings;         /* array of IDB info strings */
+
+    gchar                 file_sha256[HASH_STR_SIZE];
+    gchar                 file_sha1[HASH_STR_SIZE];
+    gcry_md_hd_t          hash_hd;                  /* while the file is read */
+    gint64                hashed;                   /* bytes of the file hashed so far */
+
+    guint                 num_ipv4_addresses;
+    guint                 num_ipv6_addresses;
+    guint                 num_decryption_secrets;
+
+    /*
+     * Problems found while reading the file; they're reported together
+     * with the infos, so that they're in the same order.
+     */
+    int                   open_err;
+    gchar                *open_err_info;
+    int                   read_err;
+    gchar                *read_err_info;
+    int                   size_err;
+    GString              *warnings;
+    gboolean              scanned;                  /* protected by scan_mutex */
 } capture_info;
 
 static char *decimal_point;
@@ -740,8 +763,8 @@ print_stats(const gchar *filename, capture_info *cf_info)
         }
     }
     if (cap_file_hashes) {
-        printf     ("SHA256:              %s\n", file_sha256);
-        printf     ("SHA1:                %s\n", file_sha1);
+        printf     ("SHA256:              %s\n", cf_info->file_sha256);
+        printf     ("SHA1:                %s\n", cf_info->file_sha1);
     }
     if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -794,14 +817,14 @@ print_stats(const gchar *filename, capture_info *cf_info)
         }
 
         if (cap_file_nrb) {
-            if (num_ipv4_addresses != 0)
-                printf   ("Number of resolved IPv4 addresses in file: %u\n", num_ipv4_addresses);
-            if (num_ipv6_addresses != 0)
-                printf   ("Number of resolved IPv6 addresses in file: %u\n", num_ipv6_addresses);
+            if (cf_info->num_ipv4_addresses != 0)
+                printf   ("Number of resolved IPv4 addresses in file: %u\n", cf_info->num_ipv4_addresses);
+            if (cf_info->num_ipv6_addresses != 0)
+                printf   ("Number of resolved IPv6 addresses in file: %u\n", cf_info->num_ipv6_addresses);
         }
         if (cap_file_dsb) {
-            if (num_decryption_secrets != 0)
-                printf   ("Number of decryption secrets in file: %u\n", num_decryption_secrets);
+            if (cf_info->num_decryption_secrets != 0)
+                printf   ("Number of decryption secrets in file: %u\n", cf_info->num_decryption_secrets);
         }
     }
 }
@@ -1020,12 +1043,12 @@ print_stats_table(const gchar *filename, capture_info *cf_info)
     if (cap_file_hashes) {
         putsep();
         putquote();
-        printf("%s", file_sha256);
+        printf("%s", cf_info->file_sha256);
         putquote();
 
         putsep();
         putquote();
-        printf("%s", file_sha1);
+        printf("%s", cf_info->file_sha1);
         putquote();
     }
 
@@ -1155,38 +1178,82 @@ hash_to_str(const unsigned char *hash, size_t length, char *str)
     }
 }
 
+/*
+ * The hashes are computed from the data wiretap reads from the file, so
+ * that the file is only read once. Data that wiretap reads again after
+ * seeking back is skipped; data it didn't read before the callback was
+ * set, or that it skipped by seeking forward or by not reading up to the
+ * end of the file, is read from the file by hash_file_data().
+ */
 static void
-calculate_hashes(const char *filename)
+hash_raw_data(gint64 offset, const guint8 *data, guint len, void *user_data)
 {
-    FILE  *fh;
-    size_t hash_bytes;
+    capture_info *cf_info = (capture_info *)user_data;
+
+    if (offset <= cf_info->hashed && offset + len > cf_info->hashed) {
+        gcry_md_write(cf_info->hash_hd, data + (cf_info->hashed - offset),
+                (size_t)(offset + len - cf_info->hashed));
+        cf_info->hashed = offset + len;
+    }
+}
 
-    (void) g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    (void) g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+/* Hash the file from where the hashes are up to until end, or until the
+   end of the file if end is -1. */
+static gboolean
+hash_file_data(capture_info *cf_info, gint64 end)
+{
+    int      fd;
+    char    *hash_buf;
+    gint64   to_read;
+    ssize_t  bytes_read;
+    gboolean ok = TRUE;
+
+    if (end != -1 && cf_info->hashed >= end)
+        return TRUE;
+
+    fd = ws_open(cf_info->filename, O_RDONLY|O_BINARY, 0000);
+    if (fd == -1)
+        return FALSE;
+    if (ws_lseek64(fd, cf_info->hashed, SEEK_SET) == -1) {
+        ws_close(fd);
+        return FALSE;
+    }
 
-    if (cap_file_hashes) {
-        fh = ws_fopen(filename, "rb");
-        if (fh && hd) {
-            while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-                gcry_md_write(hd, hash_buf, hash_bytes);
-            }
-            gcry_md_final(hd);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
+    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
+    for (;;) {
+        to_read = HASH_BUF_SIZE;
+        if (end != -1 && end - cf_info->hashed < to_read)
+            to_read = end - cf_info->hashed;
+        if (to_read == 0)
+            break;
+        bytes_read = ws_read(fd, hash_buf, (unsigned int)to_read);
+        if (bytes_read < 0) {
+            ok = FALSE;
+            break;
         }
-        if (fh) fclose(fh);
-        if (hd) gcry_md_reset(hd);
+        if (bytes_read == 0)
+            break;
+        gcry_md_write(cf_info->hash_hd, hash_buf, (size_t)bytes_read);
+        cf_info->hashed += bytes_read;
     }
+    g_free(hash_buf);
+    ws_close(fd);
+    return ok;
 }
 
-static int
-process_cap_file(const char *filename, gboolean need_separator)
+/*
+ * Read the file and fill in cf_info, without reporting anything, so
+ * that several files can be read at the same time; report_cap_file()
+ * reports the results.
+ */
+static void
+scan_cap_file(capture_info *cf_info)
 {
-    int                   status = 0;
     int                   err;
     gchar                *err_info;
     gint64                size;
     gint64                data_offset;
+    gint64                hashed_before;
 
     guint32               packet = 0;
     gint64                bytes  = 0;
@@ -1194,7 +1261,6 @@ process_cap_file(const char *filename, gboolean need_separator)
     guint32               snaplen_max_inferred =          0;
     wtap_rec              rec;
     Buffer                buf;
-    capture_info          cf_info;
     gboolean              have_times = TRUE;
     nstime_t              start_time;
     int                   start_time_tsprec;
@@ -1207,21 +1273,29 @@ process_cap_file(const char *filename, gboolean need_separator)
     guint                 i;
     wtapng_iface_descriptions_t *idb_info;
 
-    cf_info.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
-    if (!cf_info.wth) {
-        cfile_open_failure_message(filename, err, err_info);
-        return 2;
+    cf_info->wth = wtap_open_offline(cf_info->filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+    if (!cf_info->wth) {
+        cf_info->open_err = err;
+        cf_info->open_err_info = err_info;
+        return;
     }
 
     /*
-     * Calculate the checksums. Do this after wtap_open_offline, so we don't
+     * Start the checksums. Do this after wtap_open_offline, so we don't
      * bother calculating them for files that are not known capture types
      * where we wouldn't print them anyway.
      */
-    calculate_hashes(filename);
-
-    if (need_separator && long_report) {
-        printf("\n");
+    (void) g_strlcpy(cf_info->file_sha256, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->file_sha1, "<unknown>", HASH_STR_SIZE);
+    if (cap_file_hashes && gcry_md_open(&cf_info->hash_hd, GCRY_MD_SHA256, 0) == 0) {
+        gcry_md_enable(cf_info->hash_hd, GCRY_MD_SHA1);
+        cf_info->hashed = 0;
+        hashed_before = wtap_set_cb_raw_data(cf_info->wth, hash_raw_data, cf_info);
+        if (!hash_file_data(cf_info, hashed_before)) {
+            wtap_set_cb_raw_data(cf_info->wth, NULL, NULL);
+            gcry_md_close(cf_info->hash_hd);
+            cf_info->hash_hd = NULL;
+        }
     }
 
     nstime_set_zero(&start_time);
@@ -1231,25 +1305,25 @@ process_cap_file(const char *filename, gboolean need_separator)
     nstime_set_zero(&cur_time);
     nstime_set_zero(&prev_time);
 
-    cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+    cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
     ws_assert(idb_info->interface_data != NULL);
 
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    cf_info.interface_packet_counts  = g_array_sized_new(FALSE, TRUE, sizeof(guint32), cf_info.num_interfaces);
-    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-    cf_info.pkt_interface_id_unknown = 0;
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    cf_info->interface_packet_counts  = g_array_sized_new(FALSE, TRUE, sizeof(guint32), cf_info->num_interfaces);
+    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+    cf_info->pkt_interface_id_unknown = 0;
 
     g_free(idb_info);
     idb_info = NULL;
 
     /* Register callbacks for new name<->address maps from the file and
        decryption secrets from the file. */
-    wtap_set_cb_new_ipv4(cf_info.wth, count_ipv4_address);
-    wtap_set_cb_new_ipv6(cf_info.wth, count_ipv6_address);
-    wtap_set_cb_new_secrets(cf_info.wth, count_decryption_secret);
+    wtap_set_cb_new_ipv4(cf_info->wth, count_ipv4_address);
+    wtap_set_cb_new_ipv6(cf_info->wth, count_ipv6_address);
+    wtap_set_cb_new_secrets(cf_info->wth, count_decryption_secret);
 
     /* Zero out the counters for the callbacks. */
     num_ipv4_addresses = 0;
@@ -1259,7 +1333,7 @@ process_cap_file(const char *filename, gboolean need_separator)
     /* Tally up data that we need to parse through the file to find */
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
-    while (wtap_read(cf_info.wth, &rec, &buf, &err, &err_info, &data_offset))  {
+    while (wtap_read(cf_info->wth, &rec, &buf, &err, &err_info, &data_offset))  {
         if (rec.presence_flags & WTAP_HAS_TS) {
             prev_time = cur_time;
             cur_time = rec.ts;
@@ -1304,45 +1378,48 @@ process_cap_file(const char *filename, gboolean need_separator)
 
             if ((rec.rec_header.packet_header.pkt_encap > 0) &&
                     (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-                cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
+                cf_info->encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
             } else {
-                fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
-                        rec.rec_header.packet_header.pkt_encap, packet, filename);
+                if (cf_info->warnings == NULL)
+                    cf_info->warnings = g_string_new(NULL);
+                g_string_append_printf(cf_info->warnings,
+                        "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
+                        rec.rec_header.packet_header.pkt_encap, packet, cf_info->filename);
             }
 
             /* Packet interface_id info */
             if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-                /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-                if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+                /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+                if (rec.rec_header.packet_header.interface_id >= cf_info->num_interfaces) {
                     /*
                      * OK, re-fetch the number of interfaces, as there might have
                      * been an interface that was in the middle of packets, and
                      * grow the array to be big enough for the new number of
                      * interfaces.
                      */
-                    idb_info = wtap_file_get_idb_info(cf_info.wth);
+                    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-                    cf_info.num_interfaces = idb_info->interface_data->len;
-                    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+                    cf_info->num_interfaces = idb_info->interface_data->len;
+                    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
                     g_free(idb_info);
                     idb_info = NULL;
                 }
-                if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-                    g_array_index(cf_info.interface_packet_counts, guint32,
+                if (rec.rec_header.packet_header.interface_id < cf_info->num_interfaces) {
+                    g_array_index(cf_info->interface_packet_counts, guint32,
                             rec.rec_header.packet_header.interface_id) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
             else {
                 /* it's for interface_id 0 */
-                if (cf_info.num_interfaces != 0) {
-                    g_array_index(cf_info.interface_packet_counts, guint32, 0) += 1;
+                if (cf_info->num_interfaces != 0) {
+                    g_array_index(cf_info->interface_packet_counts, guint32, 0) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
         }
@@ -1352,6 +1429,21 @@ process_cap_file(const char *filename, gboolean need_separator)
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
 
+    cf_info->num_ipv4_addresses = num_ipv4_addresses;
+    cf_info->num_ipv6_addresses = num_ipv6_addresses;
+    cf_info->num_decryption_secrets = num_decryption_secrets;
+
+    if (cf_info->hash_hd) {
+        wtap_set_cb_raw_data(cf_info->wth, NULL, NULL);
+        if (hash_file_data(cf_info, -1)) {
+            gcry_md_final(cf_info->hash_hd);
+            hash_to_str(gcry_md_read(cf_info->hash_hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, cf_info->file_sha256);
+            hash_to_str(gcry_md_read(cf_info->hash_hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->file_sha1);
+        }
+        gcry_md_close(cf_info->hash_hd);
+        cf_info->hash_hd = NULL;
+    }
+
     /*
      * Get IDB info strings.
      * We do this at the end, so we can get information for all IDBs in
@@ -1359,114 +1451,181 @@ process_cap_file(const char *filename, gboolean need_separator)
      * we get, for example, a count of the number of statistics entries
      * for each interface as of the *end* of the file.
      */
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-    cf_info.idb_info_strings = g_array_sized_new(FALSE, FALSE, sizeof(gchar*), cf_info.num_interfaces);
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    for (i = 0; i < cf_info.num_interfaces; i++) {
+    cf_info->idb_info_strings = g_array_sized_new(FALSE, FALSE, sizeof(gchar*), cf_info->num_interfaces);
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    for (i = 0; i < cf_info->num_interfaces; i++) {
         const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
         gchar *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-        g_array_append_val(cf_info.idb_info_strings, s);
+        g_array_append_val(cf_info->idb_info_strings, s);
     }
 
     g_free(idb_info);
     idb_info = NULL;
 
+    /* # of packets */
+    cf_info->packet_count = packet;
+
     if (err != 0) {
-        fprintf(stderr,
-                "capinfos: An error occurred after reading %u packets from \"%s\".\n",
-                packet, filename);
-        cfile_read_failure_message(filename, err, err_info);
-        if (err == WTAP_ERR_SHORT_READ) {
-            /* Don't give up completely with this one. */
-            status = 1;
-            fprintf(stderr,
-                    "  (will continue anyway, checksums might be incorrect)\n");
-        } else {
-            cleanup_capture_info(&cf_info);
-            wtap_close(cf_info.wth);
-            return 2;
-        }
+        cf_info->read_err = err;
+        cf_info->read_err_info = err_info;
+        /* Don't give up completely with a short read. */
+        if (err != WTAP_ERR_SHORT_READ)
+            return;
     }
 
     /* File size */
-    size = wtap_file_size(cf_info.wth, &err);
+    size = wtap_file_size(cf_info->wth, &err);
     if (size == -1) {
-        fprintf(stderr,
-                "capinfos: Can't get size of \"%s\": %s.\n",
-                filename, g_strerror(err));
-        cleanup_capture_info(&cf_info);
-        wtap_close(cf_info.wth);
-        return 2;
+        cf_info->size_err = err;
+        return;
     }
 
-    cf_info.filesize = size;
+    cf_info->filesize = size;
 
     /* File Type */
-    cf_info.file_type = wtap_file_type_subtype(cf_info.wth);
-    cf_info.compression_type = wtap_get_compression_type(cf_info.wth);
+    cf_info->file_type = wtap_file_type_subtype(cf_info->wth);
+    cf_info->compression_type = wtap_get_compression_type(cf_info->wth);
 
     /* File Encapsulation */
-    cf_info.file_encap = wtap_file_encap(cf_info.wth);
+    cf_info->file_encap = wtap_file_encap(cf_info->wth);
 
-    cf_info.file_tsprec = wtap_file_tsprec(cf_info.wth);
+    cf_info->file_tsprec = wtap_file_tsprec(cf_info->wth);
 
     /* Packet size limit (snaplen) */
-    cf_info.snaplen = wtap_snapshot_length(cf_info.wth);
-    if (cf_info.snaplen > 0)
-        cf_info.snap_set = TRUE;
+    cf_info->snaplen = wtap_snapshot_length(cf_info->wth);
+    if (cf_info->snaplen > 0)
+        cf_info->snap_set = TRUE;
     else
-        cf_info.snap_set = FALSE;
+        cf_info->snap_set = FALSE;
 
-    cf_info.snaplen_min_inferred = snaplen_min_inferred;
-    cf_info.snaplen_max_inferred = snaplen_max_inferred;
-
-    /* # of packets */
-    cf_info.packet_count = packet;
+    cf_info->snaplen_min_inferred = snaplen_min_inferred;
+    cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
     /* File Times */
-    cf_info.times_known = have_times;
-    cf_info.start_time = start_time;
-    cf_info.start_time_tsprec = start_time_tsprec;
-    cf_info.stop_time = stop_time;
-    cf_info.stop_time_tsprec = stop_time_tsprec;
-    nstime_delta(&cf_info.duration, &stop_time, &start_time);
+    cf_info->times_known = have_times;
+    cf_info->start_time = start_time;
+    cf_info->start_time_tsprec = start_time_tsprec;
+    cf_info->stop_time = stop_time;
+    cf_info->stop_time_tsprec = stop_time_tsprec;
+    nstime_delta(&cf_info->duration, &stop_time, &start_time);
     /* Duration precision is the higher of the start and stop time precisions. */
-    if (cf_info.stop_time_tsprec > cf_info.start_time_tsprec)
-        cf_info.duration_tsprec = cf_info.stop_time_tsprec;
+    if (cf_info->stop_time_tsprec > cf_info->start_time_tsprec)
+        cf_info->duration_tsprec = cf_info->stop_time_tsprec;
     else
-        cf_info.duration_tsprec = cf_info.start_time_tsprec;
-    cf_info.know_order = know_order;
-    cf_info.order = order;
+        cf_info->duration_tsprec = cf_info->start_time_tsprec;
+    cf_info->know_order = know_order;
+    cf_info->order = order;
 
     /* Number of packet bytes */
-    cf_info.packet_bytes = bytes;
+    cf_info->packet_bytes = bytes;
 
-    cf_info.data_rate   = 0.0;
-    cf_info.packet_rate = 0.0;
-    cf_info.packet_size = 0.0;
+    cf_info->data_rate   = 0.0;
+    cf_info->packet_rate = 0.0;
+    cf_info->packet_size = 0.0;
 
     if (packet > 0) {
         double delta_time = nstime_to_sec(&stop_time) - nstime_to_sec(&start_time);
         if (delta_time > 0.0) {
-            cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-            cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+            cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+            cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
         }
-        cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+        cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    }
+}
+
+/* Free what's left of cf_info, after reporting it or instead. */
+static void
+close_cap_file(capture_info *cf_info)
+{
+    if (cf_info->wth) {
+        cleanup_capture_info(cf_info);
+        wtap_close(cf_info->wth);
+        cf_info->wth = NULL;
+    }
+    g_free(cf_info->open_err_info);
+    cf_info->open_err_info = NULL;
+    g_free(cf_info->read_err_info);
+    cf_info->read_err_info = NULL;
+    if (cf_info->warnings) {
+        g_string_free(cf_info->warnings, TRUE);
+        cf_info->warnings = NULL;
+    }
+}
+
+/* Report the results of scan_cap_file(). */
+static int
+report_cap_file(capture_info *cf_info, gboolean need_separator)
+{
+    int status = 0;
+
+    if (!cf_info->wth) {
+        cfile_open_failure_message(cf_info->filename, cf_info->open_err, cf_info->open_err_info);
+        cf_info->open_err_info = NULL;
+        return 2;
+    }
+
+    if (need_separator && long_report) {
+        printf("\n");
+    }
+
+    if (cf_info->warnings) {
+        fputs(cf_info->warnings->str, stderr);
+    }
+
+    if (cf_info->read_err != 0) {
+        fprintf(stderr,
+                "capinfos: An error occurred after reading %u packets from \"%s\".\n",
+                cf_info->packet_count, cf_info->filename);
+        cfile_read_failure_message(cf_info->filename, cf_info->read_err, cf_info->read_err_info);
+        cf_info->read_err_info = NULL;
+        if (cf_info->read_err == WTAP_ERR_SHORT_READ) {
+            /* Don't give up completely with this one. */
+            status = 1;
+            fprintf(stderr,
+                    "  (will continue anyway, checksums might be incorrect)\n");
+        } else {
+            close_cap_file(cf_info);
+            return 2;
+        }
+    }
+
+    if (cf_info->size_err != 0) {
+        fprintf(stderr,
+                "capinfos: Can't get size of \"%s\": %s.\n",
+                cf_info->filename, g_strerror(cf_info->size_err));
+        close_cap_file(cf_info);
+        return 2;
     }
 
     if (long_report) {
-        print_stats(filename, &cf_info);
+        print_stats(cf_info->filename, cf_info);
     } else {
-        print_stats_table(filename, &cf_info);
+        print_stats_table(cf_info->filename, cf_info);
     }
 
-    cleanup_capture_info(&cf_info);
-    wtap_close(cf_info.wth);
+    close_cap_file(cf_info);
 
     return status;
 }
 
+static GMutex scan_mutex;
+static GCond  scan_cond;
+
+static void
+scan_cap_file_thread(gpointer data, gpointer user_data _U_)
+{
+    capture_info *cf_info = (capture_info *)data;
+
+    scan_cap_file(cf_info);
+
+    g_mutex_lock(&scan_mutex);
+    cf_info->scanned = TRUE;
+    g_cond_broadcast(&scan_cond);
+    g_mutex_unlock(&scan_mutex);
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -1525,6 +1684,7 @@ print_usage(FILE *output)
     fprintf(output, "  -h, --help               display this help and exit\n");
     fprintf(output, "  -v, --version            display version info and exit\n");
     fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+    fprintf(output, "  -j <jobs> read up to <jobs> files at the same time (default is 1)\n");
     fprintf(output, "  -A generate all infos (default)\n");
     fprintf(output, "  -K disable displaying the capture comment\n");
     fprintf(output, "\n");
@@ -1582,6 +1742,11 @@ main(int argc, char *argv[])
     };
 
     int status = 0;
+    capture_info *cf_infos = NULL;
+    int    num_files = 0;
+    int    file_num;
+    int    next_scan = 0;
+    GThreadPool *scan_pool = NULL;
 
     /*
      * Set the C-language locale to the native environment and set the
@@ -1635,7 +1800,7 @@ main(int argc, char *argv[])
     wtap_init(TRUE);
 
     /* Process the options */
-    while ((opt = ws_getopt_long(argc, argv, "abcdehiklmnoqrstuvxyzABCDEFHIKLMNQRST", long_options, NULL)) !=-1) {
+    while ((opt = ws_getopt_long(argc, argv, "abcdehij:klmnoqrstuvxyzABCDEFHIKLMNQRST", long_options, NULL)) !=-1) {
 
         switch (opt) {
 
@@ -1751,6 +1916,10 @@ main(int argc, char *argv[])
                 stop_after_failure = TRUE;
                 break;
 
+            case 'j':
+                num_jobs = get_nonzero_guint32(ws_optarg, "number of jobs");
+                break;
+
             case 'A':
                 enable_all_infos();
                 break;
@@ -1830,18 +1999,48 @@ main(int argc, char *argv[])
 
     if (cap_file_hashes) {
         gcry_check_version(NULL);
-        gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-        if (hd)
-            gcry_md_enable(hd, GCRY_MD_SHA1);
-
-        hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
     }
 
     overall_error_status = 0;
 
-    for (opt = ws_optind; opt < argc; opt++) {
+    num_files = argc - ws_optind;
+    cf_infos = g_new0(capture_info, num_files);
+    for (file_num = 0; file_num < num_files; file_num++) {
+        cf_infos[file_num].filename = argv[ws_optind + file_num];
+    }
 
-        status = process_cap_file(argv[opt], need_separator);
+    if (num_jobs > 1 && num_files > 1) {
+        /*
+         * Read the files in a pool of threads, but report them in order
+         * from here. Only start reading a file when it's at most twice
+         * as many files ahead of the one to be reported next as there are
+         * threads, so that the threads have something to do while waiting
+         * for a file that takes longer without keeping all the files open.
+         */
+        scan_pool = g_thread_pool_new(scan_cap_file_thread, NULL,
+                (gint)MIN(num_jobs, (guint32)num_files), FALSE, NULL);
+        for (next_scan = 0; next_scan < num_files && (guint64)next_scan < 2 * (guint64)num_jobs; next_scan++) {
+            g_thread_pool_push(scan_pool, &cf_infos[next_scan], NULL);
+        }
+    }
+
+    for (file_num = 0; file_num < num_files; file_num++) {
+        capture_info *cf_info = &cf_infos[file_num];
+
+        if (scan_pool) {
+            g_mutex_lock(&scan_mutex);
+            while (!cf_info->scanned)
+                g_cond_wait(&scan_cond, &scan_mutex);
+            g_mutex_unlock(&scan_mutex);
+            if (next_scan < num_files) {
+                g_thread_pool_push(scan_pool, &cf_infos[next_scan], NULL);
+                next_scan++;
+            }
+        } else {
+            scan_cap_file(cf_info);
+        }
+
+        status = report_cap_file(cf_info, need_separator);
         if (status) {
             /* Something failed.  It's been reported; remember that processing
                one file failed and, if -C was specified, stop. */
@@ -1859,8 +2058,14 @@ main(int argc, char *argv[])
     }
 
 exit:
-    g_free(hash_buf);
-    gcry_md_close(hd);
+    if (scan_pool) {
+        /* Wait for the files being read and don't start reading others. */
+        g_thread_pool_free(scan_pool, TRUE, TRUE);
+    }
+    for (file_num = 0; file_num < num_files; file_num++) {
+        close_cap_file(&cf_infos[file_num]);
+    }
+    g_free(cf_infos);
     wtap_cleanup();
     free_progdirs();
     return overall_error_status;
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <locale.h>
 #include <string.h>
+#include <inttypes.h>
 #include <errno.h>
 
 #include <glib.h>
@@ -126,6 +127,28 @@ print_syntax_tree(dfilter_t *df)
     printf("Syntax tree:\n%s\n\n", dfilter_syntax_tree(df));
 }
 
+static void
+print_time_bound(const char *label, const nstime_t *t)
+{
+    if (nstime_is_unset(t))
+        printf(" %s: none\n", label);
+    else
+        printf(" %s: %" PRId64 ".%09d\n", label, (gint64)t->secs, t->nsecs);
+}
+
+static void
+print_time_window(dfilter_t *df)
+{
+    nstime_t start, end;
+
+    if (!dfilter_get_frame_time_window(df, &start, &end))
+        return;
+
+    printf("\nFrame time window:\n");
+    print_time_bound("Start", &start);
+    print_time_bound("End", &end);
+}
+
 static void
 print_warnings(dfilter_t *df)
 {
@@ -445,6 +468,8 @@ main(int argc, char **argv)
 
     dfilter_dump(stdout, df, dump_flags);
 
+    print_time_window(df);
+
     print_warnings(df);
 
     if (opt_timer)
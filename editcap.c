@@ -86,6 +86,11 @@ struct select_item {
 
 /*
  * Duplicate frame detection
+ *
+ * The packets in the duplicate window are kept in a FIFO ring, and their
+ * digests in a hash table that counts how many packets in the window have
+ * each digest, so checking a packet takes constant time regardless of the
+ * size of the window.
  */
 typedef struct _fd_hash_t {
     guint8     digest[16];
@@ -93,12 +98,23 @@ typedef struct _fd_hash_t {
     nstime_t   frame_time;
 } fd_hash_t;
 
+/* Packets in the window sharing the same digest and length */
+typedef struct _dup_entry_t {
+    fd_hash_t  hash;        /* frame_time is that of the most recent packet */
+    guint      count;
+} dup_entry_t;
+
 #define DEFAULT_DUP_DEPTH       5   /* Used with -d */
-#define MAX_DUP_DEPTH     1000000   /* the maximum window (and actual size of fd_hash[]) for de-duplication */
 
-static fd_hash_t fd_hash[MAX_DUP_DEPTH];
-static int       dup_window    = DEFAULT_DUP_DEPTH;
-static int       cur_dup_entry = 0;
+static fd_hash_t  *fd_hash       = NULL;   /* ring of packets in the window */
+static guint       fd_hash_size  = 0;
+static guint       fd_hash_first = 0;
+static guint       fd_hash_count = 0;
+static GHashTable *dup_table     = NULL;   /* fd_hash_t -> dup_entry_t */
+static fd_hash_t   cur_dup;                /* the current packet */
+static guint8     *dup_scratch   = NULL;   /* copy of the packet for --ignore-ttl */
+static guint32     dup_scratch_len = 0;
+static guint32     dup_window    = DEFAULT_DUP_DEPTH;
 
 static guint32   ignored_bytes  = 0;  /* Used with -I */
 
@@ -158,6 +174,7 @@ static gboolean               skip_radiotap             = FALSE;
 static gboolean               discard_all_secrets       = FALSE;
 static gboolean               discard_cap_comments      = FALSE;
 static gboolean               set_unused                = FALSE;
+static gboolean               dup_ignore_ttl            = FALSE;
 
 static int                    do_strict_time_adjustment = FALSE;
 static struct time_adjustment strict_time_adj           = {NSTIME_INIT_ZERO, 0}; /* strict time adjustment */
@@ -637,15 +654,242 @@ set_unused_info(const wtap_packet_header *phdr, guint8* fd) {
     }
 }
 
+/*
+ * MurmurHash3_x64_128, by Austin Appleby, placed in the public domain.
+ * Much faster than MD5 and good enough to tell packets apart; MD5 is
+ * still used with -V so that the printed hashes stay comparable.
+ */
+static inline guint64
+dup_hash_rotl64(guint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline guint64
+dup_hash_fmix64(guint64 k)
+{
+    k ^= k >> 33;
+    k *= G_GUINT64_CONSTANT(0xff51afd7ed558ccd);
+    k ^= k >> 33;
+    k *= G_GUINT64_CONSTANT(0xc4ceb9fe1a85ec53);
+    k ^= k >> 33;
+    return k;
+}
+
+static void
+dup_hash_buffer(guint8 *digest, const guint8 *data, guint32 len)
+{
+    const guint64 c1 = G_GUINT64_CONSTANT(0x87c37b91114253d5);
+    const guint64 c2 = G_GUINT64_CONSTANT(0x4cf5ad432745937f);
+    const guint32 nblocks = len / 16;
+    const guint8 *tail = data + nblocks * 16;
+    guint64 h1 = 0, h2 = 0, k1, k2;
+    guint32 i;
+
+    for (i = 0; i < nblocks; i++) {
+        memcpy(&k1, data + i * 16, 8);
+        memcpy(&k2, data + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = dup_hash_rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = dup_hash_rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = dup_hash_rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = dup_hash_rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    k1 = k2 = 0;
+    switch (len & 15) {
+        case 15: k2 ^= ((guint64)tail[14]) << 48; /* FALLTHROUGH */
+        case 14: k2 ^= ((guint64)tail[13]) << 40; /* FALLTHROUGH */
+        case 13: k2 ^= ((guint64)tail[12]) << 32; /* FALLTHROUGH */
+        case 12: k2 ^= ((guint64)tail[11]) << 24; /* FALLTHROUGH */
+        case 11: k2 ^= ((guint64)tail[10]) << 16; /* FALLTHROUGH */
+        case 10: k2 ^= ((guint64)tail[ 9]) << 8;  /* FALLTHROUGH */
+        case  9: k2 ^= ((guint64)tail[ 8]);
+                 k2 *= c2; k2 = dup_hash_rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+                 /* FALLTHROUGH */
+        case  8: k1 ^= ((guint64)tail[ 7]) << 56; /* FALLTHROUGH */
+        case  7: k1 ^= ((guint64)tail[ 6]) << 48; /* FALLTHROUGH */
+        case  6: k1 ^= ((guint64)tail[ 5]) << 40; /* FALLTHROUGH */
+        case  5: k1 ^= ((guint64)tail[ 4]) << 32; /* FALLTHROUGH */
+        case  4: k1 ^= ((guint64)tail[ 3]) << 24; /* FALLTHROUGH */
+        case  3: k1 ^= ((guint64)tail[ 2]) << 16; /* FALLTHROUGH */
+        case  2: k1 ^= ((guint64)tail[ 1]) << 8;  /* FALLTHROUGH */
+        case  1: k1 ^= ((guint64)tail[ 0]);
+                 k1 *= c1; k1 = dup_hash_rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+                 break;
+        default:
+                 break;
+    }
+
+    h1 ^= len; h2 ^= len;
+    h1 += h2; h2 += h1;
+    h1 = dup_hash_fmix64(h1);
+    h2 = dup_hash_fmix64(h2);
+    h1 += h2; h2 += h1;
+
+    memcpy(digest, &h1, 8);
+    memcpy(digest + 8, &h2, 8);
+}
+
+static guint
+dup_hash_func(gconstpointer key)
+{
+    guint h;
+
+    /* The digest is already well mixed. */
+    memcpy(&h, ((const fd_hash_t *)key)->digest, sizeof h);
+    return h;
+}
+
 static gboolean
-is_duplicate(guint8* fd, guint32 len) {
-    int i;
+dup_hash_equal(gconstpointer a, gconstpointer b)
+{
+    const fd_hash_t *fa = (const fd_hash_t *)a;
+    const fd_hash_t *fb = (const fd_hash_t *)b;
+
+    return fa->len == fb->len && memcmp(fa->digest, fb->digest, 16) == 0;
+}
+
+static void
+dup_window_init(void)
+{
+    dup_table = g_hash_table_new_full(dup_hash_func, dup_hash_equal, NULL, g_free);
+}
+
+static void
+dup_window_cleanup(void)
+{
+    if (dup_table) {
+        g_hash_table_destroy(dup_table);
+        dup_table = NULL;
+    }
+    g_free(fd_hash);
+    fd_hash = NULL;
+    fd_hash_size = fd_hash_first = fd_hash_count = 0;
+    g_free(dup_scratch);
+    dup_scratch = NULL;
+    dup_scratch_len = 0;
+}
+
+/* Add the current packet to the window. */
+static void
+dup_window_push(void)
+{
+    dup_entry_t *entry;
+
+    if (fd_hash_count == fd_hash_size) {
+        /* Grow the ring, moving the wrapped around part up. */
+        guint new_size = fd_hash_size ? fd_hash_size * 2 : 1024;
+
+        fd_hash = g_renew(fd_hash_t, fd_hash, new_size);
+        if (fd_hash_first + fd_hash_count > fd_hash_size) {
+            guint wrapped = fd_hash_first + fd_hash_count - fd_hash_size;
+
+            memcpy(&fd_hash[fd_hash_size], &fd_hash[0], wrapped * sizeof(fd_hash_t));
+        }
+        fd_hash_size = new_size;
+    }
+    fd_hash[(fd_hash_first + fd_hash_count) % fd_hash_size] = cur_dup;
+    fd_hash_count++;
+
+    entry = (dup_entry_t *)g_hash_table_lookup(dup_table, &cur_dup);
+    if (entry == NULL) {
+        entry = g_new0(dup_entry_t, 1);
+        entry->hash = cur_dup;
+        g_hash_table_insert(dup_table, &entry->hash, entry);
+    } else {
+        entry->hash.frame_time = cur_dup.frame_time;
+    }
+    entry->count++;
+}
+
+/* Remove the oldest packet from the window. */
+static void
+dup_window_pop(void)
+{
+    fd_hash_t *oldest = &fd_hash[fd_hash_first];
+    dup_entry_t *entry;
+
+    entry = (dup_entry_t *)g_hash_table_lookup(dup_table, oldest);
+    ws_assert(entry != NULL);
+    if (--entry->count == 0)
+        g_hash_table_remove(dup_table, oldest);
+
+    fd_hash_first = (fd_hash_first + 1) % fd_hash_size;
+    fd_hash_count--;
+}
+
+/*
+ * Zero the IPv4 TTL and header checksum or the IPv6 hop limit, which
+ * differ between copies of the same packet seen on either side of a
+ * router, e.g. on different SPAN ports.
+ */
+static void
+dup_clear_ip_volatile(const wtap_packet_header *phdr, guint8 *fd, guint32 len)
+{
+    guint32 offset;
+    guint16 ethertype;
+
+    switch (phdr->pkt_encap) {
+        case WTAP_ENCAP_ETHERNET:
+            if (len < 14)
+                return;
+            offset = 12;
+            ethertype = pntoh16(&fd[offset]);
+            while ((ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_IEEE_802_1AD ||
+                    ethertype == ETHERTYPE_QINQ_OLD) && offset + 6 <= len) {
+                offset += 4;
+                ethertype = pntoh16(&fd[offset]);
+            }
+            offset += 2;
+            break;
+        case WTAP_ENCAP_SLL:
+            if (len < sizeof(struct sll_header))
+                return;
+            ethertype = pntoh16(fd + offsetof(struct sll_header, sll_protocol));
+            offset = sizeof(struct sll_header);
+            break;
+        case WTAP_ENCAP_SLL2:
+            if (len < sizeof(struct sll2_header))
+                return;
+            ethertype = pntoh16(fd + offsetof(struct sll2_header, sll2_protocol));
+            offset = sizeof(struct sll2_header);
+            break;
+        case WTAP_ENCAP_RAW_IP:
+            if (len < 1)
+                return;
+            ethertype = (fd[0] >> 4) == 6 ? ETHERTYPE_IPv6 : ETHERTYPE_IP;
+            offset = 0;
+            break;
+        case WTAP_ENCAP_RAW_IP4:
+            ethertype = ETHERTYPE_IP;
+            offset = 0;
+            break;
+        case WTAP_ENCAP_RAW_IP6:
+            ethertype = ETHERTYPE_IPv6;
+            offset = 0;
+            break;
+        default:
+            /* no support for current pkt_encap */
+            return;
+    }
+
+    if (ethertype == ETHERTYPE_IP && offset + 20 <= len && (fd[offset] >> 4) == 4) {
+        fd[offset + 8] = 0;                 /* TTL */
+        memset(&fd[offset + 10], 0, 2);     /* header checksum */
+    } else if (ethertype == ETHERTYPE_IPv6 && offset + 40 <= len && (fd[offset] >> 4) == 6) {
+        fd[offset + 7] = 0;                 /* hop limit */
+    }
+}
+
+/* Compute the digest of the current packet. */
+static void
+dup_digest(const wtap_packet_header *phdr, guint8* fd, guint32 len)
+{
     const struct ieee80211_radiotap_header* tap_header;
 
     /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
     guint32 offset = ignored_bytes;
-    guint32 new_len;
-    guint8 *new_fd;
 
     if (len <= ignored_bytes) {
         offset = 0;
@@ -659,143 +903,95 @@ is_duplicate(guint8* fd, guint32 len) {
             offset = 0;
     }
 
-    new_fd  = &fd[offset];
-    new_len = len - (offset);
-
-    cur_dup_entry++;
-    if (cur_dup_entry >= dup_window)
-        cur_dup_entry = 0;
-
-    /* Calculate our digest */
-    gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
-
-    fd_hash[cur_dup_entry].len = len;
-
-    /* Look for duplicates */
-    for (i = 0; i < dup_window; i++) {
-        if (i == cur_dup_entry)
-            continue;
-
-        if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-            && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
+    /* Don't touch the packet that is written out. */
+    if (dup_ignore_ttl) {
+        if (dup_scratch_len < len) {
+            dup_scratch_len = len;
+            dup_scratch = (guint8 *)g_realloc(dup_scratch, dup_scratch_len);
         }
+        memcpy(dup_scratch, fd, len);
+        dup_clear_ip_volatile(phdr, dup_scratch, len);
+        fd = dup_scratch;
     }
 
-    return FALSE;
+    /* Calculate our digest */
+    if (verbose)
+        gcry_md_hash_buffer(GCRY_MD_MD5, cur_dup.digest, &fd[offset], len - offset);
+    else
+        dup_hash_buffer(cur_dup.digest, &fd[offset], len - offset);
+
+    cur_dup.len = len;
 }
 
 static gboolean
-is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
-    int i;
+is_duplicate(const wtap_packet_header *phdr, guint8* fd, guint32 len) {
+    gboolean duplicate;
 
-    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
-    guint32 offset = ignored_bytes;
-    guint32 new_len;
-    guint8 *new_fd;
+    dup_digest(phdr, fd, len);
+    nstime_set_unset(&cur_dup.frame_time);
 
-    if (len <= ignored_bytes) {
-        offset = 0;
-    }
+    /*
+     * The current packet is compared to the previous <dup window> - 1
+     * packets; forget about the ones that are further back.
+     */
+    while (fd_hash_count > 0 && fd_hash_count >= dup_window)
+        dup_window_pop();
 
-    new_fd  = &fd[offset];
-    new_len = len - (offset);
+    duplicate = g_hash_table_contains(dup_table, &cur_dup);
 
-    cur_dup_entry++;
-    if (cur_dup_entry >= dup_window)
-        cur_dup_entry = 0;
+    if (dup_window > 1)
+        dup_window_push();
 
-    /* Calculate our digest */
-    gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
+    return duplicate;
+}
+
+static gboolean
+is_duplicate_rel_time(const wtap_packet_header *phdr, guint8* fd, guint32 len,
+                      const nstime_t *current) {
+    const dup_entry_t *entry;
+    nstime_t delta;
+    gboolean duplicate;
 
-    fd_hash[cur_dup_entry].len = len;
-    fd_hash[cur_dup_entry].frame_time.secs = current->secs;
-    fd_hash[cur_dup_entry].frame_time.nsecs = current->nsecs;
+    dup_digest(phdr, fd, len);
+    cur_dup.frame_time = *current;
 
     /*
-     * Look for relative time related duplicates.
-     * This is hopefully a reasonably efficient mechanism for
-     * finding duplicates by rel time in the fd_hash[] cache.
-     * We check starting from the most recently added hash
-     * entries and work backwards towards older packets.
-     * This approach allows the dup test to be terminated
-     * when the relative time of a cached entry is found to
-     * be beyond the dup time window.
+     * Forget about the packets that are older than the time window,
+     * starting with the oldest one.
      *
      * Of course this assumes that the input trace file is
      * "well-formed" in the sense that the packet timestamps are
      * in strict chronologically increasing order (which is NOT
-     * always the case!!).
-     *
-     * The fd_hash[] table was deliberately created large (1,000,000).
-     * Looking for time related duplicates in large trace files with
-     * non-fractional dup time window values can potentially take
-     * a long time to complete.
+     * always the case!!). We stop at the first packet that is
+     * within the window, or that has a timestamp later than the
+     * current packet, so packets that are out of order merely stay
+     * in the window for longer.
      */
-
-    for (i = cur_dup_entry - 1;; i--) {
-        nstime_t delta;
-        int cmp;
-
-        if (i < 0)
-            i = dup_window - 1;
-
-        if (i == cur_dup_entry) {
-            /*
-             * We've decremented back to where we started.
-             * Check no more!
-             */
+    while (fd_hash_count > 0) {
+        nstime_delta(&delta, current, &fd_hash[fd_hash_first].frame_time);
+        if (delta.secs < 0 || delta.nsecs < 0 ||
+            nstime_cmp(&delta, &relative_time_window) <= 0)
             break;
-        }
-
-        if (nstime_is_unset(&(fd_hash[i].frame_time))) {
-            /*
-             * We've decremented to an unused fd_hash[] entry.
-             * Check no more!
-             */
-            break;
-        }
-
-        nstime_delta(&delta, current, &fd_hash[i].frame_time);
-
-        if (delta.secs < 0 || delta.nsecs < 0) {
-            /*
-             * A negative delta implies that the current packet
-             * has an absolute timestamp less than the cached packet
-             * that it is being compared to.  This is NOT a normal
-             * situation since trace files usually have packets in
-             * chronological order (oldest to newest).
-             *
-             * There are several possible ways to deal with this:
-             * 1. 'continue' dup checking with the next cached frame.
-             * 2. 'break' from looking for a duplicate of the current frame.
-             * 3. Take the absolute value of the delta and see if that
-             * falls within the specifed dup time window.
-             *
-             * Currently this code does option 1.  But it would pretty
-             * easy to add yet-another-editcap-option to select one of
-             * the other behaviors for dealing with out-of-sequence
-             * packets.
-             */
-            continue;
-        }
-
-        cmp = nstime_cmp(&delta, &relative_time_window);
+        dup_window_pop();
+    }
 
-        if (cmp > 0) {
-            /*
-             * The delta time indicates that we are now looking at
-             * cached packets beyond the specified dup time window.
-             * Check no more!
-             */
-            break;
-        } else if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-                   && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
-        }
+    /*
+     * Only the most recent packet with the same digest is checked.
+     * If it has a timestamp later than the current packet, i.e. the
+     * packets are out of order, this is not considered a duplicate.
+     */
+    entry = (const dup_entry_t *)g_hash_table_lookup(dup_table, &cur_dup);
+    if (entry == NULL) {
+        duplicate = FALSE;
+    } else {
+        /* Compare before dup_window_push() sets the entry's time to ours. */
+        nstime_delta(&delta, current, &entry->hash.frame_time);
+        duplicate = delta.secs >= 0 && delta.nsecs >= 0 &&
+                    nstime_cmp(&delta, &relative_time_window) <= 0;
     }
+    dup_window_push();
 
-    return FALSE;
+    return duplicate;
 }
 
 static void
@@ -821,7 +1017,7 @@ print_usage(FILE *output)
     fprintf(output, "  --novlan               remove vlan info from packets before checking for duplicates.\n");
     fprintf(output, "  -d                     remove packet if duplicate (window == %d).\n", DEFAULT_DUP_DEPTH);
     fprintf(output, "  -D <dup window>        remove packet if duplicate; configurable <dup window>.\n");
-    fprintf(output, "                         Valid <dup window> values are 0 to %d.\n", MAX_DUP_DEPTH);
+    fprintf(output, "                         Valid <dup window> values are 0 to %u.\n", G_MAXUINT32);
     fprintf(output, "                         NOTE: A <dup window> of 0 with -V (verbose option) is\n");
     fprintf(output, "                         useful to print MD5 hashes.\n");
     fprintf(output, "  -w <dup time window>   remove packet if duplicate packet is found EQUAL TO OR\n");
@@ -836,6 +1032,8 @@ print_usage(FILE *output)
     fprintf(output, "                         Useful when processing packets captured by multiple radios\n");
     fprintf(output, "                         on the same channel in the vicinity of each other.\n");
     fprintf(output, "  --set-unused           set unused byts to zero in sll link addr.\n");
+    fprintf(output, "  --ignore-ttl           ignore the IPv4 TTL and header checksum and the IPv6\n");
+    fprintf(output, "                         hop limit when checking for duplicates.\n");
     fprintf(output, "\n");
     fprintf(output, "Packet manipulation:\n");
     fprintf(output, "  -s <snaplen>           truncate each packet to max. <snaplen> bytes of data.\n");
@@ -869,7 +1067,7 @@ print_usage(FILE *output)
     fprintf(output, "                         the pseudo-random number generator. This allows one to\n");
     fprintf(output, "                         repeat a particular sequence of errors.\n");
     fprintf(output, "  -I <bytes to ignore>   ignore the specified number of bytes at the beginning\n");
-    fprintf(output, "                         of the frame during MD5 hash calculation, unless the\n");
+    fprintf(output, "                         of the frame during hash calculation, unless the\n");
     fprintf(output, "                         frame is too short, then the full frame is used.\n");
     fprintf(output, "                         Useful to remove duplicated packets taken on\n");
     fprintf(output, "                         several routers (different mac addresses for\n");
@@ -1197,6 +1395,7 @@ main(int argc, char *argv[])
 #define LONGOPT_CAPTURE_COMMENT      LONGOPT_BASE_APPLICATION+6
 #define LONGOPT_DISCARD_CAPTURE_COMMENT LONGOPT_BASE_APPLICATION+7
 #define LONGOPT_SET_UNUSED           LONGOPT_BASE_APPLICATION+8
+#define LONGOPT_IGNORE_TTL           LONGOPT_BASE_APPLICATION+9
 
     static const struct ws_option long_options[] = {
         {"novlan", ws_no_argument, NULL, LONGOPT_NO_VLAN},
@@ -1209,6 +1408,7 @@ main(int argc, char *argv[])
         {"capture-comment", ws_required_argument, NULL, LONGOPT_CAPTURE_COMMENT},
         {"discard-capture-comment", ws_no_argument, NULL, LONGOPT_DISCARD_CAPTURE_COMMENT},
         {"set-unused", ws_no_argument, NULL, LONGOPT_SET_UNUSED},
+        {"ignore-ttl", ws_no_argument, NULL, LONGOPT_IGNORE_TTL},
         {0, 0, 0, 0 }
     };
 
@@ -1393,6 +1593,12 @@ main(int argc, char *argv[])
             break;
         }
 
+        case LONGOPT_IGNORE_TTL:
+        {
+            dup_ignore_ttl = TRUE;
+            break;
+        }
+
         case 'a':
         {
             guint frame_number;
@@ -1505,12 +1711,6 @@ main(int argc, char *argv[])
             dup_detect = TRUE;
             dup_detect_by_time = FALSE;
             dup_window = get_guint32(ws_optarg, "duplicate window");
-            if (dup_window > MAX_DUP_DEPTH) {
-                fprintf(stderr, "editcap: \"%d\" duplicate window value must be between 0 and %d inclusive.\n",
-                        dup_window, MAX_DUP_DEPTH);
-                ret = WS_EXIT_INVALID_OPTION;
-                goto clean_exit;
-            }
             break;
 
         case 'E':
@@ -1624,7 +1824,6 @@ main(int argc, char *argv[])
         case 'w':
             dup_detect = FALSE;
             dup_detect_by_time = TRUE;
-            dup_window = MAX_DUP_DEPTH;
             if (!set_rel_time(ws_optarg)) {
                 ret = WS_EXIT_INVALID_OPTION;
                 goto clean_exit;
@@ -1839,11 +2038,7 @@ main(int argc, char *argv[])
         max_packet_number = G_MAXUINT;
 
     if (dup_detect || dup_detect_by_time) {
-        for (i = 0; i < dup_window; i++) {
-            memset(&fd_hash[i].digest, 0, 16);
-            fd_hash[i].len = 0;
-            nstime_set_unset(&fd_hash[i].frame_time);
-        }
+        dup_window_init();
     }
 
     /* Set up an array of all IDBs seen */
@@ -2174,14 +2369,15 @@ main(int argc, char *argv[])
 
                 /* suppress duplicates by packet window */
                 if (dup_detect) {
-                    if (is_duplicate(buf, rec->rec_header.packet_header.caplen)) {
+                    if (is_duplicate(&rec->rec_header.packet_header, buf,
+                                     rec->rec_header.packet_header.caplen)) {
                         if (verbose) {
                             fprintf(stderr, "Skipped: %u, Len: %u, MD5 Hash: ",
                                     count,
                                     rec->rec_header.packet_header.caplen);
                             for (i = 0; i < 16; i++)
                                 fprintf(stderr, "%02x",
-                                        (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                        (unsigned char)cur_dup.digest[i]);
                             fprintf(stderr, "\n");
                         }
                         duplicate_count++;
@@ -2194,7 +2390,7 @@ main(int argc, char *argv[])
                                     rec->rec_header.packet_header.caplen);
                             for (i = 0; i < 16; i++)
                                 fprintf(stderr, "%02x",
-                                        (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                        (unsigned char)cur_dup.digest[i]);
                             fprintf(stderr, "\n");
                         }
                     }
@@ -2208,7 +2404,7 @@ main(int argc, char *argv[])
                         current.secs  = rec->ts.secs;
                         current.nsecs = rec->ts.nsecs;
 
-                        if (is_duplicate_rel_time(buf,
+                        if (is_duplicate_rel_time(&rec->rec_header.packet_header, buf,
                                                   rec->rec_header.packet_header.caplen,
                                                   &current)) {
                             if (verbose) {
@@ -2217,7 +2413,7 @@ main(int argc, char *argv[])
                                         rec->rec_header.packet_header.caplen);
                                 for (i = 0; i < 16; i++)
                                     fprintf(stderr, "%02x",
-                                            (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                            (unsigned char)cur_dup.digest[i]);
                                 fprintf(stderr, "\n");
                             }
                             duplicate_count++;
@@ -2230,7 +2426,7 @@ main(int argc, char *argv[])
                                         rec->rec_header.packet_header.caplen);
                                 for (i = 0; i < 16; i++)
                                     fprintf(stderr, "%02x",
-                                            (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                            (unsigned char)cur_dup.digest[i]);
                                 fprintf(stderr, "\n");
                             }
                         }
@@ -2436,7 +2632,7 @@ main(int argc, char *argv[])
     }
 
     if (dup_detect) {
-        fprintf(stderr, "%u packet%s seen, %u packet%s skipped with duplicate window of %i packets.\n",
+        fprintf(stderr, "%u packet%s seen, %u packet%s skipped with duplicate window of %u packets.\n",
                 count - 1, plurality(count - 1, "", "s"), duplicate_count,
                 plurality(duplicate_count, "", "s"), dup_window);
     } else if (dup_detect_by_time) {
@@ -2448,6 +2644,7 @@ main(int argc, char *argv[])
     }
 
 clean_exit:
+    dup_window_cleanup();
     if (filename) {
         g_free(filename);
     }
@@ -629,6 +629,105 @@ add_conversation_table_data(conv_hash_t *ch, const address *src, const address *
     add_conversation_table_data_with_conv_id(ch, src, dst, src_port, dst_port, CONV_ID_UNSET, num_frames, num_bytes, ts, abs_ts, ct_info, ctype);
 }
 
+/*
+ * Find a conversation in either direction. is_fwd_direction is set to TRUE
+ * if it was found in the same direction as src -> dst.
+ */
+static conv_item_t *
+conversation_table_lookup(conv_hash_t *ch, const address *src, const address *dst, guint32 src_port, guint32 dst_port,
+        conv_id_t conv_id, gboolean *is_fwd_direction)
+{
+    conv_key_t existing_key;
+    gpointer conversation_idx_hash_val;
+
+    *is_fwd_direction = FALSE;
+    if (ch->conv_array == NULL) {
+        return NULL;
+    }
+
+    /* first, check in the fwd conversations */
+    existing_key.addr1 = *src;
+    existing_key.addr2 = *dst;
+    existing_key.port1 = src_port;
+    existing_key.port2 = dst_port;
+    existing_key.conv_id = conv_id;
+    if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
+        /* a conversation was found in this same fwd direction */
+        *is_fwd_direction = TRUE;
+        return &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+    }
+
+    /* then, check in the rev conversations if not found in 'fwd' */
+    existing_key.addr1 = *dst;
+    existing_key.addr2 = *src;
+    existing_key.port1 = dst_port;
+    existing_key.port2 = src_port;
+    if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
+        return &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+    }
+
+    return NULL;
+}
+
+/*
+ * Append a new conversation with all counters set to zero to the end of
+ * the list.
+ */
+static conv_item_t *
+conversation_table_append(conv_hash_t *ch, const address *src, const address *dst, guint32 src_port, guint32 dst_port,
+        conv_id_t conv_id, ct_dissector_info_t *ct_info, conversation_type ctype)
+{
+    conv_key_t *new_key;
+    conv_item_t new_conv_item;
+    conv_item_t *conv_item;
+    unsigned int conversation_idx;
+
+    /* if we don't have any entries at all yet */
+    if (ch->conv_array == NULL) {
+        ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
+
+        ch->hashtable = g_hash_table_new_full(conversation_hash,
+                                              conversation_equal, /* key_equal_func */
+                                              g_free,             /* key_destroy_func */
+                                              NULL);              /* value_destroy_func */
+    }
+
+    copy_address(&new_conv_item.src_address, src);
+    copy_address(&new_conv_item.dst_address, dst);
+    new_conv_item.dissector_info = ct_info;
+    new_conv_item.ctype = ctype;
+    new_conv_item.src_port = src_port;
+    new_conv_item.dst_port = dst_port;
+    new_conv_item.conv_id = conv_id;
+    new_conv_item.rx_frames = 0;
+    new_conv_item.tx_frames = 0;
+    new_conv_item.rx_bytes = 0;
+    new_conv_item.tx_bytes = 0;
+    new_conv_item.rx_frames_total = 0;
+    new_conv_item.tx_frames_total = 0;
+    new_conv_item.rx_bytes_total = 0;
+    new_conv_item.tx_bytes_total = 0;
+    nstime_set_unset(&new_conv_item.start_abs_time);
+    nstime_set_unset(&new_conv_item.start_time);
+    nstime_set_unset(&new_conv_item.stop_time);
+    new_conv_item.filtered = TRUE;
+
+    g_array_append_val(ch->conv_array, new_conv_item);
+    conversation_idx = ch->conv_array->len - 1;
+    conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+
+    /* ct->conversations address is not a constant but src/dst_address.data are */
+    new_key = g_new(conv_key_t, 1);
+    set_address(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
+    set_address(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
+    new_key->port1 = src_port;
+    new_key->port2 = dst_port;
+    new_key->conv_id = conv_id;
+    g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
+
+    return conv_item;
+}
+
 void
 add_conversation_table_data_with_conv_id(
     conv_hash_t *ch,
@@ -644,95 +743,25 @@ add_conversation_table_data_with_conv_id(
     ct_dissector_info_t *ct_info,
     conversation_type ctype)
 {
-    conv_item_t *conv_item = NULL;
-    gboolean is_fwd_direction = FALSE; /* direction of any conversation found */
-
-    /* if we don't have any entries at all yet */
-    if (ch->conv_array == NULL) {
-        ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
-
-        ch->hashtable = g_hash_table_new_full(conversation_hash,
-                                              conversation_equal, /* key_equal_func */
-                                              g_free,             /* key_destroy_func */
-                                              NULL);              /* value_destroy_func */
+    conv_item_t *conv_item;
+    gboolean is_fwd_direction; /* direction of any conversation found */
 
-    } else { /* try to find it among the existing known conversations */
-        /* first, check in the fwd conversations */
-        conv_key_t existing_key;
-        gpointer conversation_idx_hash_val;
-
-        existing_key.addr1 = *src;
-        existing_key.addr2 = *dst;
-        existing_key.port1 = src_port;
-        existing_key.port2 = dst_port;
-        existing_key.conv_id = conv_id;
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
-        }
-        if (conv_item == NULL) {
-            /* then, check in the rev conversations if not found in 'fwd' */
-            existing_key.addr1 = *dst;
-            existing_key.addr2 = *src;
-            existing_key.port1 = dst_port;
-            existing_key.port2 = src_port;
-            if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-                conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
-            }
-        } else {
-            /* a conversation was found in this same fwd direction */
-            is_fwd_direction = TRUE;
-        }
-    }
+    conv_item = conversation_table_lookup(ch, src, dst, src_port, dst_port, conv_id, &is_fwd_direction);
 
     /* if we still don't know what conversation this is it has to be a new one
        and we have to allocate it and append it to the end of the list */
     if (conv_item == NULL) {
-        conv_key_t *new_key;
-        conv_item_t new_conv_item;
-        unsigned int conversation_idx;
-
-        copy_address(&new_conv_item.src_address, src);
-        copy_address(&new_conv_item.dst_address, dst);
-        new_conv_item.dissector_info = ct_info;
-        new_conv_item.ctype = ctype;
-        new_conv_item.src_port = src_port;
-        new_conv_item.dst_port = dst_port;
-        new_conv_item.conv_id = conv_id;
-        new_conv_item.rx_frames = 0;
-        new_conv_item.tx_frames = 0;
-        new_conv_item.rx_bytes = 0;
-        new_conv_item.tx_bytes = 0;
-        new_conv_item.rx_frames_total = 0;
-        new_conv_item.tx_frames_total = 0;
-        new_conv_item.rx_bytes_total = 0;
-        new_conv_item.tx_bytes_total = 0;
+        conv_item = conversation_table_append(ch, src, dst, src_port, dst_port, conv_id, ct_info, ctype);
 
         if (ts) {
-            memcpy(&new_conv_item.start_time, ts, sizeof(new_conv_item.start_time));
-            memcpy(&new_conv_item.stop_time, ts, sizeof(new_conv_item.stop_time));
-            memcpy(&new_conv_item.start_abs_time, abs_ts, sizeof(new_conv_item.start_abs_time));
-        } else {
-            nstime_set_unset(&new_conv_item.start_abs_time);
-            nstime_set_unset(&new_conv_item.start_time);
-            nstime_set_unset(&new_conv_item.stop_time);
+            memcpy(&conv_item->start_time, ts, sizeof(conv_item->start_time));
+            memcpy(&conv_item->stop_time, ts, sizeof(conv_item->stop_time));
+            memcpy(&conv_item->start_abs_time, abs_ts, sizeof(conv_item->start_abs_time));
         }
-        g_array_append_val(ch->conv_array, new_conv_item);
-        conversation_idx = ch->conv_array->len - 1;
-        conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
-
-        /* ct->conversations address is not a constant but src/dst_address.data are */
-        new_key = g_new(conv_key_t, 1);
-        set_address(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
-        set_address(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
-        new_key->port1 = src_port;
-        new_key->port2 = dst_port;
-        new_key->conv_id = conv_id;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
 
         /* update the conversation struct */
         conv_item->tx_frames_total += num_frames;
         conv_item->tx_bytes_total += num_bytes;
-        conv_item->filtered = TRUE;
         if (! (ch->flags & TL_DISPLAY_FILTER_IGNORED)) {
             conv_item->tx_frames += num_frames;
             conv_item->tx_bytes += num_bytes;
@@ -772,6 +801,64 @@ add_conversation_table_data_with_conv_id(
     }
 }
 
+void
+merge_conversation_table_data(conv_hash_t *ch, const conv_hash_t *from)
+{
+    guint i;
+
+    if (!ch || !from || from->conv_array == NULL) {
+        return;
+    }
+
+    for (i = 0; i < from->conv_array->len; i++) {
+        const conv_item_t *from_item = &g_array_index(from->conv_array, conv_item_t, i);
+        conv_item_t *conv_item;
+        gboolean is_fwd_direction;
+
+        conv_item = conversation_table_lookup(ch, &from_item->src_address, &from_item->dst_address,
+                from_item->src_port, from_item->dst_port, from_item->conv_id, &is_fwd_direction);
+        if (conv_item == NULL) {
+            conv_item = conversation_table_append(ch, &from_item->src_address, &from_item->dst_address,
+                    from_item->src_port, from_item->dst_port, from_item->conv_id,
+                    from_item->dissector_info, from_item->ctype);
+            is_fwd_direction = TRUE;
+        }
+
+        if (is_fwd_direction) {
+            conv_item->tx_frames += from_item->tx_frames;
+            conv_item->tx_bytes += from_item->tx_bytes;
+            conv_item->rx_frames += from_item->rx_frames;
+            conv_item->rx_bytes += from_item->rx_bytes;
+            conv_item->tx_frames_total += from_item->tx_frames_total;
+            conv_item->tx_bytes_total += from_item->tx_bytes_total;
+            conv_item->rx_frames_total += from_item->rx_frames_total;
+            conv_item->rx_bytes_total += from_item->rx_bytes_total;
+        } else {
+            conv_item->tx_frames += from_item->rx_frames;
+            conv_item->tx_bytes += from_item->rx_bytes;
+            conv_item->rx_frames += from_item->tx_frames;
+            conv_item->rx_bytes += from_item->tx_bytes;
+            conv_item->tx_frames_total += from_item->rx_frames_total;
+            conv_item->tx_bytes_total += from_item->rx_bytes_total;
+            conv_item->rx_frames_total += from_item->tx_frames_total;
+            conv_item->rx_bytes_total += from_item->tx_bytes_total;
+        }
+        conv_item->filtered = conv_item->filtered && from_item->filtered;
+
+        if (!nstime_is_unset(&from_item->start_time)) {
+            if (nstime_is_unset(&conv_item->start_time) ||
+                    nstime_cmp(&from_item->start_time, &conv_item->start_time) < 0) {
+                conv_item->start_time = from_item->start_time;
+                conv_item->start_abs_time = from_item->start_abs_time;
+            }
+            if (nstime_is_unset(&conv_item->stop_time) ||
+                    nstime_cmp(&from_item->stop_time, &conv_item->stop_time) > 0) {
+                conv_item->stop_time = from_item->stop_time;
+            }
+        }
+    }
+}
+
 /*
  * Compute the hash value for a given address/port pair if the match
  * is to be exact.
@@ -807,13 +894,37 @@ endpoint_match(gconstpointer v, gconstpointer w)
     return 0;
 }
 
-void
-add_endpoint_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
+static endpoint_item_t *
+endpoint_table_lookup(conv_hash_t *ch, const address *addr, guint32 port)
+{
+    endpoint_key_t existing_key;
+    gpointer endpoint_idx_hash_val;
+
+    if (ch->conv_array == NULL) {
+        return NULL;
+    }
+
+    copy_address_shallow(&existing_key.myaddress, addr);
+    existing_key.port = port;
+
+    if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
+        return &g_array_index(ch->conv_array, endpoint_item_t, GPOINTER_TO_UINT(endpoint_idx_hash_val));
+    }
+    return NULL;
+}
+
+/*
+ * Append a new endpoint with all counters set to zero to the end of the
+ * list.
+ */
+static endpoint_item_t *
+endpoint_table_append(conv_hash_t *ch, const address *addr, guint32 port, et_dissector_info_t *et_info, endpoint_type etype)
 {
-    endpoint_item_t *endpoint_item = NULL;
+    endpoint_key_t *new_key;
+    endpoint_item_t new_endpoint_item;
+    endpoint_item_t *endpoint_item;
+    unsigned int endpoint_idx;
 
-    /* XXX should be optimized to allocate n extra entries at a time
-       instead of just one */
     /* if we don't have any entries at all yet */
     if(ch->conv_array==NULL){
         ch->conv_array=g_array_sized_new(FALSE, FALSE, sizeof(endpoint_item_t), 10000);
@@ -822,50 +933,46 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
                                               g_free,     /* key_destroy_func */
                                               NULL);      /* value_destroy_func */
     }
-    else {
-        /* try to find it among the existing known conversations */
-        endpoint_key_t existing_key;
-        gpointer endpoint_idx_hash_val;
 
-        copy_address_shallow(&existing_key.myaddress, addr);
-        existing_key.port = port;
+    copy_address(&new_endpoint_item.myaddress, addr);
+    new_endpoint_item.dissector_info = et_info;
+    new_endpoint_item.etype=etype;
+    new_endpoint_item.port=port;
+    new_endpoint_item.rx_frames=0;
+    new_endpoint_item.tx_frames=0;
+    new_endpoint_item.rx_bytes=0;
+    new_endpoint_item.tx_bytes=0;
+    new_endpoint_item.rx_frames_total=0;
+    new_endpoint_item.tx_frames_total=0;
+    new_endpoint_item.rx_bytes_total=0;
+    new_endpoint_item.tx_bytes_total=0;
+    new_endpoint_item.modified = TRUE;
+    new_endpoint_item.filtered = TRUE;
+
+    g_array_append_val(ch->conv_array, new_endpoint_item);
+    endpoint_idx = ch->conv_array->len - 1;
+    endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+
+    /* hl->hosts address is not a constant but address.data is */
+    new_key = g_new(endpoint_key_t,1);
+    set_address(&new_key->myaddress, endpoint_item->myaddress.type, endpoint_item->myaddress.len, endpoint_item->myaddress.data);
+    new_key->port = port;
+    g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(endpoint_idx));
+
+    return endpoint_item;
+}
 
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
-            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, GPOINTER_TO_UINT(endpoint_idx_hash_val));
-        }
-    }
+void
+add_endpoint_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
+{
+    endpoint_item_t *endpoint_item;
+
+    endpoint_item = endpoint_table_lookup(ch, addr, port);
 
     /* if we still don't know what endpoint this is it has to be a new one
        and we have to allocate it and append it to the end of the list */
     if(endpoint_item==NULL){
-        endpoint_key_t *new_key;
-        endpoint_item_t new_endpoint_item;
-        unsigned int endpoint_idx;
-
-        copy_address(&new_endpoint_item.myaddress, addr);
-        new_endpoint_item.dissector_info = et_info;
-        new_endpoint_item.etype=etype;
-        new_endpoint_item.port=port;
-        new_endpoint_item.rx_frames=0;
-        new_endpoint_item.tx_frames=0;
-        new_endpoint_item.rx_bytes=0;
-        new_endpoint_item.tx_bytes=0;
-        new_endpoint_item.rx_frames_total=0;
-        new_endpoint_item.tx_frames_total=0;
-        new_endpoint_item.rx_bytes_total=0;
-        new_endpoint_item.tx_bytes_total=0;
-        new_endpoint_item.modified = TRUE;
-        new_endpoint_item.filtered = TRUE;
-
-        g_array_append_val(ch->conv_array, new_endpoint_item);
-        endpoint_idx = ch->conv_array->len - 1;
-        endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
-
-        /* hl->hosts address is not a constant but address.data is */
-        new_key = g_new(endpoint_key_t,1);
-        set_address(&new_key->myaddress, endpoint_item->myaddress.type, endpoint_item->myaddress.len, endpoint_item->myaddress.data);
-        new_key->port = port;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(endpoint_idx));
+        endpoint_item = endpoint_table_append(ch, addr, port, et_info, etype);
     }
 
     /* if this is a new endpoint we need to initialize the struct */
@@ -892,6 +999,38 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
     }
 }
 
+void
+merge_endpoint_table_data(conv_hash_t *ch, const conv_hash_t *from)
+{
+    guint i;
+
+    if (!ch || !from || from->conv_array == NULL) {
+        return;
+    }
+
+    for (i = 0; i < from->conv_array->len; i++) {
+        const endpoint_item_t *from_item = &g_array_index(from->conv_array, endpoint_item_t, i);
+        endpoint_item_t *endpoint_item;
+
+        endpoint_item = endpoint_table_lookup(ch, &from_item->myaddress, from_item->port);
+        if (endpoint_item == NULL) {
+            endpoint_item = endpoint_table_append(ch, &from_item->myaddress, from_item->port,
+                    from_item->dissector_info, from_item->etype);
+        }
+
+        endpoint_item->modified = TRUE;
+        endpoint_item->tx_frames += from_item->tx_frames;
+        endpoint_item->tx_bytes += from_item->tx_bytes;
+        endpoint_item->rx_frames += from_item->rx_frames;
+        endpoint_item->rx_bytes += from_item->rx_bytes;
+        endpoint_item->tx_frames_total += from_item->tx_frames_total;
+        endpoint_item->tx_bytes_total += from_item->tx_bytes_total;
+        endpoint_item->rx_frames_total += from_item->rx_frames_total;
+        endpoint_item->rx_bytes_total += from_item->rx_bytes_total;
+        endpoint_item->filtered = endpoint_item->filtered && from_item->filtered;
+    }
+}
+
 /* For backwards source and binary compatibility */
 void
 add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
@@ -394,6 +394,27 @@ G_DEPRECATED_FOR(add_endpoint_table_data)
 WS_DLL_PUBLIC void add_hostlist_table_data(conv_hash_t *ch, const address *addr,
     guint32 port, gboolean sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype);
 
+/** Add the conversations of one table to another one.
+ *
+ * This allows splitting a capture into consecutive frame ranges,
+ * accumulating each range into its own table (possibly in parallel)
+ * and combining the results. If the tables are merged in frame order
+ * the result is the same as if all frames had been added to a single
+ * table.
+ *
+ * @param ch the table hash to add the data to
+ * @param from the table hash to add; it is not modified
+ */
+WS_DLL_PUBLIC void merge_conversation_table_data(conv_hash_t *ch, const conv_hash_t *from);
+
+/** Add the endpoints of one table to another one.
+ *
+ * @param ch the table hash to add the data to
+ * @param from the table hash to add; it is not modified
+ * @see merge_conversation_table_data()
+ */
+WS_DLL_PUBLIC void merge_endpoint_table_data(conv_hash_t *ch, const conv_hash_t *from);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
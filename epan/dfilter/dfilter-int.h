@@ -37,6 +37,10 @@ struct epan_dfilter {
 	GHashTable	*references;
 	GHashTable	*raw_references;
 	char		*syntax_tree_str;
+	/* Set if the filter is just a range of frame.time values. */
+	gboolean	has_time_window;
+	nstime_t	time_start;
+	nstime_t	time_end;
 	/* Used to pass arguments to functions. List of Lists (list of registers). */
 	GSList		*function_stack;
 };
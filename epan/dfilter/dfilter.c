@@ -14,6 +14,8 @@
 
 #include "dfilter-int.h"
 #include "syntax-tree.h"
+#include "sttype-field.h"
+#include "sttype-op.h"
 #include "gencode.h"
 #include "semcheck.h"
 #include "dfvm.h"
@@ -455,11 +457,102 @@ dfwork_parse(const char *expanded_text, dfsyntax_t *dfs)
 	return dfs->error == NULL;
 }
 
+/*
+ * Narrow the window [*start, *end) down to the frames that pass the test
+ * in node, if all the test does is compare frame.time with constants,
+ * possibly several times joined with "&&".  Unset bounds are unlimited.
+ */
+static gboolean
+narrow_frame_time_window(stnode_t *node, nstime_t *start, nstime_t *end)
+{
+	stnode_op_t	op;
+	stnode_t	*arg1, *arg2, *field, *value;
+	header_field_info *hfinfo;
+	fvalue_t	*fv;
+	nstime_t	t, after_t;
+	static const nstime_t one_ns = NSTIME_INIT_SECS_NSECS(0, 1);
+
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return FALSE;
+
+	sttype_oper_get(node, &op, &arg1, &arg2);
+	if (op == STNODE_OP_AND) {
+		return narrow_frame_time_window(arg1, start, end) &&
+			narrow_frame_time_window(arg2, start, end);
+	}
+
+	if (arg1 == NULL || arg2 == NULL)
+		return FALSE;
+
+	if (stnode_type_id(arg1) == STTYPE_FIELD && stnode_type_id(arg2) == STTYPE_FVALUE) {
+		field = arg1;
+		value = arg2;
+	}
+	else if (stnode_type_id(arg1) == STTYPE_FVALUE && stnode_type_id(arg2) == STTYPE_FIELD) {
+		/* "value op field", turn it around. */
+		field = arg2;
+		value = arg1;
+		switch (op) {
+			case STNODE_OP_GT: op = STNODE_OP_LT; break;
+			case STNODE_OP_GE: op = STNODE_OP_LE; break;
+			case STNODE_OP_LT: op = STNODE_OP_GT; break;
+			case STNODE_OP_LE: op = STNODE_OP_GE; break;
+			default: break;
+		}
+	}
+	else {
+		return FALSE;
+	}
+
+	hfinfo = sttype_field_hfinfo(field);
+	if (hfinfo == NULL || hfinfo->type != FT_ABSOLUTE_TIME ||
+			strcmp(hfinfo->abbrev, "frame.time") != 0 ||
+			sttype_field_drange(field) != NULL || sttype_field_raw(field))
+		return FALSE;
+
+	fv = (fvalue_t *)stnode_data(value);
+	if (fvalue_type_ftenum(fv) != FT_ABSOLUTE_TIME)
+		return FALSE;
+	nstime_copy(&t, fvalue_get_time(fv));
+	nstime_sum(&after_t, &t, &one_ns);
+
+	switch (op) {
+		case STNODE_OP_ANY_EQ:
+		case STNODE_OP_ALL_EQ:
+			if (nstime_is_unset(start) || nstime_cmp(start, &t) < 0)
+				nstime_copy(start, &t);
+			if (nstime_is_unset(end) || nstime_cmp(end, &after_t) > 0)
+				nstime_copy(end, &after_t);
+			break;
+		case STNODE_OP_GE:
+			if (nstime_is_unset(start) || nstime_cmp(start, &t) < 0)
+				nstime_copy(start, &t);
+			break;
+		case STNODE_OP_GT:
+			if (nstime_is_unset(start) || nstime_cmp(start, &after_t) < 0)
+				nstime_copy(start, &after_t);
+			break;
+		case STNODE_OP_LT:
+			if (nstime_is_unset(end) || nstime_cmp(end, &t) > 0)
+				nstime_copy(end, &t);
+			break;
+		case STNODE_OP_LE:
+			if (nstime_is_unset(end) || nstime_cmp(end, &after_t) > 0)
+				nstime_copy(end, &after_t);
+			break;
+		default:
+			return FALSE;
+	}
+	return TRUE;
+}
+
 static dfilter_t *
 dfwork_build(dfwork_t *dfw)
 {
 	dfilter_t	*dfilter;
 	char		*tree_str;
+	gboolean	has_time_window;
+	nstime_t	time_start, time_end;
 
 	log_syntax_tree(LOG_LEVEL_NOISY, dfw->st_root, "Syntax tree before semantic check", NULL);
 
@@ -467,6 +560,12 @@ dfwork_build(dfwork_t *dfw)
 	if (!dfw_semcheck(dfw))
 		return NULL;
 
+	/* Look for a frame time window while the constants are still in the
+	 * syntax tree; generating the bytecode takes them out of it. */
+	nstime_set_unset(&time_start);
+	nstime_set_unset(&time_end);
+	has_time_window = narrow_frame_time_window(dfw->st_root, &time_start, &time_end);
+
 	/* Cache tree representation in tree_str. */
 	tree_str = NULL;
 	log_syntax_tree(LOG_LEVEL_NOISY, dfw->st_root, "Syntax tree after successful semantic check", &tree_str);
@@ -480,6 +579,9 @@ dfwork_build(dfwork_t *dfw)
 
 	/* Tuck away the bytecode in the dfilter_t */
 	dfilter = dfilter_new(dfw->deprecated);
+	dfilter->has_time_window = has_time_window;
+	dfilter->time_start = time_start;
+	dfilter->time_end = time_end;
 	dfilter->insns = dfw->insns;
 	dfw->insns = NULL;
 	dfilter->interesting_fields = dfw_interesting_fields(dfw,
@@ -739,6 +841,17 @@ dfilter_syntax_tree(dfilter_t *df)
 	return df->syntax_tree_str;
 }
 
+gboolean
+dfilter_get_frame_time_window(const dfilter_t *df, nstime_t *start, nstime_t *end)
+{
+	if (!df->has_time_window)
+		return FALSE;
+
+	nstime_copy(start, &df->time_start);
+	nstime_copy(end, &df->time_end);
+	return TRUE;
+}
+
 void
 dfilter_log_full(const char *domain, enum ws_log_level level,
 			const char *file, long line, const char *func,
@@ -177,6 +177,17 @@ WS_DLL_PUBLIC
 const char *
 dfilter_syntax_tree(dfilter_t *df);
 
+/* If the filter does nothing but compare frame.time with constant
+ * times, possibly several times joined with "&&", get the window of
+ * absolute times [start, end) it matches, so that the caller can find the
+ * matching frames without dissecting them. An unlimited bound is set to
+ * "unset" (see nstime_is_unset()).
+ *
+ * Returns TRUE if the filter is such a time window. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_get_frame_time_window(const dfilter_t *df, nstime_t *start, nstime_t *end);
+
 /* Print bytecode of dfilter to log */
 WS_DLL_PUBLIC
 void
@@ -46,6 +46,7 @@ dfvm_opcode_tostr(dfvm_opcode_t code)
 		case DFVM_ANY_LE:		return "ANY_LE";
 		case DFVM_ALL_CONTAINS:		return "ALL_CONTAINS";
 		case DFVM_ANY_CONTAINS:		return "ANY_CONTAINS";
+		case DFVM_ANY_CONTAINS_ANY:	return "ANY_CONTAINS_ANY";
 		case DFVM_ALL_MATCHES:		return "ALL_MATCHES";
 		case DFVM_ANY_MATCHES:		return "ANY_MATCHES";
 		case DFVM_ALL_IN_RANGE:		return "ALL_IN_RANGE";
@@ -93,6 +94,11 @@ dfvm_value_free(dfvm_value_t *v)
 		case PCRE:
 			ws_regex_free(v->value.pcre);
 			break;
+		case MEMSEARCH:
+			ws_memsearch_free(v->value.memsearch->searcher);
+			g_free(v->value.memsearch->repr);
+			g_free(v->value.memsearch);
+			break;
 		case EMPTY:
 		case HFINFO:
 		case RAW_HFINFO:
@@ -204,6 +210,16 @@ dfvm_value_new_pcre(ws_regex_t *re)
 	return v;
 }
 
+dfvm_value_t*
+dfvm_value_new_memsearch(ws_memsearch_t *searcher, char *repr)
+{
+	dfvm_value_t *v = dfvm_value_new(MEMSEARCH);
+	v->value.memsearch = g_new(dfvm_memsearch_t, 1);
+	v->value.memsearch->searcher = searcher;
+	v->value.memsearch->repr = repr;
+	return v;
+}
+
 dfvm_value_t*
 dfvm_value_new_guint(guint num)
 {
@@ -236,6 +252,9 @@ dfvm_value_tostr(dfvm_value_t *v)
 		case PCRE:
 			s = ws_strdup(ws_regex_pattern(v->value.pcre));
 			break;
+		case MEMSEARCH:
+			s = ws_strdup(v->value.memsearch->repr);
+			break;
 		case REGISTER:
 			s = ws_strdup_printf("R%"G_GUINT32_FORMAT, v->value.numeric);
 			break;
@@ -482,6 +501,11 @@ append_op_args(wmem_strbuf_t *buf, dfvm_insn_t *insn, GSList **stack_print,
 						arg1_str, arg1_str_type, arg2_str, arg2_str_type);
 			break;
 
+		case DFVM_ANY_CONTAINS_ANY:
+			wmem_strbuf_append_printf(buf, "%s%s contains any %s",
+						arg1_str, arg1_str_type, arg2_str);
+			break;
+
 		case DFVM_ALL_MATCHES:
 		case DFVM_ANY_MATCHES:
 			wmem_strbuf_append_printf(buf, "%s%s matches %s%s",
@@ -1084,6 +1108,21 @@ all_matches(dfilter_t *df, dfvm_value_t *arg1, dfvm_value_t *arg2)
 	return TRUE;
 }
 
+static gboolean
+any_contains_any(dfilter_t *df, dfvm_value_t *arg1, dfvm_value_t *arg2)
+{
+	GSList *list1 = df->registers[arg1->value.numeric];
+	ws_memsearch_t *searcher = arg2->value.memsearch->searcher;
+
+	while (list1) {
+		if (fvalue_contains_any(list1->data, searcher) == FT_TRUE) {
+			return TRUE;
+		}
+		list1 = g_slist_next(list1);
+	}
+	return FALSE;
+}
+
 static gboolean
 any_in_range_internal(GSList *list1, fvalue_t *low, fvalue_t *high)
 {
@@ -1655,6 +1694,10 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 				accum = any_test(df, fvalue_contains, arg1, arg2);
 				break;
 
+			case DFVM_ANY_CONTAINS_ANY:
+				accum = any_contains_any(df, arg1, arg2);
+				break;
+
 			case DFVM_ALL_MATCHES:
 				accum = all_matches(df, arg1, arg2);
 				break;
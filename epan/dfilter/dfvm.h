@@ -11,6 +11,7 @@
 #define DFVM_H
 
 #include <wsutil/regex.h>
+#include <wsutil/ws_memsearch.h>
 #include <epan/proto.h>
 #include "dfilter-int.h"
 #include "syntax-tree.h"
@@ -27,9 +28,16 @@ typedef enum {
 	INTEGER,
 	DRANGE,
 	FUNCTION_DEF,
-	PCRE
+	PCRE,
+	MEMSEARCH
 } dfvm_value_type_t;
 
+/* Patterns of a multi-pattern "contains" test. */
+typedef struct {
+	ws_memsearch_t		*searcher;
+	char			*repr;		/* for dfvm_dump() */
+} dfvm_memsearch_t;
+
 typedef struct {
 	dfvm_value_type_t	type;
 
@@ -40,6 +48,7 @@ typedef struct {
 		header_field_info	*hfinfo;
 		df_func_def_t		*funcdef;
 		ws_regex_t		*pcre;
+		dfvm_memsearch_t	*memsearch;
 	} value;
 
 	int ref_count;
@@ -73,6 +82,7 @@ typedef enum {
 	DFVM_ANY_LE,
 	DFVM_ALL_CONTAINS,
 	DFVM_ANY_CONTAINS,
+	DFVM_ANY_CONTAINS_ANY,
 	DFVM_ALL_MATCHES,
 	DFVM_ANY_MATCHES,
 	DFVM_ALL_IN_RANGE,
@@ -136,6 +146,9 @@ dfvm_value_new_funcdef(df_func_def_t *funcdef);
 dfvm_value_t*
 dfvm_value_new_pcre(ws_regex_t *re);
 
+dfvm_value_t*
+dfvm_value_new_memsearch(ws_memsearch_t *searcher, char *repr);
+
 dfvm_value_t*
 dfvm_value_new_guint(guint num);
 
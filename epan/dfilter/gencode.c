@@ -55,6 +55,7 @@ select_opcode(dfvm_opcode_t op, stmatch_t how)
 		case DFVM_ANY_MATCHES:
 		case DFVM_ANY_IN_RANGE:
 			return how == STNODE_MATCH_ANY ? op : op - 1;
+		case DFVM_ANY_CONTAINS_ANY:
 		case DFVM_NOT_ALL_ZERO:
 		case DFVM_IF_TRUE_GOTO:
 		case DFVM_IF_FALSE_GOTO:
@@ -483,6 +484,126 @@ gen_relation_in(dfwork_t *dfw, stmatch_t how,
 	set_nodelist_free(nodelist_head);
 }
 
+static void
+collect_or_chain(stnode_t *st_node, GSList **leaves)
+{
+	stnode_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+
+	if (stnode_type_id(st_node) == STTYPE_TEST) {
+		sttype_oper_get(st_node, &st_op, &st_arg1, &st_arg2);
+		if (st_op == STNODE_OP_OR) {
+			collect_or_chain(st_arg1, leaves);
+			collect_or_chain(st_arg2, leaves);
+			return;
+		}
+	}
+	*leaves = g_slist_append(*leaves, st_node);
+}
+
+/* If the test is "field contains <non-empty constant>" on a field whose
+ * values can be searched with fvalue_contains_any(), returns the first
+ * field with that name, otherwise NULL. */
+static header_field_info *
+contains_any_field(stnode_t *st_node)
+{
+	stnode_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+	header_field_info *hfinfo, *hf;
+	size_t		len;
+
+	if (stnode_type_id(st_node) != STTYPE_TEST)
+		return NULL;
+
+	sttype_oper_get(st_node, &st_op, &st_arg1, &st_arg2);
+	if (st_op != STNODE_OP_CONTAINS ||
+			sttype_test_get_match(st_node) == STNODE_MATCH_ALL)
+		return NULL;
+
+	if (stnode_type_id(st_arg1) != STTYPE_FIELD ||
+			stnode_type_id(st_arg2) != STTYPE_FVALUE)
+		return NULL;
+
+	if (sttype_field_drange(st_arg1) != NULL || sttype_field_raw(st_arg1))
+		return NULL;
+
+	if (!ftype_can_contains_any(fvalue_type_ftenum(stnode_data(st_arg2))))
+		return NULL;
+	fvalue_get_contains_data(stnode_data(st_arg2), &len);
+	if (len == 0)
+		return NULL;
+
+	/* Rewind to find the first field of this name. All the fields with
+	 * the same name are read into the register, check them all. */
+	hfinfo = sttype_field_hfinfo(st_arg1);
+	while (hfinfo->same_name_prev_id != -1) {
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	}
+	for (hf = hfinfo; hf != NULL; hf = hf->same_name_next) {
+		if (!ftype_can_contains_any(hf->type))
+			return NULL;
+	}
+
+	return hfinfo;
+}
+
+/* Generate the code for an OR-ed chain of "contains" tests of the same
+ * field against constants, e.g.
+ *     http.user_agent contains "curl" || http.user_agent contains "Wget"
+ * All the patterns are compiled into one searcher, so each value of the
+ * field is scanned once, however many patterns there are.
+ * Returns FALSE, without generating any code, if the chain does not
+ * have that form. */
+static gboolean
+gen_contains_any(dfwork_t *dfw, stnode_t *st_node)
+{
+	GSList		*leaves = NULL, *l;
+	GSList		*jumps = NULL;
+	header_field_info *hfinfo = NULL, *leaf_hfinfo;
+	stnode_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+	ws_memsearch_t	*searcher;
+	GString		*repr;
+	const guint8	*data;
+	size_t		len;
+	char		*s;
+	dfvm_value_t	*val1, *val2;
+
+	collect_or_chain(st_node, &leaves);
+	for (l = leaves; l != NULL; l = l->next) {
+		leaf_hfinfo = contains_any_field(l->data);
+		if (leaf_hfinfo == NULL || (hfinfo != NULL && leaf_hfinfo != hfinfo)) {
+			g_slist_free(leaves);
+			return FALSE;
+		}
+		hfinfo = leaf_hfinfo;
+	}
+
+	searcher = ws_memsearch_new(0);
+	repr = g_string_new("{");
+	for (l = leaves; l != NULL; l = l->next) {
+		sttype_oper_get(l->data, &st_op, &st_arg1, &st_arg2);
+		data = fvalue_get_contains_data(stnode_data(st_arg2), &len);
+		ws_memsearch_add(searcher, data, len);
+		s = fvalue_to_debug_repr(NULL, stnode_data(st_arg2));
+		g_string_append_printf(repr, " %s", s);
+		g_free(s);
+	}
+	g_string_append(repr, " }");
+	ws_memsearch_compile(searcher);
+	g_slist_free(leaves);
+
+	val1 = dfw_append_read_tree(dfw, hfinfo, NULL, FALSE);
+	jumps = g_slist_prepend(jumps, dfw_append_jump(dfw));
+	val2 = dfvm_value_new_memsearch(searcher, g_string_free(repr, FALSE));
+	gen_relation_insn(dfw, DFVM_ANY_CONTAINS_ANY, val1, val2, NULL);
+
+	/* Jump here if the field was not present */
+	g_slist_foreach(jumps, fixup_jumps, dfw);
+	g_slist_free(jumps);
+	return TRUE;
+}
+
 static dfvm_value_t *
 gen_arithmetic(dfwork_t *dfw, stnode_t *st_arg, GSList **jumps_ptr)
 {
@@ -700,6 +821,9 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 			break;
 
 		case STNODE_OP_OR:
+			if (gen_contains_any(dfw, st_node))
+				break;
+
 			gencode(dfw, st_arg1);
 
 			insn = dfvm_insn_new(DFVM_IF_TRUE_GOTO);
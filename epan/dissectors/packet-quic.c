@@ -368,7 +368,7 @@ struct quic_cid_item {
 typedef struct _quic_crypto_state {
     guint64         max_contiguous_offset;
     guint8          encryption_level; /**< AKA packet type */
-    wmem_tree_t    *multisegment_pdus;
+    wmem_seqtree_t *multisegment_pdus;
     wmem_map_t     *retrans_offsets;
 } quic_crypto_state;
 
@@ -381,7 +381,7 @@ typedef struct _quic_crypto_state {
  */
 typedef struct _quic_stream_state {
     guint64         stream_id;
-    wmem_tree_t    *multisegment_pdus;
+    wmem_seqtree_t *multisegment_pdus;
     void           *subdissector_private;
 } quic_stream_state;
 
@@ -1371,7 +1371,7 @@ quic_get_stream_state(packet_info *pinfo, quic_info_data_t *quic_info, gboolean
     if (!stream) {
         stream = wmem_new0(wmem_file_scope(), quic_stream_state);
         stream->stream_id = stream_id;
-        stream->multisegment_pdus = wmem_tree_new(wmem_file_scope());
+        stream->multisegment_pdus = wmem_seqtree_new(wmem_file_scope());
         wmem_map_insert(streams, &stream->stream_id, stream);
     }
     return stream;
@@ -1440,7 +1440,7 @@ again:
     /* Have we seen this PDU before (and is it the start of a multi-
      * segment PDU)?
      */
-    if ((msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32(stream->multisegment_pdus, seq)) &&
+    if ((msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32(stream->multisegment_pdus, seq)) &&
             nxtseq <= msp->nxtpdu) {
         // XXX: This also happens the second time through the data for an MSP normally
         // TODO show expert info for retransmission? Additional checks may be
@@ -1454,7 +1454,7 @@ again:
     }
     /* Else, find the most previous PDU starting before this sequence number */
     if (!msp && seq > 0) {
-        msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(stream->multisegment_pdus, seq-1);
+        msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(stream->multisegment_pdus, seq-1);
         /* Unless if we already fully reassembled the msp that covers seq-1
          * and seq is beyond the end of that msp. In that case this segment
          * will be the start of a new msp.
@@ -1799,7 +1799,7 @@ quic_get_crypto_state(packet_info *pinfo, quic_info_data_t *quic_info, gboolean
     }
     if (!crypto) {
         crypto = wmem_new0(wmem_file_scope(), quic_crypto_state);
-        crypto->multisegment_pdus = wmem_tree_new(wmem_file_scope());
+        crypto->multisegment_pdus = wmem_seqtree_new(wmem_file_scope());
         crypto->retrans_offsets = wmem_map_new(wmem_file_scope(),
                 quic_crypto_retrans_hash, quic_crypto_retrans_equal);
         crypto->encryption_level = encryption_level;
@@ -1951,7 +1951,7 @@ desegment_quic_crypto(tvbuff_t *tvb, int offset, int length, packet_info *pinfo,
      */
 
     /* Find the most recent msp that starts before this sequence number. */
-    msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(crypto->multisegment_pdus, seq);
+    msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(crypto->multisegment_pdus, seq);
 
     /* If we already fully reassembled that msp and seq is beyond its end
      * (the latter should always be the case since we're discarding
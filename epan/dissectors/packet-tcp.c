@@ -28,6 +28,7 @@
 #include <epan/exported_pdu.h>
 #include <epan/in_cksum.h>
 #include <epan/proto_data.h>
+#include <epan/stream_frames.h>
 
 #include <wsutil/utf8_entities.h>
 #include <wsutil/str_util.h>
@@ -727,6 +728,8 @@ static dissector_handle_t sport_handle;
 static dissector_handle_t tcp_opt_unknown_handle;
 static guint32 tcp_stream_count;
 static guint32 mptcp_stream_count;
+/* The frames of each TCP stream, for filters on tcp.stream */
+static stream_frames_table_t *tcp_stream_frames = NULL;
 
 
 
@@ -1686,11 +1689,11 @@ init_tcp_conversation_data(packet_info *pinfo, int direction)
     tcpd=wmem_new0(wmem_file_scope(), struct tcp_analysis);
     tcpd->flow1.win_scale = (direction >= 0) ? pinfo->src_win_scale : pinfo->dst_win_scale;
     tcpd->flow1.window = G_MAXUINT32;
-    tcpd->flow1.multisegment_pdus=wmem_tree_new(wmem_file_scope());
+    tcpd->flow1.multisegment_pdus=wmem_seqtree_new(wmem_file_scope());
 
     tcpd->flow2.window = G_MAXUINT32;
     tcpd->flow2.win_scale = (direction >= 0) ? pinfo->dst_win_scale : pinfo->src_win_scale;
-    tcpd->flow2.multisegment_pdus=wmem_tree_new(wmem_file_scope());
+    tcpd->flow2.multisegment_pdus=wmem_seqtree_new(wmem_file_scope());
 
     if (tcp_reassemble_out_of_order) {
         tcpd->flow1.ooo_segments=wmem_list_new(wmem_file_scope());
@@ -1923,12 +1926,12 @@ print_pdu_tracking_data(packet_info *pinfo, tvbuff_t *tvb, proto_tree *tcp_tree,
    and let TCP try to find out what it can about this segment
 */
 static int
-scan_for_next_pdu(tvbuff_t *tvb, proto_tree *tcp_tree, packet_info *pinfo, int offset, guint32 seq, guint32 nxtseq, wmem_tree_t *multisegment_pdus)
+scan_for_next_pdu(tvbuff_t *tvb, proto_tree *tcp_tree, packet_info *pinfo, int offset, guint32 seq, guint32 nxtseq, wmem_seqtree_t *multisegment_pdus)
 {
     struct tcp_multisegment_pdu *msp=NULL;
 
     if(!pinfo->fd->visited) {
-        msp=(struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(multisegment_pdus, seq-1);
+        msp=(struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(multisegment_pdus, seq-1);
         if(msp) {
             /* If this is a continuation of a PDU started in a
              * previous segment we need to update the last_frame
@@ -1963,7 +1966,7 @@ scan_for_next_pdu(tvbuff_t *tvb, proto_tree *tcp_tree, packet_info *pinfo, int o
          * this segment we also verify that the found PDU does span
          * beyond the end of this segment.
          */
-        msp=(struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(multisegment_pdus, nxtseq-1);
+        msp=(struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(multisegment_pdus, nxtseq-1);
         if(msp) {
             if(pinfo->num==msp->first_frame) {
                 proto_item *item;
@@ -1982,7 +1985,7 @@ scan_for_next_pdu(tvbuff_t *tvb, proto_tree *tcp_tree, packet_info *pinfo, int o
         /* Second we check if this segment is part of a PDU started
          * prior to the segment (seq-1)
          */
-        msp=(struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(multisegment_pdus, seq-1);
+        msp=(struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(multisegment_pdus, seq-1);
         if(msp) {
             /* If this segment is completely within a previous PDU
              * then we just skip this packet
@@ -2006,7 +2009,7 @@ scan_for_next_pdu(tvbuff_t *tvb, proto_tree *tcp_tree, packet_info *pinfo, int o
    use this function to remember where the next pdu starts
 */
 struct tcp_multisegment_pdu *
-pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nxtpdu, wmem_tree_t *multisegment_pdus)
+pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nxtpdu, wmem_seqtree_t *multisegment_pdus)
 {
     struct tcp_multisegment_pdu *msp;
 
@@ -2018,7 +2021,7 @@ pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nx
     msp->last_frame=pinfo->num;
     msp->last_frame_time=pinfo->abs_ts;
     msp->flags=0;
-    wmem_tree_insert32(multisegment_pdus, seq, (void *)msp);
+    wmem_seqtree_insert32(multisegment_pdus, seq, (void *)msp);
     /*ws_warning("pdu_store_sequencenumber_of_next_pdu: seq %u", seq);*/
     return msp;
 }
@@ -4006,7 +4009,7 @@ again:
              * be able to handle retransmission, as those are still incomplete.
              */
 
-            msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(tcpd->fwd->multisegment_pdus, seq);
+            msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(tcpd->fwd->multisegment_pdus, seq);
 
             gboolean has_unfinished_msp = FALSE;
             if (msp && LE_SEQ(msp->seq, seq) && GT_SEQ(msp->nxtpdu, seq) && !(msp->flags & MSP_FLAGS_GOT_ALL_SEGMENTS)) {
@@ -4073,7 +4076,7 @@ again:
              * Only shortcircuit here when the first segment of the MSP is known,
              * and when this first segment is not one to complete the MSP.
              */
-            if ((msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32(tcpd->fwd->multisegment_pdus, seq)) &&
+            if ((msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32(tcpd->fwd->multisegment_pdus, seq)) &&
                     nxtseq <= msp->nxtpdu &&
                     !(msp->flags & MSP_FLAGS_MISSING_FIRST_SEGMENT) && msp->last_frame != pinfo->num) {
                 const char* str;
@@ -4131,7 +4134,7 @@ again:
 
             /* Else, find the most previous PDU starting before this sequence number */
             if (!msp) {
-                msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(tcpd->fwd->multisegment_pdus, seq-1);
+                msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(tcpd->fwd->multisegment_pdus, seq-1);
             }
 
             gboolean has_unfinished_msp = FALSE;
@@ -4680,7 +4683,7 @@ again:
              * the MSP should already be created. Retrieve it to see if we
              * know what later frame the PDU is reassembled in.
              */
-            if (tcpd && (msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32(tcpd->fwd->multisegment_pdus, deseg_seq))) {
+            if (tcpd && (msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32(tcpd->fwd->multisegment_pdus, deseg_seq))) {
                     ipfd_head = fragment_get(&tcp_reassembly_table, pinfo, msp->first_frame, msp);
             }
         }
@@ -7724,6 +7727,10 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         proto_item_set_generated(item);
 
+        if (!PINFO_FD_VISITED(pinfo)) {
+            stream_frames_add(tcp_stream_frames, tcpd->stream, pinfo->num);
+        }
+
         /* Display the completeness of this TCP conversation */
         item = proto_tree_add_uint(tcp_tree, hf_tcp_completeness, NULL, 0, 0, tcpd->conversation_completeness);
         proto_item_set_generated(item);
@@ -8439,7 +8446,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
              * for this flow, terminate reassembly and dissect the
              * results. */
             tcpd->fwd->fin = pinfo->num;
-            msp=(struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(tcpd->fwd->multisegment_pdus, tcph->th_seq);
+            msp=(struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(tcpd->fwd->multisegment_pdus, tcph->th_seq);
             if(msp) {
                 fragment_head *ipfd_head;
 
@@ -9779,6 +9786,7 @@ proto_register_tcp(void)
     register_conversation_table(proto_mptcp, FALSE, mptcpip_conversation_packet, tcpip_endpoint_packet);
     register_follow_stream(proto_tcp, "tcp_follow", tcp_follow_conv_filter, tcp_follow_index_filter, tcp_follow_address_filter,
                             tcp_port_to_display, follow_tcp_tap_listener, get_tcp_stream_count, NULL);
+    tcp_stream_frames = stream_frames_table_register("tcp.stream");
 }
 
 void
@@ -149,7 +149,7 @@ extern const reassembly_table_functions
 tcp_reassembly_table_functions;
 
 extern struct tcp_multisegment_pdu *
-pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nxtpdu, wmem_tree_t *multisegment_pdus);
+pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nxtpdu, wmem_seqtree_t *multisegment_pdus);
 
 typedef struct _tcp_unacked_t {
 	struct _tcp_unacked_t *next;
@@ -376,7 +376,7 @@ typedef struct _tcp_flow_t {
 	/* This tree is indexed by sequence number and keeps track of all
 	 * all pdus spanning multiple segments for this flow.
 	 */
-	wmem_tree_t *multisegment_pdus;
+	wmem_seqtree_t *multisegment_pdus;
 
 	/* A sorted list of pending out-of-order segments. */
 	wmem_list_t *ooo_segments;
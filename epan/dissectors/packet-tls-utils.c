@@ -36,6 +36,7 @@
 #include <wsutil/file_util.h>
 #include <wsutil/str_util.h>
 #include <wsutil/report_message.h>
+#include <wsutil/tempfile.h>
 #include <wsutil/pint.h>
 #include <wsutil/strtoi.h>
 #include <wsutil/wsgcrypt.h>
@@ -3935,7 +3936,7 @@ ssl_create_flow(void)
   flow = wmem_new(wmem_file_scope(), SslFlow);
   flow->byte_seq = 0;
   flow->flags = 0;
-  flow->multisegment_pdus = wmem_tree_new(wmem_file_scope());
+  flow->multisegment_pdus = wmem_seqtree_new(wmem_file_scope());
   return flow;
 }
 /* }}} */
@@ -5703,6 +5704,103 @@ tls_add_packet_info(gint proto, packet_info *pinfo, guint8 curr_layer_num_ssl)
     return pi;
 }
 
+/*
+ * Decrypted records are kept in memory until their total size exceeds the
+ * "decrypted_data_limit" preference (in KiB, 0 for no limit). The plaintext
+ * of any further records is appended to a temporary file instead and read
+ * back whenever the record is dissected again, so redissection never needs
+ * to decrypt anything either way.
+ */
+static guint tls_decrypted_data_limit;
+static guint64 tls_decrypted_data_in_memory;
+static FILE *tls_spill_file;
+static gchar *tls_spill_path;
+static gint64 tls_spill_size;
+static gboolean tls_spill_failed;
+
+static gboolean
+tls_spill_record_data(SslRecordInfo *rec, const guchar *data, guint data_len)
+{
+    if (!tls_spill_file) {
+        GError *err = NULL;
+        int fd;
+
+        if (tls_spill_failed)
+            return FALSE;
+
+        fd = create_tempfile(NULL, &tls_spill_path, "wireshark_tls", NULL, &err);
+        if (fd == -1) {
+            ssl_debug_printf("%s cannot create spill file: %s\n", G_STRFUNC, err->message);
+            g_clear_error(&err);
+            tls_spill_failed = TRUE;
+            return FALSE;
+        }
+        tls_spill_file = ws_fdopen(fd, "w+b");
+        if (!tls_spill_file) {
+            ws_close(fd);
+            ws_unlink(tls_spill_path);
+            g_free(tls_spill_path);
+            tls_spill_path = NULL;
+            tls_spill_failed = TRUE;
+            return FALSE;
+        }
+        tls_spill_size = 0;
+    }
+
+    if (ws_fseek64(tls_spill_file, tls_spill_size, SEEK_SET) != 0 ||
+        fwrite(data, 1, data_len, tls_spill_file) != data_len) {
+        return FALSE;
+    }
+
+    rec->plain_data = NULL;
+    rec->spill_offset = tls_spill_size;
+    tls_spill_size += data_len;
+    return TRUE;
+}
+
+static void
+tls_spill_cleanup(void)
+{
+    if (tls_spill_file) {
+        fclose(tls_spill_file);
+        tls_spill_file = NULL;
+        ws_unlink(tls_spill_path);
+    }
+    g_free(tls_spill_path);
+    tls_spill_path = NULL;
+    tls_spill_size = 0;
+    tls_spill_failed = FALSE;
+    tls_decrypted_data_in_memory = 0;
+}
+
+/**
+ * Returns the decrypted data of a record. If the data was spilled to disk,
+ * it is read back into a buffer allocated from scope.
+ *
+ * @return The data, or NULL if it could not be read back.
+ */
+const guchar *
+ssl_record_info_get_data(wmem_allocator_t *scope, const SslRecordInfo *rec)
+{
+    guchar *data;
+
+    if (rec->plain_data || rec->data_len == 0)
+        return rec->plain_data;
+
+    if (!tls_spill_file)
+        return NULL;
+
+    data = (guchar *)wmem_alloc(scope, rec->data_len);
+    if (ws_fseek64(tls_spill_file, rec->spill_offset, SEEK_SET) != 0 ||
+        fread(data, 1, rec->data_len, tls_spill_file) != rec->data_len) {
+        ssl_debug_printf("%s cannot read back %u bytes at offset %" G_GINT64_FORMAT "\n",
+                         G_STRFUNC, rec->data_len, rec->spill_offset);
+        wmem_free(scope, data);
+        return NULL;
+    }
+    return data;
+}
+
 /**
  * Remembers the decrypted TLS record fragment (TLSInnerPlaintext in TLS 1.3) to
  * avoid the need for a decoder in the second pass. Additionally, it remembers
@@ -5724,8 +5822,14 @@ ssl_add_record_info(gint proto, packet_info *pinfo, const guchar *data, gint dat
     SslPacketInfo *pi = tls_add_packet_info(proto, pinfo, curr_layer_num_ssl);
 
     rec = wmem_new(wmem_file_scope(), SslRecordInfo);
-    rec->plain_data = (guchar *)wmem_memdup(wmem_file_scope(), data, data_len);
     rec->data_len = data_len;
+    rec->spill_offset = 0;
+    if (tls_decrypted_data_limit == 0 ||
+        tls_decrypted_data_in_memory + data_len <= (guint64)tls_decrypted_data_limit * 1024 ||
+        !tls_spill_record_data(rec, data, data_len)) {
+        rec->plain_data = (guchar *)wmem_memdup(wmem_file_scope(), data, data_len);
+        tls_decrypted_data_in_memory += data_len;
+    }
     rec->id = record_id;
     rec->type = type;
     rec->next = NULL;
@@ -5757,15 +5861,26 @@ ssl_get_record_info(tvbuff_t *parent_tvb, int proto, packet_info *pinfo, gint re
 
     for (rec = pi->records; rec; rec = rec->next)
         if (rec->id == record_id) {
+            const guchar *data = ssl_record_info_get_data(pinfo->pool, rec);
+
+            if (!data && rec->data_len)
+                return NULL;
             *matched_record = rec;
             /* link new real_data_tvb with a parent tvb so it is freed when frame dissection is complete */
-            return tvb_new_child_real_data(parent_tvb, rec->plain_data, rec->data_len, rec->data_len);
+            return tvb_new_child_real_data(parent_tvb, data, rec->data_len, rec->data_len);
         }
 
     return NULL;
 }
 /* Links SSL records with the real packet data. }}} */
 
+/*
+ * Data read from the keylog file after its last complete line. It is kept
+ * until the rest of the line has been read, so that a line which was still
+ * being written when the file was read is only processed once complete.
+ */
+static GString *tls_keylog_partial;
+
 /* initialize/reset per capture state data (ssl sessions cache). {{{ */
 void
 ssl_common_init(ssl_master_key_map_t *mk_map,
@@ -5807,12 +5922,19 @@ ssl_common_cleanup(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
     g_free(decrypted_data->data);
     g_free(compressed_data->data);
 
+    tls_spill_cleanup();
+
     /* close the previous keylog file now that the cache are cleared, this
      * allows the cache to be filled with the full keylog file contents. */
     if (*ssl_keylog_file) {
         fclose(*ssl_keylog_file);
         *ssl_keylog_file = NULL;
     }
+    /* The secrets maps are gone, and the whole file is read again. */
+    if (tls_keylog_partial) {
+        g_string_free(tls_keylog_partial, TRUE);
+        tls_keylog_partial = NULL;
+    }
 }
 /* }}} */
 
@@ -6214,78 +6336,118 @@ tls13_key_update(SslDecryptSession *ssl, gboolean is_from_server)
 
 /** SSL keylog file handling. {{{ */
 
-static GRegex *
-ssl_compile_keyfile_regex(void)
-{
-#define OCTET "(?:[[:xdigit:]]{2})"
-    const gchar *pattern =
-        "(?:"
-        /* Matches Client Hellos having this Client Random */
-        "PMS_CLIENT_RANDOM (?<client_random_pms>" OCTET "{32}) "
-        /* Matches first part of encrypted RSA pre-master secret */
-        "|RSA (?<encrypted_pmk>" OCTET "{8}) "
-        /* Pre-Master-Secret is given, it is 48 bytes for RSA,
-           but it can be of any length for DHE */
-        ")(?<pms>" OCTET "+)"
-        "|(?:"
-        /* Matches Server Hellos having a Session ID */
-        "RSA Session-ID:(?<session_id>" OCTET "+) Master-Key:"
-        /* Matches Client Hellos having this Client Random */
-        "|CLIENT_RANDOM (?<client_random>" OCTET "{32}) "
-        /* Master-Secret is given, its length is fixed */
-        ")(?<master_secret>" OCTET "{" G_STRINGIFY(SSL_MASTER_SECRET_LENGTH) "})"
-        "|(?"
-        /* TLS 1.3 Client Random to Derived Secrets mapping. */
-        ":CLIENT_EARLY_TRAFFIC_SECRET (?<client_early>" OCTET "{32})"
-        "|CLIENT_HANDSHAKE_TRAFFIC_SECRET (?<client_handshake>" OCTET "{32})"
-        "|SERVER_HANDSHAKE_TRAFFIC_SECRET (?<server_handshake>" OCTET "{32})"
-        "|CLIENT_TRAFFIC_SECRET_0 (?<client_appdata>" OCTET "{32})"
-        "|SERVER_TRAFFIC_SECRET_0 (?<server_appdata>" OCTET "{32})"
-        "|EARLY_EXPORTER_SECRET (?<early_exporter>" OCTET "{32})"
-        "|EXPORTER_SECRET (?<exporter>" OCTET "{32})"
-        ") (?<derived_secret>" OCTET "+)";
-#undef OCTET
-    static GRegex *regex = NULL;
-    GError *gerr = NULL;
-
-    if (!regex) {
-        regex = g_regex_new(pattern,
-                (GRegexCompileFlags)(G_REGEX_OPTIMIZE | G_REGEX_ANCHORED | G_REGEX_RAW),
-                G_REGEX_MATCH_ANCHORED, &gerr);
-        if (gerr) {
-            ssl_debug_printf("%s failed to compile regex: %s\n", G_STRFUNC,
-                             gerr->message);
-            g_error_free(gerr);
-            regex = NULL;
-        }
-    }
-
-    return regex;
-}
-
-typedef struct ssl_master_key_match_group {
-    const char *re_group_name;
-    GHashTable *master_key_ht;
-} ssl_master_key_match_group_t;
+/*
+ * The keylog line formats. The line starts with the label, followed by the
+ * hex-encoded key, the separator and the hex-encoded secret. Anything after
+ * the secret is ignored. A length of 0 means any (even) length.
+ */
+typedef struct {
+    const char *label;
+    gsize key_hex_len;
+    const char *separator;
+    gsize secret_hex_len;
+    size_t map_offset;      /* Offset of the GHashTable * in ssl_master_key_map_t. */
+} tls_keylog_format_t;
+
+#define TLS_CRANDOM_HEX_LEN     (2 * 32)
+
+static const tls_keylog_format_t tls_keylog_formats[] = {
+    { "PMS_CLIENT_RANDOM ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, pms) },
+    /* Must come before the "RSA " format. */
+    { "RSA Session-ID:", 0, " Master-Key:", 2 * SSL_MASTER_SECRET_LENGTH,
+      offsetof(ssl_master_key_map_t, session) },
+    { "RSA ", 2 * 8, " ", 0,
+      offsetof(ssl_master_key_map_t, pre_master) },
+    { "CLIENT_RANDOM ", TLS_CRANDOM_HEX_LEN, " ", 2 * SSL_MASTER_SECRET_LENGTH,
+      offsetof(ssl_master_key_map_t, crandom) },
+    /* TLS 1.3 Client Random to Derived Secrets mapping. */
+    { "CLIENT_EARLY_TRAFFIC_SECRET ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_client_early) },
+    { "CLIENT_HANDSHAKE_TRAFFIC_SECRET ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_client_handshake) },
+    { "SERVER_HANDSHAKE_TRAFFIC_SECRET ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_server_handshake) },
+    { "CLIENT_TRAFFIC_SECRET_0 ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_client_appdata) },
+    { "SERVER_TRAFFIC_SECRET_0 ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_server_appdata) },
+    { "EARLY_EXPORTER_SECRET ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_early_exporter) },
+    { "EXPORTER_SECRET ", TLS_CRANDOM_HEX_LEN, " ", 0,
+      offsetof(ssl_master_key_map_t, tls13_exporter) },
+};
+
+static gsize
+tls_keylog_hex_len(const char *p, const char *end)
+{
+    const char *start = p;
+
+    while (p < end && g_ascii_isxdigit(*p))
+        p++;
+    return p - start;
+}
+
+/*
+ * Parses a single keylog line and adds the secret to the matching map.
+ * Returns FALSE if the line is not in any of the known formats.
+ */
+static gboolean
+tls_keylog_process_line(const ssl_master_key_map_t *mk_map, const char *line, gsize linelen)
+{
+    const char *end = line + linelen;
+    const tls_keylog_format_t *fmt = NULL;
+    const char *p, *hex_key, *hex_secret;
+    gsize label_len = 0, sep_len, key_len, secret_len;
+    StringInfo *key, *secret;
+    GHashTable *ht;
+
+    for (unsigned i = 0; i < G_N_ELEMENTS(tls_keylog_formats); i++) {
+        label_len = strlen(tls_keylog_formats[i].label);
+        if (linelen >= label_len && memcmp(line, tls_keylog_formats[i].label, label_len) == 0) {
+            fmt = &tls_keylog_formats[i];
+            break;
+        }
+    }
+    if (!fmt)
+        return FALSE;
+
+    hex_key = line + label_len;
+    key_len = tls_keylog_hex_len(hex_key, end);
+    if (fmt->key_hex_len ? key_len != fmt->key_hex_len : (key_len == 0 || (key_len & 1)))
+        return FALSE;
+
+    p = hex_key + key_len;
+    sep_len = strlen(fmt->separator);
+    if ((gsize)(end - p) < sep_len || memcmp(p, fmt->separator, sep_len) != 0)
+        return FALSE;
+
+    hex_secret = p + sep_len;
+    secret_len = tls_keylog_hex_len(hex_secret, end);
+    if (fmt->secret_hex_len) {
+        if (secret_len < fmt->secret_hex_len)
+            return FALSE;
+        secret_len = fmt->secret_hex_len;
+    } else {
+        secret_len &= ~(gsize)1;
+        if (secret_len == 0)
+            return FALSE;
+    }
+
+    ssl_debug_printf("    matched %.*s\n", (int)(label_len - 1), fmt->label);
+    key = wmem_new(wmem_file_scope(), StringInfo);
+    from_hex(key, hex_key, key_len);
+    secret = wmem_new(wmem_file_scope(), StringInfo);
+    from_hex(secret, hex_secret, secret_len);
+
+    ht = *(GHashTable **)((const guint8 *)mk_map + fmt->map_offset);
+    g_hash_table_insert(ht, key, secret);
+    return TRUE;
+}
 
 void
 tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const guint8 *data, guint datalen)
 {
-    ssl_master_key_match_group_t mk_groups[] = {
-        { "encrypted_pmk",  mk_map->pre_master },
-        { "session_id",     mk_map->session },
-        { "client_random",  mk_map->crandom },
-        { "client_random_pms",  mk_map->pms },
-        /* TLS 1.3 map from Client Random to derived secret. */
-        { "client_early",       mk_map->tls13_client_early },
-        { "client_handshake",   mk_map->tls13_client_handshake },
-        { "server_handshake",   mk_map->tls13_server_handshake },
-        { "client_appdata",     mk_map->tls13_client_appdata },
-        { "server_appdata",     mk_map->tls13_server_appdata },
-        { "early_exporter",     mk_map->tls13_early_exporter },
-        { "exporter",           mk_map->tls13_exporter },
-    };
-
     /* The format of the file is a series of records with one of the following formats:
      *   - "RSA xxxx yyyy"
      *     Where xxxx are the first 8 bytes of the encrypted pre-master secret (hex-encoded)
@@ -6324,10 +6486,6 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const guint8 *data,
      *     handshake or master secrets. (This format is introduced with TLS 1.3
      *     and supported by BoringSSL, OpenSSL, etc. See bug 12779.)
      */
-    GRegex *regex = ssl_compile_keyfile_regex();
-    if (!regex)
-        return;
-
     const char *next_line = (const char *)data;
     const char *line_end = next_line + datalen;
     while (next_line && next_line < line_end) {
@@ -6346,56 +6504,85 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const guint8 *data,
         }
 
         ssl_debug_printf("  checking keylog line: %.*s\n", (int)linelen, line);
-        GMatchInfo *mi;
-        if (g_regex_match_full(regex, line, linelen, 0, G_REGEX_MATCH_ANCHORED, &mi, NULL)) {
-            gchar *hex_key, *hex_pre_ms_or_ms;
-            StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
-            StringInfo *pre_ms_or_ms = NULL;
-            GHashTable *ht = NULL;
-
-            /* Is the PMS being supplied with the PMS_CLIENT_RANDOM
-             * otherwise we will use the Master Secret
-             */
-            hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "master_secret");
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "pms");
-            }
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "derived_secret");
-            }
-            /* There is always a match, otherwise the regex is wrong. */
-            DISSECTOR_ASSERT(hex_pre_ms_or_ms && strlen(hex_pre_ms_or_ms));
-
-            /* convert from hex to bytes and save to hashtable */
-            pre_ms_or_ms = wmem_new(wmem_file_scope(), StringInfo);
-            from_hex(pre_ms_or_ms, hex_pre_ms_or_ms, strlen(hex_pre_ms_or_ms));
-            g_free(hex_pre_ms_or_ms);
-
-            /* Find a master key from any format (CLIENT_RANDOM, SID, ...) */
-            for (unsigned i = 0; i < G_N_ELEMENTS(mk_groups); i++) {
-                ssl_master_key_match_group_t *g = &mk_groups[i];
-                hex_key = g_match_info_fetch_named(mi, g->re_group_name);
-                if (hex_key && *hex_key) {
-                    ssl_debug_printf("    matched %s\n", g->re_group_name);
-                    ht = g->master_key_ht;
-                    from_hex(key, hex_key, strlen(hex_key));
-                    g_free(hex_key);
-                    break;
-                }
-                g_free(hex_key);
-            }
-            DISSECTOR_ASSERT(ht); /* Cannot be reached, or regex is wrong. */
+        if (!tls_keylog_process_line(mk_map, line, linelen) && linelen > 0 && line[0] != '#') {
+            ssl_debug_printf("    unrecognized line\n");
+        }
+    }
+}
 
-            g_hash_table_insert(ht, key, pre_ms_or_ms);
+#define TLS_KEYLOG_READ_SIZE    65536
 
-        } else if (linelen > 0 && line[0] != '#') {
-            ssl_debug_printf("    unrecognized line\n");
+/*
+ * Processes the data after the last complete line of the keylog file. This
+ * is done when the file is first read or closed, and when no data was
+ * appended to it since it was last read.
+ */
+static void
+tls_keylog_flush_partial(const ssl_master_key_map_t *mk_map)
+{
+    if (tls_keylog_partial && tls_keylog_partial->len) {
+        tls_keylog_process_lines(mk_map, (const guint8 *)tls_keylog_partial->str, (guint)tls_keylog_partial->len);
+        g_string_truncate(tls_keylog_partial, 0);
+    }
+}
+
+/*
+ * Reads the data appended to the keylog file since the last call and
+ * processes its complete lines. Returns FALSE if there was no new data.
+ */
+static gboolean
+tls_keylog_read_new_lines(FILE **keylog_file, const ssl_master_key_map_t *mk_map)
+{
+    gboolean got_data = FALSE;
+
+    if (!tls_keylog_partial)
+        tls_keylog_partial = g_string_sized_new(TLS_KEYLOG_READ_SIZE);
+
+    for (;;) {
+        gsize old_len = tls_keylog_partial->len;
+        gsize nread, complete;
+
+        g_string_set_size(tls_keylog_partial, old_len + TLS_KEYLOG_READ_SIZE);
+        nread = fread(tls_keylog_partial->str + old_len, 1, TLS_KEYLOG_READ_SIZE, *keylog_file);
+        g_string_set_size(tls_keylog_partial, old_len + nread);
+
+        if (nread == 0) {
+            if (feof(*keylog_file)) {
+                /* Ensure that newly appended keys can be read in the future. */
+                clearerr(*keylog_file);
+                /*
+                 * The file may not end with a newline. A line that is still
+                 * being written to is held back for one read; if nothing
+                 * was appended to it since, take it as it is.
+                 */
+                if (!got_data)
+                    tls_keylog_flush_partial(mk_map);
+            } else if (ferror(*keylog_file)) {
+                ssl_debug_printf("%s Error while reading key log file, closing it!\n", G_STRFUNC);
+                fclose(*keylog_file);
+                *keylog_file = NULL;
+                tls_keylog_flush_partial(mk_map);
+            }
+            break;
+        }
+        got_data = TRUE;
+
+        /* Process everything up to and including the last newline. */
+        for (complete = tls_keylog_partial->len; complete > old_len; complete--) {
+            if (tls_keylog_partial->str[complete - 1] == '\n')
+                break;
+        }
+        if (complete > old_len) {
+            tls_keylog_process_lines(mk_map, (const guint8 *)tls_keylog_partial->str, (guint)complete);
+            g_string_erase(tls_keylog_partial, 0, complete);
+        } else if (tls_keylog_partial->len > TLS_KEYLOG_READ_SIZE) {
+            /* No valid line is that long. */
+            ssl_debug_printf("%s dropping overlong line\n", G_STRFUNC);
+            g_string_truncate(tls_keylog_partial, 0);
         }
-        /* always free match info even if there is no match. */
-        g_match_info_free(mi);
     }
+
+    return got_data;
 }
 
 void
@@ -6409,44 +6596,33 @@ ssl_load_keyfile(const gchar *tls_keylog_filename, FILE **keylog_file,
         return;
     }
 
-    /* Validate regexes before even trying to use it. */
-    if (!ssl_compile_keyfile_regex()) {
-        return;
-    }
-
     ssl_debug_printf("trying to use TLS keylog in %s\n", tls_keylog_filename);
 
-    /* if the keylog file was deleted/overwritten, re-open it */
-    if (*keylog_file && file_needs_reopen(ws_fileno(*keylog_file), tls_keylog_filename)) {
+    /*
+     * Only the data appended since the last call is read. If there is none,
+     * check whether the keylog file was deleted/overwritten and re-open it.
+     */
+    if (*keylog_file) {
+        if (tls_keylog_read_new_lines(keylog_file, mk_map) || !*keylog_file)
+            return;
+        if (!file_needs_reopen(ws_fileno(*keylog_file), tls_keylog_filename))
+            return;
         ssl_debug_printf("%s file got deleted, trying to re-open\n", G_STRFUNC);
         fclose(*keylog_file);
         *keylog_file = NULL;
+        /* Nothing more will be appended to the last line of the old file. */
+        tls_keylog_flush_partial(mk_map);
     }
 
-    if (*keylog_file == NULL) {
-        *keylog_file = ws_fopen(tls_keylog_filename, "r");
-        if (!*keylog_file) {
-            ssl_debug_printf("%s failed to open SSL keylog\n", G_STRFUNC);
-            return;
-        }
-    }
-
-    for (;;) {
-        char buf[1110], *line;
-        line = fgets(buf, sizeof(buf), *keylog_file);
-        if (!line) {
-            if (feof(*keylog_file)) {
-                /* Ensure that newly appended keys can be read in the future. */
-                clearerr(*keylog_file);
-            } else if (ferror(*keylog_file)) {
-                ssl_debug_printf("%s Error while reading key log file, closing it!\n", G_STRFUNC);
-                fclose(*keylog_file);
-                *keylog_file = NULL;
-            }
-            break;
-        }
-        tls_keylog_process_lines(mk_map, (guint8 *)line, (int)strlen(line));
+    *keylog_file = ws_fopen(tls_keylog_filename, "r");
+    if (!*keylog_file) {
+        ssl_debug_printf("%s failed to open SSL keylog\n", G_STRFUNC);
+        return;
     }
+    /* A keylog file that exists before the capture is read need not end
+     * with a newline, so process its last line right away. */
+    tls_keylog_read_new_lines(keylog_file, mk_map);
+    tls_keylog_flush_partial(mk_map);
 }
 /** SSL keylog file handling. }}} */
 
@@ -10777,6 +10953,14 @@ ssl_common_register_options(module_t *module, ssl_common_options_t *options, gbo
              "\n"
              "(All fields are in hex notation)",
              &(options->keylog_filename), FALSE);
+
+        prefs_register_uint_preference(module, "decrypted_data_limit",
+             "Decrypted data memory limit (KiB)",
+             "Decrypted TLS and DTLS records are kept so that they do not have to be "
+             "decrypted again when packets are redissected. Once the records take more "
+             "memory than this, the decrypted data of further records is kept in a "
+             "temporary file instead. 0 means no limit.",
+             10, &tls_decrypted_data_limit);
 }
 
 void
@@ -325,7 +325,7 @@ typedef struct _SslCipherSuite {
 typedef struct _SslFlow {
     guint32 byte_seq;
     guint16 flags;
-    wmem_tree_t *multisegment_pdus;
+    wmem_seqtree_t *multisegment_pdus;
 } SslFlow;
 
 typedef struct _SslDecompress SslDecompress;
@@ -413,8 +413,11 @@ typedef struct {
 } SslDigestAlgo;
 
 typedef struct _SslRecordInfo {
-    guchar *plain_data;     /**< Decrypted data. */
+    guchar *plain_data;     /**< Decrypted data, NULL if it was spilled to
+                                 disk (use ssl_record_info_get_data()). */
     guint   data_len;       /**< Length of decrypted data. */
+    gint64  spill_offset;   /**< Offset of the decrypted data in the spill
+                                 file if plain_data is NULL. */
     gint    id;             /**< Identifies the exact record within a frame
                                  (there can be multiple records in a frame). */
     ContentType type;       /**< Content type of the decrypted record data. */
@@ -745,6 +748,10 @@ tls_add_packet_info(gint proto, packet_info *pinfo, guint8 curr_layer_num_ssl);
 extern void
 ssl_add_record_info(gint proto, packet_info *pinfo, const guchar *data, gint data_len, gint record_id, SslFlow *flow, ContentType type, guint8 curr_layer_num_ssl);
 
+/* return the decrypted data of a record, reading it back from disk into scope if needed */
+extern const guchar *
+ssl_record_info_get_data(wmem_allocator_t *scope, const SslRecordInfo *rec);
+
 /* search in packet data for the specified id; return a newly created tvb for the associated data */
 extern tvbuff_t*
 ssl_get_record_info(tvbuff_t *parent_tvb, gint proto, packet_info *pinfo, gint record_id, guint8 curr_layer_num_ssl, SslRecordInfo **matched_record);
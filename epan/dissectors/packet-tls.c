@@ -419,6 +419,7 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
     follow_info_t *      follow_info = (follow_info_t*) tapdata;
     follow_record_t * follow_record = NULL;
     const SslRecordInfo *appl_data = NULL;
+    const guchar *       plain_data;
     const SslPacketInfo *pi = (const SslPacketInfo*)ssl;
     show_stream_t        from = FROM_CLIENT;
 
@@ -462,6 +463,9 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
            the opportunity to accurately reflect TLS PDU boundaries. Currently
            the Hex Dump view does by starting a new line, and the C Arrays
            view does by starting a new array declaration. */
+        plain_data = ssl_record_info_get_data(pinfo->pool, appl_data);
+        if (!plain_data && appl_data->data_len) continue;
+
         follow_record = g_new(follow_record_t,1);
 
         follow_record->is_server = (from == FROM_SERVER);
@@ -470,7 +474,7 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
 
         follow_record->data = g_byte_array_sized_new(appl_data->data_len);
         follow_record->data = g_byte_array_append(follow_record->data,
-                                              appl_data->plain_data,
+                                              plain_data,
                                               appl_data->data_len);
 
         /* Add the record to the follow_info structure. */
@@ -878,7 +882,7 @@ dissect_ssl(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _U_)
             } else {
                 ssl_debug_printf("  desegmenting at end of stream (FIN)\n");
                 struct tcp_multisegment_pdu *msp;
-                msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(decoder->flow->multisegment_pdus, decoder->flow->byte_seq);
+                msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(decoder->flow->multisegment_pdus, decoder->flow->byte_seq);
                 if (msp) {
                     fragment_head *ipfd_head;
                     ipfd_head = fragment_add(&ssl_reassembly_table, tvb, offset,
@@ -1387,7 +1391,7 @@ again:
      * dissection of the desegmented pdu if we'd already seen the end of
      * the pdu).
      */
-    if ((msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32(flow->multisegment_pdus, seq))) {
+    if ((msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32(flow->multisegment_pdus, seq))) {
         const char *prefix;
         gboolean is_retransmission = FALSE;
 
@@ -1420,7 +1424,7 @@ again:
     }
 
     /* Else, find the most previous PDU starting before this sequence number */
-    msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(flow->multisegment_pdus, seq-1);
+    msp = (struct tcp_multisegment_pdu *)wmem_seqtree_lookup32_le(flow->multisegment_pdus, seq-1);
     if (msp && msp->seq <= seq && msp->nxtpdu > seq) {
         int len;
 
@@ -1897,7 +1901,7 @@ dissect_ssl_payload(tvbuff_t *decrypted, packet_info *pinfo,
 
     /* try to dissect decrypted data*/
     ssl_debug_printf("%s decrypted len %d\n", G_STRFUNC, record->data_len);
-    ssl_print_data("decrypted app data fragment", record->plain_data, record->data_len);
+    ssl_print_data("decrypted app data fragment", tvb_get_ptr(decrypted, 0, -1), record->data_len);
 
     /* Can we desegment this segment? */
     if (tls_desegment_app_data) {
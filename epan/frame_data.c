@@ -151,6 +151,33 @@ frame_data_compare(const struct epan_session *epan, const frame_data *fdata1, co
   g_return_val_if_reached(0);
 }
 
+/*
+ * The data that only a few frames have.  It's allocated when a frame
+ * first gets some of it, and freed again when it has none of it left.
+ */
+typedef struct _frame_data_ext {
+  GHashTable  *dependent_frames;     /**< A hash table of frames which this one depends on */
+  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
+} frame_data_ext;
+
+static frame_data_ext *
+frame_data_ext_get(frame_data *fdata)
+{
+  if (fdata->ext == NULL)
+    fdata->ext = g_new0(frame_data_ext, 1);
+  return fdata->ext;
+}
+
+static void
+frame_data_ext_release(frame_data *fdata)
+{
+  if (fdata->ext->dependent_frames == NULL &&
+      nstime_is_zero(&fdata->ext->shift_offset)) {
+    g_free(fdata->ext);
+    fdata->ext = NULL;
+  }
+}
+
 void
 frame_data_init(frame_data *fdata, guint32 num, const wtap_rec *rec,
                 gint64 offset, guint32 cum_bytes)
@@ -161,7 +188,7 @@ frame_data_init(frame_data *fdata, guint32 num, const wtap_rec *rec,
   fdata->subnum = 0;
   fdata->passed_dfilter = 0;
   fdata->dependent_of_displayed = 0;
-  fdata->dependent_frames = NULL;
+  fdata->ext = NULL;
   fdata->encoding = PACKET_CHAR_ENC_CHAR_ASCII;
   fdata->visited = 0;
   fdata->marked = 0;
@@ -232,8 +259,6 @@ frame_data_init(frame_data *fdata, guint32 num, const wtap_rec *rec,
   fdata->has_modified_block = 0;
   fdata->need_colorize = 0;
   fdata->color_filter = NULL;
-  fdata->shift_offset.secs = 0;
-  fdata->shift_offset.nsecs = 0;
   fdata->frame_ref_num = 0;
   fdata->prev_dis_num = 0;
 }
@@ -299,9 +324,10 @@ frame_data_reset(frame_data *fdata)
     fdata->pfd = NULL;
   }
 
-  if (fdata->dependent_frames) {
-    g_hash_table_destroy(fdata->dependent_frames);
-    fdata->dependent_frames = NULL;
+  if (fdata->ext && fdata->ext->dependent_frames) {
+    g_hash_table_destroy(fdata->ext->dependent_frames);
+    fdata->ext->dependent_frames = NULL;
+    frame_data_ext_release(fdata);
   }
 }
 
@@ -313,9 +339,49 @@ frame_data_destroy(frame_data *fdata)
     fdata->pfd = NULL;
   }
 
-  if (fdata->dependent_frames) {
-    g_hash_table_destroy(fdata->dependent_frames);
-    fdata->dependent_frames = NULL;
+  if (fdata->ext) {
+    if (fdata->ext->dependent_frames)
+      g_hash_table_destroy(fdata->ext->dependent_frames);
+    g_free(fdata->ext);
+    fdata->ext = NULL;
+  }
+}
+
+void
+frame_data_add_dependent_frame(frame_data *fdata, guint32 frame_num)
+{
+  frame_data_ext *ext = frame_data_ext_get(fdata);
+
+  if (ext->dependent_frames == NULL) {
+    ext->dependent_frames = g_hash_table_new(g_direct_hash, g_direct_equal);
+  }
+  g_hash_table_insert(ext->dependent_frames, GUINT_TO_POINTER(frame_num), NULL);
+}
+
+GHashTable *
+frame_data_dependent_frames(const frame_data *fdata)
+{
+  return fdata->ext ? fdata->ext->dependent_frames : NULL;
+}
+
+const nstime_t *
+frame_data_shift_offset(const frame_data *fdata)
+{
+  static const nstime_t no_shift = NSTIME_INIT_ZERO;
+
+  return fdata->ext ? &fdata->ext->shift_offset : &no_shift;
+}
+
+void
+frame_data_set_shift_offset(frame_data *fdata, const nstime_t *offset)
+{
+  if (nstime_is_zero(offset)) {
+    if (fdata->ext) {
+      nstime_set_zero(&fdata->ext->shift_offset);
+      frame_data_ext_release(fdata);
+    }
+  } else {
+    frame_data_ext_get(fdata)->shift_offset = *offset;
   }
 }
 
@@ -58,8 +58,15 @@ typedef enum {
 
    XXX - shuffle the fields to try to keep the most commonly-accessed
    fields within the first 16 or 32 bytes, so they all fit in a cache
-   line? */
+   line?
+
+   Data that only a few frames have, such as the frames a frame depends
+   on and a time shift, is kept in a separate structure that's only
+   allocated for those frames; use the accessor functions below for it.
+   That keeps this structure at 80 bytes on LP64 (64-bit UN*X)
+   platforms. */
 struct _color_filter; /* Forward */
+struct _frame_data_ext; /* Forward */
 DIAG_OFF_PEDANTIC
 typedef struct _frame_data {
   guint32      num;          /**< Frame number */
@@ -67,11 +74,11 @@ typedef struct _frame_data {
   guint32      cap_len;      /**< Amount actually captured */
   guint32      cum_bytes;    /**< Cumulative bytes into the capture */
   gint64       file_off;     /**< File offset */
-  /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
+  /* These are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
      LLP64 (64-bit Windows) platforms.  Put them here, one after the
      other, so they don't require padding between them. */
   GSList      *pfd;          /**< Per frame proto data */
-  GHashTable  *dependent_frames;     /**< A hash table of frames which this one depends on */
+  struct _frame_data_ext *ext; /**< Rarely used data, or NULL */
   const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
   guint16      subnum;       /**< subframe number, for protocols that require this */
   /* Keep the bitfields below to 16 bits, so this plus the previous field
@@ -88,14 +95,30 @@ typedef struct _frame_data {
   unsigned int has_modified_block : 1; /** 1 = block for this packet has been modified */
   unsigned int need_colorize    : 1; /**< 1 = need to (re-)calculate packet color */
   unsigned int tsprec           : 4; /**< Time stamp precision -2^tsprec gives up to femtoseconds */
+  /* Put this in the padding before abs_ts. */
+  guint8       tcp_snd_manual_analysis;   /**< TCP SEQ Analysis Overriding, 0 = none, 1 = OOO, 2 = RET , 3 = Fast RET, 4 = Spurious RET */
   nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
   guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
   guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
-  guint8       tcp_snd_manual_analysis;   /**< TCP SEQ Analysis Overriding, 0 = none, 1 = OOO, 2 = RET , 3 = Fast RET, 4 = Spurious RET */
 } frame_data;
 DIAG_ON_PEDANTIC
 
+/** Mark a frame as depending on another frame, e.g. because it's
+ * reassembled with data from it. */
+WS_DLL_PUBLIC void frame_data_add_dependent_frame(frame_data *fdata, guint32 frame_num);
+
+/** The frames a frame depends on, as a hash table whose keys are the
+ * frame numbers (GUINT_TO_POINTER()), or NULL if there are none. */
+WS_DLL_PUBLIC GHashTable *frame_data_dependent_frames(const frame_data *fdata);
+
+/** How much the time stamp of a frame has been shifted. The returned
+ * value is valid until the time shift is changed. */
+WS_DLL_PUBLIC const nstime_t *frame_data_shift_offset(const frame_data *fdata);
+
+/** Set how much the time stamp of a frame has been shifted. This doesn't
+ * change abs_ts. */
+WS_DLL_PUBLIC void frame_data_set_shift_offset(frame_data *fdata, const nstime_t *offset);
+
 /** compare two frame_datas */
 WS_DLL_PUBLIC gint frame_data_compare(const struct epan_session *epan, const frame_data *fdata1, const frame_data *fdata2, int field);
 
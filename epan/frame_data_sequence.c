@@ -10,9 +10,15 @@
 
 #include "config.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/packet.h>
+#include <wsutil/bits_ctz.h>
+#include <wsutil/mapped_arena.h>
+#include <wsutil/ws_assert.h>
 
 #include "frame_data_sequence.h"
 
@@ -29,9 +35,73 @@
 #define LOG2_NODES_PER_LEVEL    10
 #define NODES_PER_LEVEL         (1<<LOG2_NODES_PER_LEVEL)
 
+/*
+ * An entry in the time stamp index.  The time stamp is split up
+ * explicitly so that an entry takes 16 bytes whatever the size of
+ * time_t.
+ */
+typedef struct {
+  gint64       secs;
+  gint32       nsecs;
+  guint32      num;             /* Frame number */
+} frame_time_entry;
+
+/*
+ * The entries of the time stamp index are packed in blocks of
+ * TIME_INDEX_BLOCK_LEN entries.  As the entries are sorted, the
+ * seconds of the entries in a block differ little from those of the
+ * first entry, and the frame numbers usually go up by one from entry
+ * to entry, so a block stores its first entry in full and, for each
+ * entry:
+ *
+ *    the seconds minus those of the first entry;
+ *    the nanoseconds;
+ *    the frame number minus (that of the first entry plus the index
+ *    in the block), zigzag-encoded so small negative values are small;
+ *
+ * each using as many bits as the largest value in the block needs.
+ * All the entries of a block are the same size, so any entry can be
+ * unpacked without looking at the others.  For a capture in time stamp
+ * order an entry takes about 5 bytes instead of 16.
+ */
+#define TIME_INDEX_BLOCK_LEN    64
+
+typedef struct {
+  frame_time_entry first;       /* First entry, also packed */
+  guint64      bit_off;         /* Offset of the packed entries, in bits */
+  guint8       secs_bits;       /* Width of the seconds */
+  guint8       nsecs_bits;      /* Width of the nanoseconds */
+  guint8       num_bits;        /* Width of the frame numbers */
+} time_index_block;
+
 struct _frame_data_sequence {
   guint32      count;           /* Total number of frames */
   void        *ptree_root;      /* Pointer to the root node */
+
+  /*
+   * Index of the frames with time stamps, sorted by time stamp and
+   * then by frame number.  It's built the first time it's needed and
+   * brought up to date with the frames added since then on later
+   * lookups.  Full blocks are packed, see above; the entries after
+   * them are kept as they are until there's a block's worth of them.
+   */
+  time_index_block *time_blocks;
+  guint32      time_blocks_len; /* Number of blocks */
+  guint32      time_blocks_size; /* Number of blocks allocated */
+  guint64     *time_bits;       /* Packed entries */
+  guint64      time_bits_len;   /* Number of bits used */
+  gsize        time_bits_size;  /* Number of words allocated */
+  frame_time_entry time_tail[TIME_INDEX_BLOCK_LEN]; /* Entries not in a block */
+  guint32      time_tail_len;
+  guint32      time_index_len;  /* Number of entries */
+  guint32      time_indexed;    /* Number of frames looked at */
+  gboolean     time_in_order;   /* Frames are in time stamp order */
+
+  /*
+   * If set, the leaf nodes are allocated from this arena in a
+   * memory-mapped file rather than from the heap.
+   */
+  mapped_arena_t *leaf_arena;
 };
 
 /*
@@ -55,9 +125,49 @@ new_frame_data_sequence(void)
   fds = (frame_data_sequence *)g_malloc(sizeof *fds);
   fds->count = 0;
   fds->ptree_root = NULL;
+  fds->time_blocks = NULL;
+  fds->time_blocks_len = 0;
+  fds->time_blocks_size = 0;
+  fds->time_bits = NULL;
+  fds->time_bits_len = 0;
+  fds->time_bits_size = 0;
+  fds->time_tail_len = 0;
+  fds->time_index_len = 0;
+  fds->time_indexed = 0;
+  fds->time_in_order = TRUE;
+  fds->leaf_arena = NULL;
   return fds;
 }
 
+gboolean
+frame_data_sequence_use_mapped_file(frame_data_sequence *fds,
+    const char *tempdir, GError **err)
+{
+  ws_assert(fds->count == 0);
+
+  if (fds->leaf_arena == NULL) {
+    fds->leaf_arena = mapped_arena_new(tempdir,
+        sizeof(frame_data)*NODES_PER_LEVEL, err);
+  }
+  return fds->leaf_arena != NULL;
+}
+
+/*
+ * Allocate a leaf node, from the mapped file if there is one and it
+ * can still be grown, otherwise from the heap.
+ */
+static frame_data *
+new_leaf(frame_data_sequence *fds)
+{
+  frame_data *leaf = NULL;
+
+  if (fds->leaf_arena != NULL)
+    leaf = (frame_data *)mapped_arena_alloc(fds->leaf_arena);
+  if (leaf == NULL)
+    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+  return leaf;
+}
+
 /*
  * Add a new frame_data structure to a frame_data_sequence.
  */
@@ -80,7 +190,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
   if (fds->count == 0) {
     /* The tree is empty; allocate the first leaf node, which will be
        the root node. */
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    leaf = new_leaf(fds);
     node = &leaf[0];
     fds->ptree_root = leaf;
   } else if (fds->count < NODES_PER_LEVEL) {
@@ -91,7 +201,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
     /* It's a 1-level tree that will turn into a 2-level tree. */
     level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
     level1[0] = (frame_data *)fds->ptree_root;
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    leaf = new_leaf(fds);
     level1[1] = leaf;
     node = &leaf[0];
     fds->ptree_root = level1;
@@ -100,7 +210,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
     level1 = (frame_data **)fds->ptree_root;
     leaf = level1[fds->count >> LOG2_NODES_PER_LEVEL];
     if (leaf == NULL) {
-      leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+      leaf = new_leaf(fds);
       level1[fds->count >> LOG2_NODES_PER_LEVEL] = leaf;
     }
     node = &leaf[LEAF_INDEX(fds->count)];
@@ -110,7 +220,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
     level2[0] = (frame_data **)fds->ptree_root;
     level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
     level2[1] = level1;
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    leaf = new_leaf(fds);
     level1[0] = leaf;
     node = &leaf[0];
     fds->ptree_root = level2;
@@ -124,7 +234,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
     }
     leaf = level1[LEVEL_1_INDEX(fds->count)];
     if (leaf == NULL) {
-      leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+      leaf = new_leaf(fds);
       level1[LEVEL_1_INDEX(fds->count)] = leaf;
     }
     node = &leaf[LEAF_INDEX(fds->count)];
@@ -136,7 +246,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
     level3[1] = level2;
     level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
     level2[0] = level1;
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    leaf = new_leaf(fds);
     level1[0] = leaf;
     node = &leaf[0];
     fds->ptree_root = level3;
@@ -162,7 +272,7 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
     }
     leaf = level1[LEVEL_1_INDEX(fds->count)];
     if (leaf == NULL) {
-      leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+      leaf = new_leaf(fds);
       level1[LEVEL_1_INDEX(fds->count)] = leaf;
     }
     node = &leaf[LEAF_INDEX(fds->count)];
@@ -226,7 +336,8 @@ frame_data_sequence_find(frame_data_sequence *fds, guint32 num)
 
 /* recursively frees a frame_data radix level */
 static void
-free_frame_data_array(void *array, guint count, guint level, gboolean last)
+free_frame_data_array(mapped_arena_t *leaf_arena, void *array, guint count,
+                      guint level, gboolean last)
 {
   guint i, level_count;
 
@@ -255,10 +366,10 @@ free_frame_data_array(void *array, guint count, guint level, gboolean last)
     frame_data **real_array = (frame_data **) array;
 
     for (i=0; i < level_count-1; i++) {
-      free_frame_data_array(real_array[i], count, level-1, FALSE);
+      free_frame_data_array(leaf_arena, real_array[i], count, level-1, FALSE);
     }
 
-    free_frame_data_array(real_array[level_count-1], count, level-1, last);
+    free_frame_data_array(leaf_arena, real_array[level_count-1], count, level-1, last);
   }
   else if (level == 1) {
     /* bottom level, so just clean up all the frame data */
@@ -267,6 +378,11 @@ free_frame_data_array(void *array, guint count, guint level, gboolean last)
     for (i=0; i < level_count; i++) {
       frame_data_destroy(&real_array[i]);
     }
+
+    if (leaf_arena != NULL && mapped_arena_contains(leaf_arena, array)) {
+      /* freed with the whole arena */
+      return;
+    }
   }
 
   /* free the array itself */
@@ -304,13 +420,386 @@ free_frame_data_sequence(frame_data_sequence *fds)
 
   /* call the recursive free function */
   if (levels > 0) {
-    free_frame_data_array(fds->ptree_root, fds->count, levels, TRUE);
+    free_frame_data_array(fds->leaf_arena, fds->ptree_root, fds->count, levels, TRUE);
   }
 
+  g_free(fds->time_blocks);
+  g_free(fds->time_bits);
+  mapped_arena_destroy(fds->leaf_arena);
+
   /* free the header struct */
   g_free(fds);
 }
 
+static int
+frame_time_entry_cmp(const frame_time_entry *a, const frame_time_entry *b)
+{
+  if (a->secs != b->secs)
+    return a->secs < b->secs ? -1 : 1;
+  if (a->nsecs != b->nsecs)
+    return a->nsecs < b->nsecs ? -1 : 1;
+  if (a->num != b->num)
+    return a->num < b->num ? -1 : 1;
+  return 0;
+}
+
+static int
+frame_time_entry_sort_cmp(const void *a, const void *b)
+{
+  return frame_time_entry_cmp((const frame_time_entry *)a,
+                              (const frame_time_entry *)b);
+}
+
+static int
+frame_num_sort_cmp(const void *a, const void *b)
+{
+  guint32 num_a = *(const guint32 *)a;
+  guint32 num_b = *(const guint32 *)b;
+
+  return num_a < num_b ? -1 : (num_a > num_b ? 1 : 0);
+}
+
+/* Number of bits needed to store a value. */
+static guint
+time_index_width(guint64 value)
+{
+  return value ? ws_ilog2(value) + 1 : 0;
+}
+
+static guint64
+time_index_zigzag(gint64 value)
+{
+  return ((guint64)value << 1) ^ (guint64)(value >> 63);
+}
+
+static gint64
+time_index_unzigzag(guint64 value)
+{
+  return (gint64)(value >> 1) ^ -(gint64)(value & 1);
+}
+
+static void
+time_index_put_bits(frame_data_sequence *fds, guint64 value, guint width)
+{
+  gsize word = (gsize)(fds->time_bits_len >> 6);
+  guint shift = (guint)(fds->time_bits_len & 63);
+
+  if (width == 0)
+    return;
+  fds->time_bits[word] |= value << shift;
+  if (shift + width > 64)
+    fds->time_bits[word + 1] |= value >> (64 - shift);
+  fds->time_bits_len += width;
+}
+
+static guint64
+time_index_get_bits(const frame_data_sequence *fds, guint64 bit_off, guint width)
+{
+  gsize word = (gsize)(bit_off >> 6);
+  guint shift = (guint)(bit_off & 63);
+  guint64 value;
+
+  if (width == 0)
+    return 0;
+  value = fds->time_bits[word] >> shift;
+  if (shift + width > 64)
+    value |= fds->time_bits[word + 1] << (64 - shift);
+  if (width < 64)
+    value &= (G_GUINT64_CONSTANT(1) << width) - 1;
+  return value;
+}
+
+/* Pack the entries in time_tail, which is full, into a new block. */
+static void
+time_index_pack_tail(frame_data_sequence *fds)
+{
+  const frame_time_entry *first = &fds->time_tail[0];
+  time_index_block *block;
+  guint64 max_secs = 0, max_num = 0;
+  guint32 max_nsecs = 0;
+  guint entry_bits;
+  gsize words;
+  guint32 i;
+
+  for (i = 0; i < TIME_INDEX_BLOCK_LEN; i++) {
+    const frame_time_entry *entry = &fds->time_tail[i];
+
+    max_secs = MAX(max_secs, (guint64)entry->secs - (guint64)first->secs);
+    max_nsecs = MAX(max_nsecs, (guint32)entry->nsecs);
+    max_num = MAX(max_num, time_index_zigzag((gint64)entry->num - first->num - i));
+  }
+
+  if (fds->time_blocks_len == fds->time_blocks_size) {
+    fds->time_blocks_size = MAX(64, fds->time_blocks_size * 2);
+    fds->time_blocks = (time_index_block *)g_realloc(fds->time_blocks,
+        fds->time_blocks_size * sizeof *fds->time_blocks);
+  }
+  block = &fds->time_blocks[fds->time_blocks_len++];
+  block->first = *first;
+  block->bit_off = fds->time_bits_len;
+  block->secs_bits = time_index_width(max_secs);
+  block->nsecs_bits = time_index_width(max_nsecs);
+  block->num_bits = time_index_width(max_num);
+
+  /* Make room for the block, and a word more to write past. */
+  entry_bits = block->secs_bits + block->nsecs_bits + block->num_bits;
+  words = (gsize)((fds->time_bits_len + entry_bits * TIME_INDEX_BLOCK_LEN) >> 6) + 2;
+  if (words > fds->time_bits_size) {
+    gsize old_size = fds->time_bits_size;
+
+    fds->time_bits_size = MAX(words, old_size * 2);
+    fds->time_bits = (guint64 *)g_realloc(fds->time_bits,
+        fds->time_bits_size * sizeof *fds->time_bits);
+    memset(fds->time_bits + old_size, 0,
+           (fds->time_bits_size - old_size) * sizeof *fds->time_bits);
+  }
+
+  for (i = 0; i < TIME_INDEX_BLOCK_LEN; i++) {
+    const frame_time_entry *entry = &fds->time_tail[i];
+
+    time_index_put_bits(fds, (guint64)entry->secs - (guint64)first->secs, block->secs_bits);
+    time_index_put_bits(fds, (guint32)entry->nsecs, block->nsecs_bits);
+    time_index_put_bits(fds, time_index_zigzag((gint64)entry->num - first->num - i), block->num_bits);
+  }
+  fds->time_tail_len = 0;
+}
+
+/* Add an entry at the end of the time stamp index. */
+static void
+time_index_append(frame_data_sequence *fds, const frame_time_entry *entry)
+{
+  fds->time_tail[fds->time_tail_len++] = *entry;
+  fds->time_index_len++;
+  if (fds->time_tail_len == TIME_INDEX_BLOCK_LEN)
+    time_index_pack_tail(fds);
+}
+
+/* Get an entry of the time stamp index. */
+static void
+time_index_get(const frame_data_sequence *fds, guint32 idx, frame_time_entry *entry)
+{
+  const time_index_block *block;
+  guint32 i = idx % TIME_INDEX_BLOCK_LEN;
+  guint64 bit_off;
+
+  if (idx / TIME_INDEX_BLOCK_LEN == fds->time_blocks_len) {
+    *entry = fds->time_tail[i];
+    return;
+  }
+
+  block = &fds->time_blocks[idx / TIME_INDEX_BLOCK_LEN];
+  bit_off = block->bit_off +
+      (guint64)i * (block->secs_bits + block->nsecs_bits + block->num_bits);
+  entry->secs = (gint64)((guint64)block->first.secs +
+      time_index_get_bits(fds, bit_off, block->secs_bits));
+  bit_off += block->secs_bits;
+  entry->nsecs = (gint32)(guint32)time_index_get_bits(fds, bit_off, block->nsecs_bits);
+  bit_off += block->nsecs_bits;
+  entry->num = (guint32)(block->first.num + i +
+      time_index_unzigzag(time_index_get_bits(fds, bit_off, block->num_bits)));
+}
+
+/* Free the entries of the time stamp index. */
+static void
+time_index_clear(frame_data_sequence *fds)
+{
+  g_free(fds->time_blocks);
+  fds->time_blocks = NULL;
+  fds->time_blocks_len = 0;
+  fds->time_blocks_size = 0;
+  g_free(fds->time_bits);
+  fds->time_bits = NULL;
+  fds->time_bits_len = 0;
+  fds->time_bits_size = 0;
+  fds->time_tail_len = 0;
+  fds->time_index_len = 0;
+}
+
+/*
+ * Add the frames added since the last lookup to the time stamp index.
+ * Frames are usually added in time stamp order, in which case this just
+ * appends to the index; otherwise the new entries are sorted and merged
+ * with the old ones, and the index is packed again.
+ */
+static void
+time_index_update(frame_data_sequence *fds)
+{
+  gboolean sorted = TRUE;
+  frame_data *fdata;
+  frame_time_entry *added, *entry;
+  guint32 n_added = 0, i;
+
+  if (fds->time_indexed == fds->count)
+    return;
+
+  added = g_new(frame_time_entry, fds->count - fds->time_indexed);
+  for (; fds->time_indexed < fds->count; fds->time_indexed++) {
+    fdata = frame_data_sequence_find(fds, fds->time_indexed + 1);
+    if (!fdata->has_ts) {
+      /* The frames with time stamps aren't contiguous any more. */
+      fds->time_in_order = FALSE;
+      continue;
+    }
+    entry = &added[n_added];
+    entry->secs = (gint64)fdata->abs_ts.secs;
+    entry->nsecs = fdata->abs_ts.nsecs;
+    entry->num = fdata->num;
+    if (n_added > 0 && frame_time_entry_cmp(entry - 1, entry) > 0)
+      sorted = FALSE;
+    n_added++;
+  }
+
+  if (!sorted) {
+    fds->time_in_order = FALSE;
+    qsort(added, n_added, sizeof *added, frame_time_entry_sort_cmp);
+  }
+
+  if (n_added > 0 && fds->time_index_len > 0) {
+    frame_time_entry last;
+
+    time_index_get(fds, fds->time_index_len - 1, &last);
+    if (frame_time_entry_cmp(&last, &added[0]) > 0) {
+      /* Merge the old entries and the new ones. */
+      frame_time_entry *old;
+      guint32 old_len = fds->time_index_len, j = 0;
+
+      fds->time_in_order = FALSE;
+      old = g_new(frame_time_entry, old_len);
+      for (i = 0; i < old_len; i++)
+        time_index_get(fds, i, &old[i]);
+      time_index_clear(fds);
+      i = 0;
+      while (i < old_len && j < n_added) {
+        if (frame_time_entry_cmp(&old[i], &added[j]) <= 0)
+          time_index_append(fds, &old[i++]);
+        else
+          time_index_append(fds, &added[j++]);
+      }
+      while (i < old_len)
+        time_index_append(fds, &old[i++]);
+      while (j < n_added)
+        time_index_append(fds, &added[j++]);
+      g_free(old);
+      g_free(added);
+      return;
+    }
+  }
+
+  for (i = 0; i < n_added; i++)
+    time_index_append(fds, &added[i]);
+  g_free(added);
+}
+
+/* Index of the first entry with a time stamp at or after ts. */
+static guint32
+time_index_lower_bound(frame_data_sequence *fds, const nstime_t *ts)
+{
+  frame_time_entry key, entry;
+  guint32 lo = 0, hi = fds->time_blocks_len, mid;
+
+  key.secs = (gint64)ts->secs;
+  key.nsecs = ts->nsecs;
+  key.num = 0;
+
+  /*
+   * Find the block that has the entry using the first entries of the
+   * blocks, which are stored unpacked, and then look in that block.
+   */
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (frame_time_entry_cmp(&fds->time_blocks[mid].first, &key) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  hi = lo < fds->time_blocks_len ? lo * TIME_INDEX_BLOCK_LEN : fds->time_index_len;
+  lo = lo > 0 ? (lo - 1) * TIME_INDEX_BLOCK_LEN : 0;
+
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    time_index_get(fds, mid, &entry);
+    if (frame_time_entry_cmp(&entry, &key) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+range_t *
+frame_data_sequence_find_time_range(frame_data_sequence *fds,
+    wmem_allocator_t *scope, const nstime_t *start, const nstime_t *end)
+{
+  range_t *range;
+  frame_time_entry entry;
+  guint32 lo, hi, n, i;
+  guint32 *nums;
+
+  if (fds != NULL)
+    time_index_update(fds);
+
+  if (fds == NULL || fds->time_index_len == 0) {
+    lo = hi = 0;
+  } else {
+    lo = start != NULL ? time_index_lower_bound(fds, start) : 0;
+    hi = end != NULL ? time_index_lower_bound(fds, end) : fds->time_index_len;
+  }
+  if (hi < lo)
+    hi = lo;
+  n = hi - lo;
+
+  if (n == 0) {
+    range = (range_t *)wmem_alloc(scope, sizeof (range_t));
+    range->nranges = 0;
+    return range;
+  }
+
+  if (fds->time_in_order) {
+    /* The frames in the window are consecutive. */
+    range = (range_t *)wmem_alloc(scope, sizeof (range_t));
+    range->nranges = 1;
+    time_index_get(fds, lo, &entry);
+    range->ranges[0].low = entry.num;
+    time_index_get(fds, hi - 1, &entry);
+    range->ranges[0].high = entry.num;
+    return range;
+  }
+
+  nums = g_new(guint32, n);
+  for (i = 0; i < n; i++) {
+    time_index_get(fds, lo + i, &entry);
+    nums[i] = entry.num;
+  }
+  qsort(nums, n, sizeof *nums, frame_num_sort_cmp);
+
+  range = (range_t *)wmem_alloc(scope, sizeof (range_t) + (n - 1) * sizeof (range_admin_t));
+  range->nranges = 0;
+  for (i = 0; i < n; i++) {
+    if (range->nranges > 0 &&
+        nums[i] == range->ranges[range->nranges - 1].high + 1) {
+      range->ranges[range->nranges - 1].high = nums[i];
+    } else {
+      range->ranges[range->nranges].low = nums[i];
+      range->ranges[range->nranges].high = nums[i];
+      range->nranges++;
+    }
+  }
+  g_free(nums);
+
+  return range;
+}
+
+void
+frame_data_sequence_times_changed(frame_data_sequence *fds)
+{
+  if (fds == NULL)
+    return;
+
+  time_index_clear(fds);
+  fds->time_indexed = 0;
+  fds->time_in_order = TRUE;
+}
+
 void
 find_and_mark_frame_depended_upon(gpointer key, gpointer value _U_, gpointer user_data)
 {
@@ -325,8 +814,8 @@ find_and_mark_frame_depended_upon(gpointer key, gpointer value _U_, gpointer use
      */
     if (!(dependent_fd->dependent_of_displayed || dependent_fd->passed_dfilter)) {
       dependent_fd->dependent_of_displayed = 1;
-      if (dependent_fd->dependent_frames) {
-        g_hash_table_foreach(dependent_fd->dependent_frames, find_and_mark_frame_depended_upon, frames);
+      if (frame_data_dependent_frames(dependent_fd)) {
+        g_hash_table_foreach(frame_data_dependent_frames(dependent_fd), find_and_mark_frame_depended_upon, frames);
       }
     }
   }
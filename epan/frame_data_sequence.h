@@ -11,6 +11,8 @@
 #ifndef __FRAME_DATA_SEQUENCE_H__
 #define __FRAME_DATA_SEQUENCE_H__
 
+#include <epan/range.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -19,6 +21,17 @@ typedef struct _frame_data_sequence frame_data_sequence;
 
 WS_DLL_PUBLIC frame_data_sequence *new_frame_data_sequence(void);
 
+/*
+ * Keep the frame_data structures in a memory-mapped temporary file in
+ * tempdir (NULL for the default temporary directory) rather than on the
+ * heap, so that the kernel can page them out to it; see
+ * wsutil/mapped_arena.h.  Must be called before any frames are added.
+ * Returns FALSE, and leaves the frames on the heap, if the file can't
+ * be created.
+ */
+WS_DLL_PUBLIC gboolean frame_data_sequence_use_mapped_file(frame_data_sequence *fds,
+    const char *tempdir, GError **err);
+
 WS_DLL_PUBLIC frame_data *frame_data_sequence_add(frame_data_sequence *fds,
     frame_data *fdata);
 
@@ -28,6 +41,24 @@ WS_DLL_PUBLIC frame_data *frame_data_sequence_add(frame_data_sequence *fds,
 WS_DLL_PUBLIC frame_data *frame_data_sequence_find(frame_data_sequence *fds,
     guint32 num);
 
+/*
+ * Find the frames whose time stamps are in [start, end); either bound
+ * can be NULL.  Returns the frame numbers as ranges in increasing order,
+ * allocated in the given scope.
+ *
+ * This uses an index of the frames sorted by time stamp, so it doesn't
+ * have to look at every frame; frames that are out of time stamp order
+ * are handled.
+ */
+WS_DLL_PUBLIC range_t *frame_data_sequence_find_time_range(frame_data_sequence *fds,
+    wmem_allocator_t *scope, const nstime_t *start, const nstime_t *end);
+
+/*
+ * Tell the frame_data_sequence that the time stamps of frames already
+ * in it have changed, e.g. by a time shift.
+ */
+WS_DLL_PUBLIC void frame_data_sequence_times_changed(frame_data_sequence *fds);
+
 /*
  * Free a frame_data_sequence and all the frame_data structures in it.
  */
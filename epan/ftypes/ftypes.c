@@ -273,6 +273,25 @@ ftype_can_contains(enum ftenum ftype)
 	return ft->cmp_contains ? TRUE : FALSE;
 }
 
+gboolean
+ftype_can_contains_any(enum ftenum ftype)
+{
+	switch (ftype) {
+		case FT_BYTES:
+		case FT_UINT_BYTES:
+		case FT_AX25:
+		case FT_VINES:
+		case FT_ETHER:
+		case FT_OID:
+		case FT_REL_OID:
+		case FT_SYSTEM_ID:
+		case FT_FCWWN:
+			return TRUE;
+		default:
+			return IS_FT_STRING(ftype);
+	}
+}
+
 gboolean
 ftype_can_matches(enum ftenum ftype)
 {
@@ -1075,6 +1094,37 @@ fvalue_contains(const fvalue_t *a, const fvalue_t *b)
 	return yes ? FT_TRUE : FT_FALSE;
 }
 
+const guint8 *
+fvalue_get_contains_data(const fvalue_t *fv, size_t *len)
+{
+	gsize size;
+	const guint8 *data;
+
+	ws_assert(ftype_can_contains_any(fv->ftype->ftype));
+
+	if (IS_FT_STRING(fv->ftype->ftype)) {
+		*len = fv->value.strbuf->len;
+		return (const guint8 *)fv->value.strbuf->str;
+	}
+
+	data = (const guint8 *)g_bytes_get_data(fv->value.bytes, &size);
+	*len = size;
+	return data;
+}
+
+ft_bool_t
+fvalue_contains_any(const fvalue_t *a, const ws_memsearch_t *searcher)
+{
+	const guint8 *data;
+	size_t len;
+
+	if (!ftype_can_contains_any(a->ftype->ftype))
+		return -FT_BADARG;
+
+	data = fvalue_get_contains_data(a, &len);
+	return ws_memsearch_exec(searcher, data, len, NULL) ? FT_TRUE : FT_FALSE;
+}
+
 ft_bool_t
 fvalue_matches(const fvalue_t *a, const ws_regex_t *re)
 {
@@ -15,6 +15,7 @@
 #include <wireshark.h>
 
 #include <wsutil/regex.h>
+#include <wsutil/ws_memsearch.h>
 #include <epan/wmem_scopes.h>
 
 #ifdef __cplusplus
@@ -233,6 +234,11 @@ WS_DLL_PUBLIC
 gboolean
 ftype_can_contains(enum ftenum ftype);
 
+/* Returns TRUE if values of this type are plain byte or character
+ * strings that fvalue_contains_any() can search. */
+gboolean
+ftype_can_contains_any(enum ftenum ftype);
+
 WS_DLL_PUBLIC
 gboolean
 ftype_can_matches(enum ftenum ftype);
@@ -469,6 +475,15 @@ fvalue_le(const fvalue_t *a, const fvalue_t *b);
 ft_bool_t
 fvalue_contains(const fvalue_t *a, const fvalue_t *b);
 
+/* TRUE if the value contains any of the searcher's patterns. The value's
+ * type must satisfy ftype_can_contains_any(). */
+ft_bool_t
+fvalue_contains_any(const fvalue_t *a, const ws_memsearch_t *searcher);
+
+/* Returns the bytes searched by fvalue_contains_any(). */
+const guint8 *
+fvalue_get_contains_data(const fvalue_t *fv, size_t *len);
+
 ft_bool_t
 fvalue_matches(const fvalue_t *a, const ws_regex_t *re);
 
@@ -452,10 +452,7 @@ mark_frame_as_depended_upon(frame_data *fd, guint32 frame_num)
 		/* ws_assert(frame_num < fd->num) - we assume in several other
 		 * places in the code that frames don't depend on future
 		 * frames. */
-		if (fd->dependent_frames == NULL) {
-			fd->dependent_frames = g_hash_table_new(g_direct_hash, g_direct_equal);
-		}
-		g_hash_table_insert(fd->dependent_frames, GUINT_TO_POINTER(frame_num), NULL);
+		frame_data_add_dependent_frame(fd, frame_num);
 	}
 }
 
@@ -3768,6 +3768,13 @@ prefs_register_modules(void)
                                    "Currently ICMP and ICMPv6 use this preference to add VLAN ID to conversation tracking, and IPv4 uses this preference to take VLAN ID into account during reassembly",
                                    &prefs.strict_conversation_tracking_heuristics);
 
+    prefs_register_bool_preference(protocols_module, "reassemble_without_copying",
+                                   "Reassemble without copying fragment data",
+                                   "Build reassembled packets out of the received fragments instead of copying "
+                                   "them into a new buffer. This saves memory and time with large reassemblies, "
+                                   "but the data is copied after all if a dissector needs it contiguous.",
+                                   &prefs.reassemble_without_copying);
+
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
      * configuration screen within the preferences dialog
@@ -4184,6 +4191,7 @@ pre_init_prefs(void)
     prefs.st_sort_showfullname = FALSE;
     prefs.display_hidden_proto_items = FALSE;
     prefs.display_byte_fields_with_spaces = FALSE;
+    prefs.reassemble_without_copying = FALSE;
 
     /* set the default values for the io graph dialog */
     prefs.gui_io_graph_automatic_update = TRUE;
@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #include <epan/packet.h>
 #include <epan/epan.h>
@@ -27,7 +28,9 @@
 #include <epan/prefs.h>
 #include <epan/print.h>
 #include <epan/charsets.h>
+#include <wsutil/arrow_writer.h>
 #include <wsutil/json_dumper.h>
+#include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/utf8_entities.h>
 #include <wsutil/str_util.h>
@@ -62,8 +65,28 @@ typedef struct {
     gboolean        print_text;
     proto_node_children_grouper_func node_children_grouper;
     json_dumper    *dumper;
+    wmem_allocator_t *pool;     /* packet scope, for the per-level scratch */
+    ek_output_t    *ek;         /* EK only */
 } write_json_data;
 
+/* The names used for a field in EK output, derived once per field. */
+typedef struct {
+    gchar          *name;       /* member name, prefixed by the parent protocol */
+    gchar          *name_raw;   /* member name of the hex dump */
+    gchar          *abbrev_ek;  /* abbreviation with '.' replaced by '_', or NULL if it has no '.' */
+} ek_field_names;
+
+struct _ek_output {
+    FILE           *fh;         /* the file being written to */
+    gchar          *bulk_prefix; /* NULL if not writing bulk payload files */
+    gsize           bulk_size;
+    guint           bulk_num;   /* number of the current bulk payload file */
+    gsize           bulk_len;   /* bytes written to the current bulk payload file */
+    guint           flags;
+    GString        *doc;        /* index line and document of the current packet */
+    GPtrArray      *field_names; /* ek_field_names *, indexed by field id */
+};
+
 typedef struct {
     output_fields_t *fields;
     epan_dissect_t  *edt;
@@ -77,13 +100,17 @@ struct _output_fields {
     gchar         aggregator;
     GPtrArray    *fields;
     GHashTable   *field_indicies;
-    GPtrArray   **field_values;
+    GArray      **field_values;     /* per field, offsets of its values in value_buf */
+    GString      *value_buf;        /* NUL-separated values of the current packet */
+    header_field_info **field_hfinfos; /* first of the fields with each abbreviation */
+    gboolean      primed;           /* output_fields_prime_edt() is used */
     gchar         quote;
     gboolean      escape;
     gboolean      includes_col_fields;
 };
 
-static gchar *get_field_hex_value(GSList *src_list, field_info *fi);
+static gboolean append_node_field_value(GString *buf, field_info *fi, epan_dissect_t *edt);
+static gboolean append_field_hex_value(GString *buf, GSList *src_list, field_info *fi);
 static void proto_tree_print_node(proto_node *node, gpointer data);
 static void proto_tree_write_node_pdml(proto_node *node, gpointer data);
 static void proto_tree_write_node_ek(proto_node *node, write_json_data *data);
@@ -103,12 +130,12 @@ static void print_escaped_csv(FILE *fh, const char *unescaped_string);
 
 typedef void (*proto_node_value_writer)(proto_node *, write_json_data *);
 static void write_json_index(json_dumper *dumper, epan_dissect_t *edt);
-static void write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *data);
-static void write_json_proto_node(GSList *node_values_head,
+static void write_json_proto_node_group(proto_node **nodes, guint n_nodes, write_json_data *data);
+static void write_json_proto_node(proto_node **nodes, guint n_nodes,
                                   const char *suffix,
                                   proto_node_value_writer value_writer,
                                   write_json_data *data);
-static void write_json_proto_node_value_list(GSList *node_values_head,
+static void write_json_proto_node_value_list(proto_node **nodes, guint n_nodes,
                                              proto_node_value_writer value_writer,
                                              write_json_data *data);
 static void write_json_proto_node_filtered(proto_node *node, write_json_data *data);
@@ -352,25 +379,130 @@ write_pdml_proto_tree(output_fields_t* fields, wmem_map_t *protocolfilter, epan_
     fprintf(fh, "</packet>\n\n");
 }
 
-void
+static void
+ek_field_names_free(gpointer data)
+{
+    ek_field_names *names = (ek_field_names *)data;
+
+    if (names == NULL)
+        return;
+    g_free(names->name);
+    g_free(names->name_raw);
+    g_free(names->abbrev_ek);
+    g_free(names);
+}
+
+static void
+ek_output_free(ek_output_t *ek)
+{
+    g_free(ek->bulk_prefix);
+    g_string_free(ek->doc, TRUE);
+    g_ptr_array_free(ek->field_names, TRUE);
+    g_free(ek);
+}
+
+static gboolean
+ek_open_bulk_file(ek_output_t *ek)
+{
+    gchar *path;
+
+    ek->bulk_num++;
+    ek->bulk_len = 0;
+    path = ws_strdup_printf("%s_%05u.json", ek->bulk_prefix, ek->bulk_num);
+    ek->fh = ws_fopen(path, "wb");
+    g_free(path);
+    return ek->fh != NULL;
+}
+
+static gboolean
+ek_close_bulk_file(ek_output_t *ek)
+{
+    gboolean ok = !ferror(ek->fh);
+
+    if (fclose(ek->fh) == EOF)
+        ok = FALSE;
+    ek->fh = NULL;
+    return ok;
+}
+
+ek_output_t *
+write_ek_preamble(FILE *fh, const char *bulk_prefix, gsize bulk_size, guint flags)
+{
+    ek_output_t *ek = g_new0(ek_output_t, 1);
+
+    ek->flags = flags;
+    ek->doc = g_string_sized_new(4096);
+    ek->field_names = g_ptr_array_new_with_free_func(ek_field_names_free);
+
+    if (bulk_prefix != NULL) {
+        ek->bulk_prefix = g_strdup(bulk_prefix);
+        ek->bulk_size = bulk_size;
+        if (!ek_open_bulk_file(ek)) {
+            int err = errno;
+            ek_output_free(ek);
+            errno = err;
+            return NULL;
+        }
+    } else {
+        ek->fh = fh;
+    }
+    return ek;
+}
+
+gboolean
+write_ek_finale(ek_output_t *ek)
+{
+    gboolean ok = TRUE;
+
+    if (ek->bulk_prefix != NULL && ek->fh != NULL) {
+        ok = ek_close_bulk_file(ek);
+    }
+    ek_output_free(ek);
+    return ok;
+}
+
+/*
+ * Write out the index line and the document of a packet. They are formatted
+ * in memory first, so that a bulk payload file can be ended before a
+ * document that would make it too large.
+ */
+static gboolean
+ek_write_doc(ek_output_t *ek)
+{
+    if (ek->fh == NULL)
+        return FALSE;
+
+    if (ek->bulk_prefix != NULL) {
+        if (ek->bulk_len > 0 && ek->bulk_len + ek->doc->len > ek->bulk_size) {
+            if (!ek_close_bulk_file(ek) || !ek_open_bulk_file(ek))
+                return FALSE;
+        }
+        ek->bulk_len += ek->doc->len;
+    }
+    return fwrite(ek->doc->str, 1, ek->doc->len, ek->fh) == ek->doc->len;
+}
+
+gboolean
 write_ek_proto_tree(output_fields_t* fields,
                     gboolean print_summary, gboolean print_hex,
                     wmem_map_t *protocolfilter,
                     epan_dissect_t *edt,
                     column_info *cinfo,
-                    FILE *fh)
+                    ek_output_t *ek)
 {
     ws_assert(edt);
-    ws_assert(fh);
+    ws_assert(ek);
 
     write_json_data data;
 
+    g_string_truncate(ek->doc, 0);
     json_dumper dumper = {
-        .output_file = fh,
+        .output_string = ek->doc,
         .flags = JSON_DUMPER_DOT_TO_UNDERSCORE
     };
 
     data.dumper = &dumper;
+    data.ek = ek;
 
     json_dumper_begin_object(&dumper);
     json_dumper_set_member_name(&dumper, "index");
@@ -409,6 +541,8 @@ write_ek_proto_tree(output_fields_t* fields,
     }
     json_dumper_end_object(&dumper);
     json_dumper_finish(&dumper);
+
+    return ek_write_doc(ek);
 }
 
 void
@@ -766,6 +900,7 @@ write_json_proto_tree(output_fields_t* fields,
             data.print_text = FALSE;
         }
         data.node_children_grouper = node_children_grouper;
+        data.pool = edt->pi.pool;
 
         write_json_proto_node_children(edt->tree, &data);
     } else {
@@ -774,156 +909,263 @@ write_json_proto_tree(output_fields_t* fields,
 
     json_dumper_end_object(dumper);
     json_dumper_end_object(dumper);
+    /* Write out the packet, the caller may flush the file after it. */
+    json_dumper_flush(dumper);
 }
 
 /**
  * Returns a boolean telling us whether that node list contains any node which has children
  */
 static gboolean
-any_has_children(GSList *node_values_list)
+any_has_children(proto_node **nodes, guint n_nodes)
 {
-    GSList *current_node = node_values_list;
-    while (current_node != NULL) {
-        proto_node *current_value = (proto_node *) current_node->data;
-        if (current_value->first_child != NULL) {
+    for (guint i = 0; i < n_nodes; i++) {
+        if (nodes[i]->first_child != NULL) {
             return TRUE;
         }
-        current_node = current_node->next;
     }
     return FALSE;
 }
 
 /**
- * Write a json object containing a list of key:value pairs where each key:value pair corresponds to a different json
- * key and its associated nodes in the proto_tree.
- * @param proto_node_list_head A 2-dimensional list containing a list of values for each different node json key. The
- * elements themselves are a linked list of values associated with the same json key.
+ * Write the key:value pairs of a json key and its associated nodes in the proto_tree.
+ * @param nodes The nodes associated with the same json key, in tree order.
+ * @param n_nodes The number of nodes.
  * @param pdata json writing metadata
  */
 static void
-write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
+write_json_proto_node_group(proto_node **nodes, guint n_nodes, write_json_data *pdata)
 {
-    GSList *current_node = proto_node_list_head;
-
-    json_dumper_begin_object(pdata->dumper);
+    // Retrieve the json key from the first value.
+    proto_node *first_value = nodes[0];
+    const char *json_key = proto_node_to_json_key(first_value);
+    // Check if the current json key is filtered from the output with the "-j" cli option.
+    pf_flags filter_flags = PF_NONE;
+    gboolean is_filtered = pdata->filter != NULL && !check_protocolfilter(pdata->filter, json_key, &filter_flags);
 
-    // Loop over each list of nodes (differentiated by json key) and write the associated json key:value pair in the
-    // output.
-    while (current_node != NULL) {
-        // Get the list of values for the current json key.
-        GSList *node_values_list = (GSList *) current_node->data;
+    field_info *fi = first_value->finfo;
+    char *value_string_repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_DISPLAY, fi->hfinfo->display);
+    gboolean has_children = any_has_children(nodes, n_nodes);
+
+    // We assume all values of a json key have roughly the same layout. Thus we can use the first value to derive
+    // attributes of all the values.
+    gboolean has_value = value_string_repr != NULL;
+    gboolean is_pseudo_text_field = fi->hfinfo->id == 0;
+
+    // "-x" command line option. A "_raw" suffix is added to the json key so the textual value can be printed
+    // with the original json key. If both hex and text writing are enabled the raw information of fields whose
+    // length is equal to 0 is not written to the output. If the field is a special text pseudo field no raw
+    // information is written either.
+    if (pdata->print_hex && (!pdata->print_text || fi->length > 0) && !is_pseudo_text_field) {
+        write_json_proto_node(nodes, n_nodes, "_raw", write_json_proto_node_hex_dump, pdata);
+    }
+
+    if (pdata->print_text && has_value) {
+        if (n_nodes == 1) {
+            // The common case; the value of the single node is the one we already have.
+            json_dumper_set_member_name(pdata->dumper, json_key);
+            json_dumper_value_string(pdata->dumper, value_string_repr);
+        } else {
+            write_json_proto_node(nodes, n_nodes, "", write_json_proto_node_value, pdata);
+        }
+    }
 
-        // Retrieve the json key from the first value.
-        proto_node *first_value = (proto_node *) node_values_list->data;
-        const char *json_key = proto_node_to_json_key(first_value);
-        // Check if the current json key is filtered from the output with the "-j" cli option.
-        pf_flags filter_flags = PF_NONE;
-        gboolean is_filtered = pdata->filter != NULL && !check_protocolfilter(pdata->filter, json_key, &filter_flags);
+    wmem_free(NULL, value_string_repr); // fvalue_to_string_repr returns allocated buffer
 
-        field_info *fi = first_value->finfo;
-        char *value_string_repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_DISPLAY, fi->hfinfo->display);
-        gboolean has_children = any_has_children(node_values_list);
+    if (has_children) {
+        // If a node has both a value and a set of children we print the value and the children in separate
+        // key:value pairs. These can't have the same key so whenever a value is already printed with the node
+        // json key we print the children with the same key with a "_tree" suffix added.
+        char *suffix = has_value ? "_tree": "";
 
-        // We assume all values of a json key have roughly the same layout. Thus we can use the first value to derive
-        // attributes of all the values.
-        gboolean has_value = value_string_repr != NULL;
-        gboolean is_pseudo_text_field = fi->hfinfo->id == 0;
+        if (is_filtered) {
+            write_json_proto_node(nodes, n_nodes, suffix, write_json_proto_node_filtered, pdata);
+        } else {
+            // Remove protocol filter for children, if children should be included. This functionality is enabled
+            // with the "-J" command line option. We save the filter so it can be reenabled when we are done with
+            // the current key:value pair.
+            wmem_map_t *_filter = NULL;
+            if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
+                _filter = pdata->filter;
+                pdata->filter = NULL;
+            }
 
-        wmem_free(NULL, value_string_repr); // fvalue_to_string_repr returns allocated buffer
+            // has_children is TRUE if any of the nodes have children. So we're not 100% sure whether this
+            // particular node has children or not => use the 'dynamic' version of 'write_json_proto_node'
+            write_json_proto_node(nodes, n_nodes, suffix, write_json_proto_node_dynamic, pdata);
 
-        // "-x" command line option. A "_raw" suffix is added to the json key so the textual value can be printed
-        // with the original json key. If both hex and text writing are enabled the raw information of fields whose
-        // length is equal to 0 is not written to the output. If the field is a special text pseudo field no raw
-        // information is written either.
-        if (pdata->print_hex && (!pdata->print_text || fi->length > 0) && !is_pseudo_text_field) {
-            write_json_proto_node(node_values_list, "_raw", write_json_proto_node_hex_dump, pdata);
+            // Put protocol filter back
+            if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
+                pdata->filter = _filter;
+            }
         }
+    }
 
-        if (pdata->print_text && has_value) {
-            write_json_proto_node(node_values_list, "", write_json_proto_node_value, pdata);
-        }
+    if (!has_value && !has_children && (pdata->print_text || (pdata->print_hex && is_pseudo_text_field))) {
+        write_json_proto_node(nodes, n_nodes, "", write_json_proto_node_no_value, pdata);
+    }
+}
+
+/*
+ * With the children grouped by json key, a level is written in two
+ * passes over the children using scratch memory from the packet scope:
+ * the first pass assigns each child to the group of its json key, in
+ * the order the keys are first seen, and the second pass lays out the
+ * nodes of each group contiguously, so that every group can be written
+ * with write_json_proto_node_group(). The scratch of a level is freed
+ * before returning, so mostly only the levels currently being written
+ * use memory.
+ *
+ * Most levels have only a few children, for which a linear search of
+ * the keys seen so far is cheapest; a map is only used for wide levels.
+ */
+#define JSON_KEY_GROUP_LINEAR_MAX   16
 
-        if (has_children) {
-            // If a node has both a value and a set of children we print the value and the children in separate
-            // key:value pairs. These can't have the same key so whenever a value is already printed with the node
-            // json key we print the children with the same key with a "_tree" suffix added.
-            char *suffix = has_value ? "_tree": "";
+typedef struct {
+    const char *json_key;
+    guint       n_nodes;
+    guint       offset;     /* of the group's nodes in the node array */
+} json_key_group;
 
-            if (is_filtered) {
-                write_json_proto_node(node_values_list, suffix, write_json_proto_node_filtered, pdata);
-            } else {
-                // Remove protocol filter for children, if children should be included. This functionality is enabled
-                // with the "-J" command line option. We save the filter so it can be reenabled when we are done with
-                // the current key:value pair.
-                wmem_map_t *_filter = NULL;
-                if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
-                    _filter = pdata->filter;
-                    pdata->filter = NULL;
-                }
+static void
+write_json_proto_node_children_by_json_key(proto_node *node, write_json_data *pdata)
+{
+    proto_node *child;
+    json_key_group *groups;
+    guint *child_group;
+    proto_node **nodes;
+    wmem_map_t *group_by_key = NULL;
+    guint n_children = 0, n_groups = 0, i, g;
+
+    for (child = node->first_child; child != NULL; child = child->next) {
+        n_children++;
+    }
+    if (n_children == 0) {
+        return;
+    }
 
-                // has_children is TRUE if any of the nodes have children. So we're not 100% sure whether this
-                // particular node has children or not => use the 'dynamic' version of 'write_json_proto_node'
-                write_json_proto_node(node_values_list, suffix, write_json_proto_node_dynamic, pdata);
+    groups = wmem_alloc_array(pdata->pool, json_key_group, n_children);
+    child_group = wmem_alloc_array(pdata->pool, guint, n_children);
+    if (n_children > JSON_KEY_GROUP_LINEAR_MAX) {
+        group_by_key = wmem_map_new(pdata->pool, g_str_hash, g_str_equal);
+    }
 
-                // Put protocol filter back
-                if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
-                    pdata->filter = _filter;
+    for (child = node->first_child, i = 0; child != NULL; child = child->next, i++) {
+        const char *json_key = proto_node_to_json_key(child);
+
+        if (group_by_key != NULL) {
+            void *value;
+            if (wmem_map_lookup_extended(group_by_key, json_key, NULL, &value)) {
+                g = GPOINTER_TO_UINT(value);
+            } else {
+                g = n_groups;
+                wmem_map_insert(group_by_key, json_key, GUINT_TO_POINTER(g));
+            }
+        } else {
+            for (g = 0; g < n_groups; g++) {
+                if (groups[g].json_key == json_key || strcmp(groups[g].json_key, json_key) == 0) {
+                    break;
                 }
             }
         }
-
-        if (!has_value && !has_children && (pdata->print_text || (pdata->print_hex && is_pseudo_text_field))) {
-            write_json_proto_node(node_values_list, "", write_json_proto_node_no_value, pdata);
+        if (g == n_groups) {
+            groups[n_groups].json_key = json_key;
+            groups[n_groups].n_nodes = 0;
+            n_groups++;
         }
+        groups[g].n_nodes++;
+        child_group[i] = g;
+    }
 
-        current_node = current_node->next;
+    nodes = wmem_alloc_array(pdata->pool, proto_node *, n_children);
+    for (g = 0, i = 0; g < n_groups; g++) {
+        groups[g].offset = i;
+        i += groups[g].n_nodes;
+        groups[g].n_nodes = 0;
     }
-    json_dumper_end_object(pdata->dumper);
+    for (child = node->first_child, i = 0; child != NULL; child = child->next, i++) {
+        json_key_group *group = &groups[child_group[i]];
+        nodes[group->offset + group->n_nodes++] = child;
+    }
+
+    for (g = 0; g < n_groups; g++) {
+        write_json_proto_node_group(&nodes[groups[g].offset], groups[g].n_nodes, pdata);
+    }
+
+    /* A map, if any, is freed with the packet scope. */
+    wmem_free(pdata->pool, nodes);
+    wmem_free(pdata->pool, child_group);
+    wmem_free(pdata->pool, groups);
+}
+
+/**
+ * Writes the groups of nodes returned by a custom proto_node_children_grouper_func.
+ */
+static void
+write_json_proto_node_children_grouped(proto_node *node, write_json_data *pdata)
+{
+    GSList *grouped_children_list = pdata->node_children_grouper(node);
+
+    for (GSList *current_node = grouped_children_list; current_node != NULL; current_node = current_node->next) {
+        GSList *node_values_list = (GSList *) current_node->data;
+        guint n_nodes = g_slist_length(node_values_list);
+        proto_node **nodes = wmem_alloc_array(pdata->pool, proto_node *, n_nodes);
+        guint i = 0;
+
+        for (GSList *current_value = node_values_list; current_value != NULL; current_value = current_value->next) {
+            nodes[i++] = (proto_node *) current_value->data;
+        }
+        write_json_proto_node_group(nodes, n_nodes, pdata);
+        wmem_free(pdata->pool, nodes);
+    }
+    g_slist_free_full(grouped_children_list, (GDestroyNotify) g_slist_free);
 }
 
 /**
  * Writes a single node as a key:value pair. The value_writer param can be used to specify how the node's value should
  * be written.
- * @param node_values_head Linked list containing all nodes associated with the same json key in this object.
+ * @param nodes All nodes associated with the same json key in this object.
+ * @param n_nodes The number of nodes.
  * @param suffix Suffix that should be added to the json key.
  * @param value_writer A function which writes the actual values of the node json key.
  * @param pdata json writing metadata
  */
 static void
-write_json_proto_node(GSList *node_values_head,
+write_json_proto_node(proto_node **nodes, guint n_nodes,
                       const char *suffix,
                       proto_node_value_writer value_writer,
                       write_json_data *pdata)
 {
     // Retrieve json key from first value.
-    proto_node *first_value = (proto_node *) node_values_head->data;
-    const char *json_key = proto_node_to_json_key(first_value);
-    gchar* json_key_suffix = ws_strdup_printf("%s%s", json_key, suffix);
-    json_dumper_set_member_name(pdata->dumper, json_key_suffix);
-    g_free(json_key_suffix);
-    write_json_proto_node_value_list(node_values_head, value_writer, pdata);
+    const char *json_key = proto_node_to_json_key(nodes[0]);
+    if (*suffix == '\0') {
+        json_dumper_set_member_name(pdata->dumper, json_key);
+    } else {
+        gchar* json_key_suffix = wmem_strconcat(pdata->pool, json_key, suffix, NULL);
+        json_dumper_set_member_name(pdata->dumper, json_key_suffix);
+        wmem_free(pdata->pool, json_key_suffix);
+    }
+    write_json_proto_node_value_list(nodes, n_nodes, value_writer, pdata);
 }
 
 /**
  * Writes a list of values of a single json key. If multiple values are passed they are wrapped in a json array.
- * @param node_values_head Linked list containing all values that should be written.
+ * @param nodes All values that should be written.
+ * @param n_nodes The number of values.
  * @param value_writer Function which writes the separate values.
  * @param pdata json writing metadata
  */
 static void
-write_json_proto_node_value_list(GSList *node_values_head, proto_node_value_writer value_writer, write_json_data *pdata)
+write_json_proto_node_value_list(proto_node **nodes, guint n_nodes, proto_node_value_writer value_writer, write_json_data *pdata)
 {
-    GSList *current_value = node_values_head;
-
     // Write directly if only a single value is passed. Wrap in json array otherwise.
-    if (current_value->next == NULL) {
-        value_writer((proto_node *) current_value->data, pdata);
+    if (n_nodes == 1) {
+        value_writer(nodes[0], pdata);
     } else {
         json_dumper_begin_array(pdata->dumper);
 
-        while (current_value != NULL) {
-            value_writer((proto_node *) current_value->data, pdata);
-            current_value = current_value->next;
+        for (guint i = 0; i < n_nodes; i++) {
+            value_writer(nodes[i], pdata);
         }
         json_dumper_end_array(pdata->dumper);
     }
@@ -1013,15 +1255,28 @@ write_json_proto_node_dynamic(proto_node *node, write_json_data *data)
 }
 
 /**
- * Writes the children of a node. Calls write_json_proto_node_list internally which recursively writes children of nodes
- * to the output.
+ * Writes the children of a node as a json object. Calls write_json_proto_node_group internally which recursively
+ * writes children of nodes to the output.
+ *
+ * The children are written while walking the tree. Only when they are grouped by json key, a small scratch structure
+ * is built for each level; the built-in groupers are not called, they only select the way the children are grouped.
  */
 static void
 write_json_proto_node_children(proto_node *node, write_json_data *data)
 {
-    GSList *grouped_children_list = data->node_children_grouper(node);
-    write_json_proto_node_list(grouped_children_list, data);
-    g_slist_free_full(grouped_children_list, (GDestroyNotify) g_slist_free);
+    json_dumper_begin_object(data->dumper);
+
+    if (data->node_children_grouper == proto_node_group_children_by_unique) {
+        for (proto_node *child = node->first_child; child != NULL; child = child->next) {
+            write_json_proto_node_group(&child, 1, data);
+        }
+    } else if (data->node_children_grouper == proto_node_group_children_by_json_key) {
+        write_json_proto_node_children_by_json_key(node, data);
+    } else {
+        write_json_proto_node_children_grouped(node, data);
+    }
+
+    json_dumper_end_object(data->dumper);
 }
 
 /**
@@ -1151,32 +1406,52 @@ proto_node_to_json_key(proto_node *node)
     return json_key;
 }
 
+/*
+ * Returns the names used for a field, which are derived on the first use
+ * of the field and then kept for the rest of the output.
+ */
+static const ek_field_names *
+ek_get_field_names(ek_output_t *ek, header_field_info *hfinfo)
+{
+    ek_field_names *names;
+
+    if ((guint)hfinfo->id >= ek->field_names->len) {
+        g_ptr_array_set_size(ek->field_names, hfinfo->id + 1);
+    }
+    names = (ek_field_names *)g_ptr_array_index(ek->field_names, hfinfo->id);
+    if (names == NULL) {
+        names = g_new(ek_field_names, 1);
+        if (hfinfo->parent != -1) {
+            header_field_info* parent = proto_registrar_get_nth(hfinfo->parent);
+            names->name = ws_strdup_printf("%s_%s", parent->abbrev, hfinfo->abbrev);
+        } else {
+            names->name = g_strdup(hfinfo->abbrev);
+        }
+        names->name_raw = g_strconcat(names->name, "_raw", NULL);
+        if (strchr(hfinfo->abbrev, '.') != NULL) {
+            names->abbrev_ek = g_strdelimit(g_strdup(hfinfo->abbrev), ".", '_');
+        } else {
+            names->abbrev_ek = NULL;
+        }
+        g_ptr_array_index(ek->field_names, hfinfo->id) = names;
+    }
+    return names;
+}
+
 static gboolean
-ek_check_protocolfilter(wmem_map_t *protocolfilter, const char *str, pf_flags *filter_flags)
+ek_check_protocolfilter(write_json_data *pdata, header_field_info *hfinfo, pf_flags *filter_flags)
 {
-    gchar *str_escaped = NULL;
-    gboolean check;
-    int i;
+    const ek_field_names *names;
 
-    if (check_protocolfilter(protocolfilter, str, filter_flags))
+    if (check_protocolfilter(pdata->filter, hfinfo->abbrev, filter_flags))
         return TRUE;
 
     /* to to thread the '.' and '_' equally. The '.' is replace by print_escaped_ek for '_' */
-    if (str != NULL && strlen(str) > 0) {
-        str_escaped = g_strdup(str);
-
-        i = 0;
-        while (str_escaped[i] != '\0') {
-            if (str_escaped[i] == '.') {
-                str_escaped[i] = '_';
-            }
-            i++;
-        }
-    }
+    names = ek_get_field_names(pdata->ek, hfinfo);
+    if (names->abbrev_ek == NULL)
+        return FALSE;
 
-    check = check_protocolfilter(protocolfilter, str_escaped, filter_flags);
-    g_free(str_escaped);
-    return check;
+    return check_protocolfilter(pdata->filter, names->abbrev_ek, filter_flags);
 }
 
 /**
@@ -1190,7 +1465,9 @@ write_ek_summary(column_info *cinfo, write_json_data* pdata)
     for (i = 0; i < cinfo->num_cols; i++) {
         if (!get_column_visible(i))
             continue;
-        json_dumper_set_member_name(pdata->dumper, g_ascii_strdown(cinfo->columns[i].col_title, -1));
+        gchar *name = g_ascii_strdown(cinfo->columns[i].col_title, -1);
+        json_dumper_set_member_name(pdata->dumper, name);
+        g_free(name);
         json_dumper_value_string(pdata->dumper, get_column_text(cinfo, i));
     }
 }
@@ -1209,16 +1486,24 @@ ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
         /* dissection with an invisible proto tree? */
         ws_assert(fi);
 
+        if ((pdata->ek->flags & EK_OUTPUT_OMIT_FILTERED) && pdata->filter != NULL
+                && !ek_check_protocolfilter(pdata, fi->hfinfo, NULL)) {
+            // Neither the node nor its subtree is written
+            current_node = current_node->next;
+            continue;
+        }
+
         attr_instances = (GSList *) g_hash_table_lookup(attr_table, fi->hfinfo->abbrev);
         attr_instances = g_slist_append(attr_instances, current_node);
-        // Update instance list for this attr in hash table
-        g_hash_table_insert(attr_table, g_strdup(fi->hfinfo->abbrev), attr_instances);
+        // Update instance list for this attr in hash table. The abbreviation
+        // outlives the table, so it doesn't have to be copied.
+        g_hash_table_insert(attr_table, (gpointer)fi->hfinfo->abbrev, attr_instances);
 
         /* Field, recurse through children*/
         if (fi->hfinfo->type != FT_PROTOCOL && current_node->first_child != NULL) {
             if (pdata->filter != NULL) {
                 pf_flags filter_flags = PF_NONE;
-                if (ek_check_protocolfilter(pdata->filter, fi->hfinfo->abbrev, &filter_flags)) {
+                if (ek_check_protocolfilter(pdata, fi->hfinfo, &filter_flags)) {
                     wmem_map_t *_filter = NULL;
                     /* Remove protocol filter for children, if children should be included */
                     if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
@@ -1247,20 +1532,12 @@ ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
 }
 
 static void
-ek_write_name(proto_node *pnode, gchar* suffix, write_json_data* pdata)
+ek_write_name(proto_node *pnode, gboolean raw, write_json_data* pdata)
 {
     field_info *fi = PNODE_FINFO(pnode);
-    gchar      *str;
+    const ek_field_names *names = ek_get_field_names(pdata->ek, fi->hfinfo);
 
-    if (fi->hfinfo->parent != -1) {
-        header_field_info* parent = proto_registrar_get_nth(fi->hfinfo->parent);
-        str = ws_strdup_printf("%s_%s%s", parent->abbrev, fi->hfinfo->abbrev, suffix ? suffix : "");
-        json_dumper_set_member_name(pdata->dumper, str);
-    } else {
-        str = ws_strdup_printf("%s%s", fi->hfinfo->abbrev, suffix ? suffix : "");
-        json_dumper_set_member_name(pdata->dumper, str);
-    }
-    g_free(str);
+    json_dumper_set_member_name(pdata->dumper, raw ? names->name_raw : names->name);
 }
 
 static void
@@ -1390,11 +1667,12 @@ ek_write_attr_hex(GSList *attr_instances, write_json_data *pdata)
     GSList *current_node = attr_instances;
     proto_node *pnode    = (proto_node *) current_node->data;
     field_info *fi       = NULL;
+    gboolean multiple    = attr_instances->next != NULL;
 
     // Raw name
-    ek_write_name(pnode, "_raw", pdata);
+    ek_write_name(pnode, TRUE, pdata);
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (multiple) {
         json_dumper_begin_array(pdata->dumper);
     }
 
@@ -1408,7 +1686,7 @@ ek_write_attr_hex(GSList *attr_instances, write_json_data *pdata)
         current_node = current_node->next;
     }
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (multiple) {
         json_dumper_end_array(pdata->dumper);
     }
 }
@@ -1420,6 +1698,7 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
     proto_node *pnode     = (proto_node *) current_node->data;
     field_info *fi        = PNODE_FINFO(pnode);
     pf_flags filter_flags = PF_NONE;
+    gboolean multiple     = attr_instances->next != NULL;
 
     // Hex dump -x
     if (pdata->print_hex && fi && fi->length > 0 && fi->hfinfo->id != hf_text_only) {
@@ -1427,9 +1706,9 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
     }
 
     // Print attr name
-    ek_write_name(pnode, NULL, pdata);
+    ek_write_name(pnode, FALSE, pdata);
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (multiple) {
         json_dumper_begin_array(pdata->dumper);
     }
 
@@ -1440,7 +1719,7 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
         /* Field */
         if (fi->hfinfo->type != FT_PROTOCOL) {
             if (pdata->filter != NULL
-                && !ek_check_protocolfilter(pdata->filter, fi->hfinfo->abbrev, &filter_flags)) {
+                && !ek_check_protocolfilter(pdata, fi->hfinfo, &filter_flags)) {
 
                 /* print dummy field */
                 json_dumper_begin_object(pdata->dumper);
@@ -1455,7 +1734,7 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
             json_dumper_begin_object(pdata->dumper);
 
             if (pdata->filter != NULL) {
-                if (ek_check_protocolfilter(pdata->filter, fi->hfinfo->abbrev, &filter_flags)) {
+                if (ek_check_protocolfilter(pdata, fi->hfinfo, &filter_flags)) {
                     wmem_map_t *_filter = NULL;
                     /* Remove protocol filter for children, if children should be included */
                     if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
@@ -1484,7 +1763,7 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
         current_node = current_node->next;
     }
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (multiple) {
         json_dumper_end_array(pdata->dumper);
     }
 }
@@ -1499,7 +1778,7 @@ void process_ek_attrs(gpointer key _U_, gpointer value, gpointer pdata)
 static void
 proto_tree_write_node_ek(proto_node *node, write_json_data *pdata)
 {
-    GHashTable *attr_table  = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GHashTable *attr_table  = g_hash_table_new(g_str_hash, g_str_equal);
     GHashTableIter iter;
     gpointer key, value;
     ek_fill_attr(node, attr_table, pdata);
@@ -2074,9 +2353,18 @@ void output_fields_free(output_fields_t* fields)
         }
 
         if (NULL != fields->field_values) {
+            for (i = 0; i < fields->fields->len; ++i) {
+                g_array_free(fields->field_values[i], TRUE);
+            }
             g_free(fields->field_values);
         }
 
+        if (NULL != fields->value_buf) {
+            g_string_free(fields->value_buf, TRUE);
+        }
+
+        g_free(fields->field_hfinfos);
+
         for (i = 0; i < fields->fields->len; ++i) {
             gchar* field = (gchar *)g_ptr_array_index(fields->fields,i);
             g_free(field);
@@ -2312,50 +2600,112 @@ void write_fields_preamble(output_fields_t* fields, FILE *fh)
     fputc('\n', fh);
 }
 
-static void format_field_values(output_fields_t* fields, gpointer field_index, gchar* value)
+/*
+ * Prepare the lookup tables and the value buffers the first time fields are
+ * written or primed for a file.
+ */
+static void output_fields_prepare(output_fields_t *fields)
 {
-    guint      indx;
-    GPtrArray* fv_p;
+    gsize i;
 
-    if (NULL == value)
+    if (NULL != fields->field_indicies) {
         return;
+    }
 
-    /* Unwrap change made to disambiguiate zero / null */
-    indx = GPOINTER_TO_UINT(field_index) - 1;
+    /* Prepare a lookup table from string abbreviation for field to its index. */
+    fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
 
-    if (fields->field_values[indx] == NULL) {
-        fields->field_values[indx] = g_ptr_array_new_with_free_func(g_free);
+    i = 0;
+    while (i < fields->fields->len) {
+        gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
+        /* Store field indicies +1 so that zero is not a valid value,
+         * and can be distinguished from NULL as a pointer.
+         */
+        ++i;
+        g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
     }
 
-    /* Essentially: fieldvalues[indx] is a 'GPtrArray *' with each array entry */
-    /*  pointing to a string which is (part of) the final output string.       */
+    /* The values of a packet are appended to value_buf, and field_values
+     * holds the offsets of the values of each field. Both are reused for
+     * every packet and freed in output_fields_free(). */
+    fields->field_values = g_new(GArray*, fields->fields->len);
+    for (i = 0; i < fields->fields->len; ++i) {
+        fields->field_values[i] = g_array_new(FALSE, FALSE, sizeof(gsize));
+    }
+    fields->value_buf = g_string_sized_new(1024);
 
-    fv_p = fields->field_values[indx];
+    /* Look up the registered fields for output_fields_prime_edt(). If a
+     * field is given more than once only the last one gets its values, as
+     * with the lookup table. */
+    fields->field_hfinfos = g_new0(header_field_info*, fields->fields->len);
+    for (i = 0; i < fields->fields->len; ++i) {
+        gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
+        header_field_info *hfinfo;
 
-    switch (fields->occurrence) {
-    case 'f':
-        /* print the value of only the first occurrence of the field */
-        if (g_ptr_array_len(fv_p) != 0) {
-            /*
-             * This isn't the first occurrence, so the value won't be used;
-             * free it.
-             */
-            g_free(value);
+        if (GPOINTER_TO_UINT(g_hash_table_lookup(fields->field_indicies, field)) != i + 1) {
+            continue;
+        }
+        hfinfo = proto_registrar_get_byname(field);
+        if (hfinfo == NULL || strcmp(hfinfo->abbrev, field) != 0) {
+            continue;
+        }
+        while (hfinfo->same_name_prev_id != -1) {
+            hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+        }
+        fields->field_hfinfos[i] = hfinfo;
+    }
+}
+
+void output_fields_prime_edt(output_fields_t *fields, epan_dissect_t *edt)
+{
+    header_field_info *hfinfo;
+    gsize i;
+
+    ws_assert(fields);
+    ws_assert(fields->fields);
+
+    output_fields_prepare(fields);
+
+    for (i = 0; i < fields->fields->len; ++i) {
+        for (hfinfo = fields->field_hfinfos[i]; hfinfo; hfinfo = hfinfo->same_name_next) {
+            epan_dissect_prime_with_hfid(edt, hfinfo->id);
+        }
+    }
+    fields->primed = TRUE;
+}
+
+/*
+ * Add a value, either of a field or a column text, to the field with the
+ * given index.
+ */
+static void add_field_value(output_fields_t* fields, guint indx, field_info *fi, epan_dissect_t *edt, const gchar *text)
+{
+    GArray *fv_p = fields->field_values[indx];
+    gsize   offset = fields->value_buf->len;
+
+    /* print the value of only the first occurrence of the field */
+    if (fields->occurrence == 'f' && fv_p->len != 0) {
+        return;
+    }
+
+    if (fi != NULL) {
+        if (!append_node_field_value(fields->value_buf, fi, edt)) {
             return;
         }
+    } else if (text != NULL) {
+        g_string_append(fields->value_buf, text);
+    } else {
+        return;
+    }
+    g_string_append_c(fields->value_buf, '\0');
+
+    switch (fields->occurrence) {
+    case 'f':
         break;
     case 'l':
-        /* print the value of only the last occurrence of the field */
-        if (g_ptr_array_len(fv_p) != 0) {
-            /*
-             * This isn't the first occurrence, so there's already a
-             * value in the array, which won't be used; remove the
-             * first (only) element in the array (which will free it,
-             * as we created the GPtrArray with a free func) -
-             * this value will replace it.
-             */
-            g_ptr_array_set_size(fv_p, 0);
-        }
+        /* print the value of only the last occurrence of the field;
+         * it replaces the value of any previous occurrence. */
+        g_array_set_size(fv_p, 0);
         break;
     case 'a':
         /* print the value of all accurrences of the field */
@@ -2365,7 +2715,7 @@ static void format_field_values(output_fields_t* fields, gpointer field_index, g
         break;
     }
 
-    g_ptr_array_add(fv_p, (gpointer)value);
+    g_array_append_val(fv_p, offset);
 }
 
 static void proto_tree_get_node_field_values(proto_node *node, gpointer data)
@@ -2382,9 +2732,8 @@ static void proto_tree_get_node_field_values(proto_node *node, gpointer data)
 
     field_index = g_hash_table_lookup(call_data->fields->field_indicies, fi->hfinfo->abbrev);
     if (NULL != field_index) {
-        format_field_values(call_data->fields, field_index,
-                            get_node_field_value(fi, call_data->edt) /* g_ alloc'd string */
-            );
+        /* Unwrap change made to disambiguiate zero / null */
+        add_field_value(call_data->fields, GPOINTER_TO_UINT(field_index) - 1, fi, call_data->edt, NULL);
     }
 
     /* Recurse here. */
@@ -2416,32 +2765,30 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
     data.fields = fields;
     data.edt = edt;
 
-    if (NULL == fields->field_indicies) {
-        /* Prepare a lookup table from string abbreviation for field to its index. */
-        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
+    output_fields_prepare(fields);
 
-        i = 0;
-        while (i < fields->fields->len) {
-            gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
-            /* Store field indicies +1 so that zero is not a valid value,
-             * and can be distinguished from NULL as a pointer.
-             */
-            ++i;
-            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
-        }
-    }
+    if (fields->primed) {
+        /* The tree was primed with the fields, so their items can be
+         * fetched directly instead of walking the whole tree. */
+        for (i = 0; i < fields->fields->len; ++i) {
+            header_field_info *hfinfo;
 
-    /* Array buffer to store values for this packet              */
-    /*  Allocate an array for the 'GPtrarray *' the first time   */
-    /*   ths function is invoked for a file;                     */
-    /*  Any and all 'GPtrArray *' are freed (after use) each     */
-    /*   time (each packet) this function is invoked for a flle. */
-    /* XXX: ToDo: use packet-scope'd memory & (if/when implemented) wmem ptr_array */
-    if (NULL == fields->field_values)
-        fields->field_values = g_new0(GPtrArray*, fields->fields->len);  /* free'd in output_fields_free() */
+            for (hfinfo = fields->field_hfinfos[i]; hfinfo; hfinfo = hfinfo->same_name_next) {
+                GPtrArray *finfos = proto_get_finfo_ptr_array(edt->tree, hfinfo->id);
+                guint j;
 
-    proto_tree_children_foreach(edt->tree, proto_tree_get_node_field_values,
-                                &data);
+                if (finfos == NULL) {
+                    continue;
+                }
+                for (j = 0; j < finfos->len; j++) {
+                    add_field_value(fields, (guint)i, (field_info *)g_ptr_array_index(finfos, j), edt, NULL);
+                }
+            }
+        }
+    } else {
+        proto_tree_children_foreach(edt->tree, proto_tree_get_node_field_values,
+                                    &data);
+    }
 
     /* Add columns to fields */
     if (fields->includes_col_fields) {
@@ -2454,7 +2801,7 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
             g_free(col_name);
 
             if (NULL != field_index) {
-                format_field_values(fields, field_index, g_strdup(get_column_text(cinfo, col)));
+                add_field_value(fields, GPOINTER_TO_UINT(field_index) - 1, NULL, edt, get_column_text(cinfo, col));
             }
         }
     }
@@ -2465,9 +2812,9 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
             if (0 != i) {
                 fputc(fields->separator, fh);
             }
-            if (NULL != fields->field_values[i]) {
-                GPtrArray *fv_p;
-                gchar * str;
+            if (0 != fields->field_values[i]->len) {
+                GArray *fv_p;
+                const gchar *str;
                 gsize j;
                 fv_p = fields->field_values[i];
                 if (fields->quote != '\0') {
@@ -2475,11 +2822,11 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
                 }
 
                 /* Output the array of (partial) field values */
-                for (j = 0; j < g_ptr_array_len(fv_p); j++ ) {
+                for (j = 0; j < fv_p->len; j++ ) {
                     if (j != 0) {
                         fputc(fields->aggregator, fh);
                     }
-                    str = (gchar *)g_ptr_array_index(fv_p, j);
+                    str = fields->value_buf->str + g_array_index(fv_p, gsize, j);
                     if (fields->escape) {
                         print_escaped_csv(fh, str);
                     } else {
@@ -2489,8 +2836,7 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
                 if (fields->quote != '\0') {
                     fputc(fields->quote, fh);
                 }
-                g_ptr_array_free(fv_p, TRUE);  /* get ready for the next packet */
-                fields->field_values[i] = NULL;
+                g_array_set_size(fv_p, 0);  /* get ready for the next packet */
             }
         }
         break;
@@ -2498,23 +2844,22 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
         for(i = 0; i < fields->fields->len; ++i) {
             gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
 
-            if (NULL != fields->field_values[i]) {
-                GPtrArray *fv_p;
-                gchar * str;
+            if (0 != fields->field_values[i]->len) {
+                GArray *fv_p;
+                const gchar *str;
                 gsize j;
                 fv_p = fields->field_values[i];
 
                 /* Output the array of (partial) field values */
-                for (j = 0; j < (g_ptr_array_len(fv_p)); j++ ) {
-                    str = (gchar *)g_ptr_array_index(fv_p, j);
+                for (j = 0; j < (fv_p->len); j++ ) {
+                    str = fields->value_buf->str + g_array_index(fv_p, gsize, j);
 
                     fprintf(fh, "  <field name=\"%s\" value=", field);
                     fputs("\"", fh);
                     print_escaped_xml(fh, str);
                     fputs("\"/>\n", fh);
                 }
-                g_ptr_array_free(fv_p, TRUE);  /* get ready for the next packet */
-                fields->field_values[i] = NULL;
+                g_array_set_size(fv_p, 0);  /* get ready for the next packet */
             }
         }
         break;
@@ -2523,9 +2868,9 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
         for(i = 0; i < fields->fields->len; ++i) {
             gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
 
-            if (NULL != fields->field_values[i]) {
-                GPtrArray *fv_p;
-                gchar * str;
+            if (0 != fields->field_values[i]->len) {
+                GArray *fv_p;
+                const gchar *str;
                 gsize j;
                 fv_p = fields->field_values[i];
 
@@ -2533,15 +2878,14 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
                 json_dumper_begin_array(dumper);
 
                 /* Output the array of (partial) field values */
-                for (j = 0; j < (g_ptr_array_len(fv_p)); j++ ) {
-                    str = (gchar *) g_ptr_array_index(fv_p, j);
+                for (j = 0; j < (fv_p->len); j++ ) {
+                    str = fields->value_buf->str + g_array_index(fv_p, gsize, j);
                     json_dumper_value_string(dumper, str);
                 }
 
                 json_dumper_end_array(dumper);
 
-                g_ptr_array_free(fv_p, TRUE);  /* get ready for the next packet */
-                fields->field_values[i] = NULL;
+                g_array_set_size(fv_p, 0);  /* get ready for the next packet */
             }
         }
         json_dumper_end_object(dumper);
@@ -2550,9 +2894,9 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
         for(i = 0; i < fields->fields->len; ++i) {
             gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
 
-            if (NULL != fields->field_values[i]) {
-                GPtrArray *fv_p;
-                gchar * str;
+            if (0 != fields->field_values[i]->len) {
+                GArray *fv_p;
+                const gchar *str;
                 gsize j;
                 fv_p = fields->field_values[i];
 
@@ -2560,15 +2904,14 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
                 json_dumper_begin_array(dumper);
 
                 /* Output the array of (partial) field values */
-                for (j = 0; j < (g_ptr_array_len(fv_p)); j++ ) {
-                    str = (gchar *)g_ptr_array_index(fv_p, j);
+                for (j = 0; j < (fv_p->len); j++ ) {
+                    str = fields->value_buf->str + g_array_index(fv_p, gsize, j);
                     json_dumper_value_string(dumper, str);
                 }
 
                 json_dumper_end_array(dumper);
 
-                g_ptr_array_free(fv_p, TRUE);  /* get ready for the next packet */
-                fields->field_values[i] = NULL;
+                g_array_set_size(fv_p, 0);  /* get ready for the next packet */
             }
         }
         break;
@@ -2578,6 +2921,8 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
         ws_assert_not_reached();
         break;
     }
+
+    g_string_truncate(fields->value_buf, 0);
 }
 
 void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
@@ -2585,23 +2930,224 @@ void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
     /* Nothing to do */
 }
 
+/*
+ * Columnar output: every field is a column, typed after the type of the
+ * field, and every packet is a row.
+ */
+static arrow_column_type_e arrow_column_type_for_hfinfo(const header_field_info *hfinfo)
+{
+    if (hfinfo->type == FT_BOOLEAN)
+        return ARROW_COLUMN_BOOL;
+    if (IS_FT_UINT32(hfinfo->type))
+        return ARROW_COLUMN_UINT32;
+    if (IS_FT_UINT64(hfinfo->type))
+        return ARROW_COLUMN_UINT64;
+    if (IS_FT_INT32(hfinfo->type))
+        return ARROW_COLUMN_INT32;
+    if (IS_FT_INT64(hfinfo->type))
+        return ARROW_COLUMN_INT64;
+
+    switch (hfinfo->type) {
+    case FT_FLOAT:
+    case FT_DOUBLE:
+    case FT_RELATIVE_TIME:
+        return ARROW_COLUMN_DOUBLE;
+    case FT_ABSOLUTE_TIME:
+        return ARROW_COLUMN_TIMESTAMP_NS;
+    case FT_BYTES:
+    case FT_UINT_BYTES:
+        return ARROW_COLUMN_BINARY;
+    default:
+        /* Strings, addresses and everything else are written as text. */
+        return ARROW_COLUMN_STRING_DICT;
+    }
+}
+
+arrow_writer *write_arrow_preamble(output_fields_t* fields, FILE *fh)
+{
+    arrow_writer *writer;
+    gsize i;
+
+    ws_assert(fields);
+    ws_assert(fields->fields);
+
+    output_fields_prepare(fields);
+
+    writer = arrow_writer_new(fh, 0);
+    for (i = 0; i < fields->fields->len; ++i) {
+        const gchar *field = (const gchar *)g_ptr_array_index(fields->fields, i);
+        const header_field_info *hfinfo = fields->field_hfinfos[i];
+        arrow_column_type_e type = ARROW_COLUMN_STRING_DICT;
+
+        if (hfinfo != NULL) {
+            /* Fields with the same name but different types are written as text. */
+            type = arrow_column_type_for_hfinfo(hfinfo);
+            for (hfinfo = hfinfo->same_name_next; hfinfo; hfinfo = hfinfo->same_name_next) {
+                if (arrow_column_type_for_hfinfo(hfinfo) != type) {
+                    type = ARROW_COLUMN_STRING_DICT;
+                    break;
+                }
+            }
+        } else if (!strncmp(field, COLUMN_FIELD_FILTER, strlen(COLUMN_FIELD_FILTER))) {
+            /* Column texts such as the Info column are mostly different. */
+            type = ARROW_COLUMN_STRING;
+        }
+        arrow_writer_add_column(writer, field, type);
+    }
+    return writer;
+}
+
+static void write_arrow_field_value(output_fields_t *fields, guint indx, field_info *fi,
+                                    epan_dissect_t *edt, arrow_writer *writer)
+{
+    const nstime_t *t;
+
+    switch (arrow_writer_column_type(writer, indx)) {
+    case ARROW_COLUMN_BOOL:
+        arrow_writer_set_bool(writer, indx, fvalue_get_uinteger64(fi->value) != 0);
+        break;
+    case ARROW_COLUMN_UINT32:
+        arrow_writer_set_uint(writer, indx, fvalue_get_uinteger(fi->value));
+        break;
+    case ARROW_COLUMN_UINT64:
+        arrow_writer_set_uint(writer, indx, fvalue_get_uinteger64(fi->value));
+        break;
+    case ARROW_COLUMN_INT32:
+        arrow_writer_set_int(writer, indx, fvalue_get_sinteger(fi->value));
+        break;
+    case ARROW_COLUMN_INT64:
+        arrow_writer_set_int(writer, indx, fvalue_get_sinteger64(fi->value));
+        break;
+    case ARROW_COLUMN_DOUBLE:
+        if (fi->hfinfo->type == FT_RELATIVE_TIME) {
+            arrow_writer_set_double(writer, indx, nstime_to_sec(fvalue_get_time(fi->value)));
+        } else {
+            arrow_writer_set_double(writer, indx, fvalue_get_floating(fi->value));
+        }
+        break;
+    case ARROW_COLUMN_TIMESTAMP_NS:
+        t = fvalue_get_time(fi->value);
+        arrow_writer_set_int(writer, indx, (gint64)t->secs * 1000000000 + t->nsecs);
+        break;
+    case ARROW_COLUMN_BINARY:
+        arrow_writer_set_bytes(writer, indx, (const guint8 *)fvalue_get_bytes_data(fi->value),
+                               fvalue_get_bytes_size(fi->value));
+        break;
+    default:
+    {
+        gsize offset = fields->value_buf->len;
+
+        if (append_node_field_value(fields->value_buf, fi, edt)) {
+            arrow_writer_set_string(writer, indx, fields->value_buf->str + offset);
+        }
+        g_string_truncate(fields->value_buf, offset);
+        break;
+    }
+    }
+}
+
+void write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, arrow_writer *writer)
+{
+    gsize     i;
+    gint      col;
+    gchar    *col_name;
+    gpointer  field_index;
+
+    ws_assert(fields);
+    ws_assert(fields->fields);
+    ws_assert(edt);
+    ws_assert(writer);
+
+    /*
+     * Columns hold a single value per packet: the first occurrence of the
+     * field, or the last one with "-E occurrence=l".
+     */
+    for (i = 0; i < fields->fields->len; ++i) {
+        header_field_info *hfinfo;
+        field_info *fi = NULL;
+
+        for (hfinfo = fields->field_hfinfos[i]; hfinfo; hfinfo = hfinfo->same_name_next) {
+            GPtrArray *finfos;
+
+            if (fields->primed) {
+                finfos = proto_get_finfo_ptr_array(edt->tree, hfinfo->id);
+            } else {
+                finfos = proto_find_finfo(edt->tree, hfinfo->id);
+            }
+            if (finfos != NULL && finfos->len != 0) {
+                if (fields->occurrence == 'l') {
+                    fi = (field_info *)g_ptr_array_index(finfos, finfos->len - 1);
+                } else if (fi == NULL) {
+                    fi = (field_info *)g_ptr_array_index(finfos, 0);
+                }
+            }
+            if (!fields->primed) {
+                g_ptr_array_free(finfos, TRUE);
+            }
+        }
+        if (fi != NULL) {
+            write_arrow_field_value(fields, (guint)i, fi, edt, writer);
+        }
+    }
+
+    if (fields->includes_col_fields) {
+        for (col = 0; col < cinfo->num_cols; col++) {
+            if (!get_column_visible(col))
+                continue;
+            col_name = ws_strdup_printf("%s%s", COLUMN_FIELD_FILTER, cinfo->columns[col].col_title);
+            field_index = g_hash_table_lookup(fields->field_indicies, col_name);
+            g_free(col_name);
+
+            if (NULL != field_index) {
+                guint indx = GPOINTER_TO_UINT(field_index) - 1;
+
+                if (arrow_writer_column_type(writer, indx) == ARROW_COLUMN_STRING) {
+                    arrow_writer_set_string(writer, indx, get_column_text(cinfo, col));
+                }
+            }
+        }
+    }
+
+    arrow_writer_end_row(writer);
+}
+
+gboolean write_arrow_finale(arrow_writer *writer)
+{
+    return arrow_writer_finish(writer);
+}
+
 /* Returns an g_malloced string */
 gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt)
+{
+    GString *buf = g_string_new(NULL);
+
+    if (!append_node_field_value(buf, fi, edt)) {
+        g_string_free(buf, TRUE);
+        return NULL;
+    }
+    return g_string_free(buf, FALSE);
+}
+
+/* Appends the value of the field to buf. Returns FALSE if the field has
+ * no value to print. */
+static gboolean
+append_node_field_value(GString *buf, field_info *fi, epan_dissect_t *edt)
 {
     if (fi->hfinfo->id == hf_text_only) {
         /* Text label.
          * Get the text */
         if (fi->rep) {
-            return g_strdup(fi->rep->representation);
+            g_string_append(buf, fi->rep->representation);
+            return TRUE;
         }
         else {
-            return get_field_hex_value(edt->pi.data_src, fi);
+            return append_field_hex_value(buf, edt->pi.data_src, fi);
         }
     }
     else if (fi->hfinfo->id == proto_data) {
         /* Uninterpreted data, i.e., the "Data" protocol, is
          * printed as a field instead of a protocol. */
-        return get_field_hex_value(edt->pi.data_src, fi);
+        return append_field_hex_value(buf, edt->pi.data_src, fi);
     }
     else {
         /* Normal protocols and fields */
@@ -2612,100 +3158,105 @@ gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt)
         case FT_PROTOCOL:
             /* Print out the full details for the protocol. */
             if (fi->rep) {
-                return g_strdup(fi->rep->representation);
+                g_string_append(buf, fi->rep->representation);
             } else {
                 /* Just print out the protocol abbreviation */
-                return g_strdup(fi->hfinfo->abbrev);
+                g_string_append(buf, fi->hfinfo->abbrev);
             }
+            return TRUE;
         case FT_NONE:
             /* Return "1" so that the presence of a field of type
              * FT_NONE can be checked when using -T fields */
-            return g_strdup("1");
+            g_string_append_c(buf, '1');
+            return TRUE;
         case FT_UINT_BYTES:
         case FT_BYTES:
             {
-                gchar *ret;
                 const guint8 *bytes = fvalue_get_bytes_data(fi->value);
                 if (bytes) {
-                    dfilter_string = (gchar *)wmem_alloc(NULL, 3*fvalue_length(fi->value));
+                    gsize length = fvalue_length(fi->value);
+                    gsize old_len = buf->len;
+                    gchar *end;
+                    gchar punct;
+
                     switch (fi->hfinfo->display) {
                     case SEP_DOT:
-                        ret = bytes_to_hexstr_punct(dfilter_string, bytes, fvalue_length(fi->value), '.');
+                        punct = '.';
                         break;
                     case SEP_DASH:
-                        ret = bytes_to_hexstr_punct(dfilter_string, bytes, fvalue_length(fi->value), '-');
+                        punct = '-';
                         break;
                     case SEP_COLON:
-                        ret = bytes_to_hexstr_punct(dfilter_string, bytes, fvalue_length(fi->value), ':');
+                        punct = ':';
                         break;
                     case SEP_SPACE:
-                        ret = bytes_to_hexstr_punct(dfilter_string, bytes, fvalue_length(fi->value), ' ');
+                        punct = ' ';
                         break;
                     case BASE_NONE:
                     default:
-                        ret = bytes_to_hexstr(dfilter_string, bytes, fvalue_length(fi->value));
+                        punct = '\0';
                         break;
                     }
-                    *ret = '\0';
-                    ret = g_strdup(dfilter_string);
-                    wmem_free(NULL, dfilter_string);
+                    /* Format directly into the buffer. */
+                    g_string_set_size(buf, old_len + 3 * length);
+                    if (length == 0) {
+                        end = buf->str + old_len;
+                    } else if (punct != '\0') {
+                        end = bytes_to_hexstr_punct(buf->str + old_len, bytes, length, punct);
+                    } else {
+                        end = bytes_to_hexstr(buf->str + old_len, bytes, length);
+                    }
+                    g_string_truncate(buf, end - buf->str);
                 } else {
                     if (fi->hfinfo->display & BASE_ALLOW_ZERO) {
-                        ret = g_strdup("<none>");
+                        g_string_append(buf, "<none>");
                     } else {
-                        ret = g_strdup("<MISSING>");
+                        g_string_append(buf, "<MISSING>");
                     }
                 }
-                return ret;
+                return TRUE;
             }
             break;
         default:
-            dfilter_string = fvalue_to_string_repr(NULL, fi->value, FTREPR_DISPLAY, fi->hfinfo->display);
+            dfilter_string = fvalue_to_string_repr(edt->pi.pool, fi->value, FTREPR_DISPLAY, fi->hfinfo->display);
             if (dfilter_string != NULL) {
-                gchar* ret = g_strdup(dfilter_string);
-                wmem_free(NULL, dfilter_string);
-                return ret;
+                g_string_append(buf, dfilter_string);
+                wmem_free(edt->pi.pool, dfilter_string);
+                return TRUE;
             } else {
-                return get_field_hex_value(edt->pi.data_src, fi);
+                return append_field_hex_value(buf, edt->pi.data_src, fi);
             }
         }
     }
 }
 
-static gchar*
-get_field_hex_value(GSList *src_list, field_info *fi)
+static gboolean
+append_field_hex_value(GString *buf, GSList *src_list, field_info *fi)
 {
     const guint8 *pd;
 
     if (!fi->ds_tvb)
-        return NULL;
+        return FALSE;
 
     if (fi->length > tvb_captured_length_remaining(fi->ds_tvb, fi->start)) {
-        return g_strdup("field length invalid!");
+        g_string_append(buf, "field length invalid!");
+        return TRUE;
     }
 
     /* Find the data for this field. */
     pd = get_field_data(src_list, fi);
 
     if (pd) {
-        int        i;
-        gchar     *buffer;
-        gchar     *p;
-        int        len;
-        const int  chars_per_byte = 2;
-
-        len    = chars_per_byte * fi->length;
-        buffer = (gchar *)g_malloc(sizeof(gchar)*(len + 1));
-        buffer[len] = '\0'; /* Ensure NULL termination in bad cases */
-        p = buffer;
+        gsize old_len = buf->len;
+
         /* Print a simple hex dump */
-        for (i = 0 ; i < fi->length; i++) {
-            snprintf(p, chars_per_byte+1, "%02x", pd[i]);
-            p += chars_per_byte;
+        if (fi->length > 0) {
+            g_string_set_size(buf, old_len + 2 * fi->length);
+            bytes_to_hexstr(buf->str + old_len, pd, fi->length);
         }
-        return buffer;
+        return TRUE;
     } else {
-        return NULL;
+        return FALSE;
     }
 }
 
@@ -2720,6 +3271,9 @@ output_fields_t* output_fields_new(void)
     fields->fields              = NULL; /*Do lazy initialisation */
     fields->field_indicies      = NULL;
     fields->field_values        = NULL;
+    fields->value_buf           = NULL;
+    fields->field_hfinfos       = NULL;
+    fields->primed              = FALSE;
     fields->quote               ='\0';
     fields->escape              = TRUE;
     fields->includes_col_fields = FALSE;
@@ -19,6 +19,7 @@
 #include <epan/packet.h>
 #include <epan/print_stream.h>
 
+#include <wsutil/arrow_writer.h>
 #include <wsutil/json_dumper.h>
 
 #include "ws_symbol_export.h"
@@ -71,6 +72,13 @@ WS_DLL_PUBLIC gboolean output_fields_set_option(output_fields_t* info, gchar* op
 WS_DLL_PUBLIC void output_fields_list_options(FILE *fh);
 WS_DLL_PUBLIC gboolean output_fields_has_cols(output_fields_t* info);
 
+/*
+ * Prime the epan_dissect_t with the fields to print. If this is done
+ * before each packet is dissected, the values are fetched directly instead
+ * of walking the whole protocol tree.
+ */
+WS_DLL_PUBLIC void output_fields_prime_edt(output_fields_t* info, epan_dissect_t *edt);
+
 /*
  * Higher-level packet-printing code.
  */
@@ -97,7 +105,9 @@ WS_DLL_PUBLIC void write_pdml_preamble(FILE *fh, const gchar* filename);
 WS_DLL_PUBLIC void write_pdml_proto_tree(output_fields_t* fields, wmem_map_t *protocolfilter, epan_dissect_t *edt, column_info *cinfo, FILE *fh, gboolean use_color);
 WS_DLL_PUBLIC void write_pdml_finale(FILE *fh);
 
-// Implementations of proto_node_children_grouper_func
+// Implementations of proto_node_children_grouper_func. write_json_proto_tree()
+// recognizes these two and groups the children while writing them instead of
+// calling them.
 // Groups each child separately
 WS_DLL_PUBLIC GSList *proto_node_group_children_by_unique(proto_node *node);
 // Groups children by json key (children with the same json key get put in the same group
@@ -114,12 +124,28 @@ WS_DLL_PUBLIC void write_json_proto_tree(output_fields_t* fields,
                                          json_dumper *dumper);
 WS_DLL_PUBLIC void write_json_finale(json_dumper *dumper);
 
-WS_DLL_PUBLIC void write_ek_proto_tree(output_fields_t* fields,
-                                       gboolean print_summary,
-                                       gboolean print_hex_data,
-                                       wmem_map_t *protocolfilter,
-                                       epan_dissect_t *edt,
-                                       column_info *cinfo, FILE *fh);
+/*
+ * Write the packets as documents for the Elasticsearch bulk API, either to
+ * a single file or, if bulk_prefix is not NULL, to bulk payload files named
+ * <bulk_prefix>_NNNNN.json of at most bulk_size bytes each (a single
+ * document larger than that gets a file of its own).
+ */
+typedef struct _ek_output ek_output_t;
+
+/* Leave out the layers and fields excluded by the protocol filter, instead
+ * of writing a "filtered" placeholder for them. */
+#define EK_OUTPUT_OMIT_FILTERED     0x01
+
+/* Returns NULL, with errno set, if the first bulk payload file can't be created. */
+WS_DLL_PUBLIC ek_output_t *write_ek_preamble(FILE *fh, const char *bulk_prefix, gsize bulk_size, guint flags);
+/* Returns FALSE, with errno set, on a write error. */
+WS_DLL_PUBLIC gboolean write_ek_proto_tree(output_fields_t* fields,
+                                           gboolean print_summary,
+                                           gboolean print_hex_data,
+                                           wmem_map_t *protocolfilter,
+                                           epan_dissect_t *edt,
+                                           column_info *cinfo, ek_output_t *ek);
+WS_DLL_PUBLIC gboolean write_ek_finale(ek_output_t *ek);
 
 WS_DLL_PUBLIC void write_psml_preamble(column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_psml_columns(epan_dissect_t *edt, FILE *fh, gboolean use_color);
@@ -134,6 +160,14 @@ WS_DLL_PUBLIC void write_fields_preamble(output_fields_t* fields, FILE *fh);
 WS_DLL_PUBLIC void write_fields_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_fields_finale(output_fields_t* fields, FILE *fh);
 
+/*
+ * Write the fields as the columns of an Apache Arrow IPC file, with
+ * typed columns and a row per packet.
+ */
+WS_DLL_PUBLIC arrow_writer *write_arrow_preamble(output_fields_t* fields, FILE *fh);
+WS_DLL_PUBLIC void write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, arrow_writer *writer);
+WS_DLL_PUBLIC gboolean write_arrow_finale(arrow_writer *writer);
+
 WS_DLL_PUBLIC gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt);
 
 extern void print_cache_field_handles(void);
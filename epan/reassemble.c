@@ -14,6 +14,7 @@
 
 #include <epan/packet.h>
 #include <epan/exceptions.h>
+#include <epan/prefs.h>
 #include <epan/reassemble.h>
 #include <epan/tvbuff-int.h>
 
@@ -316,6 +317,38 @@ reassembled_key_free(gpointer ptr)
 	g_slice_free(reassembled_key, (reassembled_key *)ptr);
 }
 
+/*
+ * The fragment list of a reassembly is kept sorted by offset. Fragments
+ * mostly arrive in order and are appended after the first gap, but when
+ * they don't (or when the first fragment is missing) finding the place
+ * of each new fragment means walking the list, which makes reassemblies
+ * with many fragments quadratic. Once such a walk gets long, an index
+ * mapping each offset to the last fragment with that offset is built
+ * and kept up to date by LINK_FRAG(); any other change to the list
+ * drops it.
+ */
+#define FRAGMENT_INDEX_MIN_WALK	32
+
+static void
+fragment_index_drop(fragment_head *fd_head)
+{
+	if (fd_head->fragment_index) {
+		wmem_tree_destroy(fd_head->fragment_index, FALSE, FALSE);
+		fd_head->fragment_index = NULL;
+	}
+}
+
+static void
+fragment_index_build(fragment_head *fd_head)
+{
+	fragment_item *fd_i;
+
+	fd_head->fragment_index = wmem_tree_new(NULL);
+	for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next) {
+		wmem_tree_insert32(fd_head->fragment_index, fd_i->offset, fd_i);
+	}
+}
+
 /*
  * For a fragment hash table entry, free the associated fragments.
  * The entry value (fd_chain) is freed herein and the entry is freed
@@ -336,6 +369,7 @@ free_all_fragments(gpointer key_arg _U_, gpointer value, gpointer user_data _U_)
 		fd_i = fd_head->next;
 		if(fd_head->tvb_data && !(fd_head->flags&FD_SUBSET_TVB))
 			tvb_free(fd_head->tvb_data);
+		fragment_index_drop(fd_head);
 		g_slice_free(fragment_head, fd_head);
 	}
 
@@ -377,6 +411,7 @@ free_fd_head(fragment_head *fd_head)
 		fd_head->tvb_data = NULL;
 	if (fd_head->tvb_data)
 		tvb_free(fd_head->tvb_data);
+	fragment_index_drop(fd_head);
 	for (fd_i = fd_head->next; fd_i; fd_i = tmp) {
 		tmp = fd_i->next;
 		if (fd_i->flags & FD_SUBSET_TVB)
@@ -634,6 +669,7 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		g_slice_free(fragment_item, fd);
 		fd=tmp_fd;
 	}
+	fragment_index_drop(fd_head);
 	g_slice_free(fragment_head, fd_head);
 	g_hash_table_remove(table->fragment_table, key);
 
@@ -746,6 +782,7 @@ static void fragment_reset_first_gap(fragment_head *fd_head)
  */
 static void fragment_items_removed(fragment_head *fd_head, fragment_item *modified)
 {
+	fragment_index_drop(fd_head);
 	if ((fd_head->first_gap == modified) ||
 	    ((modified != NULL) && (modified->offset > fd_head->contiguous_len))) {
 		/* Removed elements were after first gap */
@@ -1097,12 +1134,19 @@ static void
 LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
 {
 	fragment_item *fd_i;
+	guint walked = 0;
 
 	/* add fragment to list, keep list sorted */
 	if (fd_head->next == NULL || fd->offset < fd_head->next->offset) {
 		/* New first fragment */
 		fd->next = fd_head->next;
 		fd_head->next = fd;
+	} else if (fd_head->fragment_index) {
+		/* The first fragment starts at or before this one, so
+		 * there always is a last fragment at or before it. */
+		fd_i = (fragment_item *)wmem_tree_lookup32_le(fd_head->fragment_index, fd->offset);
+		fd->next = fd_i->next;
+		fd_i->next = fd;
 	} else {
 		fd_i = fd_head->next;
 		if (fd_head->first_gap != NULL) {
@@ -1114,11 +1158,18 @@ LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
 		for(; fd_i->next; fd_i=fd_i->next) {
 			if (fd->offset < fd_i->next->offset )
 				break;
+			walked++;
 		}
 		fd->next = fd_i->next;
 		fd_i->next = fd;
 	}
 
+	if (fd_head->fragment_index) {
+		wmem_tree_insert32(fd_head->fragment_index, fd->offset, fd);
+	} else if (walked >= FRAGMENT_INDEX_MIN_WALK) {
+		fragment_index_build(fd_head);
+	}
+
 	update_first_gap(fd_head, fd, FALSE);
 }
 
@@ -1131,6 +1182,7 @@ MERGE_FRAG(fragment_head *fd_head, fragment_item *fd)
 	if (fd == NULL) return;
 
 	multi_insert = (fd->next != NULL);
+	fragment_index_drop(fd_head);
 
 	if (fd_head->next == NULL) {
 		fd_head->next = fd;
@@ -1173,6 +1225,131 @@ MERGE_FRAG(fragment_head *fd_head, fragment_item *fd)
 	update_first_gap(fd_head, inserted, multi_insert);
 }
 
+/*
+ * A run of bytes of the reassembled data, taken from the data of one
+ * fragment.
+ */
+typedef struct {
+	tvbuff_t *tvb;		/* fragment data */
+	guint32  src_offset;	/* offset of the run in the fragment data */
+	guint32  len;
+	guint32  dst_offset;	/* offset of the run in the reassembled data */
+} reassembly_piece_t;
+
+/*
+ * Compare len bytes at the start of tvb with the reassembled data at
+ * offset, as far as it has been collected in pieces already.
+ */
+static gboolean
+reassembly_pieces_equal(GArray *pieces, guint32 offset, tvbuff_t *tvb, guint32 len)
+{
+	reassembly_piece_t *piece;
+	guint32 start, end;
+	guint i;
+
+	/* The pieces are sorted and don't overlap; only the last few
+	 * can possibly cover the range. */
+	for (i = pieces->len; i-- > 0; ) {
+		piece = &g_array_index(pieces, reassembly_piece_t, i);
+		if (piece->dst_offset + piece->len <= offset)
+			break;
+		start = MAX(offset, piece->dst_offset);
+		end = MIN(offset + len, piece->dst_offset + piece->len);
+		if (start < end &&
+		    tvb_memeql(piece->tvb, piece->src_offset + (start - piece->dst_offset),
+			       tvb_get_ptr(tvb, start - offset, end - start), end - start) != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * Create the tvbuff with the reassembled data out of the pieces.
+ *
+ * If the "reassemble_without_copying" preference is set and the pieces
+ * cover the whole of the data, this is a composite of the fragment data
+ * and *is_composite is set to TRUE; the caller must then move the
+ * fragment data into the chain of the composite rather than freeing it.
+ * Otherwise the data is copied into a new buffer, as it always was.
+ */
+static tvbuff_t *
+reassembly_tvb_new(GArray *pieces, guint32 datalen, gboolean *is_composite)
+{
+	reassembly_piece_t *piece;
+	tvbuff_t *tvb, *member;
+	guint32 covered = 0;
+	guint8 *data;
+	guint i;
+
+	for (i = 0; i < pieces->len; i++) {
+		piece = &g_array_index(pieces, reassembly_piece_t, i);
+		if (piece->dst_offset != covered)
+			break;
+		covered += piece->len;
+	}
+
+	if (prefs.reassemble_without_copying && pieces->len > 0 &&
+	    i == pieces->len && covered == datalen) {
+		tvb = tvb_new_composite_root();
+		for (i = 0; i < pieces->len; i++) {
+			piece = &g_array_index(pieces, reassembly_piece_t, i);
+			if (piece->src_offset == 0 &&
+			    piece->len == tvb_captured_length(piece->tvb))
+				member = piece->tvb;
+			else
+				member = tvb_new_subset_length(piece->tvb, piece->src_offset, piece->len);
+			tvb_composite_append(tvb, member);
+		}
+		tvb_composite_finalize(tvb);
+		*is_composite = TRUE;
+		return tvb;
+	}
+
+	data = (guint8 *) g_malloc(datalen);
+	for (i = 0; i < pieces->len; i++) {
+		piece = &g_array_index(pieces, reassembly_piece_t, i);
+		tvb_memcpy(piece->tvb, data + piece->dst_offset, piece->src_offset, piece->len);
+	}
+	tvb = tvb_new_real_data(data, datalen, datalen);
+	tvb_set_free_cb(tvb, g_free);
+	*is_composite = FALSE;
+	return tvb;
+}
+
+/*
+ * Release the data of the fragments of a reassembly that has just been
+ * put together by reassembly_tvb_new(). Fragment data that ended up in a
+ * composite is handed over to it; everything else is freed.
+ */
+static void
+reassembly_release_fragments(fragment_head *fd_head, GArray *pieces, gboolean is_composite)
+{
+	fragment_item *fd_i;
+	guint i = 0;
+
+	for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next) {
+		gboolean used = FALSE;
+
+		/* The pieces are in fragment order. */
+		while (i < pieces->len &&
+		       g_array_index(pieces, reassembly_piece_t, i).tvb == fd_i->tvb_data) {
+			used = TRUE;
+			i++;
+		}
+
+		if (fd_i->flags & FD_SUBSET_TVB)
+			fd_i->flags &= ~FD_SUBSET_TVB;
+		else if (fd_i->tvb_data) {
+			if (is_composite && used)
+				tvb_add_to_chain(fd_head->tvb_data, fd_i->tvb_data);
+			else
+				tvb_free(fd_i->tvb_data);
+		}
+
+		fd_i->tvb_data=NULL;
+	}
+}
+
 /*
  * This function adds a new fragment to the fragment hash table.
  * If this is the first fragment seen for this datagram, a new entry
@@ -1204,7 +1381,8 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fragment_item *fd_i;
 	guint32 dfpos, fraglen, overlap;
 	tvbuff_t *old_tvb_data;
-	guint8 *data;
+	GArray *pieces;
+	gboolean is_composite;
 
 	/* create new fd describing this fragment */
 	fd = g_slice_new(fragment_item);
@@ -1376,9 +1554,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	 */
 	/* store old data just in case */
 	old_tvb_data=fd_head->tvb_data;
-	data = (guint8 *) g_malloc(fd_head->datalen);
-	fd_head->tvb_data = tvb_new_real_data(data, fd_head->datalen, fd_head->datalen);
-	tvb_set_free_cb(fd_head->tvb_data, g_free);
+	pieces = g_array_new(FALSE, FALSE, sizeof(reassembly_piece_t));
 
 	/* add all data fragments */
 	for (dfpos=0,fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
@@ -1398,7 +1574,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 			 *
 			 * Note that the "overlap" compare must only be
 			 * done for fragments with (offset+len) <= fd_head->datalen
-			 * and thus within the newly g_malloc'd buffer.
+			 * and thus within the reassembled data.
 			 */
 
 			if (fd_i->offset >= fd_head->datalen) {
@@ -1458,10 +1634,9 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 					fd_i->flags    |= FD_OVERLAP;
 					fd_head->flags |= FD_OVERLAP;
-					if ( memcmp(data + fd_i->offset,
-							tvb_get_ptr(fd_i->tvb_data, 0, cmp_len),
-							cmp_len)
-							 ) {
+					if (!reassembly_pieces_equal(pieces,
+							fd_i->offset, fd_i->tvb_data,
+							cmp_len)) {
 						fd_i->flags    |= FD_OVERLAPCONFLICT;
 						fd_head->flags |= FD_OVERLAPCONFLICT;
 					}
@@ -1486,24 +1661,27 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 				 * out rather than mixed with the new ones?
 				 */
 				if (fd_i->offset + fraglen > dfpos) {
-					memcpy(data+dfpos,
-						tvb_get_ptr(fd_i->tvb_data, overlap, fraglen-overlap),
-						fraglen-overlap);
+					reassembly_piece_t piece;
+
+					piece.tvb = fd_i->tvb_data;
+					piece.src_offset = overlap;
+					piece.len = fraglen - overlap;
+					piece.dst_offset = dfpos;
+					g_array_append_val(pieces, piece);
 					dfpos = fd_i->offset + fraglen;
 				}
 			}
-
-			if (fd_i->flags & FD_SUBSET_TVB)
-				fd_i->flags &= ~FD_SUBSET_TVB;
-			else if (fd_i->tvb_data)
-				tvb_free(fd_i->tvb_data);
-
-			fd_i->tvb_data=NULL;
 		}
 	}
 
+	fd_head->tvb_data = reassembly_tvb_new(pieces, fd_head->datalen, &is_composite);
+	reassembly_release_fragments(fd_head, pieces, is_composite);
+	g_array_free(pieces, TRUE);
+
+	/* Fragments that were subsets of the old data may be part of the
+	 * composite now. */
 	if (old_tvb_data)
-		tvb_add_to_chain(tvb, old_tvb_data);
+		tvb_add_to_chain(is_composite ? fd_head->tvb_data : tvb, old_tvb_data);
 	/* mark this packet as defragmented.
 	   allows us to skip any trailing fragments */
 	fd_head->flags |= FD_DEFRAGMENTED;
@@ -1866,7 +2044,8 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 	fragment_item *last_fd = NULL;
 	guint32  dfpos = 0, size = 0;
 	tvbuff_t *old_tvb_data = NULL;
-	guint8 *data;
+	GArray *pieces;
+	gboolean is_composite;
 
 	for(fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
 		if(!last_fd || last_fd->offset!=fd_i->offset){
@@ -1877,10 +2056,7 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 
 	/* store old data in case the fd_i->data pointers refer to it */
 	old_tvb_data=fd_head->tvb_data;
-	data = (guint8 *) g_malloc(size);
-	fd_head->tvb_data = tvb_new_real_data(data, size, size);
-	tvb_set_free_cb(fd_head->tvb_data, g_free);
-	fd_head->len = size;		/* record size for caller	*/
+	pieces = g_array_new(FALSE, FALSE, sizeof(reassembly_piece_t));
 
 	/* add all data fragments */
 	last_fd=NULL;
@@ -1888,7 +2064,13 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 		if (fd_i->len) {
 			if(!last_fd || last_fd->offset != fd_i->offset) {
 				/* First fragment or in-sequence fragment */
-				memcpy(data+dfpos, tvb_get_ptr(fd_i->tvb_data, 0, fd_i->len), fd_i->len);
+				reassembly_piece_t piece;
+
+				piece.tvb = fd_i->tvb_data;
+				piece.src_offset = 0;
+				piece.len = fd_i->len;
+				piece.dst_offset = dfpos;
+				g_array_append_val(pieces, piece);
 				dfpos += fd_i->len;
 			} else {
 				/* duplicate/retransmission/overlap */
@@ -1904,16 +2086,18 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 		last_fd=fd_i;
 	}
 
+	fd_head->tvb_data = reassembly_tvb_new(pieces, size, &is_composite);
+	fd_head->len = size;		/* record size for caller	*/
+
 	/* we have defragmented the pdu, now free all fragments*/
-	for (fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-		if (fd_i->flags & FD_SUBSET_TVB)
-			fd_i->flags &= ~FD_SUBSET_TVB;
-		else if (fd_i->tvb_data)
-			tvb_free(fd_i->tvb_data);
-		fd_i->tvb_data=NULL;
+	reassembly_release_fragments(fd_head, pieces, is_composite);
+	g_array_free(pieces, TRUE);
+	if (old_tvb_data) {
+		if (is_composite)
+			tvb_add_to_chain(fd_head->tvb_data, old_tvb_data);
+		else
+			tvb_free(old_tvb_data);
 	}
-	if (old_tvb_data)
-		tvb_free(old_tvb_data);
 
 	/* mark this packet as defragmented.
 	 * allows us to skip any trailing fragments.
@@ -2448,6 +2632,7 @@ fragment_add_seq_single_move(reassembly_table *table, const packet_info *pinfo,
 		if (fd && fd->offset != 0) {
 			fragment_item *inserted = fd;
 			gboolean multi_insert = (inserted->next != NULL);
+			fragment_index_drop(fh);
 			if (prev_fd) {
 				prev_fd->next = fd;
 			} else {
@@ -2758,6 +2943,7 @@ fragment_start_seq_check(reassembly_table *table, const packet_info *pinfo,
 		fd_head = g_slice_new(fragment_head);
 		fd_head->next = NULL;
 		fd_head->first_gap = NULL;
+		fd_head->fragment_index = NULL;
 		fd_head->contiguous_len = 0;
 		fd_head->frame = 0;
 		fd_head->len = 0;
@@ -95,6 +95,12 @@ typedef struct _fragment_head {
 	 * an error, in which case it's the string for the error.
 	 */
 	const char *error;
+	/**
+	 * Index of the fragment list by offset, only present once the
+	 * list has grown long enough for walking it to be expensive.
+	 * Private to reassemble.c.
+	 */
+	struct _wmem_tree_t *fragment_index;
 } fragment_head;
 
 /*
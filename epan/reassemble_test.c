@@ -38,6 +38,7 @@
 
 #include <epan/packet.h>
 #include <epan/packet_info.h>
+#include <epan/prefs.h>
 #include <epan/proto.h>
 #include <epan/tvbuff.h>
 #include <epan/reassemble.h>
@@ -2375,6 +2376,66 @@ test_fragment_add_duplicate_conflict(void)
     }
 }
 
+/* This tests fragment_add with many fragments arriving out of order, enough
+ * for the fragment list to be indexed.
+ *
+ * The odd numbered fragments are added first, in ascending order, and then
+ * the even numbered ones in descending order. Fragment n is 2 bytes long,
+ * at offset 2*n, and taken from offset n of the tvb.
+ */
+#define OUT_OF_ORDER_FRAGS 101
+
+static void
+test_fragment_add_out_of_order(void)
+{
+    fragment_head *fd_head = NULL;
+    fragment_item *fd;
+    guint32 n;
+    int frag;
+
+    printf("Starting test test_fragment_add_out_of_order\n");
+
+    for (n = 1; n < OUT_OF_ORDER_FRAGS; n += 2) {
+        pinfo.num = n + 1;
+        fd_head=fragment_add(&test_reassembly_table, tvb, n, &pinfo, 12, NULL,
+                             2*n, 2, n != OUT_OF_ORDER_FRAGS - 1);
+        ASSERT_EQ_POINTER(NULL,fd_head);
+    }
+    for (frag = OUT_OF_ORDER_FRAGS - 1; frag >= 0; frag -= 2) {
+        n = (guint32)frag;
+        pinfo.num = n + 1;
+        fd_head=fragment_add(&test_reassembly_table, tvb, n, &pinfo, 12, NULL,
+                             2*n, 2, n != OUT_OF_ORDER_FRAGS - 1);
+        if (n != 0) {
+            ASSERT_EQ_POINTER(NULL,fd_head);
+        }
+    }
+
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(2*OUT_OF_ORDER_FRAGS,fd_head->datalen);
+    ASSERT_EQ(1,fd_head->reassembled_in);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+
+    /* the list is sorted */
+    for (n = 0, fd = fd_head->next; fd != NULL; n++, fd = fd->next) {
+        ASSERT_EQ(n + 1,fd->frame);
+        ASSERT_EQ(2*n,fd->offset);
+        ASSERT_EQ(2,fd->len);
+        ASSERT_EQ(0,fd->flags);
+        ASSERT_EQ_POINTER(NULL,fd->tvb_data);
+    }
+    ASSERT_EQ(OUT_OF_ORDER_FRAGS,n);
+
+    /* test the actual reassembly */
+    for (n = 0; n < OUT_OF_ORDER_FRAGS; n++) {
+        ASSERT(!tvb_memeql(fd_head->tvb_data,2*n,data+n,2));
+    }
+
+    if (debug) {
+        print_fragment_table();
+    }
+}
+
 /**********************************************************************************
  *
  * fragment_add_check
@@ -3246,6 +3307,104 @@ test_fragment_add_check_duplicate_conflict(void)
         print_fragment_table();
     }
 }
+
+/**********************************************************************************
+ *
+ * reassemble_without_copying
+ *
+ *********************************************************************************/
+
+/* Reassembles the same fragments with and without the
+ * "reassemble_without_copying" preference, and checks that the
+ * reassembled data is the same. Overlapping fragments have the same data,
+ * so only parts of them end up in the composite.
+ */
+/*   frag_offset  len  more  tvb_offset    frag_number  len  more  tvb_offset
+         60        50   T       63              2        40   F       93
+          0        40   T        3              0        50   T        3
+         30        40   T       33              1        40   T       53
+        110        40   F      113
+*/
+static const struct {
+    guint32 frag;       /* frag_offset or frag_number */
+    guint32 len;
+    gboolean more;
+    int tvb_offset;
+} without_copying_frags[] = {
+    { 60, 50, TRUE, 63 }, { 0, 40, TRUE, 3 }, { 30, 40, TRUE, 33 }, { 110, 40, FALSE, 113 },
+}, without_copying_seq_frags[] = {
+    { 2, 40, FALSE, 93 }, { 0, 50, TRUE, 3 }, { 1, 40, TRUE, 53 },
+};
+
+static void
+test_reassemble_without_copying(void)
+{
+    gboolean saved_pref = prefs.reassemble_without_copying;
+    fragment_head *fd_head = NULL;
+    guint8 *copied = NULL, *copied_seq = NULL;
+    guint8 *reassembled;
+    int pass;
+    unsigned i;
+
+    printf("Starting test test_reassemble_without_copying\n");
+
+    for (pass = 0; pass < 2; pass++) {
+        prefs.reassemble_without_copying = pass == 1;
+
+        for (i = 0; i < G_N_ELEMENTS(without_copying_frags); i++) {
+            pinfo.num = 1 + i;
+            fd_head=fragment_add(&test_reassembly_table, tvb, without_copying_frags[i].tvb_offset,
+                                 &pinfo, 20 + pass, NULL, without_copying_frags[i].frag,
+                                 without_copying_frags[i].len, without_copying_frags[i].more);
+            if (i != G_N_ELEMENTS(without_copying_frags) - 1) {
+                ASSERT_EQ_POINTER(NULL,fd_head);
+            }
+        }
+        ASSERT_NE_POINTER(NULL,fd_head);
+        ASSERT_EQ(150,fd_head->datalen);
+        ASSERT_EQ(150,tvb_captured_length(fd_head->tvb_data));
+        ASSERT(!tvb_memeql(fd_head->tvb_data,35,data+38,80));
+        reassembled = (guint8 *)tvb_memdup(NULL, fd_head->tvb_data, 0, 150);
+        if (copied == NULL) {
+            copied = reassembled;
+        } else {
+            ASSERT(!memcmp(copied, reassembled, 150));
+            g_free(reassembled);
+        }
+
+        for (i = 0; i < G_N_ELEMENTS(without_copying_seq_frags); i++) {
+            pinfo.num = 10 + i;
+            fd_head=fragment_add_seq_check(&test_reassembly_table, tvb, without_copying_seq_frags[i].tvb_offset,
+                                           &pinfo, 30 + pass, NULL, without_copying_seq_frags[i].frag,
+                                           without_copying_seq_frags[i].len, without_copying_seq_frags[i].more);
+            if (i != G_N_ELEMENTS(without_copying_seq_frags) - 1) {
+                ASSERT_EQ_POINTER(NULL,fd_head);
+            }
+        }
+        ASSERT_NE_POINTER(NULL,fd_head);
+        ASSERT_EQ(130,fd_head->datalen);
+        ASSERT_EQ(130,tvb_captured_length(fd_head->tvb_data));
+        ASSERT(!tvb_memeql(fd_head->tvb_data,45,data+48,50));
+        reassembled = (guint8 *)tvb_memdup(NULL, fd_head->tvb_data, 0, 130);
+        if (copied_seq == NULL) {
+            copied_seq = reassembled;
+        } else {
+            ASSERT(!memcmp(copied_seq, reassembled, 130));
+            g_free(reassembled);
+        }
+    }
+
+    ASSERT(!memcmp(copied, data+3, 150));
+    ASSERT(!memcmp(copied_seq, data+3, 130));
+    g_free(copied);
+    g_free(copied_seq);
+    prefs.reassemble_without_copying = saved_pref;
+
+    if (debug) {
+        print_tables();
+    }
+}
+
 /**********************************************************************************
  *
  * main
@@ -3258,6 +3417,7 @@ main(int argc _U_, char **argv _U_)
     frame_data fd;
     static const guint8 src[] = {1,2,3,4}, dst[] = {5,6,7,8};
     unsigned int i;
+    int pass;
     static void (*tests[])(void) = {
         test_simple_fragment_add_seq,              /* frag table only   */
         test_fragment_add_seq_partial_reassembly,
@@ -3284,6 +3444,7 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_duplicate_middle,
         test_fragment_add_duplicate_last,
         test_fragment_add_duplicate_conflict,
+        test_fragment_add_out_of_order,
         test_simple_fragment_add_check,              /* frag table only   */
 #if 0
         test_fragment_add_check_partial_reassembly,
@@ -3294,6 +3455,7 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_check_duplicate_last,
 #endif
         test_fragment_add_check_duplicate_conflict,
+        test_reassemble_without_copying,
     };
 
     /* a tvbuff for testing with */
@@ -3311,19 +3473,26 @@ main(int argc _U_, char **argv _U_)
     set_address(&pinfo.dst,AT_IPv4,4,dst);
 
     /*************************************************************************/
-    for(i=0; i < sizeof(tests)/sizeof(tests[0]); i++ ) {
-        /* re-init the fragment tables */
-        reassembly_table_init(&test_reassembly_table,
-                              &addresses_reassembly_table_functions);
-        ASSERT(test_reassembly_table.fragment_table != NULL);
-        ASSERT(test_reassembly_table.reassembled_table != NULL);
-
-        pinfo.fd->visited = FALSE;
-
-        tests[i]();
-
-        /* Free memory used by the tables */
-        reassembly_table_destroy(&test_reassembly_table);
+    /* Run the tests copying the fragment data and then again building the
+     * reassembled data as a composite of it; they must give the same data. */
+    for(pass=0; pass < 2; pass++) {
+        prefs.reassemble_without_copying = pass == 1;
+        printf("Reassembling %s copying fragment data\n", pass == 0 ? "with" : "without");
+
+        for(i=0; i < sizeof(tests)/sizeof(tests[0]); i++ ) {
+            /* re-init the fragment tables */
+            reassembly_table_init(&test_reassembly_table,
+                                  &addresses_reassembly_table_functions);
+            ASSERT(test_reassembly_table.fragment_table != NULL);
+            ASSERT(test_reassembly_table.reassembled_table != NULL);
+
+            pinfo.fd->visited = FALSE;
+
+            tests[i]();
+
+            /* Free memory used by the tables */
+            reassembly_table_destroy(&test_reassembly_table);
+        }
     }
 
     tvb_free(tvb);
@@ -0,0 +1,138 @@
+/* stream_frames.c
+ * Frame lists of numbered streams
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <epan/packet.h>
+#include <epan/wmem_scopes.h>
+
+#include "stream_frames.h"
+
+struct _stream_frames_table_t {
+    const char *name;
+    wmem_map_t *streams;        /* stream number -> stream_frames_t */
+};
+
+typedef struct {
+    guint32 last_frame;
+    guint num_frames;
+    wmem_array_t *deltas;       /* LEB128 encoded frame number differences */
+} stream_frames_t;
+
+static wmem_tree_t *registered_tables = NULL;
+
+stream_frames_table_t *
+stream_frames_table_register(const char *name)
+{
+    stream_frames_table_t *table;
+
+    DISSECTOR_ASSERT(name);
+
+    table = wmem_new(wmem_epan_scope(), stream_frames_table_t);
+    table->name = name;
+    table->streams = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
+                                            g_direct_hash, g_direct_equal);
+
+    if (registered_tables == NULL)
+        registered_tables = wmem_tree_new(wmem_epan_scope());
+
+    wmem_tree_insert_string(registered_tables, name, table, 0);
+
+    return table;
+}
+
+void
+stream_frames_add(stream_frames_table_t *table, guint32 stream, guint32 frame)
+{
+    stream_frames_t *sf;
+    guint8 buf[5];
+    guint len = 0;
+    guint32 delta;
+
+    sf = (stream_frames_t *)wmem_map_lookup(table->streams, GUINT_TO_POINTER(stream));
+    if (sf == NULL) {
+        sf = wmem_new(wmem_file_scope(), stream_frames_t);
+        sf->last_frame = 0;
+        sf->num_frames = 0;
+        sf->deltas = wmem_array_new(wmem_file_scope(), 1);
+        wmem_map_insert(table->streams, GUINT_TO_POINTER(stream), sf);
+    }
+
+    /* Frame numbers start at 1, so the first delta is never 0 either. */
+    if (frame <= sf->last_frame)
+        return;
+
+    delta = frame - sf->last_frame;
+    while (delta >= 0x80) {
+        buf[len++] = (guint8)(delta | 0x80);
+        delta >>= 7;
+    }
+    buf[len++] = (guint8)delta;
+
+    wmem_array_append(sf->deltas, buf, len);
+    sf->last_frame = frame;
+    sf->num_frames++;
+}
+
+guint32 *
+stream_frames_get(const char *name, guint32 stream, guint *num_frames)
+{
+    stream_frames_table_t *table;
+    stream_frames_t *sf;
+    const guint8 *p, *end;
+    guint32 *frames;
+    guint32 frame = 0, delta;
+    guint i, shift;
+
+    *num_frames = 0;
+
+    if (registered_tables == NULL)
+        return NULL;
+
+    table = (stream_frames_table_t *)wmem_tree_lookup_string(registered_tables, name, 0);
+    if (table == NULL)
+        return NULL;
+
+    sf = (stream_frames_t *)wmem_map_lookup(table->streams, GUINT_TO_POINTER(stream));
+    if (sf == NULL || sf->num_frames == 0)
+        return NULL;
+
+    frames = g_new(guint32, sf->num_frames);
+    p = (const guint8 *)wmem_array_get_raw(sf->deltas);
+    end = p + wmem_array_get_count(sf->deltas);
+    for (i = 0; i < sf->num_frames && p < end; i++) {
+        delta = 0;
+        shift = 0;
+        do {
+            delta |= (guint32)(*p & 0x7f) << shift;
+            shift += 7;
+        } while (*p++ & 0x80);
+        frame += delta;
+        frames[i] = frame;
+    }
+
+    *num_frames = i;
+    return frames;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
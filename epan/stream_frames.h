@@ -0,0 +1,65 @@
+/** @file
+ *
+ * Frame lists of numbered streams
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __STREAM_FRAMES_H__
+#define __STREAM_FRAMES_H__
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Dissectors that number the streams they see, such as TCP with the
+ * "tcp.stream" field, record on the first pass which frames belong to
+ * each stream. Code that is only interested in a single stream, such as
+ * the TCP stream graphs, can then read and dissect just those frames
+ * instead of retapping the whole capture with a "tcp.stream eq N"
+ * filter.
+ *
+ * The frame numbers are kept delta encoded, which usually takes one or
+ * two bytes per frame.
+ */
+
+typedef struct _stream_frames_table_t stream_frames_table_t;
+
+/** Register a table of stream frame lists.
+ *
+ * @param name The name of the field holding the stream number, e.g.
+ * "tcp.stream".
+ * @return The table, to be passed to stream_frames_add().
+ */
+WS_DLL_PUBLIC stream_frames_table_t *stream_frames_table_register(const char *name);
+
+/** Record that a frame belongs to a stream. Frames must be added in
+ * increasing order, which is the case on the first pass; adding the
+ * same or an earlier frame again is ignored.
+ */
+WS_DLL_PUBLIC void stream_frames_add(stream_frames_table_t *table, guint32 stream, guint32 frame);
+
+/** Get the frames of a stream.
+ *
+ * @param name The name the table was registered with.
+ * @param stream The stream number.
+ * @param[out] num_frames Set to the number of frames.
+ * @return A g_malloc'ed array of the frame numbers in increasing order,
+ * or NULL if no table with that name is registered or the stream has no
+ * frames.
+ */
+WS_DLL_PUBLIC guint32 *stream_frames_get(const char *name, guint32 stream, guint *num_frames);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __STREAM_FRAMES_H__ */
@@ -724,6 +724,22 @@ have_tap_listener(int tap_id)
 	return FALSE;
 }
 
+/*
+ * Return TRUE if there are tap listeners other than the one with the
+ * given tapdata, FALSE otherwise.
+ */
+gboolean
+have_other_tap_listeners(const void *tapdata)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata!=tapdata)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 /*
  * Return TRUE if we have any tap listeners with filters, FALSE otherwise.
  */
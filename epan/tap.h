@@ -251,6 +251,10 @@ WS_DLL_PUBLIC gboolean tap_listeners_require_dissection(void);
 /** Returns TRUE there is an active tap listener for the specified tap id. */
 WS_DLL_PUBLIC gboolean have_tap_listener(int tap_id);
 
+/** Return TRUE if there are tap listeners other than the one with the
+ * given tapdata, FALSE otherwise. */
+WS_DLL_PUBLIC gboolean have_other_tap_listeners(const void *tapdata);
+
 /** Return TRUE if we have any tap listeners with filters, FALSE otherwise. */
 WS_DLL_PUBLIC gboolean have_filtering_tap_listeners(void);
 
@@ -9,6 +9,11 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "conversation_table.h"
+#include "frame_data.h"
+#include "frame_data_sequence.h"
+#include "stream_frames.h"
+#include "wmem_scopes.h"
 #include <wsutil/utf8_entities.h>
 
 /*
@@ -74,6 +79,346 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+/*
+ * Conversation table merging. The packets are spread over a number of
+ * IPv4 address pairs, in both directions, with increasing time stamps.
+ */
+#define CT_NUM_HOSTS    64
+
+typedef struct {
+    guint32 src_ip;
+    guint32 dst_ip;
+    guint32 src_port;
+    guint32 dst_port;
+    int     num_bytes;
+    nstime_t ts;
+} ct_test_packet_t;
+
+static ct_test_packet_t *
+ct_test_packets(guint count)
+{
+    ct_test_packet_t *packets = g_new(ct_test_packet_t, count);
+    GRand *rand = g_rand_new_with_seed(12345);
+    guint i;
+
+    for (i = 0; i < count; i++) {
+        guint32 a = g_rand_int_range(rand, 0, CT_NUM_HOSTS);
+        guint32 b = g_rand_int_range(rand, 0, CT_NUM_HOSTS);
+
+        packets[i].src_ip = g_htonl(0x0a000000 | a);
+        packets[i].dst_ip = g_htonl(0x0a000000 | b);
+        packets[i].src_port = 1024 + a;
+        packets[i].dst_port = 80 + (b & 3);
+        packets[i].num_bytes = g_rand_int_range(rand, 60, 1500);
+        packets[i].ts.secs = i / 1000;
+        packets[i].ts.nsecs = (i % 1000) * 1000000;
+    }
+    g_rand_free(rand);
+    return packets;
+}
+
+static void
+ct_test_add(conv_hash_t *conv_ch, conv_hash_t *endp_ch, const ct_test_packet_t *packets, guint first, guint last)
+{
+    guint i;
+
+    for (i = first; i < last; i++) {
+        const ct_test_packet_t *pkt = &packets[i];
+        address src, dst;
+        nstime_t ts = pkt->ts;
+
+        set_address(&src, AT_IPv4, 4, &pkt->src_ip);
+        set_address(&dst, AT_IPv4, 4, &pkt->dst_ip);
+        if (conv_ch) {
+            add_conversation_table_data(conv_ch, &src, &dst, pkt->src_port, pkt->dst_port,
+                    1, pkt->num_bytes, &ts, &ts, NULL, CONVERSATION_TCP);
+        }
+        if (endp_ch) {
+            add_endpoint_table_data(endp_ch, &src, pkt->src_port, TRUE, 1, pkt->num_bytes, NULL, ENDPOINT_TCP);
+            add_endpoint_table_data(endp_ch, &dst, pkt->dst_port, FALSE, 1, pkt->num_bytes, NULL, ENDPOINT_TCP);
+        }
+    }
+}
+
+void test_conversation_table_merge(void)
+{
+    const guint count = 10000;
+    const guint splits[] = { 0, 1, 2500, 2501, 7000, count };
+    ct_test_packet_t *packets = ct_test_packets(count);
+    conv_hash_t conv_all = { 0 }, conv_merged = { 0 };
+    conv_hash_t endp_all = { 0 }, endp_merged = { 0 };
+    guint i;
+
+    ct_test_add(&conv_all, &endp_all, packets, 0, count);
+
+    for (i = 0; i + 1 < G_N_ELEMENTS(splits); i++) {
+        conv_hash_t conv_part = { 0 }, endp_part = { 0 };
+
+        ct_test_add(&conv_part, &endp_part, packets, splits[i], splits[i + 1]);
+        merge_conversation_table_data(&conv_merged, &conv_part);
+        merge_endpoint_table_data(&endp_merged, &endp_part);
+        reset_conversation_table_data(&conv_part);
+        reset_endpoint_table_data(&endp_part);
+    }
+
+    g_assert_cmpuint(conv_merged.conv_array->len, ==, conv_all.conv_array->len);
+    for (i = 0; i < conv_all.conv_array->len; i++) {
+        conv_item_t *a = &g_array_index(conv_all.conv_array, conv_item_t, i);
+        conv_item_t *b = &g_array_index(conv_merged.conv_array, conv_item_t, i);
+
+        g_assert_true(addresses_equal(&a->src_address, &b->src_address));
+        g_assert_true(addresses_equal(&a->dst_address, &b->dst_address));
+        g_assert_cmpuint(a->src_port, ==, b->src_port);
+        g_assert_cmpuint(a->dst_port, ==, b->dst_port);
+        g_assert_cmpuint(a->tx_frames, ==, b->tx_frames);
+        g_assert_cmpuint(a->rx_frames, ==, b->rx_frames);
+        g_assert_cmpuint(a->tx_bytes, ==, b->tx_bytes);
+        g_assert_cmpuint(a->rx_bytes, ==, b->rx_bytes);
+        g_assert_cmpuint(a->tx_bytes_total, ==, b->tx_bytes_total);
+        g_assert_cmpuint(a->rx_bytes_total, ==, b->rx_bytes_total);
+        g_assert_cmpint(nstime_cmp(&a->start_time, &b->start_time), ==, 0);
+        g_assert_cmpint(nstime_cmp(&a->stop_time, &b->stop_time), ==, 0);
+        g_assert_cmpint(a->filtered, ==, b->filtered);
+    }
+
+    g_assert_cmpuint(endp_merged.conv_array->len, ==, endp_all.conv_array->len);
+    for (i = 0; i < endp_all.conv_array->len; i++) {
+        endpoint_item_t *a = &g_array_index(endp_all.conv_array, endpoint_item_t, i);
+        endpoint_item_t *b = &g_array_index(endp_merged.conv_array, endpoint_item_t, i);
+
+        g_assert_true(addresses_equal(&a->myaddress, &b->myaddress));
+        g_assert_cmpuint(a->port, ==, b->port);
+        g_assert_cmpuint(a->tx_frames, ==, b->tx_frames);
+        g_assert_cmpuint(a->rx_frames, ==, b->rx_frames);
+        g_assert_cmpuint(a->tx_bytes_total, ==, b->tx_bytes_total);
+        g_assert_cmpuint(a->rx_bytes_total, ==, b->rx_bytes_total);
+    }
+
+    reset_conversation_table_data(&conv_all);
+    reset_conversation_table_data(&conv_merged);
+    reset_endpoint_table_data(&endp_all);
+    reset_endpoint_table_data(&endp_merged);
+    g_free(packets);
+}
+
+#define CT_PERF_PACKETS (4 * 1000 * 1000)
+#define CT_PERF_THREADS 4
+
+typedef struct {
+    const ct_test_packet_t *packets;
+    guint first;
+    guint last;
+    conv_hash_t conv;
+} ct_perf_part_t;
+
+static gpointer
+ct_perf_thread(gpointer data)
+{
+    ct_perf_part_t *part = (ct_perf_part_t *)data;
+
+    ct_test_add(&part->conv, NULL, part->packets, part->first, part->last);
+    return NULL;
+}
+
+void test_conversation_table_merge_perf(void)
+{
+    ct_test_packet_t *packets = ct_test_packets(CT_PERF_PACKETS);
+    ct_perf_part_t parts[CT_PERF_THREADS];
+    GThread *threads[CT_PERF_THREADS];
+    conv_hash_t conv_all = { 0 }, conv_merged = { 0 };
+    double elapsed;
+    guint i;
+
+    g_test_timer_start();
+    ct_test_add(&conv_all, NULL, packets, 0, CT_PERF_PACKETS);
+    elapsed = g_test_timer_elapsed();
+    g_test_minimized_result(elapsed, "single table: %.3f s", elapsed);
+
+    g_test_timer_start();
+    for (i = 0; i < CT_PERF_THREADS; i++) {
+        parts[i].packets = packets;
+        parts[i].first = CT_PERF_PACKETS / CT_PERF_THREADS * i;
+        parts[i].last = CT_PERF_PACKETS / CT_PERF_THREADS * (i + 1);
+        memset(&parts[i].conv, 0, sizeof(parts[i].conv));
+        threads[i] = g_thread_new("conversation table", ct_perf_thread, &parts[i]);
+    }
+    for (i = 0; i < CT_PERF_THREADS; i++) {
+        g_thread_join(threads[i]);
+        merge_conversation_table_data(&conv_merged, &parts[i].conv);
+        reset_conversation_table_data(&parts[i].conv);
+    }
+    elapsed = g_test_timer_elapsed();
+    g_test_minimized_result(elapsed, "%d tables merged: %.3f s", CT_PERF_THREADS, elapsed);
+
+    g_assert_cmpuint(conv_merged.conv_array->len, ==, conv_all.conv_array->len);
+
+    reset_conversation_table_data(&conv_all);
+    reset_conversation_table_data(&conv_merged);
+    g_free(packets);
+}
+
+void test_stream_frames(void)
+{
+    /* Deltas that take one to five bytes once encoded. */
+    static const guint32 frames[] = {
+        1, 2, 129, 130, 16514, 16515, 2113667, 2113668, 270549123, 270549124, 4294967295U
+    };
+    stream_frames_table_t *table;
+    guint32 *got;
+    guint num_frames, i;
+
+    wmem_init_scopes();
+    wmem_enter_file_scope();
+
+    table = stream_frames_table_register("test.stream");
+
+    for (i = 0; i < G_N_ELEMENTS(frames); i++) {
+        stream_frames_add(table, 7, frames[i]);
+        /* Other streams are interleaved, and frames seen again are ignored. */
+        stream_frames_add(table, 8, frames[i]);
+        stream_frames_add(table, 7, frames[i]);
+        if (i > 0) {
+            stream_frames_add(table, 7, frames[i - 1]);
+        }
+    }
+
+    got = stream_frames_get("test.stream", 7, &num_frames);
+    g_assert_nonnull(got);
+    g_assert_cmpuint(num_frames, ==, G_N_ELEMENTS(frames));
+    for (i = 0; i < num_frames; i++) {
+        g_assert_cmpuint(got[i], ==, frames[i]);
+    }
+    g_free(got);
+
+    got = stream_frames_get("test.stream", 8, &num_frames);
+    g_assert_nonnull(got);
+    g_assert_cmpuint(num_frames, ==, G_N_ELEMENTS(frames));
+    g_free(got);
+
+    g_assert_null(stream_frames_get("test.stream", 9, &num_frames));
+    g_assert_cmpuint(num_frames, ==, 0);
+    g_assert_null(stream_frames_get("other.stream", 7, &num_frames));
+    g_assert_cmpuint(num_frames, ==, 0);
+
+    /* The frame lists go away with the capture file. */
+    wmem_leave_file_scope();
+    wmem_enter_file_scope();
+    g_assert_null(stream_frames_get("test.stream", 7, &num_frames));
+    stream_frames_add(table, 7, 5);
+    got = stream_frames_get("test.stream", 7, &num_frames);
+    g_assert_nonnull(got);
+    g_assert_cmpuint(num_frames, ==, 1);
+    g_assert_cmpuint(got[0], ==, 5);
+    g_free(got);
+
+    wmem_leave_file_scope();
+    wmem_cleanup_scopes();
+}
+
+static void
+fds_test_add(frame_data_sequence *fds, guint32 num, time_t secs, int nsecs, gboolean has_ts)
+{
+    frame_data fdata;
+
+    memset(&fdata, 0, sizeof(fdata));
+    fdata.num = num;
+    fdata.has_ts = has_ts;
+    fdata.abs_ts.secs = secs;
+    fdata.abs_ts.nsecs = nsecs;
+    frame_data_sequence_add(fds, &fdata);
+}
+
+/* Check frame_data_sequence_find_time_range() against a linear scan for
+ * every window with bounds from the given times, or no bound. */
+static void
+fds_test_check_windows(frame_data_sequence *fds, guint32 count,
+    const nstime_t *times, guint num_times)
+{
+    guint i, j, r;
+    guint32 num;
+
+    for (i = 0; i <= num_times; i++) {
+        const nstime_t *start = i < num_times ? &times[i] : NULL;
+
+        for (j = 0; j <= num_times; j++) {
+            const nstime_t *end = j < num_times ? &times[j] : NULL;
+            range_t *range = frame_data_sequence_find_time_range(fds, NULL, start, end);
+
+            for (r = 1; r < range->nranges; r++) {
+                g_assert_cmpuint(range->ranges[r].low, >, range->ranges[r - 1].high + 1);
+            }
+            for (num = 1; num <= count; num++) {
+                frame_data *fdata = frame_data_sequence_find(fds, num);
+                gboolean in_window = fdata->has_ts &&
+                    (start == NULL || nstime_cmp(&fdata->abs_ts, start) >= 0) &&
+                    (end == NULL || nstime_cmp(&fdata->abs_ts, end) < 0);
+
+                g_assert_cmpint(value_is_in_range(range, num), ==, in_window);
+            }
+            wmem_free(NULL, range);
+        }
+    }
+}
+
+void test_frame_data_sequence_time_merge(void)
+{
+    static const nstime_t times[] = {
+        { 0, 0 }, { 60, 0 }, { 61, 500000000 }, { 65, 0 }, { 70, 0 },
+        { 101, 0 }, { 105, 0 }, { 110, 0 }, { 200, 0 },
+    };
+    frame_data_sequence *fds = new_frame_data_sequence();
+    guint32 num;
+
+    /* Frames in time stamp order. */
+    for (num = 1; num <= 10; num++) {
+        fds_test_add(fds, num, 100 + num, 0, TRUE);
+    }
+    fds_test_check_windows(fds, 10, times, G_N_ELEMENTS(times));
+
+    /* Frames earlier than the ones already in the index are merged in,
+     * and a frame without a time stamp is left out. */
+    for (num = 11; num <= 20; num++) {
+        fds_test_add(fds, num, 50 + num, 0, num != 15);
+    }
+    fds_test_check_windows(fds, 20, times, G_N_ELEMENTS(times));
+
+    /* A time shift drops the index. */
+    frame_data_sequence_find(fds, 3)->abs_ts.secs = 62;
+    frame_data_sequence_times_changed(fds);
+    fds_test_check_windows(fds, 20, times, G_N_ELEMENTS(times));
+
+    free_frame_data_sequence(fds);
+}
+
+void test_frame_data_sequence_time_blocks(void)
+{
+    /* The base seconds of each batch: some batches are earlier than
+     * the frames already in the index, and some jump far ahead. */
+    static const time_t base_secs[] = { 1000, 500, 100000000, 2000, 1000, 700000 };
+    nstime_t times[16];
+    frame_data_sequence *fds = new_frame_data_sequence();
+    guint32 seed = 1;
+    guint32 num = 0;
+    guint batch, i;
+
+    for (batch = 0; batch < G_N_ELEMENTS(base_secs); batch++) {
+        for (i = 0; i < 150 + batch * 37; i++) {
+            num++;
+            seed = seed * 1103515245 + 12345;
+            /* Jitter of a few seconds puts neighbouring frames out of
+             * order, and every 50th frame or so has no time stamp. */
+            fds_test_add(fds, num, base_secs[batch] + i / 4 + (seed >> 16) % 3,
+                (seed >> 4) % 1000000000, (seed >> 20) % 50 != 0);
+        }
+        for (i = 0; i < G_N_ELEMENTS(times); i++) {
+            times[i] = frame_data_sequence_find(fds, 1 + i * (num / G_N_ELEMENTS(times)))->abs_ts;
+        }
+        fds_test_check_windows(fds, num, times, G_N_ELEMENTS(times));
+    }
+
+    free_frame_data_sequence(fds);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -85,6 +430,13 @@ int main(int argc, char **argv)
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
+    g_test_add_func("/conversation_table/merge", test_conversation_table_merge);
+    g_test_add_func("/stream_frames/add_get", test_stream_frames);
+    g_test_add_func("/frame_data_sequence/time_merge", test_frame_data_sequence_time_merge);
+    g_test_add_func("/frame_data_sequence/time_blocks", test_frame_data_sequence_time_blocks);
+    if (g_test_perf()) {
+        g_test_add_func("/conversation_table/merge_perf", test_conversation_table_merge_perf);
+    }
 
     ret = g_test_run();
 
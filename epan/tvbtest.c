@@ -803,6 +803,131 @@ zstd_tests (void) {
 	printf ("Skipping ZSTD test. ZSTD is not available.\n");
 #endif
 }
+#define MANY_MEMBERS 200
+#define MEMBER_LEN 3
+
+/* A composite with many members, read mostly across member boundaries. */
+static void
+composite_tests(void)
+{
+	tvbuff_t	*tvb_parent, *tvb_comp;
+	guint8		*data;
+	const guint8	*ptr, *ptr2;
+	guint		i;
+
+	data = (guint8*)g_malloc(MANY_MEMBERS * MEMBER_LEN);
+	for (i = 0; i < MANY_MEMBERS * MEMBER_LEN; i++) {
+		data[i] = (guint8)(i * 7);
+	}
+	tvb_parent = tvb_new_real_data(data, MANY_MEMBERS * MEMBER_LEN, MANY_MEMBERS * MEMBER_LEN);
+	tvb_set_free_cb(tvb_parent, g_free);
+
+	tvb_comp = tvb_new_composite();
+	for (i = 0; i < MANY_MEMBERS; i++) {
+		tvb_composite_append(tvb_comp, tvb_new_subset_length(tvb_parent, i * MEMBER_LEN, MEMBER_LEN));
+	}
+	tvb_composite_finalize(tvb_comp);
+
+	/* Pointers to ranges straddling two members. */
+	for (i = 1; i < MANY_MEMBERS; i += 37) {
+		ptr = tvb_get_ptr(tvb_comp, i * MEMBER_LEN - 1, 2);
+		if (memcmp(ptr, &data[i * MEMBER_LEN - 1], 2) != 0) {
+			printf("Failed many member composite, straddling pointer at %u\n", i * MEMBER_LEN - 1);
+			failed = TRUE;
+		}
+		/* The same range again, and a range inside it. */
+		ptr2 = tvb_get_ptr(tvb_comp, i * MEMBER_LEN - 1, 2);
+		if (ptr2 != ptr) {
+			printf("Failed many member composite, range at %u copied twice\n", i * MEMBER_LEN - 1);
+			failed = TRUE;
+		}
+	}
+
+	/* A pointer to a range spanning many members. */
+	ptr = tvb_get_ptr(tvb_comp, 10, 100);
+	if (memcmp(ptr, &data[10], 100) != 0) {
+		printf("Failed many member composite, pointer to 100 bytes at 10\n");
+		failed = TRUE;
+	}
+
+	test(tvb_comp, "Many member composite", data, MANY_MEMBERS * MEMBER_LEN, MANY_MEMBERS * MEMBER_LEN);
+
+	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
+}
+
+#define MEMSEARCH_DATA "Hello, Wireshark world"
+
+/* Searches of a real data tvbuff, a composite of three parts of it and a
+ * subset of the composite. */
+static void
+memsearch_tests(void)
+{
+	static const struct {
+		const char *desc;
+		int tvb_idx;		/* 0 real data, 1 composite, 2 subset */
+		const char *needles[3];
+		guint flags;
+		gint offset;
+		gint maxlength;
+		gint expected;
+		guint expected_idx;
+	} tests[] = {
+		{ "match in real data", 0, { "Wireshark" }, 0, 0, -1, 7, 0 },
+		{ "match across composite members", 1, { "Wireshark" }, 0, 0, -1, 7, 0 },
+		{ "match across three composite members", 1, { ", Wireshark " }, 0, 0, -1, 5, 0 },
+		{ "match at end of composite", 1, { "world" }, 0, 0, -1, 17, 0 },
+		{ "match at end of maxlength", 1, { "shark" }, 0, 3, 13, 11, 0 },
+		{ "match past maxlength", 1, { "shark" }, 0, 3, 12, -1, 0 },
+		{ "match after offset", 1, { "o" }, 0, 5, -1, 18, 0 },
+		{ "no match", 1, { "wireshark" }, 0, 0, -1, -1, 0 },
+		{ "no match in real data", 0, { "Wireshark!" }, 0, 0, -1, -1, 0 },
+		{ "case-insensitive match", 1, { "wireSHARK" }, WS_MEMSEARCH_NOCASE, 0, -1, 7, 0 },
+		{ "first of several patterns to end", 1, { "shark", "o, W" }, 0, 0, -1, 4, 1 },
+		{ "no match of several patterns", 1, { "sharp", "Hello!" }, 0, 0, -1, -1, 0 },
+		{ "match at end of subset", 2, { "world" }, 0, 0, -1, 10, 0 },
+		{ "no match before subset", 2, { "Hello" }, 0, 0, -1, -1, 0 },
+	};
+	tvbuff_t	*tvb_parent, *tvb_comp, *tvb_sub;
+	tvbuff_t	*tvbs[3];
+	guint		i, n;
+
+	tvb_parent = tvb_new_real_data((const guint8*)MEMSEARCH_DATA, sizeof MEMSEARCH_DATA - 1, sizeof MEMSEARCH_DATA - 1);
+	tvb_comp = tvb_new_composite();
+	tvb_composite_append(tvb_comp, tvb_new_subset_length(tvb_parent, 0, 7));
+	tvb_composite_append(tvb_comp, tvb_new_subset_length(tvb_parent, 7, 4));
+	tvb_composite_append(tvb_comp, tvb_new_subset_length(tvb_parent, 11, 11));
+	tvb_composite_finalize(tvb_comp);
+	tvb_sub = tvb_new_subset_length(tvb_comp, 7, 15);
+	tvbs[0] = tvb_parent;
+	tvbs[1] = tvb_comp;
+	tvbs[2] = tvb_sub;
+
+	for (i = 0; i < G_N_ELEMENTS(tests); i++) {
+		ws_memsearch_t	*searcher = ws_memsearch_new(tests[i].flags);
+		guint		pattern_idx = G_MAXUINT;
+		gint		result;
+
+		for (n = 0; n < G_N_ELEMENTS(tests[i].needles) && tests[i].needles[n]; n++) {
+			ws_memsearch_add(searcher, tests[i].needles[n], strlen(tests[i].needles[n]));
+		}
+		ws_memsearch_compile(searcher);
+
+		result = tvb_memsearch(tvbs[tests[i].tvb_idx], tests[i].offset, tests[i].maxlength, searcher, &pattern_idx);
+		if (result != tests[i].expected) {
+			printf("Failed tvb_memsearch %s. Expected %d, got %d\n", tests[i].desc, tests[i].expected, result);
+			failed = TRUE;
+		} else if (result != -1 && pattern_idx != tests[i].expected_idx) {
+			printf("Failed tvb_memsearch %s. Expected pattern %u, got %u\n", tests[i].desc, tests[i].expected_idx, pattern_idx);
+			failed = TRUE;
+		} else {
+			printf("Passed tvb_memsearch %s\n", tests[i].desc);
+		}
+		ws_memsearch_free(searcher);
+	}
+
+	tvb_free_chain(tvb_parent);
+}
+
 /* Note: valgrind can be used to check for tvbuff memory leaks */
 int
 main(void)
@@ -815,6 +940,8 @@ main(void)
 	run_tests();
 	varint_tests();
 	zstd_tests ();
+	composite_tests();
+	memsearch_tests();
 	except_deinit();
 	exit(failed?1:0);
 }
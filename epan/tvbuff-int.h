@@ -90,6 +90,14 @@ WS_DLL_PUBLIC tvbuff_t *tvb_new(const struct tvb_ops *ops);
 
 tvbuff_t *tvb_new_proxy(tvbuff_t *backing);
 
+/*
+ * Like tvb_new_composite(), but the composite is not attached to the
+ * chain of its first member. It is the start of a chain of its own
+ * instead, and the caller must use tvb_add_to_chain() to make the
+ * composite own its members (or otherwise make sure they outlive it).
+ */
+tvbuff_t *tvb_new_composite_root(void);
+
 void tvb_add_to_chain(tvbuff_t *parent, tvbuff_t *child);
 
 guint tvb_offset_from_real_beginning_counter(const tvbuff_t *tvb, const guint counter);
@@ -2424,6 +2424,58 @@ tvb_ws_mempbrk_pattern_guint8(tvbuff_t *tvb, const gint offset, const gint maxle
 	return tvb_ws_mempbrk_guint8_generic(tvb, abs_offset, limit, pattern, found_needle);
 }
 
+/* Find first occurrence of any of the patterns of the compiled searcher in
+ * tvbuff, starting at offset. Searches at most maxlength number of bytes;
+ * if maxlength is -1, searches to end of tvbuff.
+ * Returns the offset of the start of the match, or -1 if not found.
+ * Will not throw an exception, even if maxlength exceeds boundary of tvbuff;
+ * in that case, -1 will be returned if the boundary is reached before
+ * finding a match. */
+gint
+tvb_memsearch(tvbuff_t *tvb, const gint offset, const gint maxlength,
+		const ws_memsearch_t *searcher, guint *pattern_idx)
+{
+	const guint8 *ptr;
+	const guint8 *result;
+	guint	      abs_offset = 0;
+	guint	      limit = 0;
+	int           exception;
+
+	DISSECTOR_ASSERT(tvb && tvb->initialized);
+
+	exception = compute_offset_and_remaining(tvb, offset, &abs_offset, &limit);
+	if (exception)
+		THROW(exception);
+
+	/* Only search to end of tvbuff, w/o throwing exception. */
+	if (maxlength >= 0 && limit > (guint) maxlength) {
+		/* Maximum length doesn't go past end of tvbuff; search
+		   to that value. */
+		limit = (guint) maxlength;
+	}
+
+	/* If we have real data, perform our search now. */
+	if (tvb->real_data) {
+		result = ws_memsearch_exec(searcher, tvb->real_data + abs_offset, limit, pattern_idx);
+		if (result == NULL) {
+			return -1;
+		}
+		else {
+			return (gint) (result - tvb->real_data);
+		}
+	}
+
+	ptr = ensure_contiguous(tvb, abs_offset, limit); /* tvb_get_ptr */
+	if (!ptr)
+		return -1;
+
+	result = ws_memsearch_exec(searcher, ptr, limit, pattern_idx);
+	if (!result)
+		return -1;
+
+	return (gint) ((result - ptr) + abs_offset);
+}
+
 /* Find size of stringz (NUL-terminated string) by looking for terminating
  * NUL.  The size of the string includes the terminating NUL.
  *
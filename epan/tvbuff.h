@@ -28,6 +28,7 @@
 
 #include <wsutil/nstime.h>
 #include "wsutil/ws_mempbrk.h"
+#include "wsutil/ws_memsearch.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -535,6 +536,18 @@ WS_DLL_PUBLIC gint tvb_find_guint16(tvbuff_t *tvb, const gint offset,
 WS_DLL_PUBLIC gint tvb_ws_mempbrk_pattern_guint8(tvbuff_t *tvb, const gint offset,
     const gint maxlength, const ws_mempbrk_pattern* pattern, guchar *found_needle);
 
+/** Find first occurrence of any of the patterns of a compiled searcher
+ * (see ws_memsearch_compile()) in tvbuff, starting at offset. Searches at
+ * most maxlength number of bytes; if maxlength is -1, searches to end of
+ * tvbuff. A match must lie entirely within the searched bytes.
+ * Returns the offset of the start of the match, or -1 if not found, and
+ * sets pattern_idx (if not NULL) to the index of the matching pattern.
+ * Will not throw an exception, even if maxlength exceeds boundary of tvbuff;
+ * in that case, -1 will be returned if the boundary is reached before
+ * finding a match. */
+WS_DLL_PUBLIC gint tvb_memsearch(tvbuff_t *tvb, const gint offset,
+    const gint maxlength, const ws_memsearch_t *searcher, guint *pattern_idx);
+
 
 /** Find size of stringz (NUL-terminated string) by looking for terminating
  * NUL.  The size of the string includes the terminating NUL.
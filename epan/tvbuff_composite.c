@@ -15,8 +15,25 @@
 #include "tvbuff-int.h"
 #include "proto.h"	/* XXX - only used for DISSECTOR_ASSERT, probably a new header file? */
 
+/*
+ * A copy of a range of the composite that spans several members, kept
+ * to serve tvb_get_ptr() on that range (the pointer must remain valid
+ * for as long as the tvbuff).
+ */
 typedef struct {
-	GSList		*tvbs;
+	guint		offset;
+	guint		length;
+	guint8		*data;
+} comp_span_t;
+
+/*
+ * Once this many spans have been copied, or as many bytes as the whole
+ * composite, the composite is flattened instead.
+ */
+#define COMPOSITE_MAX_SPANS	16
+
+typedef struct {
+	GPtrArray	*tvbs;
 
 	/* Used for quick testing to see if this
 	 * is the tvbuff that a COMPOSITE is
@@ -24,6 +41,14 @@ typedef struct {
 	guint		*start_offsets;
 	guint		*end_offsets;
 
+	/* TRUE if the members are chained to the composite rather
+	 * than the other way around. */
+	gboolean	root;
+
+	GSList		*spans;
+	guint		num_spans;
+	guint		span_bytes;
+
 } tvb_comp_t;
 
 struct tvb_composite {
@@ -37,8 +62,17 @@ composite_free(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
+	GSList	   *slist;
+
+	g_ptr_array_free(composite->tvbs, TRUE);
 
-	g_slist_free(composite->tvbs);
+	for (slist = composite->spans; slist != NULL; slist = slist->next) {
+		comp_span_t *span = (comp_span_t *)slist->data;
+
+		g_free(span->data);
+		g_free(span);
+	}
+	g_slist_free(composite->spans);
 
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
@@ -51,37 +85,51 @@ composite_offset(const tvbuff_t *tvb _U_, const guint counter)
 	return counter;
 }
 
+/*
+ * Return the index of the member containing abs_offset, or the number of
+ * members if abs_offset is at (or past) the end of the composite.
+ */
+static guint
+composite_find_member(const tvb_comp_t *composite, guint abs_offset)
+{
+	guint low = 0, high = composite->tvbs->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (composite->end_offsets[mid] < abs_offset)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
 static const guint8*
 composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset;
 	GSList	   *slist;
+	comp_span_t *span;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->tvbs->len) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb = (tvbuff_t *)g_ptr_array_index(composite->tvbs, i);
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
@@ -91,6 +139,28 @@ composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_get_ptr(member_tvb, member_offset, abs_length);
 	}
+
+	/* Maybe we have copied a range containing this one before. */
+	for (slist = composite->spans; slist != NULL; slist = slist->next) {
+		span = (comp_span_t *)slist->data;
+		if (abs_offset >= span->offset &&
+		    abs_offset - span->offset + abs_length <= span->length)
+			return span->data + (abs_offset - span->offset);
+	}
+
+	if (composite->num_spans < COMPOSITE_MAX_SPANS &&
+	    composite->span_bytes + abs_length < tvb->length) {
+		/* Copy just the range asked for. */
+		span = g_new(comp_span_t, 1);
+		span->offset = abs_offset;
+		span->length = abs_length;
+		span->data = (guint8 *)g_malloc(abs_length);
+		tvb_memcpy(tvb, span->data, abs_offset, abs_length);
+		composite->spans = g_slist_prepend(composite->spans, span);
+		composite->num_spans++;
+		composite->span_bytes += abs_length;
+		return span->data;
+	}
 	else {
 		/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
 		void *real_data = g_malloc(tvb->length);
@@ -108,63 +178,92 @@ composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_lengt
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	guint8 *target = (guint8 *) _target;
 
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset, member_length;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
-	/* Maybe the range specified by offset/length
-	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	composite = &composite_tvb->composite;
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->tvbs->len) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
-	member_offset = abs_offset - composite->start_offsets[i];
-
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
-		DISSECTOR_ASSERT(!tvb->real_data);
-		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
-	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
-		member_length = tvb_captured_length_remaining(member_tvb, member_offset);
-
-		/* composite_memcpy() can't handle a member_length of zero. */
-		DISSECTOR_ASSERT(member_length > 0);
+	/* Copy the part of the range in each member in turn. */
+	while (abs_length > 0) {
+		DISSECTOR_ASSERT(i < composite->tvbs->len);
+		member_tvb = (tvbuff_t *)g_ptr_array_index(composite->tvbs, i);
+		member_offset = abs_offset - composite->start_offsets[i];
+		member_length = MIN(composite->end_offsets[i] - abs_offset + 1, abs_length);
 
 		tvb_memcpy(member_tvb, target, member_offset, member_length);
+		target		+= member_length;
 		abs_offset	+= member_length;
 		abs_length	-= member_length;
+		i++;
+	}
 
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-		}
+	return _target;
+}
 
-		return target;
+static gint
+composite_find_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, guint8 needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	guint	    i;
+	tvbuff_t   *member_tvb;
+	guint	    member_offset, member_length;
+	gint	    result;
+
+	/* Search each member in turn rather than flattening the composite. */
+	for (i = composite_find_member(composite, abs_offset);
+	     limit > 0 && i < composite->tvbs->len; i++) {
+		member_tvb = (tvbuff_t *)g_ptr_array_index(composite->tvbs, i);
+		member_offset = abs_offset - composite->start_offsets[i];
+		member_length = MIN(composite->end_offsets[i] - abs_offset + 1, limit);
+
+		result = tvb_find_guint8(member_tvb, member_offset, (gint)member_length, needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+
+		abs_offset += member_length;
+		limit	   -= member_length;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return -1;
+}
+
+static gint
+composite_pbrk_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, const ws_mempbrk_pattern* pattern, guchar *found_needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	guint	    i;
+	tvbuff_t   *member_tvb;
+	guint	    member_offset, member_length;
+	gint	    result;
+
+	for (i = composite_find_member(composite, abs_offset);
+	     limit > 0 && i < composite->tvbs->len; i++) {
+		member_tvb = (tvbuff_t *)g_ptr_array_index(composite->tvbs, i);
+		member_offset = abs_offset - composite->start_offsets[i];
+		member_length = MIN(composite->end_offsets[i] - abs_offset + 1, limit);
+
+		result = tvb_ws_mempbrk_pattern_guint8(member_tvb, member_offset, (gint)member_length, pattern, found_needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+
+		abs_offset += member_length;
+		limit	   -= member_length;
+	}
+
+	return -1;
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -174,8 +273,8 @@ static const struct tvb_ops tvb_composite_ops = {
 	composite_offset,     /* offset */
 	composite_get_ptr,    /* get_ptr */
 	composite_memcpy,     /* memcpy */
-	NULL,                 /* find_guint8 XXX */
-	NULL,                 /* pbrk_guint8 XXX */
+	composite_find_guint8, /* find_guint8 */
+	composite_pbrk_guint8, /* pbrk_guint8 */
 	NULL,                 /* clone */
 };
 
@@ -198,9 +297,24 @@ tvb_new_composite(void)
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
 
-	composite->tvbs		 = NULL;
+	composite->tvbs		 = g_ptr_array_new();
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
+	composite->root		 = FALSE;
+	composite->spans	 = NULL;
+	composite->num_spans	 = 0;
+	composite->span_bytes	 = 0;
+
+	return tvb;
+}
+
+tvbuff_t *
+tvb_new_composite_root(void)
+{
+	tvbuff_t *tvb = tvb_new_composite();
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+
+	composite_tvb->composite.root = TRUE;
 
 	return tvb;
 }
@@ -218,12 +332,12 @@ tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member)
 	 * and anyway it makes no sense.
 	 */
 	if (member && member->length) {
-		composite       = &composite_tvb->composite;
-		composite->tvbs = g_slist_append(composite->tvbs, member);
+		composite = &composite_tvb->composite;
+		g_ptr_array_add(composite->tvbs, member);
 
 		/* Attach the composite TVB to the first TVB only. */
-		if (!composite->tvbs->next) {
-			tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb);
+		if (!composite->root && composite->tvbs->len == 1) {
+			tvb_add_to_chain(member, tvb);
 		}
 	}
 }
@@ -241,12 +355,12 @@ tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member)
 	 * and anyway it makes no sense.
 	 */
 	if (member && member->length) {
-		composite       = &composite_tvb->composite;
-		composite->tvbs = g_slist_prepend(composite->tvbs, member);
+		composite = &composite_tvb->composite;
+		g_ptr_array_insert(composite->tvbs, 0, member);
 
 		/* Attach the composite TVB to the first TVB only. */
-		if (!composite->tvbs->next) {
-			tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb);
+		if (!composite->root && composite->tvbs->len == 1) {
+			tvb_add_to_chain(member, tvb);
 		}
 	}
 }
@@ -255,11 +369,10 @@ void
 tvb_composite_finalize(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	GSList	   *slist;
 	guint	    num_members;
 	tvbuff_t   *member_tvb;
 	tvb_comp_t *composite;
-	int	    i = 0;
+	guint	    i;
 
 	DISSECTOR_ASSERT(tvb && !tvb->initialized);
 	DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops);
@@ -268,7 +381,7 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	DISSECTOR_ASSERT(tvb->contained_length == 0);
 
 	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
+	num_members = composite->tvbs->len;
 
 	/* Dissectors should not create composite TVBs if they're not going to
 	 * put at least one TVB in them.
@@ -279,15 +392,13 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
-	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
-		DISSECTOR_ASSERT((guint) i < num_members);
-		member_tvb = (tvbuff_t *)slist->data;
+	for (i = 0; i < num_members; i++) {
+		member_tvb = (tvbuff_t *)g_ptr_array_index(composite->tvbs, i);
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
 		tvb->contained_length += member_tvb->contained_length;
 		composite->end_offsets[i] = tvb->length - 1;
-		i++;
 	}
 
 	tvb->initialized = TRUE;
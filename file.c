@@ -24,6 +24,7 @@
 #include <wsutil/json_dumper.h>
 #include <wsutil/wslog.h>
 #include <wsutil/ws_assert.h>
+#include <wsutil/ws_memsearch.h>
 #include <wsutil/version_info.h>
 
 #include <wiretap/merge.h>
@@ -43,6 +44,7 @@
 #include <epan/addr_resolv.h>
 #include <epan/color_filters.h>
 #include <epan/secrets.h>
+#include <epan/stream_frames.h>
 
 #include "cfile.h"
 #include "file.h"
@@ -90,19 +92,7 @@ static match_result match_protocol_tree(capture_file *cf, frame_data *fdata,
 static void match_subtree_text(proto_node *node, gpointer data);
 static match_result match_summary_line(capture_file *cf, frame_data *fdata,
         wtap_rec *, Buffer *, void *criterion);
-static match_result match_narrow_and_wide(capture_file *cf, frame_data *fdata,
-        wtap_rec *, Buffer *, void *criterion);
-static match_result match_narrow_and_wide_case(capture_file *cf, frame_data *fdata,
-        wtap_rec *, Buffer *, void *criterion);
-static match_result match_narrow(capture_file *cf, frame_data *fdata,
-        wtap_rec *, Buffer *, void *criterion);
-static match_result match_narrow_case(capture_file *cf, frame_data *fdata,
-        wtap_rec *, Buffer *, void *criterion);
-static match_result match_wide(capture_file *cf, frame_data *fdata,
-        wtap_rec *, Buffer *, void *criterion);
-static match_result match_wide_case(capture_file *cf, frame_data *fdata,
-        wtap_rec *, Buffer *, void *criterion);
-static match_result match_binary(capture_file *cf, frame_data *fdata,
+static match_result match_memsearch(capture_file *cf, frame_data *fdata,
         wtap_rec *, Buffer *, void *criterion);
 static match_result match_regex(capture_file *cf, frame_data *fdata,
         wtap_rec *, Buffer *, void *criterion);
@@ -1201,12 +1191,12 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     if (dfcode != NULL) {
         fdata->passed_dfilter = dfilter_apply_edt(dfcode, edt) ? 1 : 0;
 
-        if (fdata->passed_dfilter && edt->pi.fd->dependent_frames) {
+        if (fdata->passed_dfilter && frame_data_dependent_frames(edt->pi.fd)) {
             /* This frame passed the display filter but it may depend on other
              * (potentially not displayed) frames.  Find those frames and mark them
              * as depended upon.
              */
-            g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            g_hash_table_foreach(frame_data_dependent_frames(edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
         }
     } else
         fdata->passed_dfilter = 1;
@@ -2115,15 +2105,24 @@ typedef enum {
     PSP_FAILED
 } psp_return_t;
 
+/*
+ * Process the records selected by range (all of them if range is NULL),
+ * or, if frames is not NULL, just the frames in those ranges, which must
+ * be in increasing order and must not overlap. Frames outside the ranges
+ * are not read at all.
+ */
 static psp_return_t
-process_specified_records(capture_file *cf, packet_range_t *range,
+process_records(capture_file *cf, packet_range_t *range,
+        const range_t *frames,
         const char *string1, const char *string2, gboolean terminate_is_stop,
         gboolean (*callback)(capture_file *, frame_data *,
             wtap_rec *, Buffer *, void *),
         void *callback_args,
         gboolean show_progress_bar)
 {
-    guint32          framenum;
+    guint32          framenum = 0;
+    guint32          idx, total;
+    guint            r = 0;
     frame_data      *fdata;
     wtap_rec         rec;
     Buffer           buf;
@@ -2156,9 +2155,39 @@ process_specified_records(capture_file *cf, packet_range_t *range,
     if (range != NULL)
         packet_range_process_init(range);
 
+    if (frames != NULL) {
+        total = 0;
+        for (r = 0; r < frames->nranges; r++) {
+            if (frames->ranges[r].low <= frames->ranges[r].high)
+                total += frames->ranges[r].high - frames->ranges[r].low + 1;
+        }
+        r = 0;
+    } else {
+        total = cf->count;
+    }
+
     /* Iterate through all the packets, printing the packets that
        were selected by the current display filter.  */
-    for (framenum = 1; framenum <= cf->count; framenum++) {
+    for (idx = 0; idx < total; idx++) {
+        if (frames == NULL) {
+            framenum = idx + 1;
+        } else {
+            /* Step to the next frame, moving on to the next non-empty
+               range once this one is exhausted. */
+            if (idx == 0 || framenum >= frames->ranges[r].high) {
+                if (idx != 0)
+                    r++;
+                while (frames->ranges[r].low > frames->ranges[r].high)
+                    r++;
+                framenum = frames->ranges[r].low;
+            } else {
+                framenum++;
+            }
+        }
+        if (framenum == 0 || framenum > cf->count) {
+            /* The file changed since the frame list was made. */
+            continue;
+        }
         fdata = frame_data_sequence_find(cf->provider.frames, framenum);
 
         /* Create the progress bar if necessary.
@@ -2182,11 +2211,11 @@ process_specified_records(capture_file *cf, packet_range_t *range,
             /* let's not divide by zero. I should never be started
              * with count == 0, so let's assert that
              */
-            ws_assert(cf->count > 0);
-            progbar_val = (gfloat) progbar_count / cf->count;
+            ws_assert(total > 0);
+            progbar_val = (gfloat) progbar_count / total;
 
             snprintf(progbar_status_str, sizeof(progbar_status_str),
-                    "%4u of %u packets", progbar_count, cf->count);
+                    "%4u of %u packets", progbar_count, total);
             update_progress_dlg(progbar, progbar_val, progbar_status_str);
 
             g_timer_start(prog_timer);
@@ -2244,6 +2273,18 @@ process_specified_records(capture_file *cf, packet_range_t *range,
     return ret;
 }
 
+static psp_return_t
+process_specified_records(capture_file *cf, packet_range_t *range,
+        const char *string1, const char *string2, gboolean terminate_is_stop,
+        gboolean (*callback)(capture_file *, frame_data *,
+            wtap_rec *, Buffer *, void *),
+        void *callback_args,
+        gboolean show_progress_bar)
+{
+    return process_records(cf, range, NULL, string1, string2,
+            terminate_is_stop, callback, callback_args, show_progress_bar);
+}
+
 typedef struct {
     epan_dissect_t edt;
     column_info *cinfo;
@@ -2263,8 +2304,11 @@ retap_packet(capture_file *cf, frame_data *fdata, wtap_rec *rec, Buffer *buf,
     return TRUE;
 }
 
-cf_read_status_t
-cf_retap_packets(capture_file *cf)
+/*
+ * Retap the frames in the given ranges, or all frames if it is NULL.
+ */
+static cf_read_status_t
+retap_records(capture_file *cf, const range_t *frames)
 {
     packet_range_t        range;
     retap_callback_args_t callback_args;
@@ -2317,9 +2361,10 @@ cf_retap_packets(capture_file *cf)
     packet_range_init(&range, cf);
     packet_range_process_init(&range);
 
-    ret = process_specified_records(cf, &range, "Recalculating statistics on",
-            "all packets", TRUE, retap_packet,
-            &callback_args, TRUE);
+    ret = process_records(cf, &range, frames,
+            "Recalculating statistics on",
+            frames != NULL ? "selected packets" : "all packets", TRUE,
+            retap_packet, &callback_args, TRUE);
 
     packet_range_cleanup(&range);
     epan_dissect_cleanup(&callback_args.edt);
@@ -2345,6 +2390,66 @@ cf_retap_packets(capture_file *cf)
     return CF_READ_OK;
 }
 
+cf_read_status_t
+cf_retap_packets(capture_file *cf)
+{
+    return retap_records(cf, NULL);
+}
+
+cf_read_status_t
+cf_retap_frames(capture_file *cf, const guint32 *frames, guint num_frames)
+{
+    cf_read_status_t ret;
+    range_t *ranges;
+    guint idx;
+
+    /* Coalesce runs of consecutive frames into a single range. */
+    ranges = (range_t *)g_malloc(sizeof (range_t) +
+            (num_frames > 0 ? num_frames - 1 : 0) * sizeof (range_admin_t));
+    ranges->nranges = 0;
+    for (idx = 0; idx < num_frames; idx++) {
+        if (ranges->nranges > 0 &&
+                frames[idx] == ranges->ranges[ranges->nranges - 1].high + 1) {
+            ranges->ranges[ranges->nranges - 1].high = frames[idx];
+        } else {
+            ranges->ranges[ranges->nranges].low = frames[idx];
+            ranges->ranges[ranges->nranges].high = frames[idx];
+            ranges->nranges++;
+        }
+    }
+
+    ret = retap_records(cf, ranges);
+    g_free(ranges);
+    return ret;
+}
+
+cf_read_status_t
+cf_retap_stream(capture_file *cf, const char *stream_field, guint32 stream,
+        const void *tapdata)
+{
+    cf_read_status_t ret;
+    guint32 *frames;
+    guint num_frames;
+
+    /*
+     * Retapping resets every tap listener, so if there are any others
+     * (e.g. from open statistics dialogs), they have to see all frames.
+     */
+    if (have_other_tap_listeners(tapdata)) {
+        return cf_retap_packets(cf);
+    }
+
+    frames = stream_frames_get(stream_field, stream, &num_frames);
+    if (frames == NULL) {
+        /* No index for this kind of stream, or no frames recorded. */
+        return cf_retap_packets(cf);
+    }
+
+    ret = cf_retap_frames(cf, frames, num_frames);
+    g_free(frames);
+    return ret;
+}
+
 typedef struct {
     print_args_t *print_args;
     gboolean      print_header_line;
@@ -3306,19 +3411,12 @@ match_summary_line(capture_file *cf, frame_data *fdata,
     return result;
 }
 
-typedef struct {
-    const guint8 *data;
-    size_t        data_len;
-    ws_mempbrk_pattern *pattern;
-} cbs_t;    /* "Counted byte string" */
-
-
 /*
- * The current match_* routines only support ASCII case insensitivity and don't
- * convert UTF-8 inputs to UTF-16 for matching.  The UTF-16 support just
- * interleaves with \0 bytes, which works for 7 bit ASCII.
+ * The match_memsearch routine only supports ASCII case insensitivity and
+ * doesn't convert UTF-8 inputs to UTF-16 for matching.  The UTF-16 support
+ * just interleaves with \0 bytes, which works for 7 bit ASCII.
  *
- * We could modify them to use the GLib Unicode routines or the International
+ * We could modify it to use the GLib Unicode routines or the International
  * Components for Unicode library but it's not apparent that we could do so
  * without consuming a lot more CPU and memory or that searching would be
  * significantly better.
@@ -3332,434 +3430,60 @@ gboolean
 cf_find_packet_data(capture_file *cf, const guint8 *string, size_t string_size,
         search_direction dir)
 {
-    cbs_t  info;
-    guint8 needles[3];
-    ws_mempbrk_pattern pattern;
-
-    info.data = string;
-    info.data_len = string_size;
+    ws_memsearch_t *searcher;
+    guint8         *wide;
+    size_t          i;
+    gboolean        result;
 
     /* Regex, String or hex search? */
     if (cf->regex) {
         /* Regular Expression search */
         return find_packet(cf, match_regex, NULL, dir);
-    } else if (cf->string) {
-        /* String search - what type of string? */
-        if (cf->case_type) {
-            needles[0] = string[0];
-            needles[1] = g_ascii_tolower(needles[0]);
-            needles[2] = '\0';
-            ws_mempbrk_compile(&pattern, needles);
-            info.pattern = &pattern;
-            switch (cf->scs_type) {
-
-                case SCS_NARROW_AND_WIDE:
-                    return find_packet(cf, match_narrow_and_wide_case, &info, dir);
-
-                case SCS_NARROW:
-                    return find_packet(cf, match_narrow_case, &info, dir);
-
-                case SCS_WIDE:
-                    return find_packet(cf, match_wide_case, &info, dir);
-
-                default:
-                    ws_assert_not_reached();
-                    return FALSE;
-            }
-
-        } else {
-            switch (cf->scs_type) {
-
-                case SCS_NARROW_AND_WIDE:
-                    return find_packet(cf, match_narrow_and_wide, &info, dir);
-
-                case SCS_NARROW:
-                    return find_packet(cf, match_narrow, &info, dir);
-
-                case SCS_WIDE:
-                    return find_packet(cf, match_wide, &info, dir);
-
-                default:
-                    ws_assert_not_reached();
-                    return FALSE;
-            }
-        }
-    } else
-        return find_packet(cf, match_binary, &info, dir);
-}
-
-static match_result
-match_narrow_and_wide(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion)
-{
-    cbs_t        *info       = (cbs_t *)criterion;
-    const guint8 *ascii_text = info->data;
-    size_t        textlen    = info->data_len;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    guint8        c_char;
-    size_t        c_match    = 0;
-
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
-    }
-
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
-    buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)memchr(pd, ascii_text[0], buf_end - pd);
-        if (pd == NULL) break;
-        /* Try narrow match at this start location */
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = pd[i];
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-            } else {
-                break;
-            }
-        }
-
-        /* Now try wide match at the same start location. */
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = pd[i];
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-                i++;
-                if (pd + i >= buf_end || pd[i] != '\0') break;
-            } else {
-                break;
-            }
-        }
-    }
-
-done:
-    return result;
-}
-
-/* Case insensitive match */
-static match_result
-match_narrow_and_wide_case(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion)
-{
-    cbs_t        *info       = (cbs_t *)criterion;
-    const guint8 *ascii_text = info->data;
-    size_t        textlen    = info->data_len;
-    ws_mempbrk_pattern *pattern = info->pattern;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    guint8        c_char;
-    size_t        c_match    = 0;
-
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
     }
 
-    ws_assert(pattern != NULL);
-
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
-    buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)ws_mempbrk_exec(pd, buf_end - pd, pattern, &c_char);
-        if (pd == NULL) break;
-        /* Try narrow match at this start location */
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = g_ascii_toupper(pd[i]);
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-            } else {
-                break;
-            }
-        }
-
-        /* Now try wide match at the same start location. */
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = g_ascii_toupper(pd[i]);
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-                i++;
-                if (pd + i >= buf_end || pd[i] != '\0') break;
-            } else {
-                break;
-            }
-        }
+    if (!cf->string) {
+        /* Hex search */
+        searcher = ws_memsearch_new_single(string, string_size, 0);
+        result = find_packet(cf, match_memsearch, searcher, dir);
+        ws_memsearch_free(searcher);
+        return result;
     }
 
-done:
-    return result;
-}
+    /* String search - what type of string? */
+    searcher = ws_memsearch_new(cf->case_type ? WS_MEMSEARCH_NOCASE : 0);
 
-static match_result
-match_narrow(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion)
-{
-    cbs_t        *info       = (cbs_t *)criterion;
-    const guint8 *ascii_text = info->data;
-    size_t        textlen    = info->data_len;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    guint8        c_char;
-    size_t        c_match    = 0;
-
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
+    if (cf->scs_type == SCS_NARROW_AND_WIDE || cf->scs_type == SCS_NARROW) {
+        ws_memsearch_add(searcher, string, string_size);
     }
 
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
-    buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)memchr(pd, ascii_text[0], buf_end - pd);
-        if (pd == NULL) break;
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = pd[i];
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-            } else {
-                break;
+    if (cf->scs_type == SCS_NARROW_AND_WIDE || cf->scs_type == SCS_WIDE) {
+        /* "a\0b\0c": no trailing \0 is required after the last character. */
+        if (string_size > 0) {
+            wide = (guint8 *)g_malloc0(2 * string_size - 1);
+            for (i = 0; i < string_size; i++) {
+                wide[2 * i] = string[i];
             }
+            ws_memsearch_add(searcher, wide, 2 * string_size - 1);
+            g_free(wide);
         }
     }
 
-done:
-    return result;
-}
-
-/* Case insensitive match */
-static match_result
-match_narrow_case(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion)
-{
-    cbs_t        *info       = (cbs_t *)criterion;
-    const guint8 *ascii_text = info->data;
-    size_t        textlen    = info->data_len;
-    ws_mempbrk_pattern *pattern = info->pattern;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    guint8        c_char;
-    size_t        c_match    = 0;
-
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
-    }
-
-    ws_assert(pattern != NULL);
+    ws_assert(ws_memsearch_count(searcher) > 0 || string_size == 0);
+    ws_memsearch_compile(searcher);
 
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
-    buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)ws_mempbrk_exec(pd, buf_end - pd, pattern, &c_char);
-        if (pd == NULL) break;
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = g_ascii_toupper(pd[i]);
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-            } else {
-                break;
-            }
-        }
-    }
-
-done:
+    result = find_packet(cf, match_memsearch, searcher, dir);
+    ws_memsearch_free(searcher);
     return result;
 }
 
 static match_result
-match_wide(capture_file *cf, frame_data *fdata,
+match_memsearch(capture_file *cf, frame_data *fdata,
         wtap_rec *rec, Buffer *buf, void *criterion)
 {
-    cbs_t        *info       = (cbs_t *)criterion;
-    const guint8 *ascii_text = info->data;
-    size_t        textlen    = info->data_len;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    guint8        c_char;
-    size_t        c_match    = 0;
-
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
-    }
-
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
-    buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)memchr(pd, ascii_text[0], buf_end - pd);
-        if (pd == NULL) break;
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = pd[i];
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-                i++;
-                if (pd + i >= buf_end || pd[i] != '\0') break;
-            } else {
-                break;
-            }
-        }
-    }
-
-done:
-    return result;
-}
-
-/* Case insensitive match */
-static match_result
-match_wide_case(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion)
-{
-    cbs_t        *info       = (cbs_t *)criterion;
-    const guint8 *ascii_text = info->data;
-    size_t        textlen    = info->data_len;
-    ws_mempbrk_pattern *pattern = info->pattern;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    guint8        c_char;
-    size_t        c_match    = 0;
-
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
-    }
-
-    ws_assert(pattern != NULL);
-
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
-    buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)ws_mempbrk_exec(pd, buf_end - pd, pattern, &c_char);
-        if (pd == NULL) break;
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            c_char = g_ascii_toupper(pd[i]);
-            if (c_char == ascii_text[c_match]) {
-                c_match++;
-                if (c_match == textlen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-                i++;
-                if (pd + i >= buf_end || pd[i] != '\0') break;
-            } else {
-                break;
-            }
-        }
-    }
-
-done:
-    return result;
-}
-
-static match_result
-match_binary(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion)
-{
-    cbs_t        *info        = (cbs_t *)criterion;
-    const guint8 *binary_data = info->data;
-    size_t        datalen     = info->data_len;
-    match_result  result;
-    guint32       buf_len;
-    guint8       *pd, *buf_start, *buf_end;
-    guint32       i;
-    size_t        c_match     = 0;
+    ws_memsearch_t *searcher = (ws_memsearch_t *)criterion;
+    const guint8   *buf_start, *found;
+    guint           pattern_idx;
+    guint32         match_len;
 
     /* Load the frame's data. */
     if (!cf_read_record(cf, fdata, rec, buf)) {
@@ -3767,36 +3491,17 @@ match_binary(capture_file *cf, frame_data *fdata,
         return MR_ERROR;
     }
 
-    result = MR_NOTMATCHED;
-    buf_len = fdata->cap_len;
     buf_start = ws_buffer_start_ptr(buf);
-    buf_end = buf_start + buf_len;
-    /* Not clear if using memcmp() is faster. memmem() on systems that
-     * have it should be faster, though.
-     */
-    for (pd = buf_start; pd < buf_end; pd++) {
-        pd = (guint8 *)memchr(pd, binary_data[0], buf_end - pd);
-        if (pd == NULL) break;
-        c_match = 0;
-        for (i = 0; pd + i < buf_end; i++) {
-            if (pd[i] == binary_data[c_match]) {
-                c_match++;
-                if (c_match == datalen) {
-                    result = MR_MATCHED;
-                    cf->search_pos = i + (guint32)(pd - buf_start);
-                    /* Save the position of the last character
-                       for highlighting the field. */
-                    cf->search_len = i + 1;
-                    goto done;
-                }
-            } else {
-                break;
-            }
-        }
+    found = ws_memsearch_exec(searcher, buf_start, fdata->cap_len, &pattern_idx);
+    if (found == NULL) {
+        return MR_NOTMATCHED;
     }
 
-done:
-    return result;
+    match_len = (guint32)ws_memsearch_pattern_len(searcher, pattern_idx);
+    /* Save the position of the last character for highlighting the field. */
+    cf->search_pos = (guint32)(found - buf_start) + match_len - 1;
+    cf->search_len = match_len;
+    return MR_MATCHED;
 }
 
 static match_result
@@ -4457,9 +4162,9 @@ save_record(capture_file *cf, frame_data *fdata, wtap_rec *rec,
     new_rec.block  = pkt_block;
     new_rec.block_was_modified = fdata->has_modified_block ? TRUE : FALSE;
 
-    if (!nstime_is_zero(&fdata->shift_offset)) {
+    if (!nstime_is_zero(frame_data_shift_offset(fdata))) {
         if (new_rec.presence_flags & WTAP_HAS_TS) {
-            nstime_add(&new_rec.ts, &fdata->shift_offset);
+            nstime_add(&new_rec.ts, frame_data_shift_offset(fdata));
         }
     }
 
@@ -4482,7 +4187,9 @@ save_record(capture_file *cf, frame_data *fdata, wtap_rec *rec,
      * If we're exporting to a different file, then don't do that.
      */
     if (!args->export && new_rec.presence_flags & WTAP_HAS_TS) {
-        nstime_set_zero(&fdata->shift_offset);
+        nstime_t no_shift = NSTIME_INIT_ZERO;
+
+        frame_data_set_shift_offset(fdata, &no_shift);
     }
 
     return TRUE;
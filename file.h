@@ -424,6 +424,33 @@ void cf_redissect_packets(capture_file *cf);
  */
 cf_read_status_t cf_retap_packets(capture_file *cf);
 
+/**
+ * Like cf_retap_packets(), but only read and dissect some of the frames.
+ *
+ * @param cf the capture file
+ * @param frames the frame numbers, in increasing order
+ * @param num_frames the number of frames
+ * @return one of cf_read_status_t
+ */
+cf_read_status_t cf_retap_frames(capture_file *cf, const guint32 *frames, guint num_frames);
+
+/**
+ * Retap just the frames that belong to a stream, as recorded by the
+ * dissector that numbers the streams (see epan/stream_frames.h). Falls
+ * back to cf_retap_packets() if the dissector keeps no frame lists, or
+ * if tap listeners other than the caller's are registered, since every
+ * listener is reset. The tap listener should still filter on the stream,
+ * since the frame lists only narrow down the frames that are read.
+ *
+ * @param cf the capture file
+ * @param stream_field the stream number field, e.g. "tcp.stream"
+ * @param stream the stream number
+ * @param tapdata the tapdata of the caller's tap listener
+ * @return one of cf_read_status_t
+ */
+cf_read_status_t cf_retap_stream(capture_file *cf, const char *stream_field, guint32 stream,
+        const void *tapdata);
+
 /* print_range, enum which frames should be printed */
 typedef enum {
     print_range_selected_only,    /* selected frame(s) only (currently only one) */
@@ -22,6 +22,7 @@
 #include <wiretap/wtap.h>
 
 #include <wsutil/cmdarg_err.h>
+#include <wsutil/clopts_common.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/file_util.h>
 #include <wsutil/privileges.h>
@@ -50,6 +51,10 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
     fprintf(output, "  -n        don't write to output file if the input file is ordered.\n");
+    fprintf(output, "  -w <frames>\n");
+    fprintf(output, "            reorder reading the input file sequentially, with at most\n");
+    fprintf(output, "            <frames> frames in memory; frames further out of order\n");
+    fprintf(output, "            are sorted using temporary files.\n");
     fprintf(output, "  -h        display this help and exit.\n");
     fprintf(output, "  -v        print version information and exit.\n");
 }
@@ -104,7 +109,9 @@ frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
     /* Copy, and set length and timestamp from item. */
     /* TODO: remove when wtap_seek_read() fills in rec,
        including time stamps, for all file types  */
-    rec->ts = frame->frame_time;
+    if (!nstime_is_unset(&frame->frame_time)) {
+        rec->ts = frame->frame_time;
+    }
 
     /* Dump frame to outfile */
     if (!wtap_dump(pdh, rec, ws_buffer_start_ptr(buf), &err, &err_info)) {
@@ -132,6 +139,544 @@ frames_compare(gconstpointer a, gconstpointer b)
     return nstime_cmp(time1, time2);
 }
 
+/**************************************************/
+/* Reordering in a single pass (-w)               */
+
+/*
+ * Instead of remembering every frame and re-reading them in sorted order,
+ * which seeks all over the input file, the frames can be read into a
+ * window of a fixed number of frames that's kept as a heap; whenever the
+ * window is full, the oldest frame in it is written. As long as no frame
+ * is further out of order than the window size, that sorts the file in
+ * one sequential pass.
+ *
+ * If some frames are, the frames are sorted externally instead: the same
+ * window is used to write sorted runs (replacement selection; a frame
+ * older than the last one written goes into the next run) to temporary
+ * pcapng files, which are then merged into the output file.
+ *
+ * pcapng files give every packet a time stamp, so frames without one
+ * can't be told apart when reading a run back. They sort before all
+ * others, though, so they're the first frames of each run, and it's
+ * enough to remember how many of them a run has.
+ */
+
+/* The number of temporary files merged at the same time. */
+#define MAX_MERGE_RUNS 64
+
+typedef struct FrameKey_t {
+    nstime_t     frame_time;
+    guint        num;       /* keeps frames with the same time stamp in order */
+    guint        run;       /* sorted run the frame goes to */
+} FrameKey_t;
+
+/* A frame in the window */
+typedef struct HeldFrame_t {
+    FrameKey_t   key;       /* must be first, see frame_keys_compare() */
+    wtap_rec     rec;
+    Buffer       buf;
+} HeldFrame_t;
+
+/* A temporary file being merged */
+typedef struct RunReader_t {
+    wtap        *wth;
+    guint        index;     /* keeps frames with the same time stamp in order */
+    guint        no_ts_left; /* frames without a time stamp not read yet */
+    nstime_t     frame_time; /* time stamp the current frame is sorted by */
+    wtap_rec     rec;
+    Buffer       buf;
+} RunReader_t;
+
+/* Order frames by run, time stamp and frame number. */
+static int
+frame_keys_compare(gconstpointer a, gconstpointer b)
+{
+    const FrameKey_t *key1 = (const FrameKey_t *) a;
+    const FrameKey_t *key2 = (const FrameKey_t *) b;
+    int cmp;
+
+    if (key1->run != key2->run)
+        return key1->run < key2->run ? -1 : 1;
+    cmp = nstime_cmp(&key1->frame_time, &key2->frame_time);
+    if (cmp != 0)
+        return cmp;
+    if (key1->num != key2->num)
+        return key1->num < key2->num ? -1 : 1;
+    return 0;
+}
+
+/* Order the next frames of the runs being merged. */
+static int
+run_readers_compare(gconstpointer a, gconstpointer b)
+{
+    const RunReader_t *reader1 = (const RunReader_t *) a;
+    const RunReader_t *reader2 = (const RunReader_t *) b;
+    int cmp;
+
+    cmp = nstime_cmp(&reader1->frame_time, &reader2->frame_time);
+    if (cmp != 0)
+        return cmp;
+    if (reader1->index != reader2->index)
+        return reader1->index < reader2->index ? -1 : 1;
+    return 0;
+}
+
+/* Add an item to a binary heap kept in a pointer array. */
+static void
+heap_push(GPtrArray *heap, gpointer item, GCompareFunc compare)
+{
+    guint i, parent;
+
+    g_ptr_array_add(heap, item);
+    for (i = heap->len - 1; i > 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (compare(heap->pdata[parent], item) <= 0)
+            break;
+        heap->pdata[i] = heap->pdata[parent];
+    }
+    heap->pdata[i] = item;
+}
+
+/* Remove the smallest item from a binary heap kept in a pointer array. */
+static gpointer
+heap_pop(GPtrArray *heap, GCompareFunc compare)
+{
+    gpointer top = heap->pdata[0];
+    gpointer last = g_ptr_array_remove_index(heap, heap->len - 1);
+    guint i, child;
+
+    if (heap->len == 0)
+        return top;
+    for (i = 0; (child = 2 * i + 1) < heap->len; i = child) {
+        if (child + 1 < heap->len &&
+            compare(heap->pdata[child + 1], heap->pdata[child]) < 0)
+            child++;
+        if (compare(last, heap->pdata[child]) <= 0)
+            break;
+        heap->pdata[i] = heap->pdata[child];
+    }
+    heap->pdata[i] = last;
+    return top;
+}
+
+static void
+set_frame_key(FrameKey_t *key, const wtap_rec *rec, guint num)
+{
+    key->num = num;
+    if (rec != NULL && (rec->presence_flags & WTAP_HAS_TS)) {
+        key->frame_time = rec->ts;
+    } else {
+        nstime_set_unset(&key->frame_time);
+    }
+    key->run = 0;
+}
+
+/*
+ * Read the input file, counting the frames that are out of order and
+ * finding out whether the window is large enough to sort them in one
+ * pass. Only the time stamps of the frames in the window are kept.
+ */
+static gboolean
+scan_frames(wtap *wth, const char *infile, guint window,
+            guint *frame_count, guint *wrong_order_count)
+{
+    FrameKey_t *keys = g_new(FrameKey_t, window);
+    GPtrArray *heap = g_ptr_array_sized_new(window);
+    FrameKey_t key, prev_key;
+    nstime_t last_time;
+    gboolean have_last = FALSE;
+    gboolean fits = TRUE;
+    wtap_rec rec;
+    Buffer buf;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    *frame_count = 0;
+    *wrong_order_count = 0;
+    nstime_set_zero(&last_time);
+    set_frame_key(&prev_key, NULL, 0);
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    while (wtap_read(wth, &rec, &buf, &err, &err_info, &data_offset)) {
+        set_frame_key(&key, &rec, ++*frame_count);
+        if (*frame_count > 1 && nstime_cmp(&key.frame_time, &prev_key.frame_time) < 0) {
+            (*wrong_order_count)++;
+        }
+        prev_key = key;
+
+        if (fits) {
+            FrameKey_t *slot;
+
+            if (heap->len == window) {
+                /* This frame would be written now. */
+                slot = (FrameKey_t *)heap_pop(heap, frame_keys_compare);
+                last_time = slot->frame_time;
+                have_last = TRUE;
+            } else {
+                slot = &keys[heap->len];
+            }
+            if (have_last && nstime_cmp(&key.frame_time, &last_time) < 0) {
+                DEBUG_PRINT("Frame %u is further out of order than the window\n", key.num);
+                fits = FALSE;
+            }
+            *slot = key;
+            heap_push(heap, slot, frame_keys_compare);
+        }
+        wtap_rec_reset(&rec);
+    }
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    if (err != 0) {
+      /* Print a message noting that the read failed somewhere along the line. */
+      cfile_read_failure_message(infile, err, err_info);
+    }
+
+    g_ptr_array_free(heap, TRUE);
+    g_free(keys);
+    return fits;
+}
+
+static wtap_dumper *
+run_open(wtap *wth, const wtap_dump_params *params, char **run_name)
+{
+    wtap_dump_params run_params = *params;
+    wtap_dumper *run_pdh;
+    int err;
+    gchar *err_info;
+
+    /* The name resolution and decryption secrets go to the output file only. */
+    run_params.nrbs_growing = NULL;
+    run_params.dsbs_initial = NULL;
+    run_params.dsbs_growing = NULL;
+    run_params.idb_inf = wtap_file_get_idb_info(wth);
+    run_pdh = wtap_dump_open_tempfile(NULL, run_name, "reordercap",
+                                      wtap_pcapng_file_type_subtype(),
+                                      WTAP_UNCOMPRESSED, &run_params, &err, &err_info);
+    g_free(run_params.idb_inf);
+    if (run_pdh == NULL) {
+        cfile_dump_open_failure_message(*run_name != NULL ? *run_name : "temporary file",
+                                        err, err_info, wtap_pcapng_file_type_subtype());
+        g_free(*run_name);
+        *run_name = NULL;
+    }
+    return run_pdh;
+}
+
+static gboolean
+run_close(wtap_dumper *run_pdh, const char *run_name)
+{
+    int err;
+    gchar *err_info;
+
+    if (!wtap_dump_close(run_pdh, NULL, &err, &err_info)) {
+        cfile_close_failure_message(run_name, err, err_info);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Read the next frame of a run, giving back the frames that had no time
+ * stamp in the input file without one.
+ */
+static gboolean
+run_read(RunReader_t *reader, int *err, gchar **err_info)
+{
+    gint64 data_offset;
+
+    if (!wtap_read(reader->wth, &reader->rec, &reader->buf, err, err_info, &data_offset))
+        return FALSE;
+    if (reader->no_ts_left > 0) {
+        reader->no_ts_left--;
+        reader->rec.presence_flags &= ~WTAP_HAS_TS;
+        nstime_set_unset(&reader->frame_time);
+    } else {
+        reader->frame_time = reader->rec.ts;
+    }
+    return TRUE;
+}
+
+/*
+ * Merge sorted runs into pdh, and remove them. no_ts_counts gives the
+ * number of frames without a time stamp in each run. A frame that can't
+ * be written is reported by its number in the merged output.
+ */
+static gboolean
+runs_merge(char **run_names, const guint *no_ts_counts, guint num_runs,
+           wtap_dumper *pdh, const char *infile, const char *outfile)
+{
+    RunReader_t *readers = g_new0(RunReader_t, num_runs);
+    GPtrArray *heap = g_ptr_array_sized_new(num_runs);
+    gboolean ok = TRUE;
+    guint frame_num = 0;
+    guint i;
+    int err;
+    gchar *err_info;
+
+    for (i = 0; i < num_runs; i++) {
+        readers[i].index = i;
+        readers[i].no_ts_left = no_ts_counts[i];
+        wtap_rec_init(&readers[i].rec);
+        ws_buffer_init(&readers[i].buf, 1514);
+    }
+
+    for (i = 0; i < num_runs; i++) {
+        readers[i].wth = wtap_open_offline(run_names[i], WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+        if (readers[i].wth == NULL) {
+            cfile_open_failure_message(run_names[i], err, err_info);
+            ok = FALSE;
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < num_runs; i++) {
+        if (run_read(&readers[i], &err, &err_info)) {
+            heap_push(heap, &readers[i], run_readers_compare);
+        } else if (err != 0) {
+            cfile_read_failure_message(run_names[i], err, err_info);
+            ok = FALSE;
+            goto cleanup;
+        }
+    }
+
+    while (heap->len > 0) {
+        RunReader_t *reader = (RunReader_t *)heap_pop(heap, run_readers_compare);
+
+        frame_num++;
+        if (!wtap_dump(pdh, &reader->rec, ws_buffer_start_ptr(&reader->buf), &err, &err_info)) {
+            cfile_write_failure_message(infile, outfile, err, err_info, frame_num,
+                                        wtap_dump_file_type_subtype(pdh));
+            ok = FALSE;
+            goto cleanup;
+        }
+        wtap_rec_reset(&reader->rec);
+        if (run_read(reader, &err, &err_info)) {
+            heap_push(heap, reader, run_readers_compare);
+        } else if (err != 0) {
+            cfile_read_failure_message(run_names[reader->index], err, err_info);
+            ok = FALSE;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    for (i = 0; i < num_runs; i++) {
+        if (readers[i].wth != NULL)
+            wtap_close(readers[i].wth);
+        wtap_rec_cleanup(&readers[i].rec);
+        ws_buffer_free(&readers[i].buf);
+        ws_unlink(run_names[i]);
+    }
+    g_ptr_array_free(heap, TRUE);
+    g_free(readers);
+    return ok;
+}
+
+/*
+ * Read the input file again and write its frames in order, either
+ * directly to pdh if they fit in the window, or to sorted runs in
+ * temporary files that are then merged into pdh.
+ */
+static gboolean
+frames_write_in_window(wtap *wth, const char *infile, guint window, gboolean fits,
+                       const wtap_dump_params *params, wtap_dumper *pdh,
+                       const char *outfile)
+{
+    HeldFrame_t *frames = g_new0(HeldFrame_t, window);
+    GPtrArray *free_frames = g_ptr_array_sized_new(window);
+    GPtrArray *heap = g_ptr_array_sized_new(window);
+    GPtrArray *runs = g_ptr_array_new_with_free_func(g_free);
+    GPtrArray *merged_runs = NULL;
+    GArray *runs_no_ts = g_array_new(FALSE, FALSE, sizeof(guint));
+    GArray *merged_runs_no_ts = NULL;
+    wtap_dumper *run_pdh = NULL;
+    char *run_name = NULL;
+    guint run = 0;
+    guint no_ts_count = 0;
+    nstime_t last_time = NSTIME_INIT_ZERO;
+    gboolean have_last = FALSE;
+    gboolean eof = FALSE;
+    gboolean ok = TRUE;
+    guint num = 0;
+    guint i;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    for (i = 0; i < window; i++) {
+        wtap_rec_init(&frames[i].rec);
+        ws_buffer_init(&frames[i].buf, 1514);
+        g_ptr_array_add(free_frames, &frames[i]);
+    }
+
+    if (fits) {
+        run_pdh = pdh;
+    } else {
+        run_pdh = run_open(wth, params, &run_name);
+        if (run_pdh == NULL) {
+            ok = FALSE;
+            goto cleanup;
+        }
+    }
+
+    while (!eof || heap->len > 0) {
+        HeldFrame_t *frame;
+
+        if (eof || heap->len == window) {
+            /* Write the oldest frame. */
+            frame = (HeldFrame_t *)heap_pop(heap, frame_keys_compare);
+            if (frame->key.run != run) {
+                /* The run is done, start the next one. */
+                if (!run_close(run_pdh, run_name)) {
+                    run_pdh = NULL;
+                    ok = FALSE;
+                    goto cleanup;
+                }
+                g_ptr_array_add(runs, run_name);
+                g_array_append_val(runs_no_ts, no_ts_count);
+                run_name = NULL;
+                no_ts_count = 0;
+                run_pdh = run_open(wth, params, &run_name);
+                if (run_pdh == NULL) {
+                    ok = FALSE;
+                    goto cleanup;
+                }
+                run = frame->key.run;
+            }
+
+            if (!wtap_dump(run_pdh, &frame->rec, ws_buffer_start_ptr(&frame->buf), &err, &err_info)) {
+                cfile_write_failure_message(infile, run_pdh == pdh ? outfile : run_name,
+                                            err, err_info, frame->key.num,
+                                            wtap_dump_file_type_subtype(run_pdh));
+                ok = FALSE;
+                goto cleanup;
+            }
+            if (nstime_is_unset(&frame->key.frame_time))
+                no_ts_count++;
+            last_time = frame->key.frame_time;
+            have_last = TRUE;
+            wtap_rec_reset(&frame->rec);
+            g_ptr_array_add(free_frames, frame);
+            continue;
+        }
+
+        frame = (HeldFrame_t *)g_ptr_array_remove_index(free_frames, free_frames->len - 1);
+        if (!wtap_read(wth, &frame->rec, &frame->buf, &err, &err_info, &data_offset)) {
+            if (err != 0) {
+                /* Print a message noting that the read failed somewhere along the line. */
+                cfile_read_failure_message(infile, err, err_info);
+            }
+            g_ptr_array_add(free_frames, frame);
+            eof = TRUE;
+            continue;
+        }
+        set_frame_key(&frame->key, &frame->rec, ++num);
+        if (have_last && nstime_cmp(&frame->key.frame_time, &last_time) < 0) {
+            /*
+             * It's too late to write the frame in this run. When writing
+             * directly to the output file, that can only happen if the
+             * input file changed after it was scanned.
+             */
+            frame->key.run = fits ? run : run + 1;
+        } else {
+            frame->key.run = run;
+        }
+        heap_push(heap, frame, frame_keys_compare);
+    }
+
+    if (!fits) {
+        if (!run_close(run_pdh, run_name)) {
+            run_pdh = NULL;
+            ok = FALSE;
+            goto cleanup;
+        }
+        run_pdh = NULL;
+        g_ptr_array_add(runs, run_name);
+        g_array_append_val(runs_no_ts, no_ts_count);
+        run_name = NULL;
+
+        DEBUG_PRINT("Merging %u sorted runs\n", runs->len);
+
+        /*
+         * If there are too many runs to merge them at once, merge groups
+         * of consecutive runs first. The runs stay in order, so frames
+         * with the same time stamp do too.
+         */
+        while (runs->len > MAX_MERGE_RUNS) {
+            merged_runs = g_ptr_array_new_with_free_func(g_free);
+            merged_runs_no_ts = g_array_new(FALSE, FALSE, sizeof(guint));
+            for (i = 0; i < runs->len; i += MAX_MERGE_RUNS) {
+                guint num_runs = MIN(MAX_MERGE_RUNS, runs->len - i);
+                guint j;
+
+                run_pdh = run_open(wth, params, &run_name);
+                if (run_pdh == NULL) {
+                    ok = FALSE;
+                    goto cleanup;
+                }
+                ok = runs_merge((char **)&runs->pdata[i], &g_array_index(runs_no_ts, guint, i),
+                                num_runs, run_pdh, infile, run_name);
+                if (!run_close(run_pdh, run_name) || !ok) {
+                    run_pdh = NULL;
+                    ok = FALSE;
+                    goto cleanup;
+                }
+                run_pdh = NULL;
+                g_ptr_array_add(merged_runs, run_name);
+                run_name = NULL;
+                no_ts_count = 0;
+                for (j = i; j < i + num_runs; j++)
+                    no_ts_count += g_array_index(runs_no_ts, guint, j);
+                g_array_append_val(merged_runs_no_ts, no_ts_count);
+            }
+            g_ptr_array_free(runs, TRUE);
+            runs = merged_runs;
+            merged_runs = NULL;
+            g_array_free(runs_no_ts, TRUE);
+            runs_no_ts = merged_runs_no_ts;
+            merged_runs_no_ts = NULL;
+        }
+        ok = runs_merge((char **)runs->pdata, (const guint *)runs_no_ts->data, runs->len,
+                        pdh, infile, outfile);
+        g_ptr_array_set_size(runs, 0);
+    }
+
+cleanup:
+    if (run_pdh != NULL && run_pdh != pdh) {
+        if (!wtap_dump_close(run_pdh, NULL, &err, &err_info))
+            g_free(err_info);
+    }
+    if (run_name != NULL) {
+        ws_unlink(run_name);
+        g_free(run_name);
+    }
+    /* Some of these may have been merged and removed already. */
+    for (i = 0; i < runs->len; i++) {
+        ws_unlink((const char *)runs->pdata[i]);
+    }
+    g_ptr_array_free(runs, TRUE);
+    if (merged_runs != NULL) {
+        for (i = 0; i < merged_runs->len; i++) {
+            ws_unlink((const char *)merged_runs->pdata[i]);
+        }
+        g_ptr_array_free(merged_runs, TRUE);
+    }
+    g_array_free(runs_no_ts, TRUE);
+    if (merged_runs_no_ts != NULL)
+        g_array_free(merged_runs_no_ts, TRUE);
+    for (i = 0; i < window; i++) {
+        wtap_rec_cleanup(&frames[i].rec);
+        ws_buffer_free(&frames[i].buf);
+    }
+    g_ptr_array_free(heap, TRUE);
+    g_ptr_array_free(free_frames, TRUE);
+    g_free(frames);
+    return ok;
+}
+/**************************************************/
+
 /*
  * General errors and warnings are reported with an console message
  * in reordercap.
@@ -182,6 +727,7 @@ main(int argc, char *argv[])
     gint64 data_offset;
     guint wrong_order_count = 0;
     gboolean write_output_regardless = TRUE;
+    guint32 window = 0;
     guint i;
     wtap_dump_params params;
     int                          ret = EXIT_SUCCESS;
@@ -234,11 +780,14 @@ main(int argc, char *argv[])
     wtap_init(TRUE);
 
     /* Process the options first */
-    while ((opt = ws_getopt_long(argc, argv, "hnv", long_options, NULL)) != -1) {
+    while ((opt = ws_getopt_long(argc, argv, "hnvw:", long_options, NULL)) != -1) {
         switch (opt) {
             case 'n':
                 write_output_regardless = FALSE;
                 break;
+            case 'w':
+                window = get_nonzero_guint32(ws_optarg, "reorder window");
+                break;
             case 'h':
                 show_help_header("Reorder timestamps of input file frames into output file.");
                 print_usage(stdout);
@@ -297,6 +846,31 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (window > 0) {
+        guint frame_count;
+        gboolean fits;
+        wtap *seq_wth;
+
+        fits = scan_frames(wth, infile, window, &frame_count, &wrong_order_count);
+        printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
+
+        if (write_output_regardless || (wrong_order_count > 0)) {
+            /* Read the file again from the start. */
+            seq_wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+            if (seq_wth == NULL) {
+                cfile_open_failure_message(infile, err, err_info);
+                ret = WS_EXIT_OPEN_ERROR;
+            } else {
+                if (!frames_write_in_window(seq_wth, infile, window, fits, &params, pdh, outfile))
+                    ret = OUTPUT_FILE_ERROR;
+                wtap_close(seq_wth);
+            }
+        } else {
+            printf("Not writing output file because input file is already in order.\n");
+        }
+        goto close_outfile;
+    }
+
     /* Allocate the array of frame pointers. */
     frames = g_ptr_array_new();
 
@@ -359,6 +933,7 @@ main(int argc, char *argv[])
     /* Free the whole array */
     g_ptr_array_free(frames, TRUE);
 
+close_outfile:
     /* Close outfile */
     if (!wtap_dump_close(pdh, NULL, &err, &err_info)) {
         cfile_close_failure_message(outfile, err, err_info);
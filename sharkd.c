@@ -315,8 +315,8 @@ process_packet(capture_file *cf, epan_dissect_t *edt,
          * if a display filter was given and it matches this packet.
          */
         if (edt && cf->dfcode) {
-            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            if (dfilter_apply_edt(cf->dfcode, edt) && frame_data_dependent_frames(edt->pi.fd)) {
+                g_hash_table_foreach(frame_data_dependent_frames(edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
             }
         }
 
@@ -568,8 +568,16 @@ sharkd_dissect_request(guint32 framenum, guint32 frame_ref_num,
 
 int
 sharkd_retap(void)
+{
+    return sharkd_retap_frames(NULL);
+}
+
+int
+sharkd_retap_frames(const range_t *frames)
 {
     guint32          framenum;
+    guint32          prev_framenum = 0;
+    guint            r;
     frame_data      *fdata;
     Buffer           buf;
     wtap_rec         rec;
@@ -604,22 +612,41 @@ sharkd_retap(void)
 
     reset_tap_listeners();
 
-    for (framenum = 1; framenum <= cfile.count; framenum++) {
-        fdata = sharkd_get_frame(framenum);
-
-        if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
-            break;
-
-        fdata->ref_time = FALSE;
-        fdata->frame_ref_num = (framenum != 1) ? 1 : 0;
-        fdata->prev_dis_num = framenum - 1;
-        epan_dissect_run_with_taps(&edt, cfile.cd_t, &rec,
-                frame_tvbuff_new_buffer(&cfile.provider, fdata, &buf),
-                fdata, cinfo);
-        wtap_rec_reset(&rec);
-        epan_dissect_reset(&edt);
+    /*
+     * Without ranges, retap every frame. With ranges, only the frames
+     * in them are read, so that a statistic over part of the capture
+     * costs only as much as that part.
+     */
+    for (r = 0; frames == NULL ? r < 1 : r < frames->nranges; r++) {
+        guint32 low = frames == NULL ? 1 : frames->ranges[r].low;
+        guint32 high = frames == NULL ? cfile.count : frames->ranges[r].high;
+
+        /* The ranges must be in increasing order; don't retap a frame twice. */
+        if (low <= prev_framenum)
+            low = prev_framenum + 1;
+        if (high > cfile.count)
+            high = cfile.count;
+
+        for (framenum = low; framenum <= high; framenum++) {
+            fdata = sharkd_get_frame(framenum);
+
+            if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
+                goto done;
+
+            fdata->ref_time = FALSE;
+            fdata->frame_ref_num = (framenum != 1) ? 1 : 0;
+            fdata->prev_dis_num = framenum - 1;
+            epan_dissect_run_with_taps(&edt, cfile.cd_t, &rec,
+                    frame_tvbuff_new_buffer(&cfile.provider, fdata, &buf),
+                    fdata, cinfo);
+            wtap_rec_reset(&rec);
+            epan_dissect_reset(&edt);
+            prev_framenum = framenum;
+        }
     }
 
+done:
+
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
     epan_dissect_cleanup(&edt);
@@ -645,6 +672,7 @@ sharkd_filter(const char *dftext, guint8 **result)
     guint8  passed_bits;
 
     epan_dissect_t edt;
+    nstime_t start, end;
 
     if (!dfilter_compile(dftext, &dfcode, NULL)) {
         return -1;
@@ -658,6 +686,27 @@ sharkd_filter(const char *dftext, guint8 **result)
 
     frames_count = cfile.count;
 
+    if (dfilter_get_frame_time_window(dfcode, &start, &end)) {
+        /*
+         * The filter only looks at the frame time stamps, so the time
+         * stamp index tells us which frames pass without dissecting them.
+         */
+        range_t *frames = frame_data_sequence_find_time_range(cfile.provider.frames, NULL,
+                nstime_is_unset(&start) ? NULL : &start,
+                nstime_is_unset(&end) ? NULL : &end);
+        guint r;
+
+        result_bits = (guint8 *) g_malloc0(2 + (frames_count / 8));
+        for (r = 0; r < frames->nranges; r++) {
+            for (framenum = frames->ranges[r].low; framenum <= frames->ranges[r].high; framenum++)
+                result_bits[framenum / 8] |= 1 << (framenum % 8);
+        }
+        wmem_free(NULL, frames);
+        dfilter_free(dfcode);
+        *result = result_bits;
+        return 0;
+    }
+
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
     epan_dissect_init(&edt, cfile.epan, TRUE, FALSE);
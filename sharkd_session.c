@@ -409,6 +409,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"intervals",  "filter",     2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
         {"iograph",    "interval",   2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, OPTIONAL},
         {"iograph",    "filter",     2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
+        {"iograph",    "frames",     2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
         {"iograph",    "graph0",     2, JSMN_STRING,       SHARKD_JSON_STRING,   MANDATORY},
         {"iograph",    "graph1",     2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
         {"iograph",    "graph2",     2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
@@ -450,6 +451,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"tap",        "tap13",      2, JSMN_STRING,       SHARKD_JSON_STRING, OPTIONAL},
         {"tap",        "tap14",      2, JSMN_STRING,       SHARKD_JSON_STRING, OPTIONAL},
         {"tap",        "tap15",      2, JSMN_STRING,       SHARKD_JSON_STRING, OPTIONAL},
+        {"tap",        "frames",     2, JSMN_STRING,       SHARKD_JSON_STRING, OPTIONAL},
 
         // End of the name_array
         {NULL,         NULL,         0, JSMN_STRING,       SHARKD_ARRAY_END,   OPTIONAL},
@@ -2774,6 +2776,55 @@ sharkd_session_process_tap_rtp_cb(void *arg)
     json_dumper_end_object(&dumper);
 }
 
+static int
+sharkd_session_range_compare(const void *a, const void *b)
+{
+    const range_admin_t *ra = (const range_admin_t *)a;
+    const range_admin_t *rb = (const range_admin_t *)b;
+
+    if (ra->low != rb->low)
+        return ra->low < rb->low ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Parse the optional "frames" attribute, a list of frame number ranges
+ * such as "1-100,250-300", which limits a retap to part of the capture.
+ * The ranges are sorted and overlapping ones merged, as the retap reads
+ * the frames in increasing order. *frames is set to NULL if there is no
+ * attribute.
+ */
+static gboolean
+sharkd_session_get_frames_range(char *buf, const jsmntok_t *tokens, int count, range_t **frames)
+{
+    const char *tok_frames = json_find_attr(buf, tokens, count, "frames");
+    range_t *range;
+    guint i, n;
+
+    *frames = NULL;
+    if (!tok_frames)
+        return TRUE;
+
+    if (range_convert_str(NULL, &range, tok_frames, cfile.count) != CVT_NO_ERROR)
+        return FALSE;
+
+    qsort(range->ranges, range->nranges, sizeof(range_admin_t), sharkd_session_range_compare);
+    for (i = 0, n = 0; i < range->nranges; i++)
+    {
+        if (n > 0 && range->ranges[i].low <= range->ranges[n - 1].high + 1)
+        {
+            if (range->ranges[i].high > range->ranges[n - 1].high)
+                range->ranges[n - 1].high = range->ranges[i].high;
+        }
+        else
+            range->ranges[n++] = range->ranges[i];
+    }
+    range->nranges = n;
+
+    *frames = range;
+    return TRUE;
+}
+
 /**
  * sharkd_session_process_tap()
  *
@@ -2782,6 +2833,7 @@ sharkd_session_process_tap_rtp_cb(void *arg)
  * Input:
  *   (m) tap0         - First tap request
  *   (o) tap1...tap15 - Other tap requests
+ *   (o) frames       - Only tap these frames, e.g. "1-100,250-300", default: all frames
  *
  * Output object with attributes:
  *   (m) taps  - array of object with attributes:
@@ -2808,6 +2860,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
     void *taps_data[16];
     GFreeFunc taps_free[16];
     int taps_count = 0;
+    range_t *frames;
     int i;
 
     rtpstream_tapinfo_t rtp_tapinfo =
@@ -3158,11 +3211,22 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
         return;
     }
 
-    sharkd_json_result_prologue(rpcid);
-    sharkd_json_array_open("taps");
-    sharkd_retap();
-    sharkd_json_array_close();
-    sharkd_json_result_epilogue();
+    if (!sharkd_session_get_frames_range(buf, tokens, count, &frames))
+    {
+        sharkd_json_error(
+                rpcid, -11014, NULL,
+                "sharkd_session_process_tap() invalid frames range"
+                );
+    }
+    else
+    {
+        sharkd_json_result_prologue(rpcid);
+        sharkd_json_array_open("taps");
+        sharkd_retap_frames(frames);
+        sharkd_json_array_close();
+        sharkd_json_result_epilogue();
+        wmem_free(NULL, frames);
+    }
 
     for (i = 0; i < taps_count; i++)
     {
@@ -3656,6 +3720,7 @@ sharkd_iograph_packet(void *g, packet_info *pinfo, epan_dissect_t *edt, const vo
  *   (o) graph1...graph9    - Other graph requests
  *   (o) filter0            - First graph filter
  *   (o) filter1...filter9  - Other graph filters
+ *   (o) frames   - only graph these frames, e.g. "1-100,250-300", default: all frames
  *
  * Graph requests can be one of: "packets", "bytes", "bits", "sum:<field>", "frames:<field>", "max:<field>", "min:<field>", "avg:<field>", "load:<field>",
  * if you use variant with <field>, you need to pass field name in filter request.
@@ -3672,6 +3737,7 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
     struct sharkd_iograph graphs[10];
     gboolean is_any_ok = FALSE;
     int graph_count;
+    range_t *frames;
 
     guint32 interval_ms = 1000; /* default: one per second */
     int i;
@@ -3679,6 +3745,15 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
     if (tok_interval)
         ws_strtou32(tok_interval, NULL, &interval_ms);
 
+    if (!sharkd_session_get_frames_range(buf, tokens, count, &frames))
+    {
+        sharkd_json_error(
+                rpcid, -6002, NULL,
+                "sharkd_session_process_iograph() invalid frames range"
+                );
+        return;
+    }
+
     for (i = graph_count = 0; i < (int) G_N_ELEMENTS(graphs); i++)
     {
         struct sharkd_iograph *graph = &graphs[graph_count];
@@ -3744,6 +3819,7 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
                     "%s", graph->error->str
                     );
             g_string_free(graph->error, TRUE);
+            wmem_free(NULL, frames);
             return;
         }
 
@@ -3753,7 +3829,8 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
 
     /* retap only if we have at least one ok */
     if (is_any_ok)
-        sharkd_retap();
+        sharkd_retap_frames(frames);
+    wmem_free(NULL, frames);
 
     sharkd_json_result_prologue(rpcid);
 
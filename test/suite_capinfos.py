@@ -0,0 +1,46 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Capinfos tests'''
+
+import hashlib
+import re
+import subprocess
+import pytest
+
+
+class TestCapinfosHashes:
+    @pytest.mark.parametrize('capture_name', ('dhcp.pcap', 'dhcp.pcapng', 'dhe1.pcapng.gz'))
+    def test_capinfos_hashes(self, cmd_capinfos, capture_file, capture_name, test_env):
+        '''The hashes are those of the file as stored, read in the same pass as the infos'''
+        cap_file = capture_file(capture_name)
+        with open(cap_file, 'rb') as f:
+            data = f.read()
+        stdout = subprocess.check_output((cmd_capinfos, '-H', cap_file), encoding='utf-8', env=test_env)
+        assert re.search(r'^SHA256:\s+(\w+)$', stdout, re.MULTILINE).group(1) == hashlib.sha256(data).hexdigest()
+        assert re.search(r'^SHA1:\s+(\w+)$', stdout, re.MULTILINE).group(1) == hashlib.sha1(data).hexdigest()
+
+
+class TestCapinfosJobs:
+    def test_capinfos_jobs_same_output(self, cmd_capinfos, capture_file, result_file, test_env):
+        '''-j prints the same infos, in the same order, as reading the files one after another'''
+        unreadable_file = result_file('unreadable.pcap')
+        with open(unreadable_file, 'w') as f:
+            f.write('This is not a capture file.\n')
+        cap_files = [capture_file(name) for name in (
+            'dhcp.pcap', 'dhcp.pcapng', 'dhe1.pcapng.gz', 'rsasnakeoil2.pcap', 'dns+icmp.pcapng.gz',
+        )]
+        cap_files.insert(2, unreadable_file)
+        for table_args in ((), ('-T',)):
+            default_proc = subprocess.run((cmd_capinfos, '-H') + table_args + tuple(cap_files),
+                capture_output=True, encoding='utf-8', env=test_env)
+            jobs_proc = subprocess.run((cmd_capinfos, '-H', '-j', '4') + table_args + tuple(cap_files),
+                capture_output=True, encoding='utf-8', env=test_env)
+            assert default_proc.returncode != 0
+            assert jobs_proc.returncode == default_proc.returncode
+            assert jobs_proc.stdout == default_proc.stdout
+            assert jobs_proc.stderr == default_proc.stderr
+            if not table_args:
+                assert default_proc.stdout.count('File name:') == len(cap_files) - 1
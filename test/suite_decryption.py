@@ -10,6 +10,7 @@
 
 import os.path
 import shutil
+import struct
 import subprocess
 from subprocesstest import grep_output, count_output
 import sys
@@ -508,6 +509,113 @@ class TestDecryptTLS:
             ), encoding='utf-8', env=test_env)
         assert grep_output(stdout, 'TLS13-CHACHA20-POLY1305-SHA256')
 
+    def test_tls_decrypted_data_limit(self, cmd_tshark, dirs, capture_file, test_env):
+        '''TLS records kept in a temporary file once over the memory limit are followed the same'''
+        key_file = os.path.join(dirs.key_dir, 'http2-data-reassembly.keys')
+        def follow(*args):
+            return subprocess.check_output((cmd_tshark,
+                    '-r', capture_file('http2-data-reassembly.pcap'),
+                    '-o', 'tls.keylog_file: {}'.format(key_file),
+                    '-d', 'tcp.port==8443,tls',
+                    '-q',
+                    '-z', 'follow,tls,raw,0',
+                ) + args, encoding='utf-8', env=test_env)
+        for two_pass in ((), ('-2',)):
+            unlimited = follow(*two_pass)
+            # Raw output has two hex digits per byte, so this is well over
+            # the 1 KiB limit.
+            assert len(unlimited) > 8 * 1024
+            assert follow('-o', 'tls.decrypted_data_limit:1', *two_pass) == unlimited
+
+    def test_tls13_keylog_split_line(self, cmd_tshark, dirs, capture_file, result_file, test_env):
+        '''TLS 1.3 with a key log line that is written in two pieces.'''
+        key_file = os.path.join(dirs.key_dir, 'tls13-20-chacha20poly1305.keys')
+        pcap_file = capture_file('tls13-20-chacha20poly1305.pcap')
+        keylog_file = result_file('split.keys')
+        tshark_args = (cmd_tshark,
+            '-l',
+            '-o', 'tls.keylog_file: {}'.format(keylog_file),
+            '-Tfields',
+            '-e', 'frame.number',
+            '-e', 'tls.handshake.type',
+            '-e', 'tls.app_data_proto',
+        )
+        with open(key_file, 'rb') as f:
+            keys = f.read()
+        with open(pcap_file, 'rb') as f:
+            pcap = f.read()
+
+        shutil.copyfile(key_file, keylog_file)
+        expected = subprocess.check_output(tshark_args + ('-r', pcap_file),
+            encoding='utf-8', env=test_env)
+
+        # The keys are read at the Server Hello and Finished of the first
+        # session (frames 2 and 3) and of the second one (frames 10 and 11).
+        # The first key log line of the second session,
+        # SERVER_HANDSHAKE_TRAFFIC_SECRET, is cut in the middle of the secret
+        # and read in frame 3. The truncated secret is still valid hex, so it
+        # must be held back until the rest of the line is read in frame 10.
+        line_start = keys.index(b'SERVER_HANDSHAKE_TRAFFIC_SECRET 4cfd')
+        split_at = keys.index(b' ', line_start + 32) + 1 + 32
+        with open(keylog_file, 'wb') as f:
+            f.write(keys[:line_start])
+
+        frame_offsets = [24]
+        while frame_offsets[-1] < len(pcap):
+            offset = frame_offsets[-1]
+            frame_offsets.append(offset + 16 + struct.unpack_from('<I', pcap, offset + 8)[0])
+
+        proc = subprocess.Popen(tshark_args + ('-r', '-'),
+            stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+            encoding='utf-8', env=test_env)
+        actual = ''
+        fed = 0
+
+        def dissect_until(frame, keys_to_append):
+            '''Feeds the frames up to and including frame, waits until they
+            have been dissected, and then appends to the key log file.'''
+            nonlocal actual, fed
+            proc.stdin.buffer.write(pcap[fed:frame_offsets[frame]])
+            proc.stdin.flush()
+            fed = frame_offsets[frame]
+            line = None
+            while line is None or line.split('\t')[0] != str(frame):
+                line = proc.stdout.readline()
+                assert line, 'tshark exited early'
+                actual += line
+            with open(keylog_file, 'ab') as f:
+                f.write(keys_to_append)
+
+        dissect_until(2, keys[line_start:split_at])
+        dissect_until(8, keys[split_at:])
+        proc.stdin.buffer.write(pcap[fed:])
+        proc.stdin.close()
+        actual += proc.stdout.read()
+        assert proc.wait() == 0
+        assert expected == actual
+        # The Encrypted Extensions of the second session were decrypted.
+        assert any(int(fields[0]) >= 9 and '8' in fields[1].split(',')
+                   for fields in (line.split('\t') for line in actual.splitlines()))
+
+    def test_tls13_keylog_no_final_newline(self, cmd_tshark, dirs, capture_file, result_file, test_env):
+        '''TLS 1.3 with a key log file that does not end with a newline.'''
+        key_file = os.path.join(dirs.key_dir, 'tls13-20-chacha20poly1305.keys')
+        keylog_file = result_file('no-newline.keys')
+        def follow(key_file):
+            return subprocess.check_output((cmd_tshark,
+                    '-r', capture_file('tls13-20-chacha20poly1305.pcap'),
+                    '-o', 'tls.keylog_file: {}'.format(key_file),
+                    '-q',
+                    '-z', 'follow,tls,ascii,1',
+                ), encoding='utf-8', env=test_env)
+        with open(key_file, 'rb') as f:
+            keys = f.read()
+        with open(keylog_file, 'wb') as f:
+            f.write(keys.rstrip(b'\n'))
+        # The last line, CLIENT_TRAFFIC_SECRET_0, is needed for the client's
+        # application data in the second session.
+        assert follow(keylog_file) == follow(key_file)
+
     def test_tls13_rfc8446(self, cmd_tshark, dirs, features, capture_file, test_env):
         '''TLS 1.3 (normal session, then early data followed by normal data).'''
         key_file = os.path.join(dirs.key_dir, 'tls13-rfc8446.keys')
@@ -106,3 +106,7 @@ class TestDfilterEther:
     def test_contains_4(self, checkDFilterCount):
         dfilter = "ipx.src.node contains aa:e3"
         checkDFilterCount(dfilter, 0)
+
+    def test_contains_any_1(self, checkDFilterCount):
+        dfilter = "ipx.src.node contains aa:e3 || ipx.src.node contains a3:e3"
+        checkDFilterCount(dfilter, 1)
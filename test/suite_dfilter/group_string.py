@@ -134,6 +134,14 @@ class TestDfilterString:
         dfilter = 'http.request.method contains 48:45:41:44' # "48:45:41:44"
         checkDFilterCount(dfilter, 0)
 
+    def test_contains_any_1(self, checkDFilterCount):
+        dfilter = 'http.request.method contains "POST" || http.request.method contains "EA"'
+        checkDFilterCount(dfilter, 1)
+
+    def test_contains_any_2(self, checkDFilterCount):
+        dfilter = 'http.request.method contains "POST" || http.request.method contains "PUT" || http.request.method contains "GET"'
+        checkDFilterCount(dfilter, 0)
+
     def test_contains_fail_0(self, checkDFilterCount):
         dfilter = 'http.user_agent contains "update"'
         checkDFilterCount(dfilter, 0)
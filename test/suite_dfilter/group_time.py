@@ -81,6 +81,18 @@ class TestDfilterTime:
         dfilter = 'frame.time == "Dec 31, 2002 13:55:31.3 UTC"'
         checkDFilterCount(dfilter, 1)
 
+    def test_time_window_1(self, checkDFilterCount):
+        dfilter = 'frame.time >= "Dec 31, 2002 13:55:31.3" && frame.time < "Dec 31, 2002 13:56:31.3"'
+        checkDFilterCount(dfilter, 1)
+
+    def test_time_window_2(self, checkDFilterSucceed):
+        dfilter = 'frame.time >= "2002-12-31 13:55:31.3 UTC" && frame.time < "2002-12-31 13:56:31 UTC"'
+        checkDFilterSucceed(dfilter, 'Frame time window:\n Start: 1041342931.300000000\n End: 1041342991.000000000\n')
+
+    def test_time_window_3(self, checkDFilterSucceed):
+        dfilter = '"2002-12-31 13:56:31 UTC" >= frame.time'
+        checkDFilterSucceed(dfilter, 'Frame time window:\n Start: none\n End: 1041342991.000000001\n')
+
     def test_bad_time_1(self, checkDFilterFail):
         # This is an error, only UTC timezone can be used
         dfilter = 'frame.time == "Dec 31, 2002 13:56:31.3 WET"'
@@ -0,0 +1,57 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Editcap tests'''
+
+import struct
+import subprocess
+import pytest
+
+BASE_SECS = 1600000000
+
+
+def frame_payload(num):
+    return struct.pack('>I', num) + bytes(56)
+
+
+@pytest.fixture
+def dup_capture(result_file):
+    '''A pcap file with two copies of frame 1 two seconds apart and two
+    copies of frame 2 a tenth of a second apart. Time stamps are in
+    microseconds.'''
+    frames = ((1, 0), (2, 500000), (2, 600000), (1, 2000000))
+    cap_file = result_file('dups.pcap')
+    with open(cap_file, 'wb') as f:
+        f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+        for num, usecs in frames:
+            payload = frame_payload(num)
+            f.write(struct.pack('<IIII', BASE_SECS + usecs // 1000000, usecs % 1000000,
+                                len(payload), len(payload)) + payload)
+    return cap_file
+
+
+def read_frames(cap_file):
+    '''The frame numbers of the packets in a pcap file.'''
+    with open(cap_file, 'rb') as f:
+        data = f.read()
+    frames = []
+    offset = 24
+    while offset < len(data):
+        _, _, caplen, _ = struct.unpack_from('<IIII', data, offset)
+        num, = struct.unpack_from('>I', data, offset + 16)
+        frames.append(num)
+        offset += 16 + caplen
+    return frames
+
+
+class TestEditcapDuplicates:
+    def test_editcap_dup_window(self, cmd_editcap, dup_capture, result_file, test_env):
+        '''-w removes a copy within the time window and keeps one outside it'''
+        outfile = result_file('dedup.pcap')
+        proc = subprocess.run((cmd_editcap, '-w', '1.0', dup_capture, outfile),
+                              capture_output=True, encoding='utf-8', env=test_env)
+        assert proc.returncode == 0, proc.stderr
+        assert '1 packet skipped' in proc.stderr
+        assert read_frames(outfile) == [1, 2, 1]
@@ -90,3 +90,71 @@ class TestOutputFormats:
         ''' Check that the option -j works with -Tek.'''
         check_outputformat("ek", extra_args=['-j', 'dhcp'], expected="dhcp-filter.ek",
             multiline=True, env=base_env)
+
+    def test_outputformat_json_no_duplicate_keys(self, cmd_tshark, capture_file, base_env):
+        '''Checks that --no-duplicate-keys merges the values of the same key into an array.'''
+        tshark_proc = subprocess.run([cmd_tshark, '-r', capture_file('dhcp.pcap'),
+                                      '-T', 'json', '--no-duplicate-keys', '-c1'],
+                                      check=True, capture_output=True, encoding='utf-8', env=base_env)
+        dhcp = json.loads(tshark_proc.stdout)[0]['_source']['layers']['dhcp']
+        assert dhcp['dhcp.option.type'] == ['53', '61', '50', '55', '0']
+        assert len(dhcp['dhcp.option.type_tree']) == 5
+        assert dhcp['dhcp.option.type_tree'][3]['dhcp.option.request_list_item'] == ['1', '3', '6', '42']
+        assert dhcp['dhcp.option.type_tree'][4] == {'dhcp.option.end': '255'}
+        assert dhcp['dhcp.option.padding'] == '00:00:00:00:00:00:00'
+
+    def test_outputformat_fields_select_field(self, cmd_tshark, capture_file, base_env):
+        '''Checks that the -e and -E occurrence options work with -Tfields.'''
+        tshark_proc = subprocess.run([cmd_tshark, '-r', capture_file('dhcp.pcap'),
+                                      '-T', 'fields', '-c1',
+                                      '-e', 'frame.number', '-e', 'ip.src', '-e', 'ip.dst',
+                                      '-e', 'udp.port', '-E', 'occurrence=l'],
+                                      check=True, capture_output=True, encoding='utf-8', env=base_env)
+        assert tshark_proc.stdout == '1\t0.0.0.0\t255.255.255.255\t67\n'
+
+    def test_outputformat_arrow(self, cmd_tshark, capture_file, result_file, base_env):
+        '''Checks that -Tarrow writes typed columns that pyarrow can read.'''
+        ipc = pytest.importorskip('pyarrow.ipc')
+        arrow_file = result_file('dhcp.arrow')
+        with open(arrow_file, 'wb') as out:
+            subprocess.run([cmd_tshark, '-r', capture_file('dhcp.pcap'), '-T', 'arrow',
+                            '-e', 'frame.number', '-e', 'ip.src', '-e', 'udp.srcport',
+                            '-e', 'dhcp.flags.bc', '-e', 'tcp.port'],
+                            check=True, stdout=out, env=base_env)
+        table = ipc.open_file(arrow_file).read_all()
+        assert table.column_names == ['frame.number', 'ip.src', 'udp.srcport', 'dhcp.flags.bc', 'tcp.port']
+        assert str(table.schema.field('frame.number').type) == 'uint32'
+        assert str(table.schema.field('dhcp.flags.bc').type) == 'bool'
+        assert table.column('frame.number').to_pylist() == [1, 2, 3, 4]
+        assert table.column('ip.src').to_pylist()[0] == '0.0.0.0'
+        assert table.column('udp.srcport').to_pylist() == [68, 67, 68, 67]
+        assert table.column('tcp.port').null_count == 4
+
+    def test_outputformat_ek_bulk_files(self, cmd_tshark, capture_file, result_file, dirs, base_env):
+        '''Checks that --ek-bulk-prefix splits -Tek output into bulk payload files.'''
+        prefix = result_file('dhcp-bulk')
+        subprocess.run([cmd_tshark, '-r', capture_file('dhcp.pcap'), '-T', 'ek',
+                        '--ek-bulk-prefix', prefix, '--ek-bulk-size', '1'],
+                        check=True, capture_output=True, env=base_env)
+        # Every document is larger than 1 kB, so each one gets a file of its own.
+        expected = open(os.path.join(dirs.baseline_dir, 'dhcp.ek')).read().splitlines()
+        actual = []
+        for num in range(1, 5):
+            lines = open('{}_{:05d}.json'.format(prefix, num)).read().splitlines()
+            assert len(lines) == 2
+            actual += lines
+        assert not os.path.exists('{}_00005.json'.format(prefix))
+        assert [json.loads(line) for line in expected] == [json.loads(line) for line in actual]
+
+    def test_outputformat_ek_omit_filtered(self, cmd_tshark, capture_file, dirs, base_env):
+        '''Checks that --ek-omit-filtered leaves out the layers excluded by -J.'''
+        tshark_proc = subprocess.run([cmd_tshark, '-r', capture_file('dhcp.pcap'), '-T', 'ek',
+                                      '-J', 'dhcp', '--ek-omit-filtered'],
+                                      check=True, capture_output=True, encoding='utf-8', env=base_env)
+        expected = open(os.path.join(dirs.baseline_dir, 'dhcp.ek')).read().splitlines()
+        actual = tshark_proc.stdout.splitlines()
+        assert len(expected) == len(actual)
+        for expected_line, actual_line in zip(expected[1::2], actual[1::2]):
+            layers = json.loads(actual_line)['layers']
+            assert list(layers.keys()) == ['dhcp']
+            assert layers['dhcp'] == json.loads(expected_line)['layers']['dhcp']
@@ -0,0 +1,102 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Reordercap tests'''
+
+import random
+import struct
+import subprocess
+import pytest
+
+NUM_FRAMES = 300
+BASE_SECS = 1600000000
+
+
+def pcapng_block(block_type, body):
+    length = 12 + len(body) + (-len(body) % 4)
+    return struct.pack('<II', block_type, length) + body + b'\0' * (-len(body) % 4) + struct.pack('<I', length)
+
+
+def frame_payload(num):
+    return struct.pack('>I', num) + bytes(56)
+
+
+def shuffled_frames():
+    '''Frame numbers and time stamps in microseconds, or None for no time
+    stamp, out of order. Pairs of frames have the same time stamp.'''
+    frames = [(num, None if num % 25 == 0 else (num // 2) * 1000) for num in range(NUM_FRAMES)]
+    random.Random(42).shuffle(frames)
+    return frames
+
+
+def sort_key(frame):
+    num, ts = frame
+    return (ts is not None, ts or 0)
+
+
+@pytest.fixture
+def shuffled_capture(result_file):
+    '''A pcapng file with the shuffled frames. Frames without a time stamp
+    are in simple packet blocks.'''
+    cap_file = result_file('shuffled.pcapng')
+    with open(cap_file, 'wb') as f:
+        f.write(pcapng_block(0x0A0D0D0A, struct.pack('<IHHq', 0x1A2B3C4D, 1, 0, -1)))
+        f.write(pcapng_block(1, struct.pack('<HHI', 1, 0, 0)))
+        for num, ts in shuffled_frames():
+            payload = frame_payload(num)
+            if ts is None:
+                f.write(pcapng_block(3, struct.pack('<I', len(payload)) + payload))
+            else:
+                ts += BASE_SECS * 1000000
+                f.write(pcapng_block(6, struct.pack('<IIIII', 0, ts >> 32, ts & 0xffffffff,
+                                                    len(payload), len(payload)) + payload))
+    return cap_file
+
+
+def read_packets(cap_file):
+    '''The frame numbers and time stamps of the enhanced packet blocks.'''
+    with open(cap_file, 'rb') as f:
+        data = f.read()
+    packets = []
+    offset = 0
+    while offset < len(data):
+        block_type, length = struct.unpack_from('<II', data, offset)
+        if block_type == 6:
+            _, ts_high, ts_low = struct.unpack_from('<III', data, offset + 8)
+            num, = struct.unpack_from('>I', data, offset + 28)
+            packets.append((num, (ts_high << 32) | ts_low))
+        offset += length
+    return packets
+
+
+class TestReordercapWindow:
+    def run_reordercap(self, cmd_reordercap, args, infile, outfile, env):
+        proc = subprocess.run([cmd_reordercap] + args + [infile, outfile],
+                              capture_output=True, encoding='utf-8', env=env)
+        assert proc.returncode == 0, proc.stderr
+        with open(outfile, 'rb') as f:
+            return f.read()
+
+    def test_reordercap_default(self, cmd_reordercap, shuffled_capture, result_file, test_env):
+        '''Frames are sorted by time stamp, frames without one first, and stay in file order otherwise'''
+        outfile = result_file('default.pcapng')
+        self.run_reordercap(cmd_reordercap, [], shuffled_capture, outfile, test_env)
+        expected = [(num, 0 if ts is None else ts + BASE_SECS * 1000000) for num, ts in
+                    sorted(shuffled_frames(), key=sort_key)]
+        assert read_packets(outfile) == expected
+
+    @pytest.mark.parametrize('window', (1000, NUM_FRAMES, 50, 8, 1))
+    def test_reordercap_window(self, cmd_reordercap, shuffled_capture, result_file, window, test_env):
+        '''-w writes the same file as the default mode, whether all frames fit in the window or not'''
+        if window == 1:
+            # Every frame older than the one before it starts a sorted run.
+            # There are more of them than are merged at once, so they're
+            # merged in more than one pass.
+            keys = [sort_key(frame) for frame in shuffled_frames()]
+            assert 1 + sum(1 for prev, key in zip(keys, keys[1:]) if key < prev) > 64
+        default = self.run_reordercap(cmd_reordercap, [], shuffled_capture, result_file('default.pcapng'), test_env)
+        windowed = self.run_reordercap(cmd_reordercap, ['-w', str(window)], shuffled_capture,
+                                       result_file('window.pcapng'), test_env)
+        assert windowed == default
@@ -253,6 +253,52 @@ class TestSharkd:
             }},
         ))
 
+    def test_sharkd_req_tap_frames(self, check_sharkd_session, capture_file):
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"tap", "params":{"tap0": "conv:Ethernet", "frames": "1-2"}},
+            {"jsonrpc":"2.0", "id":3, "method":"tap", "params":{"tap0": "conv:Ethernet", "frames": "garbage"}},
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":{
+                "taps": [
+                    {
+                        "tap": "conv:Ethernet",
+                        "type": "conv",
+                        "proto": "Ethernet",
+                        "geoip": MatchAny(bool),
+                        "convs": [
+                            {
+                                "saddr": MatchAny(str),
+                                "daddr": "Broadcast",
+                                "txf": 1,
+                                "txb": 314,
+                                "rxf": 0,
+                                "rxb": 0,
+                                "start": MatchAny(),
+                                "stop": MatchAny(),
+                                "filter": "eth.addr==00:0b:82:01:fc:42 && eth.addr==ff:ff:ff:ff:ff:ff",
+                            },
+                            {
+                                "saddr": MatchAny(str),
+                                "daddr": MatchAny(str),
+                                "rxf": 0,
+                                "rxb": 0,
+                                "txf": 1,
+                                "txb": 342,
+                                "start": MatchAny(),
+                                "stop": MatchAny(),
+                                "filter": "eth.addr==00:08:74:ad:f1:9b && eth.addr==00:0b:82:01:fc:42",
+                            }
+                        ],
+                    },
+                ]
+            }},
+            {"jsonrpc":"2.0","id":3,"error":{"code":-11014,"message":"sharkd_session_process_tap() invalid frames range"}},
+        ))
+
     def test_sharkd_req_tap_rtp_streams(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -395,6 +441,33 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":3,"error":{"code":-6001,"message":"Filter \"garbage filter\" is invalid - \"filter\" was unexpected in this context."}},
         ))
 
+    def test_sharkd_req_iograph_frames(self, check_sharkd_session, capture_file):
+        # dhcp.pcap has frames of 314, 342, 314 and 342 bytes. Ranges out
+        # of order or overlapping are sorted and merged.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"iograph",
+            "params":{"graph0": "packets", "graph1": "bytes", "frames": "2-3"}
+            },
+            {"jsonrpc":"2.0", "id":3, "method":"iograph",
+            "params":{"graph0": "packets", "graph1": "bytes", "frames": "3-4,1"}
+            },
+            {"jsonrpc":"2.0", "id":4, "method":"iograph",
+            "params":{"graph0": "packets", "graph1": "bytes", "frames": "2,1-2,2"}
+            },
+            {"jsonrpc":"2.0", "id":5, "method":"iograph",
+            "params":{"graph0": "packets", "frames": "garbage"}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":{"iograph": [{"items": [2.000000]}, {"items": [656.000000]}]}},
+            {"jsonrpc":"2.0","id":3,"result":{"iograph": [{"items": [3.000000]}, {"items": [970.000000]}]}},
+            {"jsonrpc":"2.0","id":4,"result":{"iograph": [{"items": [2.000000]}, {"items": [656.000000]}]}},
+            {"jsonrpc":"2.0","id":5,"error":{"code":-6002,"message":"sharkd_session_process_iograph() invalid frames range"}},
+        ))
+
     def test_sharkd_req_intervals_bad(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -427,6 +500,21 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":4,"result":{"intervals":[[0,2,656]],"last":0,"frames":2,"bytes":656}},
         ))
 
+    def test_sharkd_req_intervals_time_filter(self, check_sharkd_session, capture_file):
+        # A filter on frame.time alone is answered from the time index
+        # without dissecting the frames.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"intervals",
+            "params":{"interval": 1, "filter": 'frame.time >= "2000-01-01 00:00:00" && frame.time < "2100-01-01 00:00:00"'}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":{"intervals":[[0,2,656],[70,2,656]],"last":70,"frames":4,"bytes":1312}},
+        ))
+
     def test_sharkd_req_frame_basic(self, check_sharkd_session, capture_file):
         # XXX add more tests for other options (ref_frame, prev_frame, columns, color, bytes, hidden)
         check_sharkd_session((
@@ -1071,8 +1071,8 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
          * More importantly, edt.pi.fd.dependent_frames won't be initialized because
          * epan hasn't been initialized.
          */
-        if (edt && edt->pi.fd->dependent_frames) {
-            g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+        if (edt && frame_data_dependent_frames(edt->pi.fd)) {
+            g_hash_table_foreach(frame_data_dependent_frames(edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
         }
 
         cf->count++;
@@ -1117,6 +1117,11 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
 
         col_custom_prime_edt(edt, &cf->cinfo);
 
+        /* Prime the epan_dissect_t with the fields to print, so that they
+           can be fetched without walking the whole tree. */
+        if (print_packet_info && output_fields_num_fields(output_fields) != 0)
+            output_fields_prime_edt(output_fields, edt);
+
         /* We only need the columns if either
            1) some tap needs the columns
            or
@@ -1559,6 +1564,11 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
 
         col_custom_prime_edt(edt, &cf->cinfo);
 
+        /* Prime the epan_dissect_t with the fields to print, so that they
+           can be fetched without walking the whole tree. */
+        if (print_packet_info && output_fields_num_fields(output_fields) != 0)
+            output_fields_prime_edt(output_fields, edt);
+
         /* We only need the columns if either
            1) some tap needs the columns
            or
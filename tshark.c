@@ -138,6 +138,10 @@
 #define LONGOPT_CAPTURE_COMMENT         LONGOPT_BASE_APPLICATION+6
 #define LONGOPT_HEXDUMP                 LONGOPT_BASE_APPLICATION+7
 #define LONGOPT_SELECTED_FRAME          LONGOPT_BASE_APPLICATION+8
+#define LONGOPT_EK_BULK_PREFIX          LONGOPT_BASE_APPLICATION+9
+#define LONGOPT_EK_BULK_SIZE            LONGOPT_BASE_APPLICATION+10
+#define LONGOPT_EK_OMIT_FILTERED        LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_ON_DISK_STATE           LONGOPT_BASE_APPLICATION+12
 
 capture_file cfile;
 
@@ -147,6 +151,7 @@ static frame_data prev_dis_frame;
 static frame_data prev_cap_frame;
 
 static gboolean perform_two_pass_analysis;
+static gboolean on_disk_state = FALSE;
 static guint32 epan_auto_reset_count = 0;
 static gboolean epan_auto_reset = FALSE;
 
@@ -162,7 +167,8 @@ typedef enum {
     WRITE_FIELDS,   /* User defined list of fields */
     WRITE_JSON,     /* JSON */
     WRITE_JSON_RAW, /* JSON only raw hex */
-    WRITE_EK        /* JSON bulk insert to Elasticsearch */
+    WRITE_EK,       /* JSON bulk insert to Elasticsearch */
+    WRITE_ARROW     /* User defined list of fields as Apache Arrow columns */
         /* Add CSV and the like here */
 } output_action_e;
 
@@ -192,6 +198,13 @@ static gboolean no_duplicate_keys = FALSE;
 static proto_node_children_grouper_func node_children_grouper = proto_node_group_children_by_unique;
 
 static json_dumper jdumper;
+static arrow_writer *arrow_output;
+
+/* -T ek bulk payload files, see --ek-bulk-prefix */
+static const char *ek_bulk_prefix = NULL;
+static guint32 ek_bulk_size_kb = 0;
+static guint ek_output_flags = 0;
+static ek_output_t *ek_output;
 
 /* The line separator used between packets, changeable via the -S option */
 static const char *separator = "";
@@ -446,14 +459,14 @@ print_usage(FILE *output)
     fprintf(output, "     delimit               delimit ASCII dump text with '|' characters\n");
     fprintf(output, "     noascii               exclude ASCII dump text\n");
     fprintf(output, "     help                  display help for --hexdump and exit\n");
-    fprintf(output, "  -T pdml|ps|psml|json|jsonraw|ek|tabs|text|fields|?\n");
+    fprintf(output, "  -T pdml|ps|psml|json|jsonraw|ek|tabs|text|fields|arrow|?\n");
     fprintf(output, "                           format of text output (def: text)\n");
     fprintf(output, "  -j <protocolfilter>      protocols layers filter if -T ek|pdml|json selected\n");
     fprintf(output, "                           (e.g. \"ip ip.flags text\", filter does not expand child\n");
     fprintf(output, "                           nodes, unless child is specified also in the filter)\n");
     fprintf(output, "  -J <protocolfilter>      top level protocol filter if -T ek|pdml|json selected\n");
     fprintf(output, "                           (e.g. \"http tcp\", filter which expands all child nodes)\n");
-    fprintf(output, "  -e <field>               field to print if -Tfields selected (e.g. tcp.port,\n");
+    fprintf(output, "  -e <field>               field to print if -Tfields or -Tarrow selected (e.g. tcp.port,\n");
     fprintf(output, "                           _ws.col.Info)\n");
     fprintf(output, "                           this option can be repeated to print multiple fields\n");
     fprintf(output, "  -E<fieldsoption>=<value> set options for output when -Tfields selected:\n");
@@ -490,8 +503,15 @@ print_usage(FILE *output)
     fprintf(output, "                           values\n");
     fprintf(output, "  --elastic-mapping-filter <protocols> If -G elastic-mapping is specified, put only the\n");
     fprintf(output, "                           specified protocols within the mapping file\n");
+    fprintf(output, "  --ek-bulk-prefix <prefix> If -T ek is specified, write the output into bulk payload\n");
+    fprintf(output, "                           files named <prefix>_NNNNN.json\n");
+    fprintf(output, "  --ek-bulk-size <kB>      maximum size of each bulk payload file (def: 10240)\n");
+    fprintf(output, "  --ek-omit-filtered       If -T ek is specified, leave out the layers and fields\n");
+    fprintf(output, "                           excluded by -j or -J instead of marking them as filtered\n");
     fprintf(output, "  --temp-dir <directory>   write temporary files to this directory\n");
     fprintf(output, "                           (default: %s)\n", g_get_tmp_dir());
+    fprintf(output, "  --on-disk-state          If -2 is specified, keep the per-frame state of the\n");
+    fprintf(output, "                           first pass in memory-mapped temporary files\n");
     fprintf(output, "\n");
 
     ws_log_print_usage(output);
@@ -856,6 +876,10 @@ main(int argc, char *argv[])
         {"capture-comment", ws_required_argument, NULL, LONGOPT_CAPTURE_COMMENT},
         {"hexdump", ws_required_argument, NULL, LONGOPT_HEXDUMP},
         {"selected-frame", ws_required_argument, NULL, LONGOPT_SELECTED_FRAME},
+        {"ek-bulk-prefix", ws_required_argument, NULL, LONGOPT_EK_BULK_PREFIX},
+        {"ek-bulk-size", ws_required_argument, NULL, LONGOPT_EK_BULK_SIZE},
+        {"ek-omit-filtered", ws_no_argument, NULL, LONGOPT_EK_OMIT_FILTERED},
+        {"on-disk-state", ws_no_argument, NULL, LONGOPT_ON_DISK_STATE},
         {0, 0, 0, 0}
     };
     gboolean             arg_error = FALSE;
@@ -1530,11 +1554,17 @@ main(int argc, char *argv[])
                     output_action = WRITE_JSON_RAW;
                     print_details = TRUE;   /* Need details */
                     print_summary = FALSE;  /* Don't allow summary */
+                } else if (strcmp(ws_optarg, "arrow") == 0) {
+                    output_action = WRITE_ARROW;
+                    print_details = TRUE;   /* Need full tree info */
+                    print_summary = FALSE;  /* Don't allow summary */
                 }
                 else {
                     cmdarg_err("Invalid -T parameter \"%s\"; it must be one of:", ws_optarg);                   /* x */
                     cmdarg_err_cont("\t\"fields\"  The values of fields specified with the -e option, in a form\n"
                             "\t          specified by the -E option.\n"
+                            "\t\"arrow\"   The values of fields specified with the -e option, as the\n"
+                            "\t          typed columns of an Apache Arrow IPC file.\n"
                             "\t\"pdml\"    Packet Details Markup Language, an XML-based format for the\n"
                             "\t          details of a decoded packet. This information is equivalent to\n"
                             "\t          the packet details printed with the -V flag.\n"
@@ -1655,6 +1685,22 @@ main(int argc, char *argv[])
                 no_duplicate_keys = TRUE;
                 node_children_grouper = proto_node_group_children_by_json_key;
                 break;
+            case LONGOPT_EK_BULK_PREFIX:
+                ek_bulk_prefix = ws_optarg;
+                break;
+            case LONGOPT_EK_BULK_SIZE:
+                if (!ws_strtou32(ws_optarg, &endptr, &ek_bulk_size_kb) || *endptr != '\0' || ek_bulk_size_kb == 0) {
+                    cmdarg_err("\"%s\" is not a valid bulk payload file size", ws_optarg);
+                    exit_status = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+                break;
+            case LONGOPT_EK_OMIT_FILTERED:
+                ek_output_flags |= EK_OUTPUT_OMIT_FILTERED;
+                break;
+            case LONGOPT_ON_DISK_STATE:
+                on_disk_state = TRUE;
+                break;
             case LONGOPT_CAPTURE_COMMENT:  /* capture comment */
                 if (capture_comments == NULL) {
                     capture_comments = g_ptr_array_new_with_free_func(g_free);
@@ -1732,15 +1778,29 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if ((ek_bulk_prefix != NULL || ek_bulk_size_kb != 0 || ek_output_flags != 0) && output_action != WRITE_EK) {
+        cmdarg_err("--ek-bulk-prefix, --ek-bulk-size and --ek-omit-filtered can only be used with \"-T ek\"");
+        exit_status = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+    if (ek_bulk_size_kb != 0 && ek_bulk_prefix == NULL) {
+        cmdarg_err("--ek-bulk-size requires --ek-bulk-prefix");
+        exit_status = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+    if (ek_bulk_size_kb == 0) {
+        ek_bulk_size_kb = 10240;
+    }
+
     /* If we specified output fields, but not the output field type... */
-    if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
+    if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action && WRITE_ARROW != output_action) && 0 != output_fields_num_fields(output_fields)) {
         cmdarg_err("Output fields were specified with \"-e\", "
-                "but \"-Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
+                "but \"-Tarrow, -Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
         exit_status = WS_EXIT_INVALID_OPTION;
         goto clean_exit;
-    } else if (WRITE_FIELDS == output_action && 0 == output_fields_num_fields(output_fields)) {
-        cmdarg_err("\"-Tfields\" was specified, but no fields were "
-                "specified with \"-e\".");
+    } else if ((WRITE_FIELDS == output_action || WRITE_ARROW == output_action) && 0 == output_fields_num_fields(output_fields)) {
+        cmdarg_err("\"-T%s\" was specified, but no fields were "
+                "specified with \"-e\".", WRITE_FIELDS == output_action ? "fields" : "arrow");
 
         exit_status = WS_EXIT_INVALID_OPTION;
         goto clean_exit;
@@ -1859,6 +1919,12 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (on_disk_state && !perform_two_pass_analysis) {
+        cmdarg_err("--on-disk-state requires -2.");
+        exit_status = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+
 #ifdef HAVE_LIBPCAP
     if (caps_queries) {
         /* We're supposed to list the link-layer/timestamp types for an interface;
@@ -3105,8 +3171,8 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
          * if a display filter was given and it matches this packet.
          */
         if (edt && cf->dfcode) {
-            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            if (dfilter_apply_edt(cf->dfcode, edt) && frame_data_dependent_frames(edt->pi.fd)) {
+                g_hash_table_foreach(frame_data_dependent_frames(edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
             }
 
             if (selected_frame_number != 0 && selected_frame_number == cf->count + 1) {
@@ -3199,6 +3265,28 @@ process_cap_file_first_pass(capture_file *cf, int max_packet_count,
     /* Allocate a frame_data_sequence for all the frames. */
     cf->provider.frames = new_frame_data_sequence();
 
+    if (on_disk_state) {
+        const char *tempdir = NULL;
+        GError *map_err = NULL;
+
+#ifdef HAVE_LIBPCAP
+        tempdir = global_capture_opts.temp_dir;
+#endif
+        /*
+         * Put the frame_data structures, and the blocks that the file
+         * scope allocates the dissectors' per-frame and conversation
+         * data from, in memory-mapped files, so that the kernel can
+         * page them out to disk rather than to swap while we read the
+         * rest of the file.  If that doesn't work, we just keep them
+         * in memory.
+         */
+        if (!frame_data_sequence_use_mapped_file(cf->provider.frames, tempdir, &map_err) ||
+            !wmem_allocator_use_mapped_file(wmem_file_scope(), tempdir, &map_err)) {
+            cmdarg_err("Can't keep the first pass state on disk: %s", map_err->message);
+            g_clear_error(&map_err);
+        }
+    }
+
     if (do_dissection) {
         gboolean create_proto_tree;
 
@@ -3297,6 +3385,11 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
 
         col_custom_prime_edt(edt, &cf->cinfo);
 
+        /* Prime the epan_dissect_t with the fields to print, so that they
+           can be fetched without walking the whole tree. */
+        if (print_packet_info && output_fields_num_fields(output_fields) != 0)
+            output_fields_prime_edt(output_fields, edt);
+
         /* We only need the columns if either
            1) some tap needs the columns
            or
@@ -3963,6 +4056,11 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
 
         col_custom_prime_edt(edt, &cf->cinfo);
 
+        /* Prime the epan_dissect_t with the fields to print, so that they
+           can be fetched without walking the whole tree. */
+        if (print_packet_info && output_fields_num_fields(output_fields) != 0)
+            output_fields_prime_edt(output_fields, edt);
+
         /* We only need the columns if either
            1) some tap needs the columns
            or
@@ -4062,7 +4160,18 @@ write_preamble(capture_file *cf)
             return !ferror(stdout);
 
         case WRITE_EK:
-            return TRUE;
+            ek_output = write_ek_preamble(stdout, ek_bulk_prefix,
+                    (gsize)ek_bulk_size_kb * 1024, ek_output_flags);
+            /* If the first bulk payload file can't be created, errno is set. */
+            return ek_output != NULL;
+
+        case WRITE_ARROW:
+#ifdef _WIN32
+            /* The output is binary. */
+            _setmode(_fileno(stdout), O_BINARY);
+#endif
+            arrow_output = write_arrow_preamble(output_fields, stdout);
+            return !ferror(stdout);
 
         default:
             ws_assert_not_reached();
@@ -4433,8 +4542,16 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
             break;
 
         case WRITE_EK:
-            write_ek_proto_tree(output_fields, print_summary, print_hex,
-                    protocolfilter, edt, &cf->cinfo, stdout);
+            if (!write_ek_proto_tree(output_fields, print_summary, print_hex,
+                    protocolfilter, edt, &cf->cinfo, ek_output)) {
+                /* The bulk payload files aren't checked by our callers. */
+                show_print_file_io_error();
+                exit(2);
+            }
+            return !ferror(stdout);
+
+        case WRITE_ARROW:
+            write_arrow_proto_tree(output_fields, edt, &cf->cinfo, arrow_output);
             return !ferror(stdout);
 
         default:
@@ -4479,7 +4596,18 @@ write_finale(void)
             return !ferror(stdout);
 
         case WRITE_EK:
-            return TRUE;
+        {
+            gboolean ok = write_ek_finale(ek_output);
+            ek_output = NULL;
+            return ok && !ferror(stdout);
+        }
+
+        case WRITE_ARROW:
+        {
+            gboolean ok = write_arrow_finale(arrow_output);
+            arrow_output = NULL;
+            return ok && !ferror(stdout);
+        }
 
         default:
             ws_assert_not_reached();
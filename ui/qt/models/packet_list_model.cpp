@@ -39,6 +39,10 @@
 #include <QFontMetrics>
 #include <QModelIndex>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <atomic>
 
 // Print timing information
 //#define DEBUG_PACKET_LIST_MODEL 1
@@ -79,7 +83,12 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     number_to_row_(QVector<int>()),
     max_row_height_(0),
     max_line_count_(1),
-    idle_dissection_row_(0)
+    idle_dissection_row_(0),
+    viewport_first_row_(0),
+    prefetch_row_(0),
+    prefetch_end_row_(0),
+    prefetch_step_(1),
+    prefetch_scheduled_(false)
 {
     Q_ASSERT(glbl_plist_model == Q_NULLPTR);
     glbl_plist_model = this;
@@ -166,6 +175,7 @@ guint PacketListModel::recreateVisibleRows()
         endInsertRows();
     }
     idle_dissection_row_ = 0;
+    prefetch_row_ = prefetch_end_row_ = 0;
     return static_cast<guint>(visible_rows_.count());
 }
 
@@ -181,6 +191,8 @@ void PacketListModel::clear() {
     max_row_height_ = 0;
     max_line_count_ = 1;
     idle_dissection_row_ = 0;
+    viewport_first_row_ = 0;
+    prefetch_row_ = prefetch_end_row_ = 0;
 }
 
 void PacketListModel::invalidateAllColumnStrings()
@@ -489,11 +501,31 @@ Qt::SortOrder PacketListModel::sort_order_;
 capture_file *PacketListModel::sort_cap_file_;
 gboolean PacketListModel::stop_flag_;
 ProgressFrame *PacketListModel::progress_frame_;
-double PacketListModel::comps_;
 double PacketListModel::exp_comps_;
 
 QElapsedTimer busy_timer_;
 const int busy_timeout_ = 65; // ms, approximately 15 fps
+
+// The sort keys of a column are collected once, on the main thread since
+// that might require dissection, after which the keys are sorted in
+// chunks on worker threads and the chunks are merged pairwise.
+struct PacketListModel::SortKey {
+    PacketListRecord *record;
+    QString text;
+    double number;
+    bool number_ok;
+};
+
+// Don't bother splitting up sorts smaller than this.
+static const int min_sort_chunk_ = 20000;
+// How often sort workers report progress and check for cancellation.
+static const qint64 sort_check_interval_ = 4096;
+static std::atomic<qint64> sort_comps_;
+static std::atomic<bool> sort_abort_;
+// Fraction of the progress bar used for collecting the keys; the rest is
+// used by the sort itself.
+static double sort_progress_base_;
+
 void PacketListModel::sort(int column, Qt::SortOrder order)
 {
     if (!cap_file_ || visible_rows_.count() < 1) return;
@@ -553,7 +585,8 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
         busy_msg = tr("Sorting …");
     }
     stop_flag_ = FALSE;
-    comps_ = 0;
+    sort_comps_ = 0;
+    sort_abort_ = false;
     /* XXX: The expected number of comparisons is O(N log N), but this could
      * be a pretty significant overestimate of the amount of time it takes,
      * if there are lots of identical entries. (Especially with string
@@ -574,14 +607,17 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     busy_timer_.start();
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
-    QVector<PacketListRecord *> sorted_visible_rows_ = visible_rows_;
+    sort_progress_base_ = text_sort_column_ >= 0 ? 0.5 : 0.0;
     try {
-        std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        QVector<SortKey> sort_keys;
+        buildSortKeys(sort_keys);
+        sortKeys(sort_keys);
 
         beginResetModel();
         visible_rows_.resize(0);
         number_to_row_.fill(0);
-        foreach (PacketListRecord *record, sorted_visible_rows_) {
+        foreach (const SortKey &sort_key, sort_keys) {
+            PacketListRecord *record = sort_key.record;
             frame_data *fdata = record->frameData();
 
             if (fdata->passed_dfilter || fdata->ref_time) {
@@ -679,64 +715,173 @@ bool PacketListModel::isNumericColumn(int column)
     return true;
 }
 
-bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
+void PacketListModel::updateSortProgress()
+{
+    if (progress_frame_) {
+        double done = qMin(sort_comps_ / exp_comps_, 1.0);
+        progress_frame_->setValue(static_cast<int>((sort_progress_base_ + done * (1.0 - sort_progress_base_)) * 100));
+    }
+}
+
+// Fetch the column text of every visible row. Rows that aren't in the
+// column string cache have to be dissected, which can only be done here.
+void PacketListModel::buildSortKeys(QVector<SortKey> &keys)
+{
+    keys.reserve(visible_rows_.count());
+
+    int row = 0;
+    foreach (PacketListRecord *record, visible_rows_) {
+        SortKey key;
+        key.record = record;
+        key.number = 0;
+        key.number_ok = false;
+        if (text_sort_column_ >= 0) {
+            key.text = record->columnString(sort_cap_file_, sort_column_);
+            if (sort_column_is_numeric_) {
+                key.number = parseNumericColumn(key.text, &key.number_ok);
+            }
+        }
+        keys << key;
+        row++;
+
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            if (progress_frame_) {
+                progress_frame_->setValue(static_cast<int>(sort_progress_base_ * row / visible_rows_.count() * 100));
+            }
+            mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
+            if (stop_flag_) {
+                throw SortAbort("Sorting aborted");
+            }
+            busy_timer_.restart();
+        }
+    }
+}
+
+// Sort the keys on the thread pool, keeping the UI responsive.
+void PacketListModel::sortKeys(QVector<SortKey> &keys)
+{
+    int key_count = static_cast<int>(keys.count());
+    int chunk_count = qMax(1, qMin(QThread::idealThreadCount(), key_count / min_sort_chunk_));
+    SortKey *base = keys.data();
+
+    // Comparisons are counted per thread and added up in batches.
+    auto sort_key_less = [](const SortKey &k1, const SortKey &k2) {
+        static thread_local qint64 comps = 0;
+        if (++comps % sort_check_interval_ == 0) {
+            sort_comps_ += sort_check_interval_;
+            if (sort_abort_) {
+                throw SortAbort("Sorting aborted");
+            }
+        }
+        return sortKeyLessThan(k1, k2);
+    };
+
+    QVector<int> bounds;
+    for (int i = 0; i <= chunk_count; i++) {
+        bounds << static_cast<int>(static_cast<qint64>(key_count) * i / chunk_count);
+    }
+
+    QList<QFuture<void> > futures;
+    for (int i = 0; i < chunk_count; i++) {
+        SortKey *first = base + bounds[i];
+        SortKey *last = base + bounds[i + 1];
+        futures << QtConcurrent::run([=]() {
+            try {
+                std::sort(first, last, sort_key_less);
+            } catch (const SortAbort&) {
+            }
+        });
+    }
+    waitForSortWorkers(futures);
+
+    while (bounds.count() > 2) {
+        QVector<int> merged_bounds;
+        int i;
+
+        futures.clear();
+        for (i = 0; i + 2 < bounds.count(); i += 2) {
+            SortKey *first = base + bounds[i];
+            SortKey *middle = base + bounds[i + 1];
+            SortKey *last = base + bounds[i + 2];
+            futures << QtConcurrent::run([=]() {
+                try {
+                    std::inplace_merge(first, middle, last, sort_key_less);
+                } catch (const SortAbort&) {
+                }
+            });
+            merged_bounds << bounds[i];
+        }
+        if (i + 1 < bounds.count()) {
+            // Odd chunk out.
+            merged_bounds << bounds[i];
+        }
+        merged_bounds << bounds.last();
+        waitForSortWorkers(futures);
+        bounds = merged_bounds;
+    }
+}
+
+void PacketListModel::waitForSortWorkers(const QList<QFuture<void> > &futures)
+{
+    foreach (QFuture<void> future, futures) {
+        while (!future.isFinished()) {
+            if (busy_timer_.elapsed() > busy_timeout_) {
+                updateSortProgress();
+                mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
+                if (stop_flag_) {
+                    sort_abort_ = true;
+                }
+                busy_timer_.restart();
+            } else {
+                QThread::msleep(1);
+            }
+        }
+    }
+
+    if (sort_abort_) {
+        throw SortAbort("Sorting aborted");
+    }
+}
+
+// Called from the sort workers; must not touch anything but the keys and
+// the sort parameters.
+bool PacketListModel::sortKeyLessThan(const SortKey &k1, const SortKey &k2)
 {
     int cmp_val = 0;
-    comps_++;
+    frame_data *fd1 = k1.record->frameData();
+    frame_data *fd2 = k2.record->frameData();
 
     // Wherein we try to cram the logic of packet_list_compare_records,
     // _packet_list_compare_records, and packet_list_compare_custom from
     // gtk/packet_list_store.c into one function
 
-    if (busy_timer_.elapsed() > busy_timeout_) {
-        if (progress_frame_) {
-            progress_frame_->setValue(static_cast<int>(comps_/exp_comps_ * 100));
-        }
-        // What's the least amount of processing that we can do which will draw
-        // the busy indicator?
-        mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
-        if (stop_flag_) {
-            throw SortAbort("Sorting aborted");
-        }
-        busy_timer_.restart();
-    }
     if (sort_column_ < 0) {
         // No column.
-        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
+        cmp_val = frame_data_compare(sort_cap_file_->epan, fd1, fd2, COL_NUMBER);
     } else if (text_sort_column_ < 0) {
         // Column comes directly from frame data
-        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
+        cmp_val = frame_data_compare(sort_cap_file_->epan, fd1, fd2, sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
     } else  {
-        QString r1String = r1->columnString(sort_cap_file_, sort_column_);
-        QString r2String = r2->columnString(sort_cap_file_, sort_column_);
         // XXX: The naive string comparison compares Unicode code points.
         // Proper collation is more expensive
-        cmp_val = r1String.compare(r2String);
+        cmp_val = k1.text.compare(k2.text);
         if (cmp_val != 0 && sort_column_is_numeric_) {
-            // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this? Perhaps the actual
-            // values used for sorting should be cached too as QVariant[List].
-            // If so, we could consider using QCollatorSortKeys or similar
-            // for strings as well.
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1String, &ok_r1);
-            double num_r2 = parseNumericColumn(r2String, &ok_r2);
-
-            if (!ok_r1 && !ok_r2) {
+            // Custom column with numeric data (or something like a port
+            // number). The numbers were parsed when the keys were built.
+            if (!k1.number_ok && !k2.number_ok) {
                 cmp_val = 0;
-            } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
+            } else if (!k1.number_ok || (k2.number_ok && k1.number < k2.number)) {
                 // either r1 is invalid (and sort it before others) or both
                 // r1 and r2 are valid (sort normally)
                 cmp_val = -1;
-            } else if (!ok_r2 || (num_r1 > num_r2)) {
+            } else if (!k2.number_ok || (k1.number > k2.number)) {
                 cmp_val = 1;
             }
         }
 
         if (cmp_val == 0) {
             // All else being equal, compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
+            cmp_val = frame_data_compare(sort_cap_file_->epan, fd1, fd2, COL_NUMBER);
         }
     }
 
@@ -943,6 +1088,71 @@ void PacketListModel::dissectIdle(bool reset)
     emit bgColorizationProgress(first+1, idle_dissection_row_+1);
 }
 
+// Number of pages past the viewport to prefetch. We never prefetch more
+// than a quarter of the column string cache so that we don't evict the
+// rows that are currently being shown.
+static const int prefetch_pages_ = 4;
+void PacketListModel::setViewportRows(int first_row, int last_row)
+{
+    int row_count = static_cast<int>(visible_rows_.count());
+    if (row_count < 1 || first_row < 0 || last_row < first_row) {
+        return;
+    }
+
+    int ahead = qMin((last_row - first_row + 1) * prefetch_pages_,
+                     PacketListRecord::maxCache() / 4);
+
+    if (first_row < viewport_first_row_) {
+        prefetch_row_ = first_row - 1;
+        prefetch_end_row_ = qMax(first_row - ahead, 0) - 1;
+        prefetch_step_ = -1;
+    } else {
+        prefetch_row_ = last_row + 1;
+        prefetch_end_row_ = qMin(last_row + ahead, row_count - 1) + 1;
+        prefetch_step_ = 1;
+    }
+    viewport_first_row_ = first_row;
+
+    if (!prefetch_scheduled_ && prefetch_row_ != prefetch_end_row_) {
+        prefetch_scheduled_ = true;
+        QTimer::singleShot(0, this, &PacketListModel::prefetchIdle);
+    }
+}
+
+// Dissection isn't thread safe, so instead of using a worker thread we
+// prefetch in short slices on the main thread, the same way dissectIdle
+// does. Each slice is bounded by idle_dissection_interval_, so input
+// events and repaints are never held up for long.
+void PacketListModel::prefetchIdle()
+{
+    prefetch_scheduled_ = false;
+
+    if (!cap_file_ || cap_file_->read_lock) {
+        return;
+    }
+
+    QElapsedTimer prefetch_timer;
+    prefetch_timer.start();
+
+    while (prefetch_row_ != prefetch_end_row_
+           && prefetch_timer.elapsed() < idle_dissection_interval_) {
+        if (prefetch_row_ < 0 || prefetch_row_ >= visible_rows_.count()) {
+            prefetch_end_row_ = prefetch_row_;
+            break;
+        }
+        PacketListRecord *record = visible_rows_[prefetch_row_];
+        if (record) {
+            record->prefetch(cap_file_);
+        }
+        prefetch_row_ += prefetch_step_;
+    }
+
+    if (prefetch_row_ != prefetch_end_row_) {
+        prefetch_scheduled_ = true;
+        QTimer::singleShot(0, this, &PacketListModel::prefetchIdle);
+    }
+}
+
 // XXX Pass in cinfo from packet_list_append so that we can fill in
 // line counts?
 gint PacketListModel::appendPacket(frame_data *fdata)
@@ -20,6 +20,7 @@
 
 #include <QAbstractItemModel>
 #include <QFont>
+#include <QFuture>
 #include <QVector>
 
 #include <ui/qt/progress_frame.h>
@@ -93,6 +94,16 @@ public slots:
     void stopSorting();
     void flushVisibleRows();
     void dissectIdle(bool reset = false);
+    /**
+     * @brief Tell the model which rows are on screen.
+     *
+     * Rows just past the viewport in the direction the user is scrolling
+     * are dissected and colorized a few at a time while the application is
+     * idle, so that they can be drawn from the cache once they scroll in.
+     * @param first_row The first visible row.
+     * @param last_row The last visible row.
+     */
+    void setViewportRows(int first_row, int last_row);
 
 private:
     capture_file *cap_file_;
@@ -110,17 +121,28 @@ private:
     static int text_sort_column_;
     static Qt::SortOrder sort_order_;
     static capture_file *sort_cap_file_;
-    static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
+    struct SortKey;
+    static bool sortKeyLessThan(const SortKey &k1, const SortKey &k2);
     static double parseNumericColumn(const QString &val, bool *ok);
+    void buildSortKeys(QVector<SortKey> &keys);
+    void sortKeys(QVector<SortKey> &keys);
+    void waitForSortWorkers(const QList<QFuture<void> > &futures);
+    void updateSortProgress();
 
     static gboolean stop_flag_;
     static ProgressFrame *progress_frame_;
     static double exp_comps_;
-    static double comps_;
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
 
+    int viewport_first_row_;
+    int prefetch_row_;
+    int prefetch_end_row_;
+    int prefetch_step_;
+    bool prefetch_scheduled_;
+    void prefetchIdle();
+
     bool isNumericColumn(int column);
 
 private slots:
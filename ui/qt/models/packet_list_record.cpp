@@ -24,7 +24,11 @@
 
 #include <QStringList>
 
-QCache<guint32, QStringList> PacketListRecord::col_text_cache_(500);
+#include <cstring>
+
+QCache<guint32, PacketListRecord::ColumnText> PacketListRecord::col_text_cache_(500);
+GStringChunk *PacketListRecord::string_cache_pool_ = g_string_chunk_new(1 << 16);
+QVector<bool> PacketListRecord::interned_columns_;
 QMap<int, int> PacketListRecord::cinfo_column_;
 unsigned PacketListRecord::rows_color_ver_ = 1;
 
@@ -77,16 +81,37 @@ const QString PacketListRecord::columnString(capture_file *cap_file, int column,
     // properly colorized?
     //
     bool dissect_color = ( colorized && !colorized_ ) || ( color_ver_ != rows_color_ver_ );
-    QStringList *col_text = nullptr;
+    ColumnText *col_text = nullptr;
     if (!dissect_color) {
         col_text = col_text_cache_.object(fdata_->num);
     }
-    if (col_text == nullptr || column >= col_text->count() || col_text->at(column).isNull()) {
+    if (col_text == nullptr || column >= col_text->cells.count()) {
         dissect(cap_file, true, dissect_color);
         col_text = col_text_cache_.object(fdata_->num);
     }
 
-    return col_text ? col_text->at(column) : QString();
+    return col_text ? col_text->string(column) : QString();
+}
+
+void PacketListRecord::prefetch(capture_file *cap_file)
+{
+    Q_ASSERT(fdata_);
+
+    if (!cap_file || read_failed_) {
+        return;
+    }
+
+    bool dissect_color = !colorized();
+    if (dissect_color || !col_text_cache_.contains(fdata_->num)) {
+        dissect(cap_file, true, dissect_color);
+    }
+}
+
+void PacketListRecord::invalidateAllRecords()
+{
+    col_text_cache_.clear();
+    // Nothing refers to the interned strings any more.
+    g_string_chunk_clear(string_cache_pool_);
 }
 
 void PacketListRecord::resetColumns(column_info *cinfo)
@@ -105,6 +130,42 @@ void PacketListRecord::resetColumns(column_info *cinfo)
             j++;
         }
     }
+
+    interned_columns_.fill(false, cinfo->num_cols);
+    for (i = 0; i < cinfo->num_cols; i++) {
+        switch (cinfo->columns[i].col_fmt) {
+        case COL_PROTOCOL:
+        case COL_DEF_SRC:
+        case COL_RES_SRC:
+        case COL_UNRES_SRC:
+        case COL_DEF_DST:
+        case COL_RES_DST:
+        case COL_UNRES_DST:
+        case COL_DEF_DL_SRC:
+        case COL_RES_DL_SRC:
+        case COL_UNRES_DL_SRC:
+        case COL_DEF_DL_DST:
+        case COL_RES_DL_DST:
+        case COL_UNRES_DL_DST:
+        case COL_DEF_NET_SRC:
+        case COL_RES_NET_SRC:
+        case COL_UNRES_NET_SRC:
+        case COL_DEF_NET_DST:
+        case COL_RES_NET_DST:
+        case COL_UNRES_NET_DST:
+        case COL_DEF_SRC_PORT:
+        case COL_RES_SRC_PORT:
+        case COL_UNRES_SRC_PORT:
+        case COL_DEF_DST_PORT:
+        case COL_RES_DST_PORT:
+        case COL_UNRES_DST_PORT:
+        case COL_EXPERT:
+            interned_columns_[i] = true;
+            break;
+        default:
+            break;
+        }
+    }
 }
 
 void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color)
@@ -219,28 +280,93 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         return;
     }
 
-    QStringList *col_text = new QStringList();
+    ColumnText *col_text = new ColumnText();
+    col_text->cells.resize(cinfo->num_cols);
 
     lines_ = 1;
     line_count_changed_ = false;
 
     for (int column = 0; column < cinfo->num_cols; ++column) {
-        int col_lines = 1;
+        int col_lines = 0;
 
-        QString col_str;
         int text_col = cinfo_column_.value(column, -1);
         if (text_col < 0) {
             col_fill_in_frame_data(fdata_, cinfo, column, FALSE);
         }
 
-        col_str = QString(get_column_text(cinfo, column));
-        *col_text << col_str;
-        col_lines = static_cast<int>(col_str.count('\n'));
+        const char *col_str = get_column_text(cinfo, column);
+        if (!col_str) {
+            col_str = "";
+        }
+
+        ColumnText::Cell &cell = col_text->cells[column];
+        quint64 number;
+        if (parseColumnNumber(col_str, &number)) {
+            cell.type = ColumnText::Number;
+            cell.length = 0;
+            cell.number = number;
+        } else if (interned_columns_.value(column, false)) {
+            cell.type = ColumnText::Interned;
+            cell.length = 0;
+            cell.interned = g_string_chunk_insert_const(string_cache_pool_, col_str);
+        } else {
+            size_t len = strlen(col_str);
+            cell.type = ColumnText::Packed;
+            cell.length = static_cast<quint32>(len);
+            cell.offset = static_cast<quint32>(col_text->packed.size());
+            col_text->packed.append(col_str, static_cast<int>(len));
+        }
+
+        for (const char *nl = strchr(col_str, '\n'); nl; nl = strchr(nl + 1, '\n')) {
+            col_lines++;
+        }
         if (col_lines > lines_) {
             lines_ = col_lines;
             line_count_changed_ = true;
         }
     }
+    col_text->packed.squeeze();
 
     col_text_cache_.insert(fdata_->num, col_text);
 }
+
+const QString PacketListRecord::ColumnText::string(int column) const
+{
+    const Cell &cell = cells.at(column);
+
+    switch (cell.type) {
+    case Interned:
+        return QString::fromUtf8(cell.interned);
+    case Number:
+        return QString::number(cell.number);
+    case Packed:
+    default:
+        return QString::fromUtf8(packed.constData() + cell.offset, static_cast<int>(cell.length));
+    }
+}
+
+// Plain decimal numbers without a sign, leading zeros, separators or
+// whitespace convert back to the same text with QString::number, so
+// they can be stored as numbers.
+bool PacketListRecord::parseColumnNumber(const char *str, quint64 *number)
+{
+    quint64 val = 0;
+    int digits = 0;
+
+    if (str[0] == '0' && str[1] != '\0') {
+        return false;
+    }
+
+    for (const char *p = str; *p; p++) {
+        if (*p < '0' || *p > '9' || ++digits > 19) {
+            return false;
+        }
+        val = val * 10 + static_cast<quint64>(*p - '0');
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    *number = val;
+    return true;
+}
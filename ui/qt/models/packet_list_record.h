@@ -22,6 +22,7 @@
 #include <QByteArray>
 #include <QCache>
 #include <QList>
+#include <QVector>
 #include <QVariant>
 
 struct conversation;
@@ -37,6 +38,9 @@ public:
     void ensureColorized(capture_file *cap_file);
     // Return the string value for a column. Data is cached if possible.
     const QString columnString(capture_file *cap_file, int column, bool colorized = false);
+    // Fill the column string cache and colorize the record ahead of time
+    // so that drawing it later doesn't require a dissection.
+    void prefetch(capture_file *cap_file);
     frame_data *frameData() const { return fdata_; }
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
@@ -47,11 +51,12 @@ public:
 
     void invalidateColorized() { colorized_ = false; }
     void invalidateRecord() { col_text_cache_.remove(fdata_->num); }
-    static void invalidateAllRecords() { col_text_cache_.clear(); }
+    static void invalidateAllRecords();
     /* In Qt 6, QCache maxCost is a qsizetype, but the QAbstractItemModel
      * number of rows is still an int, so we're limited to INT_MAX anyway.
      */
     static void setMaxCache(int cost) { col_text_cache_.setMaxCost(cost); }
+    static int maxCache() { return static_cast<int>(col_text_cache_.maxCost()); }
     static void resetColumns(column_info *cinfo);
     static void resetColorization() { rows_color_ver_++; }
 
@@ -59,8 +64,38 @@ public:
     inline int lineCountChanged() { return line_count_changed_; }
 
 private:
+    /**
+     * Compact column text for one row.
+     *
+     * Each column is stored in a single cell. Columns that usually have a
+     * handful of distinct values (protocol, addresses and ports) point to
+     * strings interned in string_cache_pool_, columns whose text is a plain
+     * decimal number are stored as that number, and everything else, e.g.
+     * the Info column, is packed as UTF-8 into a per-row arena.
+     */
+    struct ColumnText {
+        enum CellType : quint8 { Interned, Number, Packed };
+        struct Cell {
+            CellType type;
+            quint32 length;             // Packed
+            union {
+                const char *interned;   // Interned
+                quint64 number;         // Number
+                quint32 offset;         // Packed
+            };
+        };
+        QVector<Cell> cells;
+        QByteArray packed;
+
+        const QString string(int column) const;
+    };
+
     /** The column text for some columns */
-    static QCache<guint32, QStringList> col_text_cache_;
+    static QCache<guint32, ColumnText> col_text_cache_;
+    /** Interned text for low-cardinality columns */
+    static struct _GStringChunk *string_cache_pool_;
+    /** Columns whose text is interned */
+    static QVector<bool> interned_columns_;
 
     frame_data *fdata_;
     int lines_;
@@ -79,6 +114,7 @@ private:
 
     void dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color = false);
     void cacheColumnStrings(column_info *cinfo);
+    static bool parseColumnNumber(const char *str, quint64 *number);
 };
 
 #endif // PACKET_LIST_RECORD_H
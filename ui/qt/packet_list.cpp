@@ -271,6 +271,7 @@ PacketList::PacketList(QWidget *parent) :
             this, SLOT(sectionMoved(int,int,int)));
 
     connect(verticalScrollBar(), SIGNAL(actionTriggered(int)), this, SLOT(vScrollBarActionTriggered(int)));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(vScrollBarValueChanged(int)));
 }
 
 PacketList::~PacketList()
@@ -1931,6 +1932,19 @@ void PacketList::vScrollBarActionTriggered(int)
     scrollViewChanged(tail_at_end_);
 }
 
+// Let the model prefetch the rows we're about to scroll into view.
+void PacketList::vScrollBarValueChanged(int)
+{
+    QModelIndex first_idx = indexAt(viewport()->rect().topLeft());
+    if (!first_idx.isValid())
+        return;
+
+    QModelIndex last_idx = indexAt(viewport()->rect().bottomLeft());
+    int last_row = last_idx.isValid() ? last_idx.row() : packet_list_model_->rowCount() - 1;
+
+    packet_list_model_->setViewportRows(first_idx.row(), last_row);
+}
+
 void PacketList::scrollViewChanged(bool at_end)
 {
     if (capture_in_progress_ && prefs.capture_auto_scroll) {
@@ -199,6 +199,7 @@ private slots:
     void updateRowHeights(const QModelIndex &ih_index);
     void copySummary();
     void vScrollBarActionTriggered(int);
+    void vScrollBarValueChanged(int);
     void drawFarOverlay();
     void drawNearOverlay();
     void updatePackets(bool redraw);
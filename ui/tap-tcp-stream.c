@@ -109,9 +109,9 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg)
         return;
     }
 
-    /* rescan all the packets and pick up all interesting tcp headers.
-     * we only filter for TCP here for speed and do the actual compare
-     * in the tap listener
+    /* rescan the packets of the stream and pick up all interesting tcp
+     * headers. we only filter for TCP here for speed and do the actual
+     * compare in the tap listener
      */
     ts.direction = COMPARE_ANY_DIR;
     ts.tg      = tg;
@@ -123,7 +123,7 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg)
         g_string_free(error_string, TRUE);
         exit(1);   /* XXX: fix this */
     }
-    cf_retap_packets(cf);
+    cf_retap_stream(cf, "tcp.stream", tg->stream, &ts);
     remove_tap_listener(&ts);
 }
 
@@ -189,6 +189,10 @@ struct wtap_reader {
     int err;                    /* error code */
     const char *err_info;       /* additional error information string for some errors */
 
+    /* gets the data as it is read from the file */
+    wtap_raw_data_callback_t raw_data_cb;
+    void *raw_data_cb_data;
+
 #ifdef HAVE_ZLIB
     /* zlib inflate stream */
     z_stream strm;              /* stream structure in-place (not a pointer) */
@@ -274,6 +278,8 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
     }
     if (ret == 0)
         state->eof = TRUE;
+    else if (state->raw_data_cb != NULL)
+        state->raw_data_cb(state->raw_pos, read_ptr, (guint)ret, state->raw_data_cb_data);
     state->raw_pos += ret;
     buf->avail += (guint)ret;
     return 0;
@@ -1593,6 +1599,13 @@ file_tell_raw(FILE_T stream)
     return stream->raw_pos;
 }
 
+void
+file_set_raw_data_cb(FILE_T stream, wtap_raw_data_callback_t raw_data_cb, void *user_data)
+{
+    stream->raw_data_cb = raw_data_cb;
+    stream->raw_data_cb_data = user_data;
+}
+
 int
 file_fstat(FILE_T stream, ws_statb64 *statb, int *err)
 {
@@ -19,6 +19,7 @@ extern void file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArra
 WS_DLL_PUBLIC gint64 file_seek(FILE_T stream, gint64 offset, int whence, int *err);
 WS_DLL_PUBLIC gint64 file_tell(FILE_T stream);
 extern gint64 file_tell_raw(FILE_T stream);
+extern void file_set_raw_data_cb(FILE_T stream, wtap_raw_data_callback_t raw_data_cb, void *user_data);
 extern int file_fstat(FILE_T stream, ws_statb64 *statb, int *err);
 WS_DLL_PUBLIC gboolean file_iscompressed(FILE_T stream);
 WS_DLL_PUBLIC int file_read(void *buf, unsigned int count, FILE_T file);
@@ -1595,6 +1595,13 @@ wtapng_process_nrb(wtap *wth, wtap_block_t nrb)
 	wtapng_process_nrb_ipv6(wth, nrb);
 }
 
+gint64
+wtap_set_cb_raw_data(wtap *wth, wtap_raw_data_callback_t raw_data_cb, void *user_data)
+{
+	file_set_raw_data_cb(wth->fh, raw_data_cb, user_data);
+	return file_tell_raw(wth->fh);
+}
+
 void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secrets) {
 	/* Is a valid wth given that supports DSBs? */
 	if (!wth || !wth->dsbs)
@@ -1785,6 +1785,24 @@ typedef void (*wtap_new_secrets_callback_t)(guint32 secrets_type, const void *se
 WS_DLL_PUBLIC
 void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secrets);
 
+/**
+ * Set a callback function to receive the data read from the file, as it
+ * is stored in the file (i.e., before it's decompressed), e.g. to compute
+ * a checksum of the file without reading it a second time.
+ *
+ * The callback gets the offset in the file at which the data was read.
+ * The data is handed over in the order in which it is read; after a seek
+ * (including the rewinds some file type readers do while opening the
+ * file), data can be handed over again, and data that was skipped isn't
+ * handed over.
+ *
+ * @return The offset in the file up to which it was read before the
+ * callback was set.
+ */
+typedef void (*wtap_raw_data_callback_t)(gint64 offset, const guint8 *data, guint len, void *user_data);
+WS_DLL_PUBLIC
+gint64 wtap_set_cb_raw_data(wtap *wth, wtap_raw_data_callback_t raw_data_cb, void *user_data);
+
 /** Read the next record in the file, filling in *phdr and *buf.
  *
  * @wth a wtap * returned by a call that opened a file for reading.
@@ -0,0 +1,942 @@
+/* arrow_writer.c
+ * Routines for writing tables in the Apache Arrow IPC file format.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "arrow_writer.h"
+
+#include <string.h>
+
+#include <wsutil/ws_assert.h>
+
+/*
+ * The metadata of the Arrow IPC format (the schema, the description of
+ * the record batches and the file footer) is serialized with FlatBuffers,
+ * see Schema.fbs, Message.fbs and File.fbs in the Arrow repository.
+ * The few tables we need are built by hand with the minimal builder
+ * below instead of depending on the FlatBuffers library.
+ */
+
+/* Union type ids of Type in Schema.fbs */
+#define ARROW_TYPE_INT              2
+#define ARROW_TYPE_FLOATING_POINT   3
+#define ARROW_TYPE_BINARY           4
+#define ARROW_TYPE_UTF8             5
+#define ARROW_TYPE_BOOL             6
+#define ARROW_TYPE_TIMESTAMP        10
+
+/* Union type ids of MessageHeader in Message.fbs */
+#define ARROW_MESSAGE_SCHEMA            1
+#define ARROW_MESSAGE_DICTIONARY_BATCH  2
+#define ARROW_MESSAGE_RECORD_BATCH      3
+
+#define ARROW_METADATA_V5           4
+#define ARROW_PRECISION_DOUBLE      2
+#define ARROW_TIME_UNIT_NANOSECOND  3
+
+#define ARROW_MAGIC                 "ARROW1"
+#define ARROW_MAGIC_LEN             6
+#define ARROW_CONTINUATION          0xFFFFFFFF
+
+/*
+ * Start a new record batch when the variable-length data of a column
+ * exceeds this, so that the 32-bit offsets cannot overflow.
+ */
+#define ARROW_WRITER_BATCH_BYTES    (64 * 1024 * 1024)
+
+#define ARROW_ALIGN(len)            (((len) + 7) & ~(gsize)7)
+
+/*
+ * FlatBuffers builder. A FlatBuffer is built back to front: the children
+ * of a table are written before the table itself, at the end of the
+ * buffer, so that the table refers to them with forward offsets. All
+ * positions ("refs") are counted from the end of the buffer, so that
+ * they do not change when more data is prepended.
+ */
+#define FB_MAX_SLOTS    8
+
+typedef struct {
+    GByteArray *buf;
+    guint       minalign;
+    guint32     slots[FB_MAX_SLOTS];   /* refs of the fields of the current table */
+    guint       num_slots;
+    guint32     table_start;
+} fb_builder;
+
+static void
+fb_init(fb_builder *fb)
+{
+    memset(fb, 0, sizeof(*fb));
+    fb->buf = g_byte_array_sized_new(1024);
+    fb->minalign = 1;
+}
+
+static void
+fb_put_le(fb_builder *fb, guint64 value, guint size)
+{
+    guint8 bytes[8];
+    guint i;
+
+    for (i = 0; i < size; i++) {
+        bytes[i] = (guint8)(value >> (8 * i));
+    }
+    g_byte_array_prepend(fb->buf, bytes, size);
+}
+
+/*
+ * Pad the buffer so that it is aligned to size after additional_bytes
+ * are prepended.
+ */
+static void
+fb_prep(fb_builder *fb, guint size, gsize additional_bytes)
+{
+    static const guint8 zeros[8];
+    gsize pad;
+
+    if (size > fb->minalign) {
+        fb->minalign = size;
+    }
+    pad = (~(fb->buf->len + additional_bytes) + 1) & (size - 1);
+    g_byte_array_prepend(fb->buf, zeros, (guint)pad);
+}
+
+static void
+fb_scalar(fb_builder *fb, guint64 value, guint size)
+{
+    fb_prep(fb, size, 0);
+    fb_put_le(fb, value, size);
+}
+
+static void
+fb_uoffset(fb_builder *fb, guint32 ref)
+{
+    fb_prep(fb, 4, 0);
+    fb_put_le(fb, fb->buf->len + 4 - ref, 4);
+}
+
+static guint32
+fb_string(fb_builder *fb, const char *str)
+{
+    gsize len = strlen(str);
+
+    fb_prep(fb, 4, len + 1);
+    g_byte_array_prepend(fb->buf, (const guint8 *)"", 1);
+    g_byte_array_prepend(fb->buf, (const guint8 *)str, (guint)len);
+    fb_put_le(fb, len, 4);
+    return fb->buf->len;
+}
+
+/* A vector of structs, already serialized in little endian order. */
+static guint32
+fb_struct_vector(fb_builder *fb, const guint8 *data, guint count, gsize elem_size)
+{
+    gsize len = count * elem_size;
+
+    fb_prep(fb, 4, len);
+    fb_prep(fb, 8, len);
+    g_byte_array_prepend(fb->buf, data, (guint)len);
+    fb_put_le(fb, count, 4);
+    return fb->buf->len;
+}
+
+static guint32
+fb_offset_vector(fb_builder *fb, const guint32 *refs, guint count)
+{
+    guint i;
+
+    fb_prep(fb, 4, 4 * (gsize)count);
+    for (i = count; i > 0; i--) {
+        fb_uoffset(fb, refs[i - 1]);
+    }
+    fb_put_le(fb, count, 4);
+    return fb->buf->len;
+}
+
+static void
+fb_table_start(fb_builder *fb)
+{
+    memset(fb->slots, 0, sizeof(fb->slots));
+    fb->num_slots = 0;
+    fb->table_start = fb->buf->len;
+}
+
+static void
+fb_table_slot(fb_builder *fb, guint slot)
+{
+    ws_assert(slot < FB_MAX_SLOTS);
+    fb->slots[slot] = fb->buf->len;
+    if (slot >= fb->num_slots) {
+        fb->num_slots = slot + 1;
+    }
+}
+
+static void
+fb_table_add_scalar(fb_builder *fb, guint slot, guint64 value, guint size)
+{
+    fb_scalar(fb, value, size);
+    fb_table_slot(fb, slot);
+}
+
+static void
+fb_table_add_offset(fb_builder *fb, guint slot, guint32 ref)
+{
+    fb_uoffset(fb, ref);
+    fb_table_slot(fb, slot);
+}
+
+static guint32
+fb_table_end(fb_builder *fb)
+{
+    guint32 object, vtable, soffset;
+    guint i;
+
+    /* The table starts with the offset of its vtable, patched below. */
+    fb_scalar(fb, 0, 4);
+    object = fb->buf->len;
+
+    for (i = fb->num_slots; i > 0; i--) {
+        fb_put_le(fb, fb->slots[i - 1] ? object - fb->slots[i - 1] : 0, 2);
+    }
+    fb_put_le(fb, object - fb->table_start, 2);
+    fb_put_le(fb, (fb->num_slots + 2) * 2, 2);
+    vtable = fb->buf->len;
+
+    /* The vtable precedes the table, at table start - soffset. */
+    soffset = vtable - object;
+    for (i = 0; i < 4; i++) {
+        fb->buf->data[fb->buf->len - object + i] = (guint8)(soffset >> (8 * i));
+    }
+    return object;
+}
+
+static GByteArray *
+fb_finish(fb_builder *fb, guint32 root)
+{
+    fb_prep(fb, fb->minalign, 4);
+    fb_uoffset(fb, root);
+    return fb->buf;
+}
+
+/*
+ * The writer.
+ */
+typedef struct {
+    char       *name;
+    arrow_column_type_e type;
+    gboolean    is_set;         /* a value was set in the current row */
+    guint       null_count;
+    GByteArray *validity;       /* one bit per row */
+    GByteArray *values;         /* fixed-size values, bits for booleans,
+                                   offsets for strings and byte strings,
+                                   indices for dictionary strings */
+    GByteArray *data;           /* string and byte string data */
+    /* Dictionary strings */
+    GHashTable *dict;           /* string -> index + 1 */
+    guint       dict_len;
+    GByteArray *dict_offsets;   /* entries not written yet */
+    GByteArray *dict_data;
+    gboolean    dict_written;
+} arrow_column;
+
+typedef struct {
+    gint64 offset;
+    gint32 metadata_len;
+    gint64 body_len;
+} arrow_block;
+
+struct _arrow_writer {
+    FILE       *fh;
+    gint64      offset;         /* of the next byte written */
+    gboolean    error;
+    gboolean    started;
+    guint       batch_rows;
+    guint       num_rows;       /* in the current record batch */
+    GPtrArray  *columns;
+    GArray     *dictionary_blocks;
+    GArray     *record_batch_blocks;
+};
+
+typedef struct {
+    const guint8 *data;
+    gsize len;
+} arrow_buffer;
+
+static void
+bitmap_set(GByteArray *bitmap, guint idx, gboolean value)
+{
+    if (idx / 8 >= bitmap->len) {
+        guint8 zero = 0;
+        g_byte_array_append(bitmap, &zero, 1);
+    }
+    if (value) {
+        bitmap->data[idx / 8] |= 1 << (idx % 8);
+    }
+}
+
+static void
+append_le(GByteArray *array, guint64 value, guint size)
+{
+    guint8 bytes[8];
+    guint i;
+
+    for (i = 0; i < size; i++) {
+        bytes[i] = (guint8)(value >> (8 * i));
+    }
+    g_byte_array_append(array, bytes, size);
+}
+
+static gboolean
+column_is_variable(const arrow_column *column)
+{
+    return column->type == ARROW_COLUMN_STRING || column->type == ARROW_COLUMN_BINARY;
+}
+
+static guint
+column_value_size(const arrow_column *column)
+{
+    switch (column->type) {
+    case ARROW_COLUMN_BOOL:
+        return 0;
+    case ARROW_COLUMN_INT32:
+    case ARROW_COLUMN_UINT32:
+    case ARROW_COLUMN_STRING:
+    case ARROW_COLUMN_STRING_DICT:
+    case ARROW_COLUMN_BINARY:
+        return 4;
+    case ARROW_COLUMN_INT64:
+    case ARROW_COLUMN_UINT64:
+    case ARROW_COLUMN_DOUBLE:
+    case ARROW_COLUMN_TIMESTAMP_NS:
+        return 8;
+    }
+    ws_assert_not_reached();
+    return 0;
+}
+
+static void
+column_reset(arrow_column *column)
+{
+    g_byte_array_set_size(column->validity, 0);
+    g_byte_array_set_size(column->values, 0);
+    g_byte_array_set_size(column->data, 0);
+    column->null_count = 0;
+    if (column_is_variable(column)) {
+        append_le(column->values, 0, 4);
+    }
+}
+
+static void
+column_free(gpointer data)
+{
+    arrow_column *column = (arrow_column *)data;
+
+    g_free(column->name);
+    g_byte_array_free(column->validity, TRUE);
+    g_byte_array_free(column->values, TRUE);
+    g_byte_array_free(column->data, TRUE);
+    if (column->dict) {
+        g_hash_table_destroy(column->dict);
+        g_byte_array_free(column->dict_offsets, TRUE);
+        g_byte_array_free(column->dict_data, TRUE);
+    }
+    g_free(column);
+}
+
+arrow_writer *
+arrow_writer_new(FILE *fh, guint batch_rows)
+{
+    arrow_writer *writer = g_new0(arrow_writer, 1);
+
+    writer->fh = fh;
+    writer->batch_rows = batch_rows ? batch_rows : ARROW_WRITER_BATCH_ROWS;
+    writer->columns = g_ptr_array_new_with_free_func(column_free);
+    writer->dictionary_blocks = g_array_new(FALSE, FALSE, sizeof(arrow_block));
+    writer->record_batch_blocks = g_array_new(FALSE, FALSE, sizeof(arrow_block));
+    return writer;
+}
+
+guint
+arrow_writer_add_column(arrow_writer *writer, const char *name, arrow_column_type_e type)
+{
+    arrow_column *column = g_new0(arrow_column, 1);
+
+    ws_assert(!writer->started);
+
+    column->name = g_strdup(name);
+    column->type = type;
+    column->validity = g_byte_array_new();
+    column->values = g_byte_array_new();
+    column->data = g_byte_array_new();
+    if (type == ARROW_COLUMN_STRING_DICT) {
+        column->dict = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+        column->dict_offsets = g_byte_array_new();
+        column->dict_data = g_byte_array_new();
+        append_le(column->dict_offsets, 0, 4);
+    }
+    column_reset(column);
+    g_ptr_array_add(writer->columns, column);
+    return writer->columns->len - 1;
+}
+
+arrow_column_type_e
+arrow_writer_column_type(const arrow_writer *writer, guint column)
+{
+    ws_assert(column < writer->columns->len);
+    return ((arrow_column *)g_ptr_array_index(writer->columns, column))->type;
+}
+
+static void
+arrow_write(arrow_writer *writer, const void *data, gsize len)
+{
+    if (len != 0 && fwrite(data, 1, len, writer->fh) != len) {
+        writer->error = TRUE;
+    }
+    writer->offset += len;
+}
+
+static void
+arrow_write_padding(arrow_writer *writer, gsize len)
+{
+    static const guint8 zeros[8];
+
+    arrow_write(writer, zeros, ARROW_ALIGN(len) - len);
+}
+
+/*
+ * Write an encapsulated message: a continuation marker, the length of the
+ * metadata, the metadata padded to 8 bytes, and the body (which is written
+ * by the caller). Returns the block describing it for the file footer.
+ */
+static arrow_block
+arrow_write_message(arrow_writer *writer, GByteArray *metadata, gint64 body_len)
+{
+    arrow_block block;
+    guint8 prefix[8];
+    gsize padded_len = ARROW_ALIGN(metadata->len + 8) - 8;
+    guint i;
+
+    block.offset = writer->offset;
+    block.metadata_len = (gint32)(padded_len + 8);
+    block.body_len = body_len;
+
+    for (i = 0; i < 4; i++) {
+        prefix[i] = (guint8)(ARROW_CONTINUATION >> (8 * i));
+        prefix[4 + i] = (guint8)(padded_len >> (8 * i));
+    }
+    arrow_write(writer, prefix, sizeof(prefix));
+    arrow_write(writer, metadata->data, metadata->len);
+    arrow_write_padding(writer, metadata->len);
+    return block;
+}
+
+static guint32
+build_int_type(fb_builder *fb, guint bit_width, gboolean is_signed)
+{
+    fb_table_start(fb);
+    fb_table_add_scalar(fb, 0, bit_width, 4);
+    fb_table_add_scalar(fb, 1, is_signed, 1);
+    return fb_table_end(fb);
+}
+
+static guint32
+build_field(fb_builder *fb, const arrow_column *column, guint column_idx)
+{
+    guint32 name, type, children, dictionary = 0, timezone = 0;
+    guint8 type_type;
+
+    name = fb_string(fb, column->name);
+    children = fb_offset_vector(fb, NULL, 0);
+
+    if (column->type == ARROW_COLUMN_TIMESTAMP_NS) {
+        timezone = fb_string(fb, "UTC");
+    }
+
+    switch (column->type) {
+    case ARROW_COLUMN_BOOL:
+        type_type = ARROW_TYPE_BOOL;
+        fb_table_start(fb);
+        type = fb_table_end(fb);
+        break;
+    case ARROW_COLUMN_INT32:
+    case ARROW_COLUMN_UINT32:
+    case ARROW_COLUMN_INT64:
+    case ARROW_COLUMN_UINT64:
+        type_type = ARROW_TYPE_INT;
+        type = build_int_type(fb, column_value_size(column) * 8,
+                              column->type == ARROW_COLUMN_INT32 || column->type == ARROW_COLUMN_INT64);
+        break;
+    case ARROW_COLUMN_DOUBLE:
+        type_type = ARROW_TYPE_FLOATING_POINT;
+        fb_table_start(fb);
+        fb_table_add_scalar(fb, 0, ARROW_PRECISION_DOUBLE, 2);
+        type = fb_table_end(fb);
+        break;
+    case ARROW_COLUMN_TIMESTAMP_NS:
+        type_type = ARROW_TYPE_TIMESTAMP;
+        fb_table_start(fb);
+        fb_table_add_offset(fb, 1, timezone);
+        fb_table_add_scalar(fb, 0, ARROW_TIME_UNIT_NANOSECOND, 2);
+        type = fb_table_end(fb);
+        break;
+    case ARROW_COLUMN_STRING:
+    case ARROW_COLUMN_STRING_DICT:
+        type_type = ARROW_TYPE_UTF8;
+        fb_table_start(fb);
+        type = fb_table_end(fb);
+        break;
+    case ARROW_COLUMN_BINARY:
+        type_type = ARROW_TYPE_BINARY;
+        fb_table_start(fb);
+        type = fb_table_end(fb);
+        break;
+    default:
+        ws_assert_not_reached();
+        return 0;
+    }
+
+    if (column->type == ARROW_COLUMN_STRING_DICT) {
+        /* The dictionary id is the column index, the indices are int32. */
+        guint32 index_type = build_int_type(fb, 32, TRUE);
+
+        fb_table_start(fb);
+        fb_table_add_scalar(fb, 0, column_idx, 8);
+        fb_table_add_offset(fb, 1, index_type);
+        dictionary = fb_table_end(fb);
+    }
+
+    fb_table_start(fb);
+    fb_table_add_offset(fb, 0, name);
+    fb_table_add_offset(fb, 3, type);
+    if (dictionary) {
+        fb_table_add_offset(fb, 4, dictionary);
+    }
+    fb_table_add_offset(fb, 5, children);
+    fb_table_add_scalar(fb, 1, TRUE, 1);
+    fb_table_add_scalar(fb, 2, type_type, 1);
+    return fb_table_end(fb);
+}
+
+static guint32
+build_schema(fb_builder *fb, const arrow_writer *writer)
+{
+    guint32 *fields = g_new(guint32, writer->columns->len);
+    guint32 fields_vector;
+    guint i;
+
+    for (i = 0; i < writer->columns->len; i++) {
+        fields[i] = build_field(fb, (const arrow_column *)g_ptr_array_index(writer->columns, i), i);
+    }
+    fields_vector = fb_offset_vector(fb, fields, writer->columns->len);
+    g_free(fields);
+
+    fb_table_start(fb);
+    fb_table_add_offset(fb, 1, fields_vector);
+    fb_table_add_scalar(fb, 0, 0, 2);   /* little endian */
+    return fb_table_end(fb);
+}
+
+static guint32
+build_message(fb_builder *fb, guint8 header_type, guint32 header, gint64 body_len)
+{
+    fb_table_start(fb);
+    fb_table_add_scalar(fb, 3, (guint64)body_len, 8);
+    fb_table_add_offset(fb, 2, header);
+    fb_table_add_scalar(fb, 0, ARROW_METADATA_V5, 2);
+    fb_table_add_scalar(fb, 1, header_type, 1);
+    return fb_table_end(fb);
+}
+
+static void
+arrow_writer_start(arrow_writer *writer)
+{
+    static const guint8 magic[8] = ARROW_MAGIC;
+    fb_builder fb;
+    GByteArray *metadata;
+
+    if (writer->started) {
+        return;
+    }
+    writer->started = TRUE;
+
+    arrow_write(writer, magic, sizeof(magic));
+
+    fb_init(&fb);
+    metadata = fb_finish(&fb, build_message(&fb, ARROW_MESSAGE_SCHEMA, build_schema(&fb, writer), 0));
+    arrow_write_message(writer, metadata, 0);
+    g_byte_array_free(metadata, TRUE);
+}
+
+/*
+ * Write a record batch message whose body consists of the given buffers,
+ * for columns with the given lengths and null counts.
+ */
+static arrow_block
+arrow_write_record_batch(arrow_writer *writer, guint num_rows,
+                         GByteArray *nodes, const GArray *buffers,
+                         gint64 dictionary_id, gboolean is_delta)
+{
+    GByteArray *buffer_descs = g_byte_array_new();
+    GByteArray *metadata;
+    arrow_block block;
+    fb_builder fb;
+    guint32 nodes_vector, buffers_vector, header;
+    gint64 body_len = 0;
+    guint i;
+
+    for (i = 0; i < buffers->len; i++) {
+        const arrow_buffer *buffer = &g_array_index(buffers, arrow_buffer, i);
+
+        append_le(buffer_descs, body_len, 8);
+        append_le(buffer_descs, buffer->len, 8);
+        body_len += ARROW_ALIGN(buffer->len);
+    }
+
+    fb_init(&fb);
+    nodes_vector = fb_struct_vector(&fb, nodes->data, nodes->len / 16, 16);
+    buffers_vector = fb_struct_vector(&fb, buffer_descs->data, buffers->len, 16);
+    fb_table_start(&fb);
+    fb_table_add_scalar(&fb, 0, num_rows, 8);
+    fb_table_add_offset(&fb, 1, nodes_vector);
+    fb_table_add_offset(&fb, 2, buffers_vector);
+    header = fb_table_end(&fb);
+
+    if (dictionary_id >= 0) {
+        guint32 record_batch = header;
+
+        fb_table_start(&fb);
+        fb_table_add_scalar(&fb, 0, (guint64)dictionary_id, 8);
+        fb_table_add_offset(&fb, 1, record_batch);
+        fb_table_add_scalar(&fb, 2, is_delta, 1);
+        header = fb_table_end(&fb);
+        metadata = fb_finish(&fb, build_message(&fb, ARROW_MESSAGE_DICTIONARY_BATCH, header, body_len));
+    } else {
+        metadata = fb_finish(&fb, build_message(&fb, ARROW_MESSAGE_RECORD_BATCH, header, body_len));
+    }
+
+    block = arrow_write_message(writer, metadata, body_len);
+    g_byte_array_free(metadata, TRUE);
+    g_byte_array_free(buffer_descs, TRUE);
+
+    for (i = 0; i < buffers->len; i++) {
+        const arrow_buffer *buffer = &g_array_index(buffers, arrow_buffer, i);
+
+        arrow_write(writer, buffer->data, buffer->len);
+        arrow_write_padding(writer, buffer->len);
+    }
+    return block;
+}
+
+static void
+add_buffer(GArray *buffers, const guint8 *data, gsize len)
+{
+    arrow_buffer buffer = { data, len };
+
+    g_array_append_val(buffers, buffer);
+}
+
+static void
+add_node(GByteArray *nodes, guint length, guint null_count)
+{
+    append_le(nodes, length, 8);
+    append_le(nodes, null_count, 8);
+}
+
+/* Write the dictionary entries added since the last record batch. */
+static void
+arrow_write_dictionary(arrow_writer *writer, arrow_column *column, guint column_idx)
+{
+    GByteArray *nodes;
+    GArray *buffers;
+    arrow_block block;
+    guint count = column->dict_offsets->len / 4 - 1;
+
+    /* The first dictionary batch is required, even if it is empty. */
+    if (count == 0 && column->dict_written) {
+        return;
+    }
+
+    nodes = g_byte_array_new();
+    buffers = g_array_new(FALSE, FALSE, sizeof(arrow_buffer));
+    add_node(nodes, count, 0);
+    add_buffer(buffers, NULL, 0);
+    add_buffer(buffers, column->dict_offsets->data, column->dict_offsets->len);
+    add_buffer(buffers, column->dict_data->data, column->dict_data->len);
+
+    block = arrow_write_record_batch(writer, count, nodes, buffers, column_idx, column->dict_written);
+    g_array_append_val(writer->dictionary_blocks, block);
+    column->dict_written = TRUE;
+
+    g_byte_array_free(nodes, TRUE);
+    g_array_free(buffers, TRUE);
+
+    g_byte_array_set_size(column->dict_offsets, 0);
+    g_byte_array_set_size(column->dict_data, 0);
+    append_le(column->dict_offsets, 0, 4);
+}
+
+static void
+arrow_write_batch(arrow_writer *writer)
+{
+    GByteArray *nodes = g_byte_array_new();
+    GArray *buffers = g_array_new(FALSE, FALSE, sizeof(arrow_buffer));
+    arrow_block block;
+    guint i;
+
+    arrow_writer_start(writer);
+
+    for (i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+
+        if (column->dict) {
+            arrow_write_dictionary(writer, column, i);
+        }
+
+        add_node(nodes, writer->num_rows, column->null_count);
+        /* The validity bitmap can be left out if there are no nulls. */
+        if (column->null_count != 0) {
+            add_buffer(buffers, column->validity->data, column->validity->len);
+        } else {
+            add_buffer(buffers, NULL, 0);
+        }
+        add_buffer(buffers, column->values->data, column->values->len);
+        if (column_is_variable(column)) {
+            add_buffer(buffers, column->data->data, column->data->len);
+        }
+    }
+
+    block = arrow_write_record_batch(writer, writer->num_rows, nodes, buffers, -1, FALSE);
+    g_array_append_val(writer->record_batch_blocks, block);
+
+    g_byte_array_free(nodes, TRUE);
+    g_array_free(buffers, TRUE);
+
+    for (i = 0; i < writer->columns->len; i++) {
+        column_reset((arrow_column *)g_ptr_array_index(writer->columns, i));
+    }
+    writer->num_rows = 0;
+}
+
+static arrow_column *
+column_to_set(arrow_writer *writer, guint column_idx)
+{
+    arrow_column *column;
+
+    ws_assert(column_idx < writer->columns->len);
+    column = (arrow_column *)g_ptr_array_index(writer->columns, column_idx);
+    if (column->is_set) {
+        return NULL;
+    }
+    column->is_set = TRUE;
+    return column;
+}
+
+void
+arrow_writer_set_bool(arrow_writer *writer, guint column_idx, gboolean value)
+{
+    arrow_column *column = column_to_set(writer, column_idx);
+
+    if (column) {
+        ws_assert(column->type == ARROW_COLUMN_BOOL);
+        bitmap_set(column->values, writer->num_rows, value);
+    }
+}
+
+void
+arrow_writer_set_int(arrow_writer *writer, guint column_idx, gint64 value)
+{
+    arrow_column *column = column_to_set(writer, column_idx);
+
+    if (column) {
+        ws_assert(column->type == ARROW_COLUMN_INT32 || column->type == ARROW_COLUMN_INT64 ||
+                  column->type == ARROW_COLUMN_TIMESTAMP_NS);
+        append_le(column->values, (guint64)value, column_value_size(column));
+    }
+}
+
+void
+arrow_writer_set_uint(arrow_writer *writer, guint column_idx, guint64 value)
+{
+    arrow_column *column = column_to_set(writer, column_idx);
+
+    if (column) {
+        ws_assert(column->type == ARROW_COLUMN_UINT32 || column->type == ARROW_COLUMN_UINT64);
+        append_le(column->values, value, column_value_size(column));
+    }
+}
+
+void
+arrow_writer_set_double(arrow_writer *writer, guint column_idx, double value)
+{
+    arrow_column *column = column_to_set(writer, column_idx);
+    guint64 bits;
+
+    if (column) {
+        ws_assert(column->type == ARROW_COLUMN_DOUBLE);
+        memcpy(&bits, &value, sizeof(bits));
+        append_le(column->values, bits, 8);
+    }
+}
+
+static void
+column_append_data(arrow_column *column, const guint8 *value, gsize len)
+{
+    g_byte_array_append(column->data, value, (guint)len);
+    append_le(column->values, column->data->len, 4);
+}
+
+void
+arrow_writer_set_string(arrow_writer *writer, guint column_idx, const char *value)
+{
+    arrow_column *column = column_to_set(writer, column_idx);
+    gpointer index;
+
+    if (!column) {
+        return;
+    }
+    if (column->type == ARROW_COLUMN_STRING) {
+        column_append_data(column, (const guint8 *)value, strlen(value));
+        return;
+    }
+
+    ws_assert(column->type == ARROW_COLUMN_STRING_DICT);
+    index = g_hash_table_lookup(column->dict, value);
+    if (index == NULL) {
+        gsize len = strlen(value);
+
+        index = GUINT_TO_POINTER(++column->dict_len);
+        g_hash_table_insert(column->dict, g_strdup(value), index);
+        g_byte_array_append(column->dict_data, (const guint8 *)value, (guint)len);
+        append_le(column->dict_offsets, column->dict_data->len, 4);
+    }
+    append_le(column->values, GPOINTER_TO_UINT(index) - 1, 4);
+}
+
+void
+arrow_writer_set_bytes(arrow_writer *writer, guint column_idx, const guint8 *value, gsize len)
+{
+    arrow_column *column = column_to_set(writer, column_idx);
+
+    if (column) {
+        ws_assert(column->type == ARROW_COLUMN_BINARY);
+        column_append_data(column, value, len);
+    }
+}
+
+void
+arrow_writer_end_row(arrow_writer *writer)
+{
+    gboolean batch_full = writer->num_rows + 1 >= writer->batch_rows;
+    guint i;
+
+    for (i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+
+        bitmap_set(column->validity, writer->num_rows, column->is_set);
+        if (!column->is_set) {
+            /* Nulls still take up a value slot. */
+            column->null_count++;
+            if (column->type == ARROW_COLUMN_BOOL) {
+                bitmap_set(column->values, writer->num_rows, FALSE);
+            } else if (column_is_variable(column)) {
+                append_le(column->values, column->data->len, 4);
+            } else {
+                append_le(column->values, 0, column_value_size(column));
+            }
+        }
+        column->is_set = FALSE;
+
+        if (column->data->len > ARROW_WRITER_BATCH_BYTES ||
+                (column->dict && column->dict_data->len > ARROW_WRITER_BATCH_BYTES)) {
+            batch_full = TRUE;
+        }
+    }
+    writer->num_rows++;
+
+    if (batch_full) {
+        arrow_write_batch(writer);
+    }
+}
+
+static guint32
+build_blocks(fb_builder *fb, const GArray *blocks)
+{
+    GByteArray *data = g_byte_array_new();
+    guint32 ref;
+    guint i;
+
+    for (i = 0; i < blocks->len; i++) {
+        const arrow_block *block = &g_array_index(blocks, arrow_block, i);
+
+        append_le(data, (guint64)block->offset, 8);
+        append_le(data, (guint32)block->metadata_len, 4);
+        append_le(data, 0, 4);      /* padding */
+        append_le(data, (guint64)block->body_len, 8);
+    }
+    ref = fb_struct_vector(fb, data->data, blocks->len, 24);
+    g_byte_array_free(data, TRUE);
+    return ref;
+}
+
+gboolean
+arrow_writer_finish(arrow_writer *writer)
+{
+    static const guint8 end_of_stream[8] = { 0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0 };
+    fb_builder fb;
+    GByteArray *footer;
+    guint32 schema, dictionaries, record_batches;
+    guint8 footer_len[4];
+    gboolean ok;
+    guint i;
+
+    /* Write the remaining rows; a file with no rows still has a batch. */
+    if (writer->num_rows != 0 || writer->record_batch_blocks->len == 0) {
+        arrow_write_batch(writer);
+    }
+    arrow_write(writer, end_of_stream, sizeof(end_of_stream));
+
+    fb_init(&fb);
+    schema = build_schema(&fb, writer);
+    dictionaries = build_blocks(&fb, writer->dictionary_blocks);
+    record_batches = build_blocks(&fb, writer->record_batch_blocks);
+    fb_table_start(&fb);
+    fb_table_add_offset(&fb, 1, schema);
+    fb_table_add_offset(&fb, 2, dictionaries);
+    fb_table_add_offset(&fb, 3, record_batches);
+    fb_table_add_scalar(&fb, 0, ARROW_METADATA_V5, 2);
+    footer = fb_finish(&fb, fb_table_end(&fb));
+
+    arrow_write(writer, footer->data, footer->len);
+    for (i = 0; i < 4; i++) {
+        footer_len[i] = (guint8)(footer->len >> (8 * i));
+    }
+    arrow_write(writer, footer_len, sizeof(footer_len));
+    arrow_write(writer, ARROW_MAGIC, ARROW_MAGIC_LEN);
+    g_byte_array_free(footer, TRUE);
+
+    ok = !writer->error;
+    g_ptr_array_free(writer->columns, TRUE);
+    g_array_free(writer->dictionary_blocks, TRUE);
+    g_array_free(writer->record_batch_blocks, TRUE);
+    g_free(writer);
+    return ok;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
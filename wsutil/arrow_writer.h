@@ -0,0 +1,136 @@
+/** @file
+ * Routines for writing tables in the Apache Arrow IPC file format.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ARROW_WRITER_H__
+#define __ARROW_WRITER_H__
+
+#include "ws_symbol_export.h"
+#include <glib.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Writes a table with typed columns as an Arrow IPC file
+ * (https://arrow.apache.org/docs/format/Columnar.html), which analytics
+ * tools can memory-map and use without parsing it.
+ *
+ * The columns are added first, then the rows are added one at a time by
+ * setting the values of the columns and ending the row. Columns that were
+ * not set in a row are null. The rows are written out in record batches
+ * of a fixed number of rows, so the memory used does not depend on the
+ * number of rows (except for the dictionaries, see below).
+ *
+ * The file is written sequentially, so it can also be written to a pipe.
+ *
+ * Example:
+ *
+ *  arrow_writer *writer = arrow_writer_new(stdout, 0);
+ *  guint num = arrow_writer_add_column(writer, "frame.number", ARROW_COLUMN_UINT32);
+ *  guint proto = arrow_writer_add_column(writer, "protocol", ARROW_COLUMN_STRING_DICT);
+ *  arrow_writer_set_uint(writer, num, 1);
+ *  arrow_writer_set_string(writer, proto, "TCP");
+ *  arrow_writer_end_row(writer);
+ *  arrow_writer_finish(writer);
+ */
+
+typedef enum {
+    ARROW_COLUMN_BOOL,          /**< Booleans */
+    ARROW_COLUMN_INT32,         /**< Signed 32-bit integers */
+    ARROW_COLUMN_UINT32,        /**< Unsigned 32-bit integers */
+    ARROW_COLUMN_INT64,         /**< Signed 64-bit integers */
+    ARROW_COLUMN_UINT64,        /**< Unsigned 64-bit integers */
+    ARROW_COLUMN_DOUBLE,        /**< Double precision floating point numbers */
+    ARROW_COLUMN_TIMESTAMP_NS,  /**< Nanoseconds since the Epoch, UTC, set as a signed integer */
+    ARROW_COLUMN_STRING,        /**< UTF-8 strings */
+    ARROW_COLUMN_STRING_DICT,   /**< Dictionary-encoded UTF-8 strings. Each different
+                                     string is kept in memory until the writer is freed;
+                                     use ARROW_COLUMN_STRING for mostly unique values. */
+    ARROW_COLUMN_BINARY,        /**< Byte strings */
+} arrow_column_type_e;
+
+typedef struct _arrow_writer arrow_writer;
+
+/** Default number of rows per record batch. */
+#define ARROW_WRITER_BATCH_ROWS     65536
+
+/** Create a writer.
+ *
+ * @param fh The file to write to.
+ * @param batch_rows The number of rows per record batch, or 0 for the default.
+ * @return A new writer, to be freed with arrow_writer_finish().
+ */
+WS_DLL_PUBLIC arrow_writer *arrow_writer_new(FILE *fh, guint batch_rows);
+
+/** Add a column. Columns can only be added before the first row.
+ *
+ * @return The index of the column.
+ */
+WS_DLL_PUBLIC guint arrow_writer_add_column(arrow_writer *writer, const char *name,
+                arrow_column_type_e type);
+
+/** The type of a column. */
+WS_DLL_PUBLIC arrow_column_type_e arrow_writer_column_type(const arrow_writer *writer, guint column);
+
+/*
+ * Set the value of a column in the current row. Only the first value set
+ * for a column in a row is used.
+ */
+
+/** Set the value of an ARROW_COLUMN_BOOL column. */
+WS_DLL_PUBLIC void arrow_writer_set_bool(arrow_writer *writer, guint column, gboolean value);
+
+/** Set the value of an ARROW_COLUMN_INT32, ARROW_COLUMN_INT64 or ARROW_COLUMN_TIMESTAMP_NS column. */
+WS_DLL_PUBLIC void arrow_writer_set_int(arrow_writer *writer, guint column, gint64 value);
+
+/** Set the value of an ARROW_COLUMN_UINT32 or ARROW_COLUMN_UINT64 column. */
+WS_DLL_PUBLIC void arrow_writer_set_uint(arrow_writer *writer, guint column, guint64 value);
+
+/** Set the value of an ARROW_COLUMN_DOUBLE column. */
+WS_DLL_PUBLIC void arrow_writer_set_double(arrow_writer *writer, guint column, double value);
+
+/** Set the value of an ARROW_COLUMN_STRING or ARROW_COLUMN_STRING_DICT column.
+ * The string must be valid UTF-8.
+ */
+WS_DLL_PUBLIC void arrow_writer_set_string(arrow_writer *writer, guint column, const char *value);
+
+/** Set the value of an ARROW_COLUMN_BINARY column. */
+WS_DLL_PUBLIC void arrow_writer_set_bytes(arrow_writer *writer, guint column,
+                const guint8 *value, gsize len);
+
+/** End the current row, writing a record batch if it is full. */
+WS_DLL_PUBLIC void arrow_writer_end_row(arrow_writer *writer);
+
+/** Write the remaining rows and the file footer, and free the writer.
+ *
+ * @return TRUE if everything was written, FALSE on a write error.
+ */
+WS_DLL_PUBLIC gboolean arrow_writer_finish(arrow_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ARROW_WRITER_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
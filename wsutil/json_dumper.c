@@ -15,7 +15,9 @@
 #define WS_LOG_DOMAIN LOG_DOMAIN_WSUTIL
 
 #include <math.h>
+#include <string.h>
 
+#include <wsutil/bits_ctz.h>
 #include <wsutil/wslog.h>
 
 /*
@@ -60,58 +62,168 @@ enum json_dumper_change {
     JSON_DUMPER_FINISH,
 };
 
-/* JSON Dumper putc */
+/*
+ * SSE2 is part of the x86-64 baseline, so no run-time CPU check or
+ * special compiler flag is needed for it; see ws_memsearch.c.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_JSON_DUMPER_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Write out the bytes buffered for output_file. */
 static void
-jd_putc(const json_dumper *dumper, char c)
+jd_flush(json_dumper *dumper)
 {
-    if (dumper->output_file) {
-        fputc(c, dumper->output_file);
+    if (dumper->output_file && dumper->buffer_len != 0) {
+        fwrite(dumper->buffer, 1, dumper->buffer_len, dumper->output_file);
     }
+    dumper->buffer_len = 0;
+}
 
-    if (dumper->output_string) {
-        g_string_append_c(dumper->output_string, c);
+/* Append to the buffer for output_file, writing it out when it is full. */
+static void
+jd_buffer_append(json_dumper *dumper, const char *s, gsize len)
+{
+    if (len > JSON_DUMPER_BUFFER_SIZE - dumper->buffer_len) {
+        jd_flush(dumper);
+    }
+    if (len >= JSON_DUMPER_BUFFER_SIZE) {
+        fwrite(s, 1, len, dumper->output_file);
+    } else {
+        memcpy(dumper->buffer + dumper->buffer_len, s, len);
+        dumper->buffer_len += len;
     }
 }
 
-/* JSON Dumper puts */
 static void
-jd_puts(const json_dumper *dumper, const char *s)
+jd_puts_len(json_dumper *dumper, const char *s, gsize len)
 {
     if (dumper->output_file) {
-        fputs(s, dumper->output_file);
+        jd_buffer_append(dumper, s, len);
     }
 
     if (dumper->output_string) {
-        g_string_append(dumper->output_string, s);
+        g_string_append_len(dumper->output_string, s, len);
     }
 }
 
+/* JSON Dumper putc */
 static void
-jd_puts_len(const json_dumper *dumper, const char *s, gsize len)
+jd_putc(json_dumper *dumper, char c)
 {
     if (dumper->output_file) {
-        fwrite(s, 1, len, dumper->output_file);
+        if (dumper->buffer_len == JSON_DUMPER_BUFFER_SIZE) {
+            jd_flush(dumper);
+        }
+        dumper->buffer[dumper->buffer_len++] = c;
     }
 
     if (dumper->output_string) {
-        g_string_append_len(dumper->output_string, s, len);
+        g_string_append_c(dumper->output_string, c);
     }
 }
 
+/* JSON Dumper puts */
+static void
+jd_puts(json_dumper *dumper, const char *s)
+{
+    jd_puts_len(dumper, s, strlen(s));
+}
+
 static void
-jd_vprintf(const json_dumper *dumper, const char *format, va_list args)
+jd_vprintf(json_dumper *dumper, const char *format, va_list args)
 {
     if (dumper->output_file) {
-        vfprintf(dumper->output_file, format, args);
+        va_list args_copy;
+        int len;
+
+        G_VA_COPY(args_copy, args);
+        len = vsnprintf(dumper->buffer + dumper->buffer_len,
+                        JSON_DUMPER_BUFFER_SIZE - dumper->buffer_len, format, args_copy);
+        va_end(args_copy);
+        if (len >= 0 && (gsize)len < JSON_DUMPER_BUFFER_SIZE - dumper->buffer_len) {
+            dumper->buffer_len += len;
+        } else {
+            /* Did not fit, flush and format again. */
+            char *str;
+
+            G_VA_COPY(args_copy, args);
+            str = g_strdup_vprintf(format, args_copy);
+            va_end(args_copy);
+            jd_buffer_append(dumper, str, strlen(str));
+            g_free(str);
+        }
     }
 
     if (dumper->output_string) {
-        g_string_append_vprintf(dumper->output_string, format, args);
+        va_list args_copy;
+
+        G_VA_COPY(args_copy, args);
+        g_string_append_vprintf(dumper->output_string, format, args_copy);
+        va_end(args_copy);
+    }
+}
+
+/*
+ * Characters that json_puts_string() must look at: control characters,
+ * the quote, the backslash and the slash (for "</"). A dot is only
+ * special when converting dots to underscores.
+ */
+#define JSON_ESCAPE_ALWAYS  1
+#define JSON_ESCAPE_DOT     2
+
+static const guint8 json_escape_class[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    ['"'] = JSON_ESCAPE_ALWAYS,
+    ['.'] = JSON_ESCAPE_DOT,
+    ['/'] = JSON_ESCAPE_ALWAYS,
+    ['\\'] = JSON_ESCAPE_ALWAYS,
+};
+
+/*
+ * Returns the length of the initial run of str that can be copied to
+ * the output as is.
+ */
+static gsize
+json_safe_run_len(const char *str, gsize len, gboolean dot_to_underscore)
+{
+    const guint8 *p = (const guint8 *)str;
+    const guint8 mask = dot_to_underscore ? JSON_ESCAPE_ALWAYS|JSON_ESCAPE_DOT : JSON_ESCAPE_ALWAYS;
+    gsize i = 0;
+
+#ifdef HAVE_JSON_DUMPER_SSE2
+    const __m128i cntrl_max = _mm_set1_epi8(0x1f);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i dot = _mm_set1_epi8(dot_to_underscore ? '.' : '"');
+
+    for (; i + 16 <= len; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i *)(const void *)(p + i));
+        /* Unsigned block <= 0x1f, i.e. max(block, 0x1f) == 0x1f. */
+        __m128i special = _mm_cmpeq_epi8(_mm_max_epu8(block, cntrl_max), cntrl_max);
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(block, quote));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(block, backslash));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(block, slash));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(block, dot));
+
+        guint32 found = (guint32)_mm_movemask_epi8(special);
+        if (found != 0) {
+            return i + ws_ctz(found);
+        }
     }
+#endif
+
+    while (i < len && !(json_escape_class[p[i]] & mask)) {
+        i++;
+    }
+    return i;
 }
 
 static void
-json_puts_string(const json_dumper *dumper, const char *str, gboolean dot_to_underscore)
+json_puts_string(json_dumper *dumper, const char *str, gboolean dot_to_underscore)
 {
     if (!str) {
         jd_puts(dumper, "null");
@@ -123,23 +235,40 @@ json_puts_string(const json_dumper *dumper, const char *str, gboolean dot_to_und
         "u0010", "u0011", "u0012", "u0013", "u0014", "u0015", "u0016", "u0017", "u0018", "u0019", "u001a", "u001b", "u001c", "u001d", "u001e", "u001f"
     };
 
+    gsize len = strlen(str);
+    gsize i = 0;
+
     jd_putc(dumper, '"');
-    for (int i = 0; str[i]; i++) {
-        if ((guint)str[i] < 0x20) {
+    while (i < len) {
+        /* Copy the characters that need no escaping in one go. */
+        gsize run = json_safe_run_len(str + i, len - i, dot_to_underscore);
+        if (run != 0) {
+            jd_puts_len(dumper, str + i, run);
+            i += run;
+            if (i == len) {
+                break;
+            }
+        }
+
+        guint8 c = (guint8)str[i];
+        if (c < 0x20) {
             jd_putc(dumper, '\\');
-            jd_puts(dumper, json_cntrl[(guint)str[i]]);
-        } else if (i > 0 && str[i - 1] == '<' && str[i] == '/') {
-            // Convert </script> to <\/script> to avoid breaking web pages.
-            jd_puts(dumper, "\\/");
-        } else {
-            if (str[i] == '\\' || str[i] == '"') {
-                jd_putc(dumper, '\\');
+            jd_puts(dumper, json_cntrl[c]);
+        } else if (c == '/') {
+            if (i > 0 && str[i - 1] == '<') {
+                // Convert </script> to <\/script> to avoid breaking web pages.
+                jd_puts_len(dumper, "\\/", 2);
+            } else {
+                jd_putc(dumper, '/');
             }
-            if (dot_to_underscore && str[i] == '.')
-                jd_putc(dumper, '_');
-            else
-                jd_putc(dumper, str[i]);
+        } else if (c == '.') {
+            jd_putc(dumper, '_');
+        } else {
+            /* Quote or backslash. */
+            jd_putc(dumper, '\\');
+            jd_putc(dumper, c);
         }
+        i++;
     }
     jd_putc(dumper, '"');
 }
@@ -178,6 +307,7 @@ json_dumper_bad(json_dumper *dumper, const char *what)
     }
 
     if (dumper->output_file) {
+        jd_flush(dumper);
         fflush(dumper->output_file);
     }
     char unknown_curr_type_name[10+1];
@@ -244,7 +374,7 @@ json_dumper_check_previous_error(json_dumper *dumper)
 }
 
 static void
-print_newline_indent(const json_dumper *dumper, guint depth)
+print_newline_indent(json_dumper *dumper, guint depth)
 {
     if ((dumper->flags & JSON_DUMPER_FLAGS_PRETTY_PRINT)) {
         jd_putc(dumper, '\n');
@@ -637,10 +767,17 @@ json_dumper_finish(json_dumper *dumper)
     }
 
     jd_putc(dumper, '\n');
+    jd_flush(dumper);
     dumper->state[0] = JSON_DUMPER_TYPE_NONE;
     return TRUE;
 }
 
+void
+json_dumper_flush(json_dumper *dumper)
+{
+    jd_flush(dumper);
+}
+
 void
 json_dumper_begin_base64(json_dumper *dumper)
 {
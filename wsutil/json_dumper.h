@@ -50,6 +50,8 @@ extern "C" {
 
 /** Maximum object/array nesting depth. */
 #define JSON_DUMPER_MAX_DEPTH   1100
+/** Size of the buffer for output to a file. */
+#define JSON_DUMPER_BUFFER_SIZE 8192
 typedef struct json_dumper {
     FILE    *output_file;    /**< Output file. If it is not NULL, JSON will be dumped in the file. */
     GString *output_string;  /**< Output GLib strings. If it is not NULL, JSON will be dumped in the string. */
@@ -62,6 +64,8 @@ typedef struct json_dumper {
     gint    base64_state;
     gint    base64_save;
     guint8  state[JSON_DUMPER_MAX_DEPTH];
+    gsize   buffer_len;
+    char    buffer[JSON_DUMPER_BUFFER_SIZE];
 } json_dumper;
 
 WS_DLL_PUBLIC void
@@ -112,10 +116,20 @@ json_dumper_write_base64(json_dumper *dumper, const guchar *data, size_t len);
 /**
  * Finishes dumping data. Returns TRUE if everything is okay and FALSE if
  * something went wrong (open/close mismatch, missing values, etc.).
+ * Any output buffered for the output file is written out.
  */
 WS_DLL_PUBLIC gboolean
 json_dumper_finish(json_dumper *dumper);
 
+/**
+ * Output to the output file is buffered in the dumper and written out
+ * when the buffer fills up and by json_dumper_finish(). This writes out
+ * the buffered output earlier, e.g. before writing to the same file
+ * directly or flushing it. It does not call fflush().
+ */
+WS_DLL_PUBLIC void
+json_dumper_flush(json_dumper *dumper);
+
 #ifdef __cplusplus
 }
 #endif
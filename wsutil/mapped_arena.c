@@ -0,0 +1,251 @@
+/* mapped_arena.c
+ * Fixed-size memory slots in a memory-mapped temporary file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "mapped_arena.h"
+
+#include <errno.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
+#include <wsutil/ws_assert.h>
+
+/*
+ * The file is mapped in segments of about this size. Mapping every slot
+ * on its own could run into the limit on the number of mappings of a
+ * process, and mapping the whole file at once would need address space
+ * for the largest size it could ever get.
+ */
+#define SEGMENT_TARGET_SIZE     (64 * 1024 * 1024)
+
+/*
+ * Segments start at multiples of this in the file, which is the
+ * allocation granularity of Windows and at least the page size elsewhere.
+ */
+#define SEGMENT_ALIGNMENT       (64 * 1024)
+
+struct _mapped_arena {
+    int         fd;
+    gchar      *path;           /* removed at destroy time on Windows */
+    gsize       slot_size;
+    gsize       slots_per_segment;
+    gsize       segment_size;
+    guint64     file_size;
+    GArray     *segments;       /* guint8 *, sorted by address */
+    guint8     *next_slot;      /* in the newest segment, never handed out */
+    guint8     *segment_end;
+    void       *free_slots;     /* slots given back, linked through their first word */
+};
+
+mapped_arena_t *
+mapped_arena_new(const char *tempdir, gsize slot_size, GError **err)
+{
+    mapped_arena_t *arena;
+    gchar *path = NULL;
+    int fd;
+
+    ws_assert(slot_size >= sizeof(void *));
+
+    /*
+     * create_tempfile() opens the file write-only if a directory is given,
+     * but a shared writable mapping needs it to be opened for reading too.
+     */
+    fd = create_tempfile(tempdir, &path, "wireshark_state", NULL, err);
+    if (fd == -1) {
+        g_free(path);
+        return NULL;
+    }
+    ws_close(fd);
+    fd = ws_open(path, O_RDWR|O_BINARY, 0600);
+    if (fd == -1) {
+        g_set_error_literal(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+                g_strerror(errno));
+        ws_unlink(path);
+        g_free(path);
+        return NULL;
+    }
+#ifndef _WIN32
+    /* Nobody else needs to see the file, and this way it can't be left behind. */
+    ws_unlink(path);
+    g_free(path);
+    path = NULL;
+#endif
+
+    arena = g_new0(mapped_arena_t, 1);
+    arena->fd = fd;
+    arena->path = path;
+    arena->slot_size = (slot_size + 15) & ~(gsize)15;
+    arena->slots_per_segment = MAX(1, SEGMENT_TARGET_SIZE / arena->slot_size);
+    arena->segment_size = arena->slots_per_segment * arena->slot_size;
+    arena->segment_size = (arena->segment_size + SEGMENT_ALIGNMENT - 1) & ~(gsize)(SEGMENT_ALIGNMENT - 1);
+    arena->segments = g_array_new(FALSE, FALSE, sizeof(guint8 *));
+    return arena;
+}
+
+gsize
+mapped_arena_slot_size(const mapped_arena_t *arena)
+{
+    return arena->slot_size;
+}
+
+/* Grow the file by a segment and map it. */
+static gboolean
+mapped_arena_add_segment(mapped_arena_t *arena)
+{
+    guint64 offset = arena->file_size;
+    guint64 new_size = offset + arena->segment_size;
+    guint8 *base;
+    guint i;
+
+#ifdef _WIN32
+    HANDLE file = (HANDLE)_get_osfhandle(arena->fd);
+    HANDLE mapping;
+
+    /* Creating a mapping larger than the file extends the file. */
+    mapping = CreateFileMapping(file, NULL, PAGE_READWRITE,
+            (DWORD)(new_size >> 32), (DWORD)new_size, NULL);
+    if (mapping == NULL)
+        return FALSE;
+    base = (guint8 *)MapViewOfFile(mapping, FILE_MAP_WRITE,
+            (DWORD)(offset >> 32), (DWORD)offset, arena->segment_size);
+    /* The view keeps the mapping alive. */
+    CloseHandle(mapping);
+    if (base == NULL)
+        return FALSE;
+#else
+    /*
+     * Allocate the disk space up front where possible; otherwise running
+     * out of it would only be noticed as a SIGBUS when a page is written
+     * back.
+     */
+#ifdef HAVE_POSIX_FALLOCATE
+    if (posix_fallocate(arena->fd, (off_t)offset, (off_t)arena->segment_size) != 0)
+        return FALSE;
+#else
+    if (ftruncate(arena->fd, (off_t)new_size) != 0)
+        return FALSE;
+#endif
+    base = (guint8 *)mmap(NULL, arena->segment_size, PROT_READ|PROT_WRITE,
+            MAP_SHARED, arena->fd, (off_t)offset);
+    if (base == (guint8 *)MAP_FAILED)
+        return FALSE;
+#endif
+
+    arena->file_size = new_size;
+    for (i = 0; i < arena->segments->len; i++) {
+        if (g_array_index(arena->segments, guint8 *, i) > base)
+            break;
+    }
+    g_array_insert_val(arena->segments, i, base);
+    arena->next_slot = base;
+    arena->segment_end = base + arena->slots_per_segment * arena->slot_size;
+    return TRUE;
+}
+
+void *
+mapped_arena_alloc(mapped_arena_t *arena)
+{
+    void *slot;
+
+    if (arena->free_slots != NULL) {
+        slot = arena->free_slots;
+        arena->free_slots = *(void **)slot;
+        return slot;
+    }
+
+    if (arena->next_slot == arena->segment_end) {
+        if (!mapped_arena_add_segment(arena))
+            return NULL;
+    }
+    slot = arena->next_slot;
+    arena->next_slot += arena->slot_size;
+    return slot;
+}
+
+void
+mapped_arena_free(mapped_arena_t *arena, void *slot)
+{
+    ws_assert(mapped_arena_contains(arena, slot));
+
+    *(void **)slot = arena->free_slots;
+    arena->free_slots = slot;
+}
+
+gboolean
+mapped_arena_contains(const mapped_arena_t *arena, const void *ptr)
+{
+    const guint8 *p = (const guint8 *)ptr;
+    guint lo = 0, hi = arena->segments->len, mid;
+
+    /* Find the last segment starting at or before ptr. */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (g_array_index(arena->segments, guint8 *, mid) <= p)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return FALSE;
+    return p < g_array_index(arena->segments, guint8 *, lo - 1) + arena->segment_size;
+}
+
+guint64
+mapped_arena_size(const mapped_arena_t *arena)
+{
+    return arena->file_size;
+}
+
+void
+mapped_arena_destroy(mapped_arena_t *arena)
+{
+    guint i;
+
+    if (!arena)
+        return;
+
+    for (i = 0; i < arena->segments->len; i++) {
+#ifdef _WIN32
+        UnmapViewOfFile(g_array_index(arena->segments, guint8 *, i));
+#else
+        munmap(g_array_index(arena->segments, guint8 *, i), arena->segment_size);
+#endif
+    }
+    g_array_free(arena->segments, TRUE);
+    ws_close(arena->fd);
+    if (arena->path != NULL) {
+        ws_unlink(arena->path);
+        g_free(arena->path);
+    }
+    g_free(arena);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,88 @@
+/** @file
+ * Fixed-size memory slots in a memory-mapped temporary file.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __MAPPED_ARENA_H__
+#define __MAPPED_ARENA_H__
+
+#include "ws_symbol_export.h"
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A mapped arena hands out memory slots of one size that are backed by a
+ * temporary file instead of by swap. The kernel can write pages that are
+ * not being used back to the file and drop them, so data that is built up
+ * once and then only revisited now and then (such as the state kept for
+ * every frame of a capture) can grow larger than physical memory without
+ * the system running out of memory.
+ *
+ * The file is grown in segments of several slots and is removed when the
+ * arena is destroyed (on UN*X it's unlinked right away, so it also goes
+ * away if the program is killed).
+ *
+ * An arena isn't thread-safe.
+ */
+
+typedef struct _mapped_arena mapped_arena_t;
+
+/** Create an arena.
+ *
+ * @param tempdir The directory for the temporary file, or NULL for the
+ * default temporary directory.
+ * @param slot_size The size of each slot.
+ * @param err Set if the file can't be created.
+ * @return A new arena, to be freed with mapped_arena_destroy(), or NULL.
+ */
+WS_DLL_PUBLIC mapped_arena_t *mapped_arena_new(const char *tempdir, gsize slot_size, GError **err);
+
+/** The size of the slots of an arena. */
+WS_DLL_PUBLIC gsize mapped_arena_slot_size(const mapped_arena_t *arena);
+
+/** Get a slot. Its contents are undefined.
+ *
+ * @return The slot, or NULL if the file can't be grown (e.g. because the
+ * file system is full), in which case the caller can fall back to the heap.
+ */
+WS_DLL_PUBLIC void *mapped_arena_alloc(mapped_arena_t *arena);
+
+/** Give a slot back to the arena, to be handed out again. */
+WS_DLL_PUBLIC void mapped_arena_free(mapped_arena_t *arena, void *slot);
+
+/** Whether memory belongs to the arena, e.g. to decide whether a slot or
+ * memory from the heap is being freed. */
+WS_DLL_PUBLIC gboolean mapped_arena_contains(const mapped_arena_t *arena, const void *ptr);
+
+/** The number of bytes of the file that are in use. */
+WS_DLL_PUBLIC guint64 mapped_arena_size(const mapped_arena_t *arena);
+
+/** Unmap and remove the file. Slots still being used become invalid. */
+WS_DLL_PUBLIC void mapped_arena_destroy(mapped_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAPPED_ARENA_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
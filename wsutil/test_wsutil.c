@@ -635,6 +635,294 @@ void test_nstime_from_iso8601(void)
     g_assert_cmpint(result.nsecs, ==, expect.nsecs);
 }
 
+#include "ws_memsearch.h"
+
+static void test_memsearch_single(void)
+{
+    const char *hay = "GET /index.html HTTP/1.1\r\nHost: www.example.com\r\n\r\n";
+    size_t hay_len = strlen(hay);
+    const guint8 *res;
+    ws_memsearch_t *ms;
+    guint idx = 42;
+
+    ms = ws_memsearch_new_single("Host:", 5, 0);
+    res = ws_memsearch_exec(ms, hay, hay_len, &idx);
+    g_assert_nonnull(res);
+    g_assert_cmpint((const char *)res - hay, ==, 26);
+    g_assert_cmpuint(idx, ==, 0);
+    /* Not past the end of the haystack. */
+    g_assert_null(ws_memsearch_exec(ms, hay, 30, NULL));
+    ws_memsearch_free(ms);
+
+    ms = ws_memsearch_new_single("host:", 5, 0);
+    g_assert_null(ws_memsearch_exec(ms, hay, hay_len, NULL));
+    ws_memsearch_free(ms);
+
+    ms = ws_memsearch_new_single("host:", 5, WS_MEMSEARCH_NOCASE);
+    res = ws_memsearch_exec(ms, hay, hay_len, NULL);
+    g_assert_nonnull(res);
+    g_assert_cmpint((const char *)res - hay, ==, 26);
+    ws_memsearch_free(ms);
+
+    /* Match at the very end, past the vectorized part. */
+    ms = ws_memsearch_new_single("\r\n\r\n", 4, 0);
+    res = ws_memsearch_exec(ms, hay, hay_len, NULL);
+    g_assert_nonnull(res);
+    g_assert_cmpint((const char *)res - hay, ==, hay_len - 4);
+    ws_memsearch_free(ms);
+
+    /* Embedded NUL bytes are matched like any other byte. */
+    ms = ws_memsearch_new_single("b\0c", 3, 0);
+    res = ws_memsearch_exec(ms, "aab\0cc", 6, NULL);
+    g_assert_nonnull(res);
+    g_assert_cmpint((const char *)res - "aab\0cc", ==, 2);
+    ws_memsearch_free(ms);
+
+    /* An empty pattern never matches. */
+    ms = ws_memsearch_new_single("", 0, 0);
+    g_assert_null(ws_memsearch_exec(ms, hay, hay_len, NULL));
+    ws_memsearch_free(ms);
+}
+
+static void test_memsearch_multi(void)
+{
+    const char *hay = "User-Agent: Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101 Firefox/91.0";
+    size_t hay_len = strlen(hay);
+    const guint8 *res;
+    ws_memsearch_t *ms;
+    guint idx;
+
+    ms = ws_memsearch_new(0);
+    g_assert_cmpuint(ws_memsearch_add(ms, "Firefox", 7), ==, 0);
+    g_assert_cmpuint(ws_memsearch_add(ms, "Gecko", 5), ==, 1);
+    g_assert_cmpuint(ws_memsearch_add(ms, "curl", 4), ==, 2);
+    ws_memsearch_compile(ms);
+    g_assert_cmpuint(ws_memsearch_count(ms), ==, 3);
+
+    /* The match ending first is reported. */
+    res = ws_memsearch_exec(ms, hay, hay_len, &idx);
+    g_assert_nonnull(res);
+    g_assert_cmpuint(idx, ==, 1);
+    g_assert_cmpint((const char *)res - hay, ==, 44);
+    g_assert_cmpuint(ws_memsearch_pattern_len(ms, idx), ==, 5);
+
+    res = ws_memsearch_exec(ms, hay + 50, hay_len - 50, &idx);
+    g_assert_nonnull(res);
+    g_assert_cmpuint(idx, ==, 0);
+
+    g_assert_null(ws_memsearch_exec(ms, hay, 40, NULL));
+    ws_memsearch_free(ms);
+
+    /* Overlapping patterns: the longest one ending first wins. */
+    ms = ws_memsearch_new(WS_MEMSEARCH_NOCASE);
+    ws_memsearch_add(ms, "he", 2);
+    ws_memsearch_add(ms, "she", 3);
+    ws_memsearch_add(ms, "hers", 4);
+    ws_memsearch_compile(ms);
+    res = ws_memsearch_exec(ms, "USHERS", 6, &idx);
+    g_assert_nonnull(res);
+    g_assert_cmpuint(idx, ==, 1);
+    g_assert_cmpint((const char *)res - "USHERS", ==, 1);
+    ws_memsearch_free(ms);
+}
+
+#include "json_dumper.h"
+
+static void test_json_dumper_escape(void)
+{
+    json_dumper dumper = {
+        .output_string = g_string_new(NULL),
+    };
+    const char *want;
+
+    json_dumper_begin_array(&dumper);
+    /* Long enough for the vectorized scan, with characters to escape at the end. */
+    json_dumper_value_string(&dumper, "0123456789abcdef0123456789abcdef\"\\");
+    json_dumper_value_string(&dumper, "tab\there, bell\a, </script> and a/b");
+    json_dumper_value_string(&dumper, u8"UTF-8 " UTF8_HORIZONTAL_ELLIPSIS " is copied as is");
+    json_dumper_value_string(&dumper, "");
+    json_dumper_value_string(&dumper, NULL);
+    json_dumper_end_array(&dumper);
+    g_assert_true(json_dumper_finish(&dumper));
+    want = "[\"0123456789abcdef0123456789abcdef\\\"\\\\\","
+           "\"tab\\there, bell\\u0007, <\\/script> and a/b\","
+           "\"UTF-8 " UTF8_HORIZONTAL_ELLIPSIS " is copied as is\","
+           "\"\",null]\n";
+    g_assert_cmpstr(dumper.output_string->str, ==, want);
+    g_string_free(dumper.output_string, TRUE);
+
+    dumper = (json_dumper) {
+        .output_string = g_string_new(NULL),
+        .flags = JSON_DUMPER_DOT_TO_UNDERSCORE,
+    };
+    json_dumper_begin_object(&dumper);
+    json_dumper_set_member_name(&dumper, "ip.src.addr");
+    json_dumper_value_string(&dumper, "192.0.2.1");
+    json_dumper_end_object(&dumper);
+    g_assert_true(json_dumper_finish(&dumper));
+    g_assert_cmpstr(dumper.output_string->str, ==, "{\"ip_src_addr\":\"192.0.2.1\"}\n");
+    g_string_free(dumper.output_string, TRUE);
+}
+
+static void test_json_dumper_file(void)
+{
+    json_dumper dumper = { 0 };
+    char *str, *contents;
+    long size;
+    int i;
+
+    /* Output to a file is buffered; it must match the output to a string. */
+    dumper.output_file = tmpfile();
+    g_assert_nonnull(dumper.output_file);
+    dumper.output_string = g_string_new(NULL);
+    dumper.flags = JSON_DUMPER_FLAGS_PRETTY_PRINT;
+
+    str = g_strnfill(3 * JSON_DUMPER_BUFFER_SIZE, 'x');
+    json_dumper_begin_array(&dumper);
+    for (i = 0; i < 2000; i++) {
+        json_dumper_value_anyf(&dumper, "%d", i);
+        json_dumper_value_string(&dumper, "a \"quoted\" </value>");
+        if (i % 500 == 0) {
+            json_dumper_value_string(&dumper, str);
+        }
+    }
+    json_dumper_end_array(&dumper);
+    g_assert_true(json_dumper_finish(&dumper));
+    g_free(str);
+
+    size = ftell(dumper.output_file);
+    g_assert_cmpint(size, ==, dumper.output_string->len);
+    contents = (char *)g_malloc(size + 1);
+    rewind(dumper.output_file);
+    g_assert_cmpuint(fread(contents, 1, size, dumper.output_file), ==, size);
+    contents[size] = '\0';
+    g_assert_cmpstr(contents, ==, dumper.output_string->str);
+    g_free(contents);
+
+    fclose(dumper.output_file);
+    g_string_free(dumper.output_string, TRUE);
+}
+
+static void test_json_dumper_escape_perf(void)
+{
+#define JSON_LOOP_COUNT (2 * 1000 * 1000)
+    const char *text = "The quick brown fox\tjumps over the \"lazy\" dog, "
+                       "looking for </script> in a rather long field value";
+    json_dumper dumper = { 0 };
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    double bytes;
+    int i;
+
+    dumper.output_file = fopen("/dev/null", "w");
+    if (dumper.output_file == NULL) {
+        g_test_skip("/dev/null is not available");
+        return;
+    }
+
+    RESOURCE_USAGE_START;
+    json_dumper_begin_array(&dumper);
+    for (i = 0; i < JSON_LOOP_COUNT; i++) {
+        json_dumper_value_string(&dumper, text);
+    }
+    json_dumper_end_array(&dumper);
+    json_dumper_finish(&dumper);
+    RESOURCE_USAGE_END;
+    fclose(dumper.output_file);
+
+    bytes = (double)strlen(text) * JSON_LOOP_COUNT;
+    g_test_maximized_result(bytes * 1000.0 / (utime_ms + stime_ms),
+        "json_dumper_value_string(): %.1f MB/s (u %.3f ms s %.3f ms)",
+        bytes / 1000.0 / (utime_ms + stime_ms), utime_ms, stime_ms);
+}
+
+#include "arrow_writer.h"
+
+static void test_arrow_writer(void)
+{
+    static const guint8 magic[8] = "ARROW1";
+    static const guint8 continuation[4] = { 0xff, 0xff, 0xff, 0xff };
+    FILE *fh = tmpfile();
+    arrow_writer *writer;
+    guint8 *contents;
+    long size;
+    guint32 footer_len;
+    guint num, name, i;
+
+    g_assert_nonnull(fh);
+    writer = arrow_writer_new(fh, 2);
+    num = arrow_writer_add_column(writer, "num", ARROW_COLUMN_UINT32);
+    name = arrow_writer_add_column(writer, "name", ARROW_COLUMN_STRING_DICT);
+    g_assert_cmpuint(arrow_writer_column_type(writer, name), ==, ARROW_COLUMN_STRING_DICT);
+    for (i = 0; i < 5; i++) {
+        arrow_writer_set_uint(writer, num, i);
+        if (i != 3) {
+            arrow_writer_set_string(writer, name, i % 2 ? "odd" : "even");
+        }
+        arrow_writer_end_row(writer);
+    }
+    g_assert_true(arrow_writer_finish(writer));
+
+    size = ftell(fh);
+    g_assert_cmpint(size, >, 2 * sizeof(magic));
+    contents = (guint8 *)g_malloc(size);
+    rewind(fh);
+    g_assert_cmpuint(fread(contents, 1, size, fh), ==, size);
+    fclose(fh);
+
+    /* The magic, then the schema message. */
+    g_assert_true(memcmp(contents, magic, sizeof(magic)) == 0);
+    g_assert_true(memcmp(contents + sizeof(magic), continuation, sizeof(continuation)) == 0);
+
+    /* The footer, its length and the magic, after the end of stream marker. */
+    g_assert_true(memcmp(contents + size - 6, magic, 6) == 0);
+    footer_len = contents[size - 10] | contents[size - 9] << 8 |
+                 contents[size - 8] << 16 | (guint32)contents[size - 7] << 24;
+    g_assert_cmpuint(footer_len, <, size - 10 - 8 - sizeof(magic));
+    g_assert_true(memcmp(contents + size - 10 - footer_len - 8, continuation, sizeof(continuation)) == 0);
+    g_free(contents);
+}
+
+#include "mapped_arena.h"
+
+static void test_mapped_arena(void)
+{
+    mapped_arena_t *arena;
+    GError *err = NULL;
+    guint8 *slots[700];
+    guint8 heap[32];
+    void *slot;
+    guint i;
+
+    /* 700 slots of 100000 bytes take more than one 64 MiB segment */
+    arena = mapped_arena_new(NULL, 100000, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(arena);
+    g_assert_cmpuint(mapped_arena_slot_size(arena), ==, 100000);
+    g_assert_cmpuint(mapped_arena_size(arena), ==, 0);
+
+    for (i = 0; i < G_N_ELEMENTS(slots); i++) {
+        slots[i] = (guint8 *)mapped_arena_alloc(arena);
+        g_assert_nonnull(slots[i]);
+        slots[i][0] = slots[i][99999] = i & 0xff;
+    }
+    g_assert_cmpuint(mapped_arena_size(arena), >=, (guint64)G_N_ELEMENTS(slots) * 100000);
+    for (i = 0; i < G_N_ELEMENTS(slots); i++) {
+        g_assert_cmpuint(slots[i][0], ==, i & 0xff);
+        g_assert_cmpuint(slots[i][99999], ==, i & 0xff);
+        g_assert_true(mapped_arena_contains(arena, slots[i]));
+        g_assert_true(mapped_arena_contains(arena, slots[i] + 99999));
+    }
+    g_assert_false(mapped_arena_contains(arena, heap));
+
+    /* Slots given back are handed out again. */
+    mapped_arena_free(arena, slots[10]);
+    slot = mapped_arena_alloc(arena);
+    g_assert_true(slot == slots[10]);
+    g_assert_cmpuint(slots[11][0], ==, 11);
+
+    mapped_arena_destroy(arena);
+}
+
 #include "ws_getopt.h"
 
 #define ARGV_MAX 31
@@ -852,6 +1140,20 @@ int main(int argc, char **argv)
 
     g_test_add_func("/nstime/from_iso8601", test_nstime_from_iso8601);
 
+    g_test_add_func("/ws_memsearch/single", test_memsearch_single);
+    g_test_add_func("/ws_memsearch/multi", test_memsearch_multi);
+
+    g_test_add_func("/json_dumper/escape", test_json_dumper_escape);
+    g_test_add_func("/json_dumper/file", test_json_dumper_file);
+
+    if (g_test_perf()) {
+        g_test_add_func("/json_dumper/escape_perf", test_json_dumper_escape_perf);
+    }
+
+    g_test_add_func("/arrow_writer/file", test_arrow_writer);
+
+    g_test_add_func("/mapped_arena/slots", test_mapped_arena);
+
     g_test_add_func("/ws_getopt/basic1", test_getopt_long_basic1);
     g_test_add_func("/ws_getopt/basic2", test_getopt_long_basic2);
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);
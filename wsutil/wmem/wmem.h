@@ -20,6 +20,7 @@
 #include "wmem_miscutl.h"
 #include "wmem_multimap.h"
 #include "wmem_queue.h"
+#include "wmem_seqtree.h"
 #include "wmem_stack.h"
 #include "wmem_strbuf.h"
 #include "wmem_strutl.h"
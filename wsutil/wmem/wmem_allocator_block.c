@@ -18,6 +18,8 @@
 #include "wmem_allocator.h"
 #include "wmem_allocator_block.h"
 
+#include <wsutil/mapped_arena.h>
+
 /* This has turned into a very interesting excercise in algorithms and data
  * structures.
  *
@@ -199,6 +201,7 @@ typedef struct _wmem_block_allocator_t {
     wmem_block_hdr_t   *block_list;
     wmem_block_chunk_t *master_head;
     wmem_block_chunk_t *recycler_head;
+    mapped_arena_t     *arena; /* source of the normal-sized blocks, or NULL */
 } wmem_block_allocator_t;
 
 /* DEBUG AND TEST */
@@ -755,14 +758,34 @@ wmem_block_init_block(wmem_block_allocator_t *allocator,
     wmem_block_push_master(allocator, chunk);
 }
 
+/* Frees a normal-sized block, giving it back to where it came from. Blocks
+ * allocated before a mapped file was set up (or when it was full) come from
+ * the heap. */
+static void
+wmem_block_free_block(wmem_block_allocator_t *allocator,
+                      wmem_block_hdr_t *block)
+{
+    if (allocator->arena && mapped_arena_contains(allocator->arena, block)) {
+        mapped_arena_free(allocator->arena, block);
+    }
+    else {
+        wmem_free(NULL, block);
+    }
+}
+
 /* Creates a new block, and initializes it. */
 static void
 wmem_block_new_block(wmem_block_allocator_t *allocator)
 {
-    wmem_block_hdr_t *block;
+    wmem_block_hdr_t *block = NULL;
 
     /* allocate the new block and add it to the block list */
-    block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
+    if (allocator->arena) {
+        block = (wmem_block_hdr_t *)mapped_arena_alloc(allocator->arena);
+    }
+    if (block == NULL) {
+        block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
+    }
     wmem_block_add_to_block_list(allocator, block);
 
     /* initialize it */
@@ -1067,7 +1090,7 @@ wmem_block_gc(void *private_data)
             else if (allocator->master_head == chunk) {
                 allocator->master_head = free_chunk->next;
             }
-            wmem_free(NULL, cur);
+            wmem_block_free_block(allocator, cur);
         }
         else {
             /* part of this block is used, so add it to the new block list */
@@ -1081,14 +1104,32 @@ wmem_block_gc(void *private_data)
 static void
 wmem_block_allocator_cleanup(void *private_data)
 {
+    wmem_block_allocator_t *allocator = (wmem_block_allocator_t*) private_data;
+
     /* wmem guarantees that free_all() is called directly before this, so
      * calling gc will return all our blocks to the OS automatically */
     wmem_block_gc(private_data);
 
     /* then just free the allocator structs */
+    mapped_arena_destroy(allocator->arena);
     wmem_free(NULL, private_data);
 }
 
+gboolean
+wmem_block_allocator_use_mapped_file(wmem_allocator_t *allocator,
+                                     const char *tempdir, GError **err)
+{
+    wmem_block_allocator_t *block_allocator;
+
+    block_allocator = (wmem_block_allocator_t*) allocator->private_data;
+    if (block_allocator->arena) {
+        return TRUE;
+    }
+
+    block_allocator->arena = mapped_arena_new(tempdir, WMEM_BLOCK_SIZE, err);
+    return block_allocator->arena != NULL;
+}
+
 void
 wmem_block_allocator_init(wmem_allocator_t *allocator)
 {
@@ -1109,6 +1150,7 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
     block_allocator->block_list    = NULL;
     block_allocator->master_head   = NULL;
     block_allocator->recycler_head = NULL;
+    block_allocator->arena         = NULL;
 }
 
 /*
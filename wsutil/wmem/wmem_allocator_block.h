@@ -22,6 +22,10 @@ extern "C" {
 void
 wmem_block_allocator_init(wmem_allocator_t *allocator);
 
+gboolean
+wmem_block_allocator_use_mapped_file(wmem_allocator_t *allocator,
+                                     const char *tempdir, GError **err);
+
 /* Exposed only for testing purposes */
 void
 wmem_block_verify(wmem_allocator_t *allocator);
@@ -125,6 +125,17 @@ wmem_destroy_allocator(wmem_allocator_t *allocator)
     wmem_free(NULL, allocator);
 }
 
+gboolean
+wmem_allocator_use_mapped_file(wmem_allocator_t *allocator, const char *tempdir, GError **err)
+{
+    if (allocator->type != WMEM_ALLOCATOR_BLOCK) {
+        g_set_error_literal(err, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                "Only block allocators can use a mapped file");
+        return FALSE;
+    }
+    return wmem_block_allocator_use_mapped_file(allocator, tempdir, err);
+}
+
 wmem_allocator_t *
 wmem_allocator_new(const wmem_allocator_type_t type)
 {
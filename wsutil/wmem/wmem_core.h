@@ -203,6 +203,23 @@ WS_DLL_PUBLIC
 wmem_allocator_t *
 wmem_allocator_new(const wmem_allocator_type_t type);
 
+/** Have a block allocator take the blocks it allocates from now on from a
+ * memory-mapped temporary file (see wsutil/mapped_arena.h) instead of from
+ * the heap, so that the memory of a long-lived scope can be written out to
+ * disk instead of to swap. The file is removed when the allocator is
+ * destroyed.
+ *
+ * @param allocator The allocator.
+ * @param tempdir The directory for the file, or NULL for the default one.
+ * @param err Set if the file can't be created.
+ * @return TRUE on success; FALSE if the file can't be created or the
+ * allocator isn't a WMEM_ALLOCATOR_BLOCK allocator (e.g. because the type was
+ * overridden), in which case the allocator keeps using the heap.
+ */
+WS_DLL_PUBLIC
+gboolean
+wmem_allocator_use_mapped_file(wmem_allocator_t *allocator, const char *tempdir, GError **err);
+
 /** Initialize the wmem subsystem. This must be called before any other wmem
  * function, usually at the very beginning of your program.
  */
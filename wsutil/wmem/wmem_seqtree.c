@@ -0,0 +1,259 @@
+/* wmem_seqtree.c
+ * Wireshark Memory Manager sorted array map for mostly increasing
+ * 32-bit keys
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_tree.h"
+#include "wmem_seqtree.h"
+
+typedef struct {
+    guint32 key;
+    void   *data;
+} wmem_seqtree_node_t;
+
+/*
+ * An insert in the middle that would move more nodes than this turns the
+ * sequence tree into a wmem_tree.
+ */
+#define SEQTREE_MAX_MOVE    64
+
+/* The nodes are sorted by key, but the array may be rotated: split is the
+ * index of the node with the smallest key. This happens when the keys wrap
+ * around, as TCP sequence numbers do, and the keys after the wrap can then
+ * still be appended. Other indexes are logical indexes, counted from the
+ * smallest key; finger is the one of the node found by the last lookup or
+ * insert, which is where the next one usually is. Once the keys arrive too
+ * far out of order, all nodes are moved to a wmem_tree. */
+struct _wmem_seqtree_t {
+    wmem_allocator_t *allocator;
+
+    wmem_seqtree_node_t *nodes;
+    guint count;
+    guint alloc_count;
+    guint split;
+    guint finger;
+
+    wmem_tree_t *tree;
+};
+
+wmem_seqtree_t *
+wmem_seqtree_new(wmem_allocator_t *allocator)
+{
+    wmem_seqtree_t *tree;
+
+    tree = wmem_new0(allocator, wmem_seqtree_t);
+    tree->allocator = allocator;
+
+    return tree;
+}
+
+gboolean
+wmem_seqtree_is_empty(const wmem_seqtree_t *tree)
+{
+    if (tree->tree)
+        return wmem_tree_is_empty(tree->tree);
+    return tree->count == 0;
+}
+
+guint
+wmem_seqtree_count(const wmem_seqtree_t *tree)
+{
+    if (tree->tree)
+        return wmem_tree_count(tree->tree);
+    return tree->count;
+}
+
+/* Returns the node with the given logical index. */
+static inline wmem_seqtree_node_t *
+seqtree_node(const wmem_seqtree_t *tree, guint idx)
+{
+    idx += tree->split;
+    if (idx >= tree->count)
+        idx -= tree->count;
+    return &tree->nodes[idx];
+}
+
+/* Returns the number of nodes with a key less than or equal to the given
+ * one, i.e. the index of the node after the one wmem_seqtree_lookup32_le
+ * would find. */
+static guint
+seqtree_upper_bound(wmem_seqtree_t *tree, guint32 key)
+{
+    guint finger = tree->finger;
+    guint lo, hi, mid;
+
+    if (tree->count == 0)
+        return 0;
+
+    /* Past the last node: the usual case when keys keep increasing. */
+    if (seqtree_node(tree, tree->count - 1)->key <= key)
+        return tree->count;
+
+    /* At or just after the finger. */
+    if (finger < tree->count && seqtree_node(tree, finger)->key <= key) {
+        if (seqtree_node(tree, finger + 1)->key > key)
+            return finger + 1;
+        if (finger + 2 < tree->count && seqtree_node(tree, finger + 2)->key > key)
+            return finger + 2;
+        lo = finger + 1;
+        hi = tree->count - 1;
+    } else {
+        lo = 0;
+        hi = finger < tree->count ? finger : tree->count - 1;
+    }
+
+    /* The key of node hi is > key here; find the first such node. */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (seqtree_node(tree, mid)->key <= key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Moves all nodes to a wmem_tree. */
+static void
+seqtree_to_tree(wmem_seqtree_t *tree)
+{
+    guint idx;
+
+    tree->tree = wmem_tree_new(tree->allocator);
+    for (idx = 0; idx < tree->count; idx++) {
+        wmem_seqtree_node_t *node = seqtree_node(tree, idx);
+
+        wmem_tree_insert32(tree->tree, node->key, node->data);
+    }
+    wmem_free(tree->allocator, tree->nodes);
+    tree->nodes = NULL;
+    tree->count = tree->alloc_count = 0;
+}
+
+void
+wmem_seqtree_insert32(wmem_seqtree_t *tree, guint32 key, void *data)
+{
+    guint idx;
+    gboolean wrapped;
+
+    if (tree->tree) {
+        wmem_tree_insert32(tree->tree, key, data);
+        return;
+    }
+
+    idx = seqtree_upper_bound(tree, key);
+    if (idx > 0 && seqtree_node(tree, idx - 1)->key == key) {
+        seqtree_node(tree, idx - 1)->data = data;
+        tree->finger = idx - 1;
+        return;
+    }
+
+    /*
+     * The node can be appended to the array if it goes after the largest
+     * key, or, once the keys have wrapped around, after the largest key
+     * since the wrap. A key smaller than all others starts the wrap.
+     */
+    wrapped = (idx == 0 && tree->split == 0 && tree->count > 0);
+    if (idx != tree->count - tree->split && !wrapped &&
+            (tree->split != 0 || tree->count - idx > SEQTREE_MAX_MOVE)) {
+        seqtree_to_tree(tree);
+        wmem_tree_insert32(tree->tree, key, data);
+        return;
+    }
+
+    if (tree->count == tree->alloc_count) {
+        tree->alloc_count = tree->alloc_count ? tree->alloc_count * 2 : 8;
+        tree->nodes = (wmem_seqtree_node_t *)wmem_realloc(tree->allocator,
+                tree->nodes, tree->alloc_count * sizeof(wmem_seqtree_node_t));
+    }
+
+    if (idx == tree->count - tree->split || wrapped) {
+        tree->nodes[tree->count].key = key;
+        tree->nodes[tree->count].data = data;
+        if (wrapped)
+            tree->split = tree->count;
+    } else {
+        /* A few nodes out of order; the array isn't rotated. */
+        memmove(&tree->nodes[idx + 1], &tree->nodes[idx],
+                (tree->count - idx) * sizeof(wmem_seqtree_node_t));
+        tree->nodes[idx].key = key;
+        tree->nodes[idx].data = data;
+    }
+    tree->count++;
+    tree->finger = idx;
+}
+
+void *
+wmem_seqtree_lookup32(wmem_seqtree_t *tree, guint32 key)
+{
+    guint idx;
+
+    if (tree->tree)
+        return wmem_tree_lookup32(tree->tree, key);
+
+    idx = seqtree_upper_bound(tree, key);
+    if (idx == 0 || seqtree_node(tree, idx - 1)->key != key)
+        return NULL;
+
+    tree->finger = idx - 1;
+    return seqtree_node(tree, idx - 1)->data;
+}
+
+void *
+wmem_seqtree_lookup32_le(wmem_seqtree_t *tree, guint32 key)
+{
+    guint idx;
+
+    if (tree->tree)
+        return wmem_tree_lookup32_le(tree->tree, key);
+
+    idx = seqtree_upper_bound(tree, key);
+    if (idx == 0)
+        return NULL;
+
+    tree->finger = idx - 1;
+    return seqtree_node(tree, idx - 1)->data;
+}
+
+void *
+wmem_seqtree_remove32(wmem_seqtree_t *tree, guint32 key)
+{
+    guint idx;
+    void *data;
+
+    if (tree->tree)
+        return wmem_tree_remove32(tree->tree, key);
+
+    idx = seqtree_upper_bound(tree, key);
+    if (idx == 0 || seqtree_node(tree, idx - 1)->key != key)
+        return NULL;
+
+    data = seqtree_node(tree, idx - 1)->data;
+    seqtree_node(tree, idx - 1)->data = NULL;
+    return data;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
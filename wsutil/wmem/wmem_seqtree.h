@@ -0,0 +1,110 @@
+/** @file
+ * Definitions for the Wireshark Memory Manager sorted array map for
+ * mostly increasing 32-bit keys
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WMEM_SEQTREE_H__
+#define __WMEM_SEQTREE_H__
+
+#include "wmem_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-seqtree Sequence Tree
+ *
+ *    A map from guint32 keys to values with the same interface as the
+ *    guint32 functions of @ref wmem-tree, for keys that are mostly
+ *    inserted in increasing order, such as frame numbers or TCP sequence
+ *    numbers.
+ *
+ *    The entries are kept in a sorted array. Appending a key larger than
+ *    all the others is O(1) amortized, and the position of the last
+ *    lookup is remembered, so looking up the same key or the one after it
+ *    again is O(1) as well; other lookups are a binary search. Keys that
+ *    wrap around 2^32 once can still be appended. Inserting a key in the
+ *    middle has to move the larger entries up, so once keys arrive too
+ *    far out of order, the entries are moved to a wmem_tree.
+ *
+ *    @{
+ */
+
+struct _wmem_seqtree_t;
+typedef struct _wmem_seqtree_t wmem_seqtree_t;
+
+/** Creates a sequence tree with the given allocator scope. When the scope
+ * is emptied, the tree is fully destroyed. */
+WS_DLL_PUBLIC
+wmem_seqtree_t *
+wmem_seqtree_new(wmem_allocator_t *allocator)
+G_GNUC_MALLOC;
+
+/** Returns true if the tree is empty (has no nodes). */
+WS_DLL_PUBLIC
+gboolean
+wmem_seqtree_is_empty(const wmem_seqtree_t *tree);
+
+/** Returns number of nodes in tree */
+WS_DLL_PUBLIC
+guint
+wmem_seqtree_count(const wmem_seqtree_t *tree);
+
+/** Insert a node indexed by a guint32 key value. Like wmem_tree_insert32(),
+ * an existing node with the same key is overwritten. */
+WS_DLL_PUBLIC
+void
+wmem_seqtree_insert32(wmem_seqtree_t *tree, guint32 key, void *data);
+
+/** Look up a node in the tree indexed by a guint32 integer value. If no node
+ * is found the function will return NULL.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_seqtree_lookup32(wmem_seqtree_t *tree, guint32 key);
+
+/** Look up a node in the tree indexed by a guint32 integer value.
+ * Returns the node that has the largest key that is less than or equal
+ * to the search key, or NULL if no such key exists.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_seqtree_lookup32_le(wmem_seqtree_t *tree, guint32 key);
+
+/** Remove a node in the tree indexed by a guint32 integer value. Like
+ * wmem_tree_remove32(), this is not really a remove, but the value is set to
+ * NULL so that wmem_seqtree_lookup32 will not find it.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_seqtree_remove32(wmem_seqtree_t *tree, guint32 key);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_SEQTREE_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -345,6 +345,43 @@ wmem_test_allocator_block(void)
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_BLOCK, &wmem_block_verify);
 }
 
+static void
+wmem_test_allocator_block_mapped(void)
+{
+    wmem_allocator_t *allocator;
+    GError *err = NULL;
+    char *ptr;
+    int i;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_BLOCK);
+    g_assert_true(wmem_allocator_use_mapped_file(allocator, NULL, &err));
+    g_assert_no_error(err);
+
+    wmem_test_allocator_det(allocator, &wmem_block_verify, 64);
+
+    /* enough to need several blocks, and to reuse them after gc */
+    for (i=0; i<2; i++) {
+        int j;
+
+        for (j=0; j<64; j++) {
+            ptr = (char *)wmem_alloc(allocator, 1024*1024);
+            memset(ptr, j, 1024*1024);
+        }
+        wmem_block_verify(allocator);
+        wmem_free_all(allocator);
+        wmem_gc(allocator);
+        wmem_block_verify(allocator);
+    }
+
+    wmem_destroy_allocator(allocator);
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_SIMPLE);
+    g_assert_false(wmem_allocator_use_mapped_file(allocator, NULL, &err));
+    g_assert_nonnull(err);
+    g_clear_error(&err);
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_allocator_block_fast(void)
 {
@@ -1337,6 +1374,85 @@ wmem_test_tree(void)
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_seqtree(void)
+{
+    wmem_allocator_t   *allocator;
+    wmem_seqtree_t     *seqtree;
+    wmem_tree_t        *tree;
+    guint32             i, key;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    seqtree = wmem_seqtree_new(allocator);
+    g_assert_true(seqtree);
+    g_assert_true(wmem_seqtree_is_empty(seqtree));
+    g_assert_true(wmem_seqtree_lookup32_le(seqtree, 0) == NULL);
+
+    /* increasing keys, with gaps */
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key = i * 2 + 1;
+        g_assert_true(wmem_seqtree_lookup32(seqtree, key) == NULL);
+        if (i > 0) {
+            g_assert_true(wmem_seqtree_lookup32_le(seqtree, key) == GINT_TO_POINTER(i-1));
+        }
+        wmem_seqtree_insert32(seqtree, key, GINT_TO_POINTER(i));
+        g_assert_true(wmem_seqtree_lookup32(seqtree, key) == GINT_TO_POINTER(i));
+        g_assert_true(!wmem_seqtree_is_empty(seqtree));
+    }
+    g_assert_true(wmem_seqtree_count(seqtree) == CONTAINER_ITERS);
+    g_assert_true(wmem_seqtree_lookup32_le(seqtree, 0) == NULL);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_seqtree_lookup32_le(seqtree, i * 2 + 1) == GINT_TO_POINTER(i));
+        g_assert_true(wmem_seqtree_lookup32_le(seqtree, i * 2 + 2) == GINT_TO_POINTER(i));
+        g_assert_true(wmem_seqtree_lookup32(seqtree, i * 2 + 2) == NULL);
+    }
+    g_assert_true(wmem_seqtree_remove32(seqtree, 1) == GINT_TO_POINTER(0));
+    g_assert_true(wmem_seqtree_lookup32(seqtree, 1) == NULL);
+    wmem_seqtree_insert32(seqtree, 3, GINT_TO_POINTER(42));
+    g_assert_true(wmem_seqtree_lookup32(seqtree, 3) == GINT_TO_POINTER(42));
+    g_assert_true(wmem_seqtree_count(seqtree) == CONTAINER_ITERS);
+    wmem_free_all(allocator);
+
+    /* random keys and lookups behave like a wmem_tree */
+    seqtree = wmem_seqtree_new(allocator);
+    tree = wmem_tree_new(allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key = g_test_rand_int_range(0, CONTAINER_ITERS * 4);
+        wmem_seqtree_insert32(seqtree, key, GINT_TO_POINTER(i));
+        wmem_tree_insert32(tree, key, GINT_TO_POINTER(i));
+
+        key = g_test_rand_int_range(0, CONTAINER_ITERS * 4);
+        g_assert_true(wmem_seqtree_lookup32(seqtree, key) == wmem_tree_lookup32(tree, key));
+        g_assert_true(wmem_seqtree_lookup32_le(seqtree, key) == wmem_tree_lookup32_le(tree, key));
+    }
+    g_assert_true(wmem_seqtree_count(seqtree) == wmem_tree_count(tree));
+    g_assert_true(wmem_seqtree_lookup32_le(seqtree, G_MAXUINT32) == wmem_tree_lookup32_le(tree, G_MAXUINT32));
+    wmem_free_all(allocator);
+
+    /* increasing keys that wrap around 2^32, like TCP sequence numbers */
+    seqtree = wmem_seqtree_new(allocator);
+    tree = wmem_tree_new(allocator);
+    key = G_MAXUINT32 - CONTAINER_ITERS * 5;
+    for (i=0; i<CONTAINER_ITERS * 2; i++) {
+        key += g_test_rand_int_range(1, 10);
+        wmem_seqtree_insert32(seqtree, key, GINT_TO_POINTER(i));
+        wmem_tree_insert32(tree, key, GINT_TO_POINTER(i));
+        g_assert_true(wmem_seqtree_lookup32(seqtree, key) == GINT_TO_POINTER(i));
+        g_assert_true(wmem_seqtree_lookup32_le(seqtree, key - 1) == wmem_tree_lookup32_le(tree, key - 1));
+    }
+    g_assert_true(wmem_seqtree_count(seqtree) == wmem_tree_count(tree));
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key = g_test_rand_int();
+        g_assert_true(wmem_seqtree_lookup32(seqtree, key) == wmem_tree_lookup32(tree, key));
+        g_assert_true(wmem_seqtree_lookup32_le(seqtree, key) == wmem_tree_lookup32_le(tree, key));
+    }
+    g_assert_true(wmem_seqtree_lookup32_le(seqtree, 0) == wmem_tree_lookup32_le(tree, 0));
+    g_assert_true(wmem_seqtree_lookup32_le(seqtree, G_MAXUINT32) == wmem_tree_lookup32_le(tree, G_MAXUINT32));
+
+    wmem_destroy_allocator(allocator);
+}
+
 
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
@@ -1450,6 +1566,7 @@ main(int argc, char **argv)
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/wmem/allocator/block",     wmem_test_allocator_block);
+    g_test_add_func("/wmem/allocator/block_mapped", wmem_test_allocator_block_mapped);
     g_test_add_func("/wmem/allocator/blk_fast",  wmem_test_allocator_block_fast);
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
@@ -1471,6 +1588,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/strbuf/validate", wmem_test_strbuf_validate);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
+    g_test_add_func("/wmem/datastruct/seqtree", wmem_test_seqtree);
 
     ret = g_test_run();
 
@@ -0,0 +1,361 @@
+/* ws_memsearch.c
+ * Literal single- and multi-pattern substring search
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "ws_memsearch.h"
+
+#include <string.h>
+
+#include <wsutil/bits_ctz.h>
+#include <wsutil/ws_assert.h>
+#include <wsutil/wmem/wmem_strutl.h>
+
+/*
+ * SSE2 is part of the x86-64 baseline, so unlike the SSE4.2 code in
+ * ws_mempbrk_sse42.c no run-time CPU check or special compiler flag is
+ * needed here.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_MEMSEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#define AC_NO_STATE     G_MAXUINT32
+#define AC_NO_OUTPUT    G_MAXUINT32
+
+struct _ws_memsearch_t {
+    guint flags;
+    gboolean compiled;
+    GPtrArray *patterns;        /* GByteArray *, folded if WS_MEMSEARCH_NOCASE */
+    guint8 fold[256];           /* identity, or ASCII lower-casing */
+
+    /*
+     * Aho-Corasick automaton, used with more than one pattern. The
+     * transition table is complete (the failure links are folded into
+     * it), so scanning costs one table lookup per haystack byte.
+     */
+    guint32 *delta;             /* n_states * 256 transitions */
+    guint32 *output;            /* longest pattern ending in each state */
+    guint n_states;
+};
+
+ws_memsearch_t *
+ws_memsearch_new(guint flags)
+{
+    ws_memsearch_t *ms = g_new0(ws_memsearch_t, 1);
+    int i;
+
+    ms->flags = flags;
+    ms->patterns = g_ptr_array_new_with_free_func((GDestroyNotify)g_byte_array_unref);
+    for (i = 0; i < 256; i++) {
+        if (flags & WS_MEMSEARCH_NOCASE)
+            ms->fold[i] = (guint8)g_ascii_tolower(i);
+        else
+            ms->fold[i] = (guint8)i;
+    }
+    return ms;
+}
+
+guint
+ws_memsearch_add(ws_memsearch_t *ms, const void *needle, size_t needle_len)
+{
+    const guint8 *p = (const guint8 *)needle;
+    GByteArray *pattern;
+    size_t i;
+
+    ws_assert(!ms->compiled);
+
+    pattern = g_byte_array_sized_new((guint)needle_len);
+    g_byte_array_set_size(pattern, (guint)needle_len);
+    for (i = 0; i < needle_len; i++)
+        pattern->data[i] = ms->fold[p[i]];
+    g_ptr_array_add(ms->patterns, pattern);
+
+    return ms->patterns->len - 1;
+}
+
+static guint32
+ac_new_state(GArray *delta, GArray *output)
+{
+    guint32 state = output->len;
+    guint32 no_output = AC_NO_OUTPUT;
+
+    g_array_set_size(delta, (state + 1) * 256);
+    memset(&g_array_index(delta, guint32, state * 256), 0xff, 256 * sizeof(guint32));
+    g_array_append_val(output, no_output);
+    return state;
+}
+
+static void
+ac_build(ws_memsearch_t *ms)
+{
+    GArray *delta_arr = g_array_new(FALSE, FALSE, sizeof(guint32));
+    GArray *output_arr = g_array_new(FALSE, FALSE, sizeof(guint32));
+    guint32 *delta, *output, *fail, *queue;
+    guint head, tail, idx, c;
+    guint32 state, next;
+
+    /* Build the trie. State 0 is the root. */
+    ac_new_state(delta_arr, output_arr);
+    for (idx = 0; idx < ms->patterns->len; idx++) {
+        GByteArray *pattern = (GByteArray *)g_ptr_array_index(ms->patterns, idx);
+
+        if (pattern->len == 0)
+            continue;
+
+        state = 0;
+        for (c = 0; c < pattern->len; c++) {
+            next = g_array_index(delta_arr, guint32, state * 256 + pattern->data[c]);
+            if (next == AC_NO_STATE) {
+                next = ac_new_state(delta_arr, output_arr);
+                g_array_index(delta_arr, guint32, state * 256 + pattern->data[c]) = next;
+            }
+            state = next;
+        }
+        /* Duplicate patterns report the first one added. */
+        if (g_array_index(output_arr, guint32, state) == AC_NO_OUTPUT)
+            g_array_index(output_arr, guint32, state) = idx;
+    }
+
+    ms->n_states = output_arr->len;
+    ms->delta = (guint32 *)g_array_free(delta_arr, FALSE);
+    ms->output = (guint32 *)g_array_free(output_arr, FALSE);
+    delta = ms->delta;
+    output = ms->output;
+
+    /*
+     * Compute the failure links breadth-first and use them to fill
+     * in the missing transitions. A state that does not end a pattern
+     * itself inherits the longest pattern ending in its failure state.
+     */
+    fail = g_new0(guint32, ms->n_states);
+    queue = g_new(guint32, ms->n_states);
+    head = tail = 0;
+
+    for (c = 0; c < 256; c++) {
+        next = delta[c];
+        if (next == AC_NO_STATE) {
+            delta[c] = 0;
+        } else {
+            fail[next] = 0;
+            queue[tail++] = next;
+        }
+    }
+
+    while (head < tail) {
+        state = queue[head++];
+        if (output[state] == AC_NO_OUTPUT)
+            output[state] = output[fail[state]];
+
+        for (c = 0; c < 256; c++) {
+            next = delta[state * 256 + c];
+            if (next == AC_NO_STATE) {
+                delta[state * 256 + c] = delta[fail[state] * 256 + c];
+            } else {
+                fail[next] = delta[fail[state] * 256 + c];
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    g_free(queue);
+    g_free(fail);
+}
+
+void
+ws_memsearch_compile(ws_memsearch_t *ms)
+{
+    ws_assert(!ms->compiled);
+
+    if (ms->patterns->len > 1)
+        ac_build(ms);
+    ms->compiled = TRUE;
+}
+
+ws_memsearch_t *
+ws_memsearch_new_single(const void *needle, size_t needle_len, guint flags)
+{
+    ws_memsearch_t *ms = ws_memsearch_new(flags);
+
+    ws_memsearch_add(ms, needle, needle_len);
+    ws_memsearch_compile(ms);
+    return ms;
+}
+
+guint
+ws_memsearch_count(const ws_memsearch_t *ms)
+{
+    return ms->patterns->len;
+}
+
+size_t
+ws_memsearch_pattern_len(const ws_memsearch_t *ms, guint pattern_idx)
+{
+    ws_assert(pattern_idx < ms->patterns->len);
+    return ((GByteArray *)g_ptr_array_index(ms->patterns, pattern_idx))->len;
+}
+
+static inline gboolean
+memsearch_eq(const ws_memsearch_t *ms, const guint8 *hay, const guint8 *needle, size_t len)
+{
+    size_t i;
+
+    if (!(ms->flags & WS_MEMSEARCH_NOCASE))
+        return memcmp(hay, needle, len) == 0;
+
+    for (i = 0; i < len; i++) {
+        if (ms->fold[hay[i]] != needle[i])
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static const guint8 *
+memsearch_single_portable(const ws_memsearch_t *ms, const guint8 *hay, size_t hay_len,
+                const guint8 *needle, size_t needle_len)
+{
+    const guint8 *p, *last;
+
+    if (hay_len < needle_len)
+        return NULL;
+
+    if (!(ms->flags & WS_MEMSEARCH_NOCASE))
+        return ws_memmem(hay, hay_len, needle, needle_len);
+
+    last = hay + hay_len - needle_len;
+    for (p = hay; p <= last; p++) {
+        if (ms->fold[*p] == needle[0] &&
+                memsearch_eq(ms, p + 1, needle + 1, needle_len - 1))
+            return p;
+    }
+    return NULL;
+}
+
+#ifdef HAVE_MEMSEARCH_SSE2
+/*
+ * Compare 16 candidate positions at a time against the first and the
+ * last byte of the needle and only verify the positions where both
+ * match; see "SIMD-friendly algorithms for substring searching" by
+ * Wojciech Muła.
+ */
+static const guint8 *
+memsearch_single_sse2(const ws_memsearch_t *ms, const guint8 *hay, size_t hay_len,
+                const guint8 *needle, size_t needle_len)
+{
+    const guint8 first = needle[0];
+    const guint8 last = needle[needle_len - 1];
+    const gboolean nocase = (ms->flags & WS_MEMSEARCH_NOCASE) != 0;
+    const __m128i first_a = _mm_set1_epi8((char)first);
+    const __m128i first_b = _mm_set1_epi8((char)(nocase ? g_ascii_toupper(first) : first));
+    const __m128i last_a = _mm_set1_epi8((char)last);
+    const __m128i last_b = _mm_set1_epi8((char)(nocase ? g_ascii_toupper(last) : last));
+    size_t i;
+
+    for (i = 0; i + needle_len + 15 <= hay_len; i += 16) {
+        const __m128i block_first = _mm_loadu_si128((const __m128i *)(const void *)(hay + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i *)(const void *)(hay + i + needle_len - 1));
+        const __m128i eq_first = _mm_or_si128(_mm_cmpeq_epi8(first_a, block_first),
+                                              _mm_cmpeq_epi8(first_b, block_first));
+        const __m128i eq_last = _mm_or_si128(_mm_cmpeq_epi8(last_a, block_last),
+                                             _mm_cmpeq_epi8(last_b, block_last));
+        guint32 mask = (guint32)_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+
+        while (mask != 0) {
+            int bit = ws_ctz(mask);
+
+            if (memsearch_eq(ms, hay + i + bit + 1, needle + 1, needle_len - 1))
+                return hay + i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    return memsearch_single_portable(ms, hay + i, hay_len - i, needle, needle_len);
+}
+#endif
+
+static const guint8 *
+memsearch_ac(const ws_memsearch_t *ms, const guint8 *hay, size_t hay_len, guint *pattern_idx)
+{
+    const guint8 *p, *end = hay + hay_len;
+    const guint32 *delta = ms->delta;
+    const guint32 *output = ms->output;
+    size_t state = 0;
+
+    for (p = hay; p < end; p++) {
+        if (ms->flags & WS_MEMSEARCH_NOCASE)
+            state = delta[(state << 8) | ms->fold[*p]];
+        else
+            state = delta[(state << 8) | *p];
+
+        if (output[state] != AC_NO_OUTPUT) {
+            if (pattern_idx)
+                *pattern_idx = output[state];
+            return p + 1 - ws_memsearch_pattern_len(ms, output[state]);
+        }
+    }
+    return NULL;
+}
+
+const guint8 *
+ws_memsearch_exec(const ws_memsearch_t *ms, const void *haystack, size_t haystack_len,
+                guint *pattern_idx)
+{
+    const GByteArray *pattern;
+    const guint8 *result;
+
+    ws_assert(ms->compiled);
+
+    if (ms->patterns->len == 0 || haystack == NULL)
+        return NULL;
+
+    if (ms->patterns->len > 1)
+        return memsearch_ac(ms, (const guint8 *)haystack, haystack_len, pattern_idx);
+
+    pattern = (const GByteArray *)g_ptr_array_index(ms->patterns, 0);
+    if (pattern->len == 0)
+        return NULL;
+
+#ifdef HAVE_MEMSEARCH_SSE2
+    result = memsearch_single_sse2(ms, (const guint8 *)haystack, haystack_len,
+                                   pattern->data, pattern->len);
+#else
+    result = memsearch_single_portable(ms, (const guint8 *)haystack, haystack_len,
+                                       pattern->data, pattern->len);
+#endif
+    if (result && pattern_idx)
+        *pattern_idx = 0;
+    return result;
+}
+
+void
+ws_memsearch_free(ws_memsearch_t *ms)
+{
+    if (!ms)
+        return;
+
+    g_ptr_array_free(ms->patterns, TRUE);
+    g_free(ms->delta);
+    g_free(ms->output);
+    g_free(ms);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,93 @@
+/** @file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMSEARCH_H__
+#define __WS_MEMSEARCH_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Literal substring search over a set of one or more byte-string
+ * patterns.
+ *
+ * A searcher is created empty, patterns are added to it and it is then
+ * compiled once; after that it can be executed any number of times
+ * against different haystacks (and from several threads at once, the
+ * compiled searcher is never modified by ws_memsearch_exec()).
+ *
+ * A searcher with a single pattern uses a vectorized first/last byte
+ * filter where the platform supports it.  A searcher with several
+ * patterns is compiled into an Aho-Corasick automaton so that the
+ * haystack is scanned only once regardless of the number of patterns.
+ */
+
+/** Match ASCII letters case-insensitively. */
+#define WS_MEMSEARCH_NOCASE     0x01
+
+typedef struct _ws_memsearch_t ws_memsearch_t;
+
+/** Create an empty searcher.
+ *
+ * @param flags A combination of WS_MEMSEARCH_ flags.
+ * @return A new searcher, to be freed with ws_memsearch_free().
+ */
+WS_DLL_PUBLIC ws_memsearch_t *ws_memsearch_new(guint flags);
+
+/** Add a pattern to a searcher that has not been compiled yet.
+ *
+ * Empty patterns are accepted but never match.
+ *
+ * @return The index of the pattern, as reported by ws_memsearch_exec().
+ */
+WS_DLL_PUBLIC guint ws_memsearch_add(ws_memsearch_t *ms, const void *needle, size_t needle_len);
+
+/** Prepare the searcher for ws_memsearch_exec(). No patterns can be added
+ * afterwards.
+ */
+WS_DLL_PUBLIC void ws_memsearch_compile(ws_memsearch_t *ms);
+
+/** Convenience function to create and compile a searcher for one pattern. */
+WS_DLL_PUBLIC ws_memsearch_t *ws_memsearch_new_single(const void *needle, size_t needle_len, guint flags);
+
+/** Number of patterns added to the searcher. */
+WS_DLL_PUBLIC guint ws_memsearch_count(const ws_memsearch_t *ms);
+
+/** Length of the pattern with the given index. */
+WS_DLL_PUBLIC size_t ws_memsearch_pattern_len(const ws_memsearch_t *ms, guint pattern_idx);
+
+/** Search the haystack for any of the patterns of a compiled searcher.
+ *
+ * Of all the matches, the one that ends first is reported; if several
+ * patterns end at the same position the longest of them is reported.
+ * With a single pattern this is simply its first occurrence.
+ *
+ * @param ms The compiled searcher.
+ * @param haystack The data to search.
+ * @param haystack_len The length of the data.
+ * @param pattern_idx If not NULL, set to the index of the matching pattern.
+ * @return A pointer to the start of the match, or NULL if none of the
+ * patterns occurs in the haystack.
+ */
+WS_DLL_PUBLIC const guint8 *ws_memsearch_exec(const ws_memsearch_t *ms,
+                const void *haystack, size_t haystack_len, guint *pattern_idx);
+
+/** Free a searcher. */
+WS_DLL_PUBLIC void ws_memsearch_free(ws_memsearch_t *ms);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WS_MEMSEARCH_H__ */